@@ -0,0 +1,95 @@
+#include "Bench.hpp"
+
+#include "CPU/Tracer.hpp"
+
+#include <stb_image_write.h>
+
+namespace Bench {
+
+    void RunAdaptiveSampling(const Context& context)
+    {
+        auto scene = LoadScene(context);
+        if (!scene) return;
+
+        auto camera = MakeCamera(context);
+
+        const u32 maxSamples = std::max(context.samples, 2u);
+
+        Renderer::Settings settings {
+            .width = context.width,
+            .height = context.height,
+            .samples = maxSamples * 8,
+            .tile = context.tile
+        };
+
+        CPU::Tracer tracer(scene, settings, CPU::Tracer::Options {
+            .threads = 0,
+            .pinThreads = context.pinThreads
+        });
+
+        tracer.Render(camera);
+        std::vector<glm::vec4> reference(tracer.GetImage().begin(), tracer.GetImage().end());
+
+        struct Result
+        {
+            u32 samples { 0 };
+            f64 time { 0.0 };
+            f64 error { 0.0 };
+        };
+
+        std::vector<Result> fixed;
+
+        LOG_INFO("{:>8} | {:>10} | {:>10} | {:>10}", "mode", "avg spp", "time (ms)", "rel. rmse");
+
+        for (u32 samples = 1; samples <= maxSamples; samples *= 2) {
+            tracer.SetSampleCount(samples);
+
+            auto stats = tracer.Render(camera);
+            f64 error = ComputeRelativeRMSE(tracer.GetImage(), reference);
+
+            fixed.push_back(Result { samples, stats.wallTime, error });
+            LOG_INFO("{:>8} | {:>10.2f} | {:>10.2f} | {:>10.5f}", "fixed", static_cast<f64>(samples), stats.wallTime * 1000.0, error);
+        }
+
+        tracer.SetSampleCount(maxSamples);
+        tracer.SetAdaptive(true, 0.01f);
+
+        auto stats = tracer.Render(camera);
+        f64 error = ComputeRelativeRMSE(tracer.GetImage(), reference);
+        f64 averageSamples = static_cast<f64>(tracer.GetAccumulator().GetTotalSamples()) / (static_cast<f64>(context.width) * context.height);
+
+        LOG_INFO("{:>8} | {:>10.2f} | {:>10.2f} | {:>10.5f}", "adaptive", averageSamples, stats.wallTime * 1000.0, error);
+
+        // Fixed-rate time needed to reach the adaptive error, interpolated in log space between the two
+        // sweep points that bracket it.
+        std::optional<f64> equalErrorTime;
+        for (usize i = 0; i < fixed.size(); ++i) {
+            if (fixed[i].error > error) continue;
+
+            if (i == 0) {
+                equalErrorTime = fixed[i].time;
+            } else {
+                const auto& a = fixed[i - 1];
+                const auto& b = fixed[i];
+                f64 t = (std::log(a.error) - std::log(error)) / std::max(std::log(a.error) - std::log(b.error), 1e-9);
+                equalErrorTime = a.time + (b.time - a.time) * t;
+            }
+            break;
+        }
+
+        if (equalErrorTime) {
+            LOG_INFO("Equal-error wall clock: fixed {:.2f} ms vs adaptive {:.2f} ms ({:.2f}x)",
+                *equalErrorTime * 1000.0, stats.wallTime * 1000.0, *equalErrorTime / stats.wallTime);
+        } else {
+            LOG_INFO("Fixed sampling did not reach the adaptive error ({:.5f}) within {} spp", error, maxSamples);
+        }
+
+        auto heatmap = tracer.GetAccumulator().BuildHeatmap(maxSamples);
+        if (stbi_write_png("adaptive_heatmap.png", static_cast<i32>(context.width), static_cast<i32>(context.height), 3, heatmap.data(), static_cast<i32>(context.width) * 3)) {
+            LOG_INFO("Sample count heatmap written to adaptive_heatmap.png (blue = 0, red = {} spp)", maxSamples);
+        } else {
+            LOG_WARN("Failed to write adaptive_heatmap.png");
+        }
+    }
+
+}
@@ -0,0 +1,187 @@
+#include "Bench.hpp"
+
+#include "Scene/AlphaCoverage.hpp"
+
+namespace Bench {
+
+    namespace {
+
+        inline constexpr u32 ATLAS_SIZE { 1024 };
+        inline constexpr u32 ATLAS_CELLS { 4 };
+        inline constexpr u32 LEAF_CARDS { 4096 };
+        inline constexpr std::array<u32, 4> CARD_TESSELLATIONS { 1, 2, 4, 8 };
+        inline constexpr u32 VALIDATION_SAMPLES { 16 };
+
+        // Atlas of 4x4 leaves with anti-aliased elliptical silhouettes, roughly half of each cell covered.
+        Scene::ImageData MakeLeafAtlas()
+        {
+            Scene::ImageData image;
+            image.width = ATLAS_SIZE;
+            image.height = ATLAS_SIZE;
+            image.channels = 4;
+            image.pixels.resize(static_cast<usize>(ATLAS_SIZE) * ATLAS_SIZE * 4);
+
+            const f32 cell = static_cast<f32>(ATLAS_SIZE / ATLAS_CELLS);
+
+            for (u32 y = 0; y < ATLAS_SIZE; ++y) {
+                for (u32 x = 0; x < ATLAS_SIZE; ++x) {
+                    const glm::vec2 local = glm::vec2(static_cast<f32>(x % (ATLAS_SIZE / ATLAS_CELLS)), static_cast<f32>(y % (ATLAS_SIZE / ATLAS_CELLS))) + 0.5f;
+                    const glm::vec2 p = (local / cell - 0.5f) / glm::vec2(0.3f, 0.45f);
+
+                    const f32 distance = (glm::length(p) - 1.0f) * cell * 0.3f;
+                    const f32 alpha = std::clamp(0.5f - distance, 0.0f, 1.0f);
+
+                    std::byte* texel = image.pixels.data() + (static_cast<usize>(y) * ATLAS_SIZE + x) * 4;
+                    texel[0] = std::byte { 40 };
+                    texel[1] = std::byte { 120 };
+                    texel[2] = std::byte { 30 };
+                    texel[3] = static_cast<std::byte>(static_cast<u8>(alpha * 255.0f + 0.5f));
+                }
+            }
+
+            return image;
+        }
+
+        // Randomly placed leaf cards, each mapping one atlas cell and tessellated into n x n quads.
+        Scene::SceneData MakeFoliage(u32 tessellation)
+        {
+            Scene::SceneData scene;
+            scene.textures.push_back(MakeLeafAtlas());
+            scene.materials.push_back(Scene::MaterialData {
+                .alphaCutoff = 0.5f,
+                .alphaMode = Scene::MaterialData::AlphaMode::Mask,
+                .baseColorTexture = 0
+            });
+
+            std::mt19937 rng(5);
+            std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+
+            Scene::Mesh mesh;
+            Scene::MeshPrimitive primitive;
+
+            for (u32 card = 0; card < LEAF_CARDS; ++card) {
+                const glm::vec3 origin = glm::vec3(unit(rng), unit(rng), unit(rng)) * 10.0f;
+                const glm::vec3 u = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) - 0.5f) * 0.3f;
+                const glm::vec3 v = glm::normalize(glm::cross(u, glm::vec3(0.0f, 1.0f, 0.0f)) + glm::vec3(0.0f, 0.5f, 0.0f)) * 0.3f;
+
+                const u32 cell = card % (ATLAS_CELLS * ATLAS_CELLS);
+                const glm::vec2 uvOrigin = glm::vec2(static_cast<f32>(cell % ATLAS_CELLS), static_cast<f32>(cell / ATLAS_CELLS)) / static_cast<f32>(ATLAS_CELLS);
+
+                const u32 base = static_cast<u32>(scene.vertices.size());
+                for (u32 j = 0; j <= tessellation; ++j) {
+                    for (u32 i = 0; i <= tessellation; ++i) {
+                        const glm::vec2 st = glm::vec2(static_cast<f32>(i), static_cast<f32>(j)) / static_cast<f32>(tessellation);
+                        scene.vertices.push_back(Scene::Vertex {
+                            .position = origin + u * st.x + v * st.y,
+                            .normal = glm::normalize(glm::cross(u, v)),
+                            .uv0 = uvOrigin + st / static_cast<f32>(ATLAS_CELLS),
+                            .tangent = glm::vec4(1.0f)
+                        });
+                    }
+                }
+
+                for (u32 j = 0; j < tessellation; ++j) {
+                    for (u32 i = 0; i < tessellation; ++i) {
+                        const u32 v0 = base + j * (tessellation + 1) + i;
+                        const u32 v1 = v0 + 1;
+                        const u32 v2 = v0 + tessellation + 1;
+                        const u32 v3 = v2 + 1;
+
+                        scene.indices.insert(scene.indices.end(), { v0, v1, v2, v1, v3, v2 });
+                    }
+                }
+            }
+
+            primitive.indexCount = static_cast<u32>(scene.indices.size());
+            mesh.primitives.push_back(primitive);
+            scene.meshes.push_back(std::move(mesh));
+            scene.nodes.push_back(Scene::Node {});
+
+            return scene;
+        }
+
+        // Bilinear REPEAT lookup, as the GPU sampler filters the base colour texture.
+        f32 SampleAlpha(const Scene::ImageData& image, const glm::vec2& uv)
+        {
+            const glm::vec2 p = uv * glm::vec2(static_cast<f32>(image.width), static_cast<f32>(image.height)) - 0.5f;
+            const glm::vec2 base = glm::floor(p);
+            const glm::vec2 f = p - base;
+
+            auto Fetch = [&](i32 x, i32 y) {
+                x = ((x % static_cast<i32>(image.width)) + static_cast<i32>(image.width)) % static_cast<i32>(image.width);
+                y = ((y % static_cast<i32>(image.height)) + static_cast<i32>(image.height)) % static_cast<i32>(image.height);
+                return std::to_integer<u8>(image.pixels[(static_cast<usize>(y) * image.width + x) * 4 + 3]) / 255.0f;
+            };
+
+            const i32 x = static_cast<i32>(base.x);
+            const i32 y = static_cast<i32>(base.y);
+
+            return glm::mix(
+                glm::mix(Fetch(x, y), Fetch(x + 1, y), f.x),
+                glm::mix(Fetch(x, y + 1), Fetch(x + 1, y + 1), f.x),
+                f.y
+            );
+        }
+
+        // Random points on every classified triangle whose alpha test disagrees with the bits; must be 0.
+        u64 CountViolations(const Scene::SceneData& scene, const Scene::AlphaCoverage& coverage)
+        {
+            using State = Scene::AlphaCoverage::State;
+
+            const auto& material = scene.materials[0];
+            const auto states = coverage.GetStates(0);
+            const auto masks = coverage.GetMasks(0);
+
+            std::mt19937 rng(17);
+            std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+
+            u64 violations = 0;
+
+            for (u32 t = 0; t < states.size(); ++t) {
+                const u32* indices = scene.indices.data() + t * 3;
+                const glm::vec2 uv0 = scene.vertices[indices[0]].uv0;
+                const glm::vec2 uv1 = scene.vertices[indices[1]].uv0;
+                const glm::vec2 uv2 = scene.vertices[indices[2]].uv0;
+
+                for (u32 s = 0; s < VALIDATION_SAMPLES; ++s) {
+                    glm::vec2 b(unit(rng), unit(rng));
+                    if (b.x + b.y > 1.0f) b = 1.0f - b;
+
+                    const bool passes = SampleAlpha(scene.textures[0], uv0 + (uv1 - uv0) * b.x + (uv2 - uv0) * b.y) * material.baseColorFactor.a >= material.alphaCutoff;
+                    const u64 bit = u64 { 1 } << Scene::AlphaCoverage::GetMicroTriangle(b);
+
+                    bool expected = passes;
+                    if (states[t] == State::Opaque || (states[t] == State::Mixed && (masks[t].opaque & bit) != 0)) expected = true;
+                    if (states[t] == State::Transparent || (states[t] == State::Mixed && (masks[t].transparent & bit) != 0)) expected = false;
+
+                    if (expected != passes) violations++;
+                }
+            }
+
+            return violations;
+        }
+
+    }
+
+    void RunAlphaCoverage(const Context&)
+    {
+        LOG_INFO("{} leaf cards, {}x{} micro-triangles per triangle", LEAF_CARDS, Scene::AlphaCoverage::SUBDIVISIONS, Scene::AlphaCoverage::SUBDIVISIONS);
+        LOG_INFO("{:>8} | {:>10} | {:>8} | {:>8} | {:>8} | {:>12} | {:>12} | {:>10} | {:>10}",
+            "cards", "triangles", "opaque", "clear", "mixed", "any-hit -%", "fetches -%", "build (ms)", "violations");
+
+        for (u32 tessellation : CARD_TESSELLATIONS) {
+            const auto scene = MakeFoliage(tessellation);
+            const auto coverage = Scene::AlphaCoverage::Build(scene);
+            const auto& stats = coverage.GetStats();
+
+            const f64 count = static_cast<f64>(stats.triangles);
+
+            LOG_INFO("{:>8} | {:>10} | {:>7.1f}% | {:>7.1f}% | {:>7.1f}% | {:>11.1f}% | {:>11.1f}% | {:>10.1f} | {:>10}",
+                fmt::format("{}x{}", tessellation, tessellation), stats.triangles,
+                100.0 * stats.opaque / count, 100.0 * stats.transparent / count, 100.0 * stats.mixed / count,
+                100.0 * (stats.opaqueArea + stats.transparentArea) / stats.area, 100.0 * stats.resolvedArea / stats.area,
+                stats.buildTime, CountViolations(scene, coverage));
+        }
+    }
+
+}
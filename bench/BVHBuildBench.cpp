@@ -0,0 +1,194 @@
+#include "Bench.hpp"
+
+#include "CPU/BVH.hpp"
+#include "CPU/CompressedBVH.hpp"
+#include "CPU/ThreadPool.hpp"
+
+namespace Bench {
+
+    namespace {
+
+        inline constexpr u32 DEEP_CLUSTER_TRIANGLES { 16384 };
+        inline constexpr u32 DEEP_CLUSTER_RAYS { 1024 };
+
+        // One small triangle per Morton bit from bit 3 up, each at a power of two along one axis, so every
+        // LBVH split peels one of them off, above a cluster of stacked triangles sharing Morton code 0
+        // that can only be split in the middle. A far corner triangle pins the quantisation grid to
+        // whole units. The result is about 60 + log2(cluster / leaf size) levels deep.
+        std::shared_ptr<Scene::SceneData> MakeDeepScene()
+        {
+            auto scene = std::make_shared<Scene::SceneData>();
+
+            auto AddTriangle = [&](const glm::vec3& centre, f32 size) {
+                const glm::vec3 normal(0.0f, 0.0f, 1.0f);
+                for (const auto& offset : { glm::vec3(-size, -size, 0.0f), glm::vec3(size, -size, 0.0f), glm::vec3(-size, size, 0.0f) }) {
+                    scene->indices.push_back(static_cast<u32>(scene->vertices.size()));
+                    scene->vertices.push_back(Scene::Vertex { .position = centre + offset, .normal = normal, .uv0 = glm::vec2(0.0f), .tangent = glm::vec4(0.0f) });
+                }
+            };
+
+            for (u32 i = 0; i < DEEP_CLUSTER_TRIANGLES; ++i) {
+                AddTriangle(glm::vec3(0.0f, 0.0f, 0.9f * static_cast<f32>(i) / static_cast<f32>(DEEP_CLUSTER_TRIANGLES)), 0.4f);
+            }
+
+            for (u32 m = 1; m <= 20; ++m) {
+                for (u32 axis = 0; axis < 3; ++axis) {
+                    glm::vec3 centre(0.0f);
+                    centre[axis] = static_cast<f32>(1u << m) + 0.5f;
+                    AddTriangle(centre, 0.2f);
+                }
+            }
+
+            AddTriangle(glm::vec3(2097151.0f), 0.2f);
+
+            scene->materials.emplace_back();
+            scene->meshes.push_back(Scene::Mesh { .primitives = { Scene::MeshPrimitive {
+                .indexOffset = 0,
+                .indexCount = static_cast<u32>(scene->indices.size()),
+                .vertexOffset = 0,
+                .materialIndex = 0
+            } } });
+            scene->nodes.push_back(Scene::Node { .transform = glm::mat4(1.0f), .meshIndex = 0 });
+
+            return scene;
+        }
+
+        bool IntersectAll(const CPU::Geometry& geometry, const CPU::Ray& ray, CPU::Hit& hit)
+        {
+            bool found = false;
+
+            for (u32 prim = 0; prim < geometry.GetTriangleCount(); ++prim) {
+                f32 t, u, v;
+                if (CPU::IntersectTriangle(ray, geometry.GetVertex(prim, 0).position, geometry.GetVertex(prim, 1).position,
+                    geometry.GetVertex(prim, 2).position, std::min(ray.tMax, hit.t), t, u, v))
+                {
+                    hit.t = t;
+                    hit.primitive = prim;
+                    found = true;
+                }
+            }
+
+            return found;
+        }
+
+    }
+
+    void RunBVHBuilders(const Context& context)
+    {
+        auto scene = LoadScene(context);
+        if (!scene) return;
+
+        auto geometry = std::make_shared<CPU::Geometry>(*scene);
+
+        struct Config
+        {
+            std::string_view name;
+            CPU::BVH::BuildSettings settings;
+        };
+
+        const std::array configs {
+            Config { "binned SAH", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::BinnedSAH } },
+            Config { "LBVH 30", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::LBVH, .mortonBits = 30 } },
+            Config { "LBVH 63", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::LBVH, .mortonBits = 63 } },
+            Config { "PLOC r8", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::PLOC, .plocRadius = 8 } },
+            Config { "PLOC r16", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::PLOC, .plocRadius = 16 } }
+        };
+
+        std::vector<CPU::Ray> rays;
+
+        LOG_INFO("{} triangles, {} pool threads", geometry->GetTriangleCount(), CPU::ThreadPool::Get().GetThreadCount());
+        LOG_INFO("{:>10} | {:>10} | {:>8} | {:>8} | {:>8}", "builder", "build (ms)", "nodes", "SAH", "Mrays/s");
+
+        for (const auto& config : configs) {
+            f64 buildTime = std::numeric_limits<f64>::max();
+            std::unique_ptr<CPU::BVH> bvh;
+
+            for (u32 run = 0; run < 3; ++run) {
+                auto start = std::chrono::steady_clock::now();
+                bvh = std::make_unique<CPU::BVH>(geometry, config.settings);
+                std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+
+                buildTime = std::min(buildTime, elapsed.count());
+            }
+
+            if (rays.empty()) {
+                rays = GenerateRays(bvh->GetBounds(), 1u << 20);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& ray : rays) {
+                CPU::Hit hit;
+                bvh->Intersect(ray, hit);
+            }
+            std::chrono::duration<f64> traceTime = std::chrono::steady_clock::now() - start;
+
+            LOG_INFO("{:>10} | {:>10.2f} | {:>8} | {:>8.2f} | {:>8.2f}",
+                config.name, buildTime * 1000.0, bvh->GetNodeCount(), bvh->ComputeSAHCost(), rays.size() / 1e6 / traceTime.count());
+        }
+    }
+
+    // Trees deeper than the fixed traversal stacks: checks every builder, binary and compressed, against
+    // brute force on rays into the cluster at the bottom of the Morton chain and onto each chain triangle.
+    void RunDeepBVH(const Context&)
+    {
+        auto scene = MakeDeepScene();
+        auto geometry = std::make_shared<CPU::Geometry>(*scene);
+
+        std::mt19937 rng(29);
+        std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+
+        std::vector<CPU::Ray> rays;
+        for (u32 i = 0; i < DEEP_CLUSTER_RAYS; ++i) {
+            const glm::vec3 target(unit(rng) * 0.6f - 0.4f, unit(rng) * 0.6f - 0.4f, unit(rng) * 0.9f);
+            const glm::vec3 origin(unit(rng) * 4.0f - 2.0f, unit(rng) * 4.0f - 2.0f, 3.0f);
+            rays.push_back(CPU::Ray { .origin = origin, .tMin = 0.001f, .direction = glm::normalize(target - origin), .tMax = 1e7f });
+        }
+
+        for (u32 prim = DEEP_CLUSTER_TRIANGLES; prim < geometry->GetTriangleCount(); ++prim) {
+            const glm::vec3 centroid = geometry->GetBounds(prim).Centroid();
+            rays.push_back(CPU::Ray { .origin = centroid + glm::vec3(-0.1f, -0.1f, 1.0f), .tMin = 0.001f, .direction = glm::vec3(0.0f, 0.0f, -1.0f), .tMax = 1e7f });
+        }
+
+        std::vector<CPU::Hit> reference(rays.size());
+        for (usize i = 0; i < rays.size(); ++i) {
+            IntersectAll(*geometry, rays[i], reference[i]);
+        }
+
+        struct Config
+        {
+            std::string_view name;
+            CPU::BVH::BuildSettings settings;
+        };
+
+        const std::array configs {
+            Config { "binned SAH", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::BinnedSAH } },
+            Config { "LBVH 63", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::LBVH, .mortonBits = 63 } },
+            Config { "PLOC r16", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::PLOC, .plocRadius = 16 } },
+            Config { "SBVH", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::SBVH } }
+        };
+
+        LOG_INFO("{} triangles, {} rays", geometry->GetTriangleCount(), rays.size());
+        LOG_INFO("{:>10} | {:>6} | {:>10} | {:>9} | {:>10}", "builder", "depth", "mismatches", "wide depth", "mismatches");
+
+        for (const auto& config : configs) {
+            CPU::BVH bvh(geometry, config.settings);
+            CPU::CompressedBVH compressed(bvh);
+
+            u32 binaryErrors = 0;
+            u32 wideErrors = 0;
+
+            for (usize i = 0; i < rays.size(); ++i) {
+                CPU::Hit binary;
+                const bool binaryFound = bvh.Intersect(rays[i], binary);
+                if (binary.primitive != reference[i].primitive || binaryFound != bvh.Occluded(rays[i])) binaryErrors++;
+
+                CPU::Hit wide;
+                const bool wideFound = compressed.Intersect(rays[i], wide);
+                if (wide.primitive != reference[i].primitive || wideFound != compressed.Occluded(rays[i])) wideErrors++;
+            }
+
+            LOG_INFO("{:>10} | {:>6} | {:>10} | {:>10} | {:>10}", config.name, bvh.GetMaxDepth(), binaryErrors, compressed.GetMaxDepth(), wideErrors);
+        }
+    }
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Scene/SceneData.hpp"
+#include "Scene/Camera.hpp"
+#include "CPU/Math.hpp"
+
+namespace Bench {
+
+    struct Context
+    {
+        std::filesystem::path scene;
+        u32 width { 1280 };
+        u32 height { 720 };
+        u32 samples { 4 };
+        u32 tile { 128 };
+        u32 maxThreads { 64 };
+        bool pinThreads { false };
+    };
+
+    std::shared_ptr<Scene::SceneData> LoadScene(const Context& context);
+    Scene::CameraData MakeCamera(const Context& context);
+    std::vector<CPU::Ray> GenerateRays(const CPU::AABB& bounds, u32 count);
+    f64 ComputeRelativeRMSE(std::span<const glm::vec4> image, std::span<const glm::vec4> reference);
+
+    void RunTileScaling(const Context& context);
+    void RunAdaptiveSampling(const Context& context);
+    void RunTriangleLayout(const Context& context);
+    void RunBVHBuilders(const Context& context);
+    void RunDeepBVH(const Context& context);
+    void RunRefit(const Context& context);
+    void RunSpatialSplits(const Context& context);
+    void RunCompressedBVH(const Context& context);
+    void RunSamplingSequences(const Context& context);
+    void RunImageWriter(const Context& context);
+    void RunDenoiser(const Context& context);
+    void RunLightSampling(const Context& context);
+    void RunEnvironmentMap(const Context& context);
+    void RunWavefront(const Context& context);
+    void RunAlphaCoverage(const Context& context);
+    void RunProcedural(const Context& context);
+
+}
@@ -0,0 +1,147 @@
+#include "Bench.hpp"
+
+#include "CPU/BVH.hpp"
+#include "CPU/CompressedBVH.hpp"
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+    // Hardware cache-miss counter for the calling thread. Reads as nullopt where perf events are
+    // unavailable (non-Linux, containers, perf_event_paranoid).
+    class CacheMissCounter
+    {
+    public:
+        CacheMissCounter()
+        {
+#if defined(__linux__)
+            perf_event_attr attr {};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(perf_event_attr);
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            m_Fd = static_cast<i32>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+        }
+
+        ~CacheMissCounter()
+        {
+#if defined(__linux__)
+            if (m_Fd >= 0) close(m_Fd);
+#endif
+        }
+
+        CacheMissCounter(const CacheMissCounter&) = delete;
+        CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+        void Start()
+        {
+#if defined(__linux__)
+            if (m_Fd < 0) return;
+            ioctl(m_Fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_Fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+        }
+
+        std::optional<u64> Stop()
+        {
+#if defined(__linux__)
+            if (m_Fd < 0) return std::nullopt;
+            ioctl(m_Fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            u64 count = 0;
+            if (read(m_Fd, &count, sizeof(count)) != sizeof(count)) return std::nullopt;
+            return count;
+#else
+            return std::nullopt;
+#endif
+        }
+
+    private:
+        i32 m_Fd { -1 };
+    };
+
+    std::string FormatMisses(std::optional<u64> misses)
+    {
+        if (!misses) return "n/a";
+        return std::to_string(*misses);
+    }
+
+}
+
+namespace Bench {
+
+    void RunCompressedBVH(const Context& context)
+    {
+        auto scene = LoadScene(context);
+        if (!scene) return;
+
+        auto geometry = std::make_shared<CPU::Geometry>(*scene);
+
+        CPU::BVH bvh(geometry, CPU::BVH::BuildSettings {});
+        CPU::CompressedBVH compressed(bvh);
+
+        auto rays = GenerateRays(bvh.GetBounds(), 1u << 20);
+
+        CacheMissCounter counter;
+
+        auto Trace = [&](const auto& accel, std::vector<CPU::Hit>& hits, std::optional<u64>& misses) {
+            hits.assign(rays.size(), CPU::Hit {});
+
+            counter.Start();
+            auto start = std::chrono::steady_clock::now();
+            for (usize i = 0; i < rays.size(); ++i) {
+                accel.Intersect(rays[i], hits[i]);
+            }
+            std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+            misses = counter.Stop();
+
+            return elapsed.count();
+        };
+
+        std::vector<CPU::Hit> binaryHits;
+        std::vector<CPU::Hit> compressedHits;
+        std::optional<u64> binaryMisses;
+        std::optional<u64> compressedMisses;
+
+        Trace(bvh, binaryHits, binaryMisses);
+        f64 binaryTime = Trace(bvh, binaryHits, binaryMisses);
+
+        Trace(compressed, compressedHits, compressedMisses);
+        f64 compressedTime = Trace(compressed, compressedHits, compressedMisses);
+
+        u64 mismatches = 0;
+        for (usize i = 0; i < rays.size(); ++i) {
+            if (binaryHits[i].IsValid() != compressedHits[i].IsValid()) {
+                mismatches++;
+            } else if (binaryHits[i].IsValid() && std::abs(binaryHits[i].t - compressedHits[i].t) > 1e-4f * binaryHits[i].t) {
+                mismatches++;
+            }
+        }
+
+        const f64 mrays = static_cast<f64>(rays.size()) / 1e6;
+        const usize binaryNodeBytes = bvh.GetNodeCount() * sizeof(CPU::BVH::Node);
+
+        LOG_INFO("{:>10} | {:>7} | {:>11} | {:>10} | {:>8} | {:>12}", "layout", "nodes", "nodes (KiB)", "time (ms)", "Mrays/s", "cache misses");
+        LOG_INFO("{:>10} | {:>7} | {:>11.1f} | {:>10.2f} | {:>8.2f} | {:>12}", "binary", bvh.GetNodeCount(), binaryNodeBytes / 1024.0,
+            binaryTime * 1000.0, mrays / binaryTime, FormatMisses(binaryMisses));
+        LOG_INFO("{:>10} | {:>7} | {:>11.1f} | {:>10.2f} | {:>8.2f} | {:>12}", "compressed", compressed.GetNodeCount(), compressed.GetNodeMemoryUsage() / 1024.0,
+            compressedTime * 1000.0, mrays / compressedTime, FormatMisses(compressedMisses));
+
+        LOG_INFO("Node memory reduced {:.2f}x, trace time {:.2f}x of binary, {} hit mismatches",
+            static_cast<f64>(binaryNodeBytes) / std::max<usize>(1, compressed.GetNodeMemoryUsage()), compressedTime / binaryTime, mismatches);
+
+        if (binaryMisses && compressedMisses && *binaryMisses > 0) {
+            LOG_INFO("Cache misses reduced by {:.1f}%", 100.0 * (1.0 - static_cast<f64>(*compressedMisses) / static_cast<f64>(*binaryMisses)));
+        }
+    }
+
+}
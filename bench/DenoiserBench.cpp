@@ -0,0 +1,126 @@
+#include "Bench.hpp"
+
+#include "CPU/Tracer.hpp"
+#include "CPU/Denoiser.hpp"
+
+namespace Bench {
+
+    void RunDenoiser(const Context& context)
+    {
+        auto scene = LoadScene(context);
+        if (!scene) return;
+
+        // Quarter resolution keeps the high sample count reference affordable.
+        Context small = context;
+        small.width = std::max(1u, context.width / 4);
+        small.height = std::max(1u, context.height / 4);
+
+        auto camera = MakeCamera(small);
+
+        const u32 maxSamples = std::bit_ceil(std::max(context.samples * 16, 16u));
+
+        Renderer::Settings settings {
+            .width = small.width,
+            .height = small.height,
+            .samples = maxSamples * 16,
+            .tile = context.tile
+        };
+
+        CPU::Tracer tracer(scene, settings, CPU::Tracer::Options {
+            .threads = 0,
+            .pinThreads = context.pinThreads
+        });
+
+        tracer.Render(camera);
+        std::vector<glm::vec4> reference(tracer.GetImage().begin(), tracer.GetImage().end());
+
+        tracer.SetSampleSequence(CPU::SampleSequence(CPU::SampleSequence::Type::Sobol, 1));
+
+        CPU::Denoiser denoiser(CPU::Denoiser::Settings {});
+
+        struct Point
+        {
+            u32 samples { 0 };
+            f64 raw { 0.0 };
+            f64 denoised { 0.0 };
+        };
+
+        std::vector<Point> points;
+
+        LOG_INFO("{:>7} | {:>10} | {:>10} | {:>10}", "spp", "raw rmse", "denoised", "time (ms)");
+
+        for (u32 samples = 1; samples <= maxSamples; samples *= 2) {
+            tracer.SetSampleCount(samples);
+            tracer.Render(camera);
+            tracer.ResolveFeatures();
+
+            std::vector<glm::vec4> image(tracer.GetImage().begin(), tracer.GetImage().end());
+
+            auto start = std::chrono::steady_clock::now();
+            denoiser.Apply(image, tracer.GetAccumulator(), tracer.GetFeatures());
+            std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+
+            Point point { samples, ComputeRelativeRMSE(tracer.GetImage(), reference), ComputeRelativeRMSE(image, reference) };
+            points.push_back(point);
+
+            LOG_INFO("{:>7} | {:>10.5f} | {:>10.5f} | {:>10.2f}", samples, point.raw, point.denoised, elapsed.count() * 1000.0);
+        }
+
+        // Raw samples needed to match each denoised error, interpolated in log-log space.
+        for (const auto& point : points) {
+            std::optional<f64> equalErrorSamples;
+            for (usize i = 0; i < points.size(); ++i) {
+                if (points[i].raw > point.denoised) continue;
+
+                if (i == 0) {
+                    equalErrorSamples = points[i].samples;
+                } else {
+                    const auto& a = points[i - 1];
+                    const auto& b = points[i];
+                    f64 t = (std::log(a.raw) - std::log(point.denoised)) / std::max(std::log(a.raw) - std::log(b.raw), 1e-9);
+                    equalErrorSamples = std::exp(std::log(static_cast<f64>(a.samples)) + (std::log(static_cast<f64>(b.samples)) - std::log(static_cast<f64>(a.samples))) * t);
+                }
+                break;
+            }
+
+            if (equalErrorSamples && *equalErrorSamples < point.samples) {
+                // Where little noise is left the filter mostly blurs edges and shading, which costs accuracy.
+                LOG_INFO("Denoised {} spp is worse than raw, matching raw {:.1f} spp", point.samples, *equalErrorSamples);
+            } else if (equalErrorSamples) {
+                LOG_INFO("Denoised {} spp matches raw {:.1f} spp ({:.2f}x fewer samples)", point.samples, *equalErrorSamples, *equalErrorSamples / point.samples);
+            } else {
+                LOG_INFO("Denoised {} spp beats raw {} spp", point.samples, maxSamples);
+            }
+        }
+
+        // Filter cost at 4K is independent of the sample count, so one sample is enough to time it.
+        constexpr u32 WIDTH_4K = 3840;
+        constexpr u32 HEIGHT_4K = 2160;
+
+        tracer.Resize(WIDTH_4K, HEIGHT_4K);
+        tracer.SetSampleCount(1);
+
+        Context large = context;
+        large.width = WIDTH_4K;
+        large.height = HEIGHT_4K;
+
+        auto camera4K = MakeCamera(large);
+        tracer.Render(camera4K);
+
+        tracer.ResolveFeatures();
+
+        std::vector<glm::vec4> image(tracer.GetImage().begin(), tracer.GetImage().end());
+
+        f64 best = std::numeric_limits<f64>::max();
+        for (u32 run = 0; run < 3; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            denoiser.Apply(image, tracer.GetAccumulator(), tracer.GetFeatures());
+            std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+
+        LOG_INFO("4K ({}x{}): filter {:.2f} ms ({:.1f} Mpixels/s, {} iterations)",
+            WIDTH_4K, HEIGHT_4K, best * 1000.0, static_cast<f64>(WIDTH_4K) * HEIGHT_4K / best / 1e6, denoiser.GetSettings().iterations);
+    }
+
+}
@@ -0,0 +1,146 @@
+#include "Bench.hpp"
+
+#include "CPU/ThreadPool.hpp"
+#include "Scene/EnvironmentMap.hpp"
+
+namespace Bench {
+
+    namespace {
+
+        inline constexpr std::array<u32, 4> MAP_WIDTHS { 2048, 4096, 8192, 16384 };
+        inline constexpr u32 SCALING_WIDTH { 16384 };
+        inline constexpr f64 SCALING_TARGET_MS { 100.0 };
+        inline constexpr u32 ESTIMATE_SAMPLES { 16 };
+        inline constexpr u32 ESTIMATE_TRIALS { 4096 };
+
+        inline constexpr f32 PI { std::numbers::pi_v<f32> };
+
+        // Dim sky gradient plus a small, very bright sun: the case where uniform sampling misses nearly
+        // all of the energy.
+        Image::DecodedImage MakeSky(u32 width)
+        {
+            Image::DecodedImage image;
+            image.width = width;
+            image.height = width / 2;
+            image.pixels.resize(static_cast<usize>(image.width) * image.height);
+
+            const glm::vec3 sun = glm::normalize(glm::vec3(0.3f, 0.6f, 0.2f));
+
+            CPU::ThreadPool::Get().ParallelFor(image.height, 16, [&](u32 begin, u32 end) {
+                for (u32 y = begin; y < end; ++y) {
+                    for (u32 x = 0; x < image.width; ++x) {
+                        const glm::vec2 uv((x + 0.5f) / image.width, (y + 0.5f) / image.height);
+                        const glm::vec3 direction = Scene::EnvironmentMap::UVToDirection(uv);
+
+                        glm::vec3 radiance = glm::mix(glm::vec3(0.8f, 0.9f, 1.0f), glm::vec3(0.1f, 0.2f, 0.6f), std::max(direction.y, 0.0f));
+                        if (direction.y < 0.0f) radiance = glm::vec3(0.05f);
+                        if (glm::dot(direction, sun) > 0.9995f) radiance = glm::vec3(50000.0f);
+
+                        image.pixels[static_cast<usize>(y) * image.width + x] = glm::vec4(radiance, 1.0f);
+                    }
+                }
+            });
+
+            return image;
+        }
+
+    }
+
+    void RunEnvironmentMap(const Context& context)
+    {
+        LOG_INFO("{} pool threads", CPU::ThreadPool::Get().GetThreadCount());
+        LOG_INFO("{:>12} | {:>14} | {:>10} | {:>12}", "map", "distribution", "build (ms)", "Mtexels/s");
+
+        for (u32 width : MAP_WIDTHS) {
+            auto sky = MakeSky(width);
+            const u64 texels = static_cast<u64>(sky.width) * sky.height;
+
+            auto start = std::chrono::steady_clock::now();
+            auto map = Scene::EnvironmentMap::Build(std::move(sky));
+            const f64 elapsed = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            LOG_INFO("{:>12} | {:>14} | {:>10.1f} | {:>12.1f}",
+                fmt::format("{}x{}", map.GetWidth(), map.GetHeight()),
+                fmt::format("{}x{}", map.GetDistributionWidth(), map.GetDistributionHeight()),
+                elapsed, static_cast<f64>(texels) / elapsed * 1e-3);
+        }
+
+        // The build streams every texel once, so it scales with the memory bandwidth the threads can draw
+        // rather than with arithmetic; a fresh sky per run keeps only one 16K map alive at a time.
+        LOG_INFO("{:>8} | {:>10} | {:>8}", "threads", "16K (ms)", "speedup");
+
+        f64 serial = 0.0;
+        std::optional<u32> targetThreads;
+
+        for (u32 threads = 1; threads <= context.maxThreads; threads *= 2) {
+            CPU::ThreadPool pool(threads);
+            auto sky = MakeSky(SCALING_WIDTH);
+
+            auto start = std::chrono::steady_clock::now();
+            auto map = Scene::EnvironmentMap::Build(std::move(sky), pool);
+            const f64 elapsed = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            if (threads == 1) serial = elapsed;
+            if (elapsed <= SCALING_TARGET_MS && !targetThreads) targetThreads = threads;
+
+            LOG_INFO("{:>8} | {:>10.1f} | {:>7.2f}x", threads, elapsed, serial / elapsed);
+        }
+
+        if (targetThreads) {
+            LOG_INFO("16K build is under {:.0f} ms from {} threads", SCALING_TARGET_MS, *targetThreads);
+        } else {
+            LOG_INFO("16K build stays above {:.0f} ms with up to {} threads", SCALING_TARGET_MS, context.maxThreads);
+        }
+
+        // Irradiance on an upward-facing receiver, unoccluded: cosine-weighted hemisphere sampling against
+        // the environment distribution at an equal sample count.
+        auto map = Scene::EnvironmentMap::Build(MakeSky(2048));
+        const auto pixels = map.GetPixels();
+
+        f64 reference = 0.0;
+        for (u32 y = 0; y < map.GetHeight(); ++y) {
+            for (u32 x = 0; x < map.GetWidth(); ++x) {
+                const glm::vec2 uv((x + 0.5f) / map.GetWidth(), (y + 0.5f) / map.GetHeight());
+                const glm::vec3 direction = Scene::EnvironmentMap::UVToDirection(uv);
+                if (direction.y <= 0.0f) continue;
+
+                const f64 solidAngle = 2.0 * PI * PI * std::sin(PI * uv.y) / (static_cast<f64>(map.GetWidth()) * map.GetHeight());
+                reference += pixels[static_cast<usize>(y) * map.GetWidth() + x].g * direction.y * solidAngle;
+            }
+        }
+
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+
+        auto Cosine = [&](const glm::vec2& u) {
+            const f32 r = std::sqrt(u.x);
+            const f32 phi = 2.0f * PI * u.y;
+            const glm::vec3 direction(r * std::cos(phi), std::sqrt(std::max(1.0f - u.x, 0.0f)), r * std::sin(phi));
+            return direction.y > 0.0f ? map.Evaluate(direction).g * PI : 0.0f;
+        };
+
+        auto Importance = [&](const glm::vec2& u) {
+            const auto sample = map.SampleDirection(u);
+            return sample.pdf > 0.0f ? sample.radiance.g * std::max(sample.direction.y, 0.0f) / sample.pdf : 0.0f;
+        };
+
+        LOG_INFO("{:>10} | {:>10}", "method", "rel. rmse");
+
+        for (const auto& [name, estimate] : { std::pair<std::string_view, std::function<f32(const glm::vec2&)>> { "cosine", Cosine }, { "envmap", Importance } }) {
+            f64 squared = 0.0;
+
+            for (u32 trial = 0; trial < ESTIMATE_TRIALS; ++trial) {
+                f64 sum = 0.0;
+                for (u32 s = 0; s < ESTIMATE_SAMPLES; ++s) {
+                    sum += estimate(glm::vec2(unit(rng), unit(rng)));
+                }
+
+                const f64 diff = sum / ESTIMATE_SAMPLES - reference;
+                squared += diff * diff;
+            }
+
+            LOG_INFO("{:>10} | {:>10.5f}", name, std::sqrt(squared / ESTIMATE_TRIALS) / reference);
+        }
+    }
+
+}
@@ -0,0 +1,108 @@
+#include "Bench.hpp"
+
+#include "Image/ImageWriter.hpp"
+
+namespace Bench {
+
+    namespace {
+
+        // Smooth HDR gradients with per-pixel noise, roughly what a converged-but-noisy render compresses like.
+        std::vector<glm::vec4> MakeTestImage(u32 width, u32 height)
+        {
+            std::mt19937 rng(42);
+            std::uniform_real_distribution<f32> noise(0.9f, 1.1f);
+
+            std::vector<glm::vec4> pixels(static_cast<usize>(width) * height);
+            for (u32 y = 0; y < height; ++y) {
+                for (u32 x = 0; x < width; ++x) {
+                    f32 u = static_cast<f32>(x) / static_cast<f32>(width);
+                    f32 v = static_cast<f32>(y) / static_cast<f32>(height);
+
+                    glm::vec3 color(u * 4.0f, v * 2.0f, 0.5f + 0.5f * std::sin(u * 20.0f) * std::cos(v * 12.0f));
+                    pixels[static_cast<usize>(y) * width + x] = glm::vec4(color * noise(rng), 1.0f);
+                }
+            }
+
+            return pixels;
+        }
+
+    }
+
+    void RunImageWriter(const Context& context)
+    {
+        constexpr u32 WIDTH { 3840 };
+        constexpr u32 HEIGHT { 2160 };
+        constexpr u32 QUEUED_IMAGES { 8 };
+
+        auto image = MakeTestImage(WIDTH, HEIGHT);
+
+        const f64 megapixels = static_cast<f64>(WIDTH) * HEIGHT / 1e6;
+        const f64 inputMiB = static_cast<f64>(image.size() * sizeof(glm::vec4)) / (1024.0 * 1024.0);
+
+        struct Case
+        {
+            std::string_view name;
+            Image::Format format;
+            Image::EXRCompression compression;
+        };
+
+        const std::array cases {
+            Case { "exr16 zip", Image::Format::EXRHalf, Image::EXRCompression::ZIP },
+            Case { "exr16 none", Image::Format::EXRHalf, Image::EXRCompression::None },
+            Case { "exr32 zip", Image::Format::EXRFloat, Image::EXRCompression::ZIP },
+            Case { "exr32 none", Image::Format::EXRFloat, Image::EXRCompression::None },
+            Case { "pfm", Image::Format::PFM, Image::EXRCompression::None },
+            Case { "hdr", Image::Format::HDR, Image::EXRCompression::None },
+            Case { "png", Image::Format::PNG, Image::EXRCompression::None }
+        };
+
+        LOG_INFO("Single-threaded encode of a {}x{} frame ({:.1f} MiB of RGBA32F)", WIDTH, HEIGHT, inputMiB);
+        LOG_INFO("{:>10} | {:>10} | {:>9} | {:>9} | {:>8}", "format", "time (ms)", "Mpix/s", "size (MiB)", "ratio");
+
+        for (const auto& c : cases) {
+            auto start = std::chrono::steady_clock::now();
+            auto encoded = Image::ImageEncoder::Encode(c.format, WIDTH, HEIGHT, image, c.compression);
+            std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+
+            if (!encoded) {
+                LOG_WARN("{:>10} | encode failed", c.name);
+                continue;
+            }
+
+            const f64 sizeMiB = static_cast<f64>(encoded->size()) / (1024.0 * 1024.0);
+            LOG_INFO("{:>10} | {:>10.2f} | {:>9.2f} | {:>10.2f} | {:>8.2f}", c.name, elapsed.count() * 1000.0, megapixels / elapsed.count(), sizeMiB, inputMiB / sizeMiB);
+        }
+
+        // Queue a burst of fp16 EXR frames and measure how quickly the pool drains it, and how long the
+        // submitting thread was held up by the memory budget.
+        const std::filesystem::path outputDir = std::filesystem::temp_directory_path() / "pathtracer_image_bench";
+
+        LOG_INFO("{} queued 4K fp16 EXR (zip) frames, budget 256 MiB", QUEUED_IMAGES);
+        LOG_INFO("{:>7} | {:>9} | {:>10} | {:>10} | {:>10}", "threads", "frames/s", "submit (ms)", "stall (ms)", "peak (MiB)");
+
+        for (u32 threads = 1; threads <= std::min(context.maxThreads, std::max(1u, std::thread::hardware_concurrency())); threads *= 2) {
+            Image::ImageWriter writer(Image::ImageWriter::Settings {
+                .threads = threads,
+                .maxPendingBytes = 256ull << 20,
+                .exrCompression = Image::EXRCompression::ZIP
+            });
+
+            auto start = std::chrono::steady_clock::now();
+            for (u32 i = 0; i < QUEUED_IMAGES; ++i) {
+                writer.Submit(outputDir / ("frame" + std::to_string(i) + ".exr"), WIDTH, HEIGHT, std::vector<glm::vec4>(image));
+            }
+            std::chrono::duration<f64> submitted = std::chrono::steady_clock::now() - start;
+
+            writer.Flush();
+            std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+
+            auto stats = writer.GetStats();
+            LOG_INFO("{:>7} | {:>9.2f} | {:>10.2f} | {:>10.2f} | {:>10.1f}", threads, stats.written / elapsed.count(), submitted.count() * 1000.0,
+                stats.stallTime * 1000.0, static_cast<f64>(stats.peakPendingBytes) / (1024.0 * 1024.0));
+        }
+
+        std::error_code ec;
+        std::filesystem::remove_all(outputDir, ec);
+    }
+
+}
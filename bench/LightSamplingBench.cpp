@@ -0,0 +1,174 @@
+#include "Bench.hpp"
+
+#include "Scene/LightTable.hpp"
+#include "Scene/LightTree.hpp"
+
+namespace Bench {
+
+    namespace {
+
+        inline constexpr u32 LIGHT_COUNT { 1u << 15 };
+        inline constexpr u32 RECEIVER_COUNT { 4096 };
+        inline constexpr f32 FIELD_SIZE { 200.0f };
+        inline constexpr f32 LIGHT_SIZE { 0.05f };
+        inline constexpr f64 TIME_BUDGET { 0.5 };
+
+        // Many small emitters of widely varying power scattered over a large field, like street lights
+        // over a city: only a handful matter to any one shading point.
+        Scene::SceneData BuildLightField(std::mt19937& rng)
+        {
+            std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+
+            Scene::SceneData scene;
+            scene.meshes.push_back(Scene::Mesh {});
+            scene.nodes.push_back(Scene::Node { glm::mat4(1.0f), 0 });
+
+            for (u32 i = 0; i < LIGHT_COUNT; ++i) {
+                const glm::vec3 center((unit(rng) - 0.5f) * FIELD_SIZE, 1.0f + unit(rng) * 4.0f, (unit(rng) - 0.5f) * FIELD_SIZE);
+                const glm::vec3 normal = glm::normalize(glm::vec3(unit(rng) - 0.5f, -1.0f, unit(rng) - 0.5f));
+
+                const glm::vec3 tangent = glm::normalize(glm::cross(normal, glm::vec3(1.0f, 0.0f, 0.0f)));
+                const glm::vec3 bitangent = glm::cross(normal, tangent);
+
+                const u32 base = static_cast<u32>(scene.vertices.size());
+                for (const glm::vec3& corner : { tangent, -0.5f * tangent + 0.87f * bitangent, -0.5f * tangent - 0.87f * bitangent }) {
+                    scene.vertices.push_back(Scene::Vertex { .position = center + corner * LIGHT_SIZE, .normal = normal });
+                }
+
+                scene.meshes[0].primitives.push_back(Scene::MeshPrimitive {
+                    .indexOffset = static_cast<u32>(scene.indices.size()),
+                    .indexCount = 3,
+                    .vertexOffset = 0,
+                    .materialIndex = i
+                });
+                scene.indices.insert(scene.indices.end(), { base, base + 1, base + 2 });
+
+                Scene::MaterialData material;
+                material.emissiveFactor = glm::vec3(std::pow(10.0f, unit(rng) * 4.0f));
+                scene.materials.push_back(material);
+            }
+
+            return scene;
+        }
+
+        // Unoccluded irradiance / pi at a receiver facing +y from one light sample.
+        f32 EstimateDirect(const Scene::LightTable::Triangle& tri, const Scene::SceneData& scene, const glm::vec3& position, f32 pmf, const glm::vec2& u)
+        {
+            const f32 su = std::sqrt(u.x);
+            const glm::vec3 point = tri.p0 * (1.0f - su) + tri.p1 * (su * (1.0f - u.y)) + tri.p2 * (su * u.y);
+
+            const glm::vec3 toLight = point - position;
+            const f32 dist2 = glm::dot(toLight, toLight);
+            const glm::vec3 wi = toLight / std::sqrt(dist2);
+
+            const glm::vec3 lightNormal = glm::normalize(glm::cross(tri.p1 - tri.p0, tri.p2 - tri.p0));
+            const f32 cosLight = std::abs(glm::dot(lightNormal, wi));
+            const f32 cosReceiver = std::max(wi.y, 0.0f);
+
+            const f32 radiance = scene.materials[tri.material].emissiveFactor.x;
+            return radiance * cosReceiver * cosLight / dist2 * tri.area / (pmf * std::numbers::pi_v<f32>);
+        }
+
+    }
+
+    void RunLightSampling(const Context&)
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+
+        const auto scene = BuildLightField(rng);
+
+        auto start = std::chrono::steady_clock::now();
+        const auto table = Scene::LightTable::Build(scene);
+        const f64 tableTime = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        const auto tree = Scene::LightTree::Build(table);
+        const f64 treeTime = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+
+        LOG_INFO("{} lights: alias table built in {:.2f} ms, light tree in {:.2f} ms", LIGHT_COUNT, tableTime * 1000.0, treeTime * 1000.0);
+
+        std::vector<glm::vec3> receivers(RECEIVER_COUNT);
+        for (auto& p : receivers) {
+            p = glm::vec3((unit(rng) - 0.5f) * FIELD_SIZE, 0.0f, (unit(rng) - 0.5f) * FIELD_SIZE);
+        }
+
+        // Lights are tiny next to their distance, so summing every light at its centroid is an accurate
+        // reference.
+        const auto triangles = table.GetTriangles();
+        std::vector<f64> reference(RECEIVER_COUNT, 0.0);
+
+        for (u32 r = 0; r < RECEIVER_COUNT; ++r) {
+            for (const auto& tri : triangles) {
+                const glm::vec3 toLight = (tri.p0 + tri.p1 + tri.p2) / 3.0f - receivers[r];
+                const f32 dist2 = glm::dot(toLight, toLight);
+                const glm::vec3 wi = toLight / std::sqrt(dist2);
+
+                const glm::vec3 lightNormal = glm::normalize(glm::cross(tri.p1 - tri.p0, tri.p2 - tri.p0));
+                const f64 radiance = scene.materials[tri.material].emissiveFactor.x;
+
+                reference[r] += radiance * std::max(wi.y, 0.0f) * std::abs(glm::dot(lightNormal, wi)) / dist2 * tri.area / std::numbers::pi;
+            }
+        }
+
+        struct Method
+        {
+            std::string_view name;
+            std::function<f32(const glm::vec3&, f32, const glm::vec2&)> estimate;
+        };
+
+        const std::array methods {
+            Method { "alias", [&](const glm::vec3& p, f32 u, const glm::vec2& u2) {
+                const u32 index = table.Sample(u);
+                return EstimateDirect(triangles[index], scene, p, triangles[index].pdf, u2);
+            } },
+            Method { "tree", [&](const glm::vec3& p, f32 u, const glm::vec2& u2) {
+                f32 pmf = 0.0f;
+                const auto index = tree.Sample(p, glm::vec3(0.0f, 1.0f, 0.0f), u, pmf);
+                return index ? EstimateDirect(triangles[*index], scene, p, pmf, u2) : 0.0f;
+            } }
+        };
+
+        struct Result
+        {
+            u32 passes { 0 };
+            f64 time { 0.0 };
+            f64 error { 0.0 };
+        };
+
+        std::array<Result, methods.size()> results;
+
+        LOG_INFO("{:>6} | {:>7} | {:>12} | {:>10}", "method", "spp", "Msamples/s", "rel. rmse");
+
+        for (usize m = 0; m < methods.size(); ++m) {
+            std::vector<f64> sums(RECEIVER_COUNT, 0.0);
+            auto& result = results[m];
+
+            start = std::chrono::steady_clock::now();
+            while (result.time < TIME_BUDGET) {
+                for (u32 r = 0; r < RECEIVER_COUNT; ++r) {
+                    sums[r] += methods[m].estimate(receivers[r], unit(rng), glm::vec2(unit(rng), unit(rng)));
+                }
+
+                result.passes++;
+                result.time = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            f64 squared = 0.0;
+            for (u32 r = 0; r < RECEIVER_COUNT; ++r) {
+                const f64 estimate = sums[r] / result.passes;
+                const f64 diff = estimate - reference[r];
+                squared += (diff * diff) / (reference[r] * reference[r] + 1e-8);
+            }
+            result.error = std::sqrt(squared / RECEIVER_COUNT);
+
+            LOG_INFO("{:>6} | {:>7} | {:>12.2f} | {:>10.5f}", methods[m].name, result.passes,
+                static_cast<f64>(result.passes) * RECEIVER_COUNT / result.time * 1e-6, result.error);
+        }
+
+        // Error falls as 1/sqrt(time), so the squared error ratio is the equal-error time saving.
+        const f64 ratio = results[0].error / std::max(results[1].error, 1e-12);
+        LOG_INFO("Equal-time error: tree {:.2f}x lower than alias table ({:.1f}x less time for equal error)", ratio, ratio * ratio);
+    }
+
+}
@@ -0,0 +1,124 @@
+#include "Bench.hpp"
+
+#include "Scene/SceneLoader.hpp"
+#include "Scene/CameraSystem.hpp"
+#include "CPU/Accumulator.hpp"
+#include "PathConfig.inl"
+
+namespace {
+
+    struct Entry
+    {
+        std::string_view name;
+        std::function<void(const Bench::Context&)> run;
+    };
+
+    const std::array s_Benchmarks {
+        Entry { "tiles", Bench::RunTileScaling },
+        Entry { "adaptive", Bench::RunAdaptiveSampling },
+        Entry { "triangles", Bench::RunTriangleLayout },
+        Entry { "builders", Bench::RunBVHBuilders },
+        Entry { "deep", Bench::RunDeepBVH },
+        Entry { "refit", Bench::RunRefit },
+        Entry { "sbvh", Bench::RunSpatialSplits },
+        Entry { "compressed", Bench::RunCompressedBVH },
+        Entry { "sampling", Bench::RunSamplingSequences },
+        Entry { "images", Bench::RunImageWriter },
+        Entry { "denoise", Bench::RunDenoiser },
+        Entry { "lights", Bench::RunLightSampling },
+        Entry { "envmap", Bench::RunEnvironmentMap },
+        Entry { "wavefront", Bench::RunWavefront },
+        Entry { "alpha", Bench::RunAlphaCoverage },
+        Entry { "procedural", Bench::RunProcedural }
+    };
+
+    u32 ParseU32(std::string_view value, u32 fallback)
+    {
+        u32 result = fallback;
+        std::from_chars(value.data(), value.data() + value.size(), result);
+        return result;
+    }
+
+}
+
+namespace Bench {
+
+    std::shared_ptr<Scene::SceneData> LoadScene(const Context& context)
+    {
+        auto scene = Scene::GlTFLoader::Load(context.scene);
+        if (!scene) return nullptr;
+
+        return std::make_shared<Scene::SceneData>(std::move(*scene));
+    }
+
+    Scene::CameraData MakeCamera(const Context& context)
+    {
+        Scene::CameraState state;
+        state.position = glm::vec3(0.0f, 0.0f, 4.0f);
+
+        return Scene::CameraSystem::ComputeShaderData(state, static_cast<f32>(context.width) / static_cast<f32>(context.height));
+    }
+
+    std::vector<CPU::Ray> GenerateRays(const CPU::AABB& bounds, u32 count)
+    {
+        std::mt19937 rng(1337);
+        std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+
+        const glm::vec3 extent = bounds.Extent();
+
+        std::vector<CPU::Ray> rays(count);
+        for (auto& ray : rays) {
+            ray.origin = bounds.min + glm::vec3(unit(rng), unit(rng), unit(rng)) * extent;
+            ray.direction = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) * 2.0f - 1.0f);
+            ray.tMin = 0.001f;
+            ray.tMax = 1000.0f;
+        }
+
+        return rays;
+    }
+
+    f64 ComputeRelativeRMSE(std::span<const glm::vec4> image, std::span<const glm::vec4> reference)
+    {
+        f64 sum = 0.0;
+        for (usize i = 0; i < image.size(); ++i) {
+            f64 ref = CPU::Accumulator::Luminance(glm::vec3(reference[i]));
+            f64 diff = CPU::Accumulator::Luminance(glm::vec3(image[i])) - ref;
+            sum += (diff * diff) / (ref * ref + 1e-4);
+        }
+        return std::sqrt(sum / static_cast<f64>(image.size()));
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    Logger::Init();
+
+    Bench::Context context;
+    context.scene = std::filesystem::path(PathConfig::AssetDir) / "Suzanne.glb";
+
+    std::vector<std::string_view> selected;
+
+    for (i32 i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        std::string_view value = i + 1 < argc ? std::string_view(argv[i + 1]) : std::string_view();
+
+        if (arg == "--scene" && !value.empty()) { context.scene = value; ++i; }
+        else if (arg == "--width" && !value.empty()) { context.width = ParseU32(value, context.width); ++i; }
+        else if (arg == "--height" && !value.empty()) { context.height = ParseU32(value, context.height); ++i; }
+        else if (arg == "--samples" && !value.empty()) { context.samples = ParseU32(value, context.samples); ++i; }
+        else if (arg == "--tile" && !value.empty()) { context.tile = ParseU32(value, context.tile); ++i; }
+        else if (arg == "--threads" && !value.empty()) { context.maxThreads = ParseU32(value, context.maxThreads); ++i; }
+        else if (arg == "--pin") { context.pinThreads = true; }
+        else selected.push_back(arg);
+    }
+
+    for (const auto& bench : s_Benchmarks) {
+        if (!selected.empty() && std::ranges::find(selected, bench.name) == selected.end()) continue;
+
+        LOG_INFO("=== {} ===", bench.name);
+        bench.run(context);
+    }
+
+    Logger::Shutdown();
+}
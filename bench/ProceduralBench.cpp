@@ -0,0 +1,168 @@
+#include "Bench.hpp"
+
+#include "Scene/ParticleField.hpp"
+
+#include "CPU/ThreadPool.hpp"
+
+namespace Bench {
+
+    namespace {
+
+        inline constexpr u32 PARTICLE_COUNT { 10'000'000 };
+        inline constexpr std::array<u32, 3> ICOSPHERE_LEVELS { 0, 1, 2 };
+
+        // Tessellated copies are only generated for this many particles and scaled up; 10M level-2
+        // icospheres alone would need over 100 GiB.
+        inline constexpr u32 MESH_SAMPLE { 50'000 };
+        inline constexpr u32 MESH_GRAIN { 1024 };
+
+        struct Icosphere
+        {
+            std::vector<glm::vec3> positions;
+            std::vector<u32> indices;
+        };
+
+        // Unit icosahedron with every triangle split into four per level, new vertices pushed onto the sphere.
+        Icosphere MakeIcosphere(u32 level)
+        {
+            const f32 t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+
+            Icosphere sphere;
+            sphere.positions = {
+                { -1.0f, t, 0.0f }, { 1.0f, t, 0.0f }, { -1.0f, -t, 0.0f }, { 1.0f, -t, 0.0f },
+                { 0.0f, -1.0f, t }, { 0.0f, 1.0f, t }, { 0.0f, -1.0f, -t }, { 0.0f, 1.0f, -t },
+                { t, 0.0f, -1.0f }, { t, 0.0f, 1.0f }, { -t, 0.0f, -1.0f }, { -t, 0.0f, 1.0f }
+            };
+            sphere.indices = {
+                0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+                1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+                3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+                4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1
+            };
+
+            for (auto& position : sphere.positions) position = glm::normalize(position);
+
+            for (u32 l = 0; l < level; ++l) {
+                std::unordered_map<u64, u32> midpoints;
+                std::vector<u32> indices;
+                indices.reserve(sphere.indices.size() * 4);
+
+                auto Midpoint = [&](u32 a, u32 b) {
+                    const u64 key = (static_cast<u64>(std::min(a, b)) << 32) | std::max(a, b);
+                    auto [it, inserted] = midpoints.try_emplace(key, static_cast<u32>(sphere.positions.size()));
+                    if (inserted) sphere.positions.push_back(glm::normalize(sphere.positions[a] + sphere.positions[b]));
+                    return it->second;
+                };
+
+                for (usize i = 0; i < sphere.indices.size(); i += 3) {
+                    const u32 v0 = sphere.indices[i + 0];
+                    const u32 v1 = sphere.indices[i + 1];
+                    const u32 v2 = sphere.indices[i + 2];
+                    const u32 m01 = Midpoint(v0, v1);
+                    const u32 m12 = Midpoint(v1, v2);
+                    const u32 m20 = Midpoint(v2, v0);
+
+                    indices.insert(indices.end(), { v0, m01, m20, v1, m12, m01, v2, m20, m12, m01, m12, m20 });
+                }
+
+                sphere.indices = std::move(indices);
+            }
+
+            return sphere;
+        }
+
+        // Bakes one scaled and translated icosphere per particle into a single vertex and index buffer, as
+        // the triangle path would upload it.
+        f64 InstantiateIcospheres(const Icosphere& sphere, std::span<const Scene::ProceduralPrimitive> particles, usize& bytes)
+        {
+            const usize vertexCount = sphere.positions.size();
+            const usize indexCount = sphere.indices.size();
+
+            auto start = std::chrono::steady_clock::now();
+
+            std::vector<Scene::Vertex> vertices(vertexCount * particles.size());
+            std::vector<u32> indices(indexCount * particles.size());
+
+            CPU::ThreadPool::Get().ParallelFor(static_cast<u32>(particles.size()), MESH_GRAIN, [&](u32 begin, u32 end) {
+                for (u32 p = begin; p < end; ++p) {
+                    const auto& particle = particles[p];
+                    const u32 base = static_cast<u32>(p * vertexCount);
+
+                    for (usize v = 0; v < vertexCount; ++v) {
+                        vertices[base + v] = Scene::Vertex {
+                            .position = particle.a + sphere.positions[v] * particle.radius,
+                            .normal = sphere.positions[v],
+                            .uv0 = glm::vec2(0.0f),
+                            .tangent = glm::vec4(1.0f)
+                        };
+                    }
+
+                    for (usize i = 0; i < indexCount; ++i) {
+                        indices[p * indexCount + i] = base + sphere.indices[i];
+                    }
+                }
+            });
+
+            std::chrono::duration<f64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            bytes = vertices.size() * sizeof(Scene::Vertex) + indices.size() * sizeof(u32);
+            return elapsed.count();
+        }
+
+        f64 ToGiB(f64 bytes)
+        {
+            return bytes / static_cast<f64>(1ull << 30);
+        }
+
+    }
+
+    void RunProcedural(const Context&)
+    {
+        auto start = std::chrono::steady_clock::now();
+        const auto particles = Scene::ParticleField::Scatter(Scene::ParticleField::Settings {
+            .count = PARTICLE_COUNT,
+            .min = glm::vec3(-10.0f),
+            .max = glm::vec3(10.0f),
+            .capsuleFraction = 0.0f
+        });
+        std::chrono::duration<f64, std::milli> scatterTime = std::chrono::steady_clock::now() - start;
+
+        // Same conversion the Renderer runs before the procedural BLAS build.
+        start = std::chrono::steady_clock::now();
+        std::vector<CPU::AABB> aabbs(particles.size());
+        CPU::ThreadPool::Get().ParallelFor(PARTICLE_COUNT, 1u << 14, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i) {
+                aabbs[i] = CPU::AABB { particles[i].GetMin(), particles[i].GetMax() };
+            }
+        });
+        std::chrono::duration<f64, std::milli> aabbTime = std::chrono::steady_clock::now() - start;
+
+        constexpr usize AABB_BYTES { sizeof(f32) * 6 };
+        constexpr usize PROCEDURAL_BYTES { sizeof(Scene::ProceduralPrimitive) + AABB_BYTES };
+
+        LOG_INFO("{} spheres; BLAS build input is one AABB or the triangle list per sphere", PARTICLE_COUNT);
+        LOG_INFO("icosphere generation is timed on {} spheres and scaled to {}", MESH_SAMPLE, PARTICLE_COUNT);
+        LOG_INFO("{:>12} | {:>14} | {:>10} | {:>10} | {:>14}",
+            "geometry", "BLAS prims", "bytes/obj", "total GiB", "generate (ms)");
+
+        LOG_INFO("{:>12} | {:>14} | {:>10} | {:>10.2f} | {:>14.1f}",
+            "AABB", PARTICLE_COUNT, PROCEDURAL_BYTES, ToGiB(static_cast<f64>(PROCEDURAL_BYTES) * PARTICLE_COUNT),
+            scatterTime.count() + aabbTime.count());
+
+        const auto sample = std::span(particles).first(MESH_SAMPLE);
+        const f64 scale = static_cast<f64>(PARTICLE_COUNT) / MESH_SAMPLE;
+
+        for (u32 level : ICOSPHERE_LEVELS) {
+            const auto sphere = MakeIcosphere(level);
+            const u64 triangles = sphere.indices.size() / 3;
+
+            usize bytes = 0;
+            const f64 time = InstantiateIcospheres(sphere, sample, bytes);
+
+            LOG_INFO("{:>12} | {:>14} | {:>10} | {:>10.2f} | {:>14.1f}",
+                fmt::format("ico L{}", level), triangles * PARTICLE_COUNT, bytes / MESH_SAMPLE,
+                ToGiB(static_cast<f64>(bytes) * scale), time * scale);
+        }
+    }
+
+}
@@ -0,0 +1,104 @@
+#include "Bench.hpp"
+
+#include "CPU/BVH.hpp"
+
+namespace Bench {
+
+    void RunRefit(const Context& context)
+    {
+        auto scene = LoadScene(context);
+        if (!scene) return;
+
+        auto geometry = std::make_shared<CPU::Geometry>(*scene);
+
+        std::vector<glm::vec3> rest;
+        rest.reserve(geometry->GetVertices().size());
+        for (const auto& vertex : geometry->GetVertices()) {
+            rest.push_back(vertex.position);
+        }
+
+        CPU::BVH initial(geometry, CPU::BVH::BuildSettings {});
+        const CPU::AABB bounds = initial.GetBounds();
+        const glm::vec3 center = bounds.Centroid();
+        const f32 height = std::max(bounds.Extent().y, 1e-3f);
+
+        // Twist around the vertical axis plus a travelling wave, so triangles move far relative to their
+        // size and the refitted tree degrades the way skinned characters do.
+        auto Animate = [&](u32 frame) {
+            const f32 time = static_cast<f32>(frame) * 0.02f;
+            auto vertices = geometry->GetVertices();
+
+            for (usize i = 0; i < vertices.size(); ++i) {
+                glm::vec3 p = rest[i] - center;
+
+                f32 angle = std::sin(time) * (p.y / height) * std::numbers::pi_v<f32>;
+                f32 c = std::cos(angle);
+                f32 s = std::sin(angle);
+
+                p = glm::vec3(p.x * c - p.z * s, p.y, p.x * s + p.z * c);
+                p.y += std::sin(time * 3.0f + p.x * 4.0f / height) * 0.05f * height;
+
+                vertices[i].position = p + center;
+            }
+        };
+
+        auto rays = GenerateRays(bounds, 1u << 18);
+
+        auto Trace = [&](const CPU::BVH& bvh) {
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& ray : rays) {
+                CPU::Hit hit;
+                bvh.Intersect(ray, hit);
+            }
+            std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+            return rays.size() / 1e6 / elapsed.count();
+        };
+
+        auto Elapsed = [](auto start) {
+            return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+
+        constexpr u32 FRAME_COUNT { 1000 };
+        constexpr u32 SAMPLE_INTERVAL { 100 };
+
+        CPU::BVH refitted(geometry, CPU::BVH::BuildSettings {});
+
+        f64 refitTotal = 0.0;
+        f64 sahRebuildTotal = 0.0;
+        f64 lbvhRebuildTotal = 0.0;
+        u32 samples = 0;
+
+        LOG_INFO("{:>5} | {:>9} | {:>10} | {:>10} | {:>11} | {:>10} | {:>10} | {:>10}",
+            "frame", "refit ms", "SAH ms", "LBVH ms", "degradation", "refit Mr/s", "SAH Mr/s", "LBVH Mr/s");
+
+        for (u32 frame = 0; frame < FRAME_COUNT; ++frame) {
+            Animate(frame);
+
+            auto start = std::chrono::steady_clock::now();
+            refitted.Refit();
+            f64 refitTime = Elapsed(start);
+            refitTotal += refitTime;
+
+            if (frame % SAMPLE_INTERVAL != SAMPLE_INTERVAL - 1) continue;
+
+            start = std::chrono::steady_clock::now();
+            CPU::BVH sah(geometry, CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::BinnedSAH });
+            f64 sahTime = Elapsed(start);
+
+            start = std::chrono::steady_clock::now();
+            CPU::BVH lbvh(geometry, CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::LBVH });
+            f64 lbvhTime = Elapsed(start);
+
+            sahRebuildTotal += sahTime;
+            lbvhRebuildTotal += lbvhTime;
+            samples++;
+
+            LOG_INFO("{:>5} | {:>9.3f} | {:>10.2f} | {:>10.2f} | {:>10.2f}x | {:>10.2f} | {:>10.2f} | {:>10.2f}",
+                frame + 1, refitTime, sahTime, lbvhTime, refitted.GetSAHDegradation(), Trace(refitted), Trace(sah), Trace(lbvh));
+        }
+
+        LOG_INFO("Average per frame: refit {:.3f} ms, SAH rebuild {:.2f} ms, LBVH rebuild {:.2f} ms",
+            refitTotal / FRAME_COUNT, sahRebuildTotal / std::max(1u, samples), lbvhRebuildTotal / std::max(1u, samples));
+    }
+
+}
@@ -0,0 +1,107 @@
+#include "Bench.hpp"
+
+#include "CPU/Tracer.hpp"
+
+namespace Bench {
+
+    void RunSamplingSequences(const Context& context)
+    {
+        auto scene = LoadScene(context);
+        if (!scene) return;
+
+        // Quarter resolution keeps the high sample count reference affordable.
+        Context small = context;
+        small.width = std::max(1u, context.width / 4);
+        small.height = std::max(1u, context.height / 4);
+
+        auto camera = MakeCamera(small);
+
+        const u32 maxSamples = std::bit_ceil(std::max(context.samples * 16, 16u));
+
+        Renderer::Settings settings {
+            .width = small.width,
+            .height = small.height,
+            .samples = maxSamples * 16,
+            .tile = context.tile
+        };
+
+        CPU::Tracer tracer(scene, settings, CPU::Tracer::Options {
+            .threads = 0,
+            .pinThreads = context.pinThreads
+        });
+
+        tracer.Render(camera);
+        std::vector<glm::vec4> reference(tracer.GetImage().begin(), tracer.GetImage().end());
+
+        struct Curve
+        {
+            std::string_view name;
+            CPU::SampleSequence::Type type;
+            std::vector<std::pair<u32, f64>> errors;
+        };
+
+        std::array curves {
+            Curve { "random", CPU::SampleSequence::Type::Random, {} },
+            Curve { "sobol", CPU::SampleSequence::Type::Sobol, {} }
+        };
+
+        LOG_INFO("{:>8} | {:>7} | {:>10}", "sequence", "spp", "rel. rmse");
+
+        for (auto& curve : curves) {
+            // A different seed than the reference so the estimate is not correlated with it.
+            tracer.SetSampleSequence(CPU::SampleSequence(curve.type, 1));
+
+            for (u32 samples = 2; samples <= maxSamples; samples *= 2) {
+                tracer.SetSampleCount(samples);
+                tracer.Render(camera);
+
+                f64 error = ComputeRelativeRMSE(tracer.GetImage(), reference);
+                curve.errors.emplace_back(samples, error);
+
+                LOG_INFO("{:>8} | {:>7} | {:>10.5f}", curve.name, samples, error);
+            }
+        }
+
+        // Samples Sobol needs to match the error random reaches at maxSamples, interpolated in log-log space.
+        const f64 target = curves[0].errors.back().second;
+        const auto& sobol = curves[1].errors;
+
+        std::optional<f64> equalErrorSamples;
+        for (usize i = 0; i < sobol.size(); ++i) {
+            if (sobol[i].second > target) continue;
+
+            if (i == 0) {
+                equalErrorSamples = sobol[i].first;
+            } else {
+                const auto& [sa, ea] = sobol[i - 1];
+                const auto& [sb, eb] = sobol[i];
+                f64 t = (std::log(ea) - std::log(target)) / std::max(std::log(ea) - std::log(eb), 1e-9);
+                equalErrorSamples = std::exp(std::log(static_cast<f64>(sa)) + (std::log(static_cast<f64>(sb)) - std::log(static_cast<f64>(sa))) * t);
+            }
+            break;
+        }
+
+        if (equalErrorSamples) {
+            LOG_INFO("Sobol reaches random's {} spp error ({:.5f}) at {:.1f} spp ({:.2f}x fewer samples)",
+                maxSamples, target, *equalErrorSamples, static_cast<f64>(maxSamples) / *equalErrorSamples);
+        } else {
+            LOG_INFO("Sobol did not reach random's {} spp error ({:.5f})", maxSamples, target);
+        }
+
+        // The same frame rendered on one thread and on all of them must match bit for bit.
+        settings.samples = std::min(maxSamples, 16u);
+
+        CPU::Tracer serial(scene, settings, CPU::Tracer::Options { .threads = 1 });
+        CPU::Tracer parallel(scene, settings, CPU::Tracer::Options { .threads = std::min(context.maxThreads, std::max(2u, std::thread::hardware_concurrency())) });
+
+        serial.Render(camera);
+        parallel.Render(camera);
+
+        const bool identical = std::ranges::equal(serial.GetImage(), parallel.GetImage(), [](const glm::vec4& a, const glm::vec4& b) {
+            return std::memcmp(&a, &b, sizeof(glm::vec4)) == 0;
+        });
+
+        LOG_INFO("1 vs {} threads at {} spp: {}", parallel.GetScheduler().GetThreadCount(), settings.samples, identical ? "bit-identical" : "MISMATCH");
+    }
+
+}
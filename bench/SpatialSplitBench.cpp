@@ -0,0 +1,134 @@
+#include "Bench.hpp"
+
+#include "CPU/BVH.hpp"
+
+namespace Bench {
+
+    namespace {
+
+        // Architectural stand-in: a few huge floor and wall quads, a lattice of long diagonal beams and
+        // some small clutter, which is where object-split SAH trees overlap the most.
+        std::shared_ptr<Scene::SceneData> MakeThinGeometryScene()
+        {
+            auto scene = std::make_shared<Scene::SceneData>();
+
+            auto AddTriangle = [&](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+                glm::vec3 normal = glm::normalize(glm::cross(b - a, c - a));
+                for (const auto& p : { a, b, c }) {
+                    scene->indices.push_back(static_cast<u32>(scene->vertices.size()));
+                    scene->vertices.push_back(Scene::Vertex { .position = p, .normal = normal, .uv0 = glm::vec2(0.0f), .tangent = glm::vec4(0.0f) });
+                }
+            };
+
+            auto AddQuad = [&](const glm::vec3& origin, const glm::vec3& u, const glm::vec3& v) {
+                AddTriangle(origin, origin + u, origin + u + v);
+                AddTriangle(origin, origin + u + v, origin + v);
+            };
+
+            auto AddBeam = [&](const glm::vec3& from, const glm::vec3& to, f32 width) {
+                glm::vec3 axis = to - from;
+                glm::vec3 side = glm::normalize(glm::cross(axis, std::abs(axis.y) < 0.9f * glm::length(axis) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f))) * width;
+                glm::vec3 up = glm::normalize(glm::cross(side, axis)) * width;
+
+                AddQuad(from, axis, side);
+                AddQuad(from + up, axis, side);
+                AddQuad(from, axis, up);
+                AddQuad(from + side, axis, up);
+            };
+
+            AddQuad(glm::vec3(-50.0f, 0.0f, -50.0f), glm::vec3(100.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 100.0f));
+            AddQuad(glm::vec3(-50.0f, 20.0f, -50.0f), glm::vec3(0.0f, 0.0f, 100.0f), glm::vec3(100.0f, 0.0f, 0.0f));
+            AddQuad(glm::vec3(-50.0f, 0.0f, -50.0f), glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(100.0f, 0.0f, 0.0f));
+            AddQuad(glm::vec3(-50.0f, 0.0f, -50.0f), glm::vec3(0.0f, 0.0f, 100.0f), glm::vec3(0.0f, 20.0f, 0.0f));
+
+            for (i32 i = -20; i <= 20; ++i) {
+                f32 x = static_cast<f32>(i) * 2.5f;
+                AddBeam(glm::vec3(x - 20.0f, 18.0f, -50.0f), glm::vec3(x + 20.0f, 18.0f, 50.0f), 0.2f);
+                AddBeam(glm::vec3(x + 20.0f, 16.0f, -50.0f), glm::vec3(x - 20.0f, 16.0f, 50.0f), 0.2f);
+                AddBeam(glm::vec3(x, 0.0f, -40.0f), glm::vec3(x * 0.5f, 20.0f, 40.0f), 0.1f);
+            }
+
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+            for (u32 i = 0; i < 20000; ++i) {
+                glm::vec3 p(unit(rng) * 100.0f - 50.0f, unit(rng) * 20.0f, unit(rng) * 100.0f - 50.0f);
+                AddTriangle(p, p + glm::vec3(0.2f, 0.0f, 0.0f), p + glm::vec3(0.0f, 0.2f, 0.1f));
+            }
+
+            scene->materials.emplace_back();
+            scene->meshes.push_back(Scene::Mesh { .primitives = { Scene::MeshPrimitive {
+                .indexOffset = 0,
+                .indexCount = static_cast<u32>(scene->indices.size()),
+                .vertexOffset = 0,
+                .materialIndex = 0
+            } } });
+            scene->nodes.push_back(Scene::Node { .transform = glm::mat4(1.0f), .meshIndex = 0 });
+
+            return scene;
+        }
+
+        void CompareSpatialSplits(std::string_view name, const std::shared_ptr<Scene::SceneData>& scene)
+        {
+            auto geometry = std::make_shared<CPU::Geometry>(*scene);
+
+            struct Config
+            {
+                std::string_view name;
+                CPU::BVH::BuildSettings settings;
+            };
+
+            const std::array configs {
+                Config { "SAH", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::BinnedSAH } },
+                Config { "SBVH 1e-3", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::SBVH, .spatialSplitAlpha = 1e-3f } },
+                Config { "SBVH 1e-5", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::SBVH, .spatialSplitAlpha = 1e-5f } },
+                Config { "SBVH 1e-7", CPU::BVH::BuildSettings { .method = CPU::BVH::BuildMethod::SBVH, .spatialSplitAlpha = 1e-7f } }
+            };
+
+            LOG_INFO("--- {} ({} triangles) ---", name, geometry->GetTriangleCount());
+            LOG_INFO("{:>10} | {:>10} | {:>8} | {:>10} | {:>12} | {:>8} | {:>8} | {:>7}",
+                "builder", "build (ms)", "nodes", "references", "memory (KiB)", "SAH", "Mrays/s", "speedup");
+
+            std::vector<CPU::Ray> rays;
+            f64 baseline = 0.0;
+            usize baselineMemory = 0;
+
+            for (const auto& config : configs) {
+                auto start = std::chrono::steady_clock::now();
+                CPU::BVH bvh(geometry, config.settings);
+                std::chrono::duration<f64, std::milli> buildTime = std::chrono::steady_clock::now() - start;
+
+                if (rays.empty()) {
+                    rays = GenerateRays(bvh.GetBounds(), 1u << 19);
+                }
+
+                start = std::chrono::steady_clock::now();
+                for (const auto& ray : rays) {
+                    CPU::Hit hit;
+                    bvh.Intersect(ray, hit);
+                }
+                std::chrono::duration<f64> traceTime = std::chrono::steady_clock::now() - start;
+
+                f64 throughput = rays.size() / 1e6 / traceTime.count();
+                if (baseline == 0.0) {
+                    baseline = throughput;
+                    baselineMemory = bvh.GetMemoryUsage();
+                }
+
+                LOG_INFO("{:>10} | {:>10.2f} | {:>8} | {:>10} | {:>6.1f} ({:+4.0f}%) | {:>8.2f} | {:>8.2f} | {:>6.2f}x",
+                    config.name, buildTime.count(), bvh.GetNodeCount(), bvh.GetReferenceCount(), bvh.GetMemoryUsage() / 1024.0,
+                    (static_cast<f64>(bvh.GetMemoryUsage()) / baselineMemory - 1.0) * 100.0, bvh.ComputeSAHCost(), throughput, throughput / baseline);
+            }
+        }
+
+    }
+
+    void RunSpatialSplits(const Context& context)
+    {
+        CompareSpatialSplits("thin geometry", MakeThinGeometryScene());
+
+        if (auto scene = LoadScene(context)) {
+            CompareSpatialSplits(context.scene.filename().string(), scene);
+        }
+    }
+
+}
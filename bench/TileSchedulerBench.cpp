@@ -0,0 +1,47 @@
+#include "Bench.hpp"
+
+#include "CPU/Tracer.hpp"
+
+namespace Bench {
+
+    void RunTileScaling(const Context& context)
+    {
+        auto scene = LoadScene(context);
+        if (!scene) return;
+
+        auto camera = MakeCamera(context);
+
+        Renderer::Settings settings {
+            .width = context.width,
+            .height = context.height,
+            .samples = context.samples,
+            .tile = context.tile
+        };
+
+        f64 baseline = 0.0;
+
+        LOG_INFO("{:>7} | {:>10} | {:>7} | {:>10} | {:>11} | {:>6}", "threads", "time (ms)", "speedup", "efficiency", "utilisation", "steals");
+
+        for (u32 threads = 1; threads <= context.maxThreads; threads *= 2) {
+            CPU::Tracer tracer(scene, settings, CPU::Tracer::Options {
+                .threads = threads,
+                .pinThreads = context.pinThreads
+            });
+
+            tracer.Render(camera);
+
+            auto stats = tracer.Render(camera);
+            if (threads == 1) baseline = stats.wallTime;
+
+            f64 speedup = baseline / stats.wallTime;
+
+            LOG_INFO("{:>7} | {:>10.2f} | {:>6.2f}x | {:>9.1f}% | {:>10.1f}% | {:>6}",
+                threads, stats.wallTime * 1000.0, speedup, speedup / threads * 100.0, stats.GetAverageUtilisation() * 100.0, stats.GetStealCount());
+
+            if (threads == context.maxThreads || threads * 2 > context.maxThreads) {
+                CPU::TileScheduler::LogStats(stats);
+            }
+        }
+    }
+
+}
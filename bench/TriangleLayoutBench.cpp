@@ -0,0 +1,58 @@
+#include "Bench.hpp"
+
+#include "CPU/BVH.hpp"
+
+namespace Bench {
+
+    void RunTriangleLayout(const Context& context)
+    {
+        auto scene = LoadScene(context);
+        if (!scene) return;
+
+        auto geometry = std::make_shared<CPU::Geometry>(*scene);
+
+        CPU::BVH indexed(geometry, CPU::BVH::BuildSettings { .packTriangles = false });
+        CPU::BVH packed(geometry, CPU::BVH::BuildSettings { .packTriangles = true });
+
+        auto rays = GenerateRays(indexed.GetBounds(), 1u << 20);
+
+        auto Trace = [&](const CPU::BVH& bvh, std::vector<CPU::Hit>& hits) {
+            hits.assign(rays.size(), CPU::Hit {});
+
+            auto start = std::chrono::steady_clock::now();
+            for (usize i = 0; i < rays.size(); ++i) {
+                bvh.Intersect(rays[i], hits[i]);
+            }
+            std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+
+            return elapsed.count();
+        };
+
+        std::vector<CPU::Hit> indexedHits;
+        std::vector<CPU::Hit> packedHits;
+
+        Trace(indexed, indexedHits);
+        f64 indexedTime = Trace(indexed, indexedHits);
+
+        Trace(packed, packedHits);
+        f64 packedTime = Trace(packed, packedHits);
+
+        u64 mismatches = 0;
+        for (usize i = 0; i < rays.size(); ++i) {
+            if (indexedHits[i].IsValid() != packedHits[i].IsValid()) mismatches++;
+        }
+
+        const f64 mrays = static_cast<f64>(rays.size()) / 1e6;
+
+        LOG_INFO("{:>8} | {:>7} | {:>10} | {:>8} | {:>11} | {:>11}", "layout", "nodes", "time (ms)", "Mrays/s", "nodes (KiB)", "tris (KiB)");
+        LOG_INFO("{:>8} | {:>7} | {:>10.2f} | {:>8.2f} | {:>11.1f} | {:>11.1f}", "indexed", indexed.GetNodeCount(), indexedTime * 1000.0, mrays / indexedTime,
+            (indexed.GetMemoryUsage() - indexed.GetTriangleMemoryUsage()) / 1024.0, geometry->GetVertices().size_bytes() / 1024.0 + geometry->GetIndices().size_bytes() / 1024.0);
+        LOG_INFO("{:>8} | {:>7} | {:>10.2f} | {:>8.2f} | {:>11.1f} | {:>11.1f}", "packed", packed.GetNodeCount(), packedTime * 1000.0, mrays / packedTime,
+            (packed.GetMemoryUsage() - packed.GetTriangleMemoryUsage()) / 1024.0, packed.GetTriangleMemoryUsage() / 1024.0);
+
+        LOG_INFO("Packed speedup {:.2f}x, extra memory {:.1f} KiB ({:.1f} bytes/triangle), {} hit mismatches",
+            indexedTime / packedTime, packed.GetTriangleMemoryUsage() / 1024.0,
+            static_cast<f64>(packed.GetTriangleMemoryUsage()) / std::max(1u, geometry->GetTriangleCount()), mismatches);
+    }
+
+}
@@ -0,0 +1,54 @@
+#include "Bench.hpp"
+
+#include "CPU/WavefrontIntegrator.hpp"
+
+namespace Bench {
+
+    void RunWavefront(const Context& context)
+    {
+        auto scene = LoadScene(context);
+        if (!scene) return;
+
+        auto camera = MakeCamera(context);
+
+        LOG_INFO("{:>7} | {:>16} | {:>10} | {:>9} | {:>8}", "threads", "integrator", "time (ms)", "Mrays/s", "speedup");
+
+        for (u32 threads = 1; threads <= context.maxThreads; threads *= 2) {
+            CPU::WavefrontIntegrator integrator(scene, CPU::WavefrontIntegrator::Settings {
+                .width = context.width,
+                .height = context.height,
+                .samples = context.samples,
+                .threads = threads
+            });
+
+            integrator.RenderPerPixel(camera);
+
+            const auto perPixel = integrator.RenderPerPixel(camera);
+            const std::vector<glm::vec4> reference(integrator.GetImage().begin(), integrator.GetImage().end());
+
+            auto Report = [&](std::string_view name, const CPU::WavefrontIntegrator::Stats& stats) {
+                LOG_INFO("{:>7} | {:>16} | {:>10.1f} | {:>9.2f} | {:>7.2f}x",
+                    threads, name, stats.wallTime * 1000.0, static_cast<f64>(stats.GetRayCount()) / stats.wallTime * 1e-6, perPixel.wallTime / stats.wallTime);
+            };
+
+            Report("per-pixel", perPixel);
+
+            integrator.SetSortByMaterial(false);
+            Report("wavefront", integrator.Render(camera));
+
+            integrator.SetSortByMaterial(true);
+            const auto sorted = integrator.Render(camera);
+            Report("wavefront+sort", sorted);
+
+            // Both integrators trace identical paths, so anything above rounding noise is a bug.
+            const f64 error = ComputeRelativeRMSE(integrator.GetImage(), reference);
+            if (error > 1e-4) LOG_WARN("Wavefront image differs from the per-pixel reference: rel. rmse {:.6f}", error);
+
+            if (threads == context.maxThreads || threads * 2 > context.maxThreads) {
+                CPU::WavefrontIntegrator::LogStats(sorted);
+                LOG_INFO("Queues: {:.1f} MiB", static_cast<f64>(integrator.GetQueueMemoryUsage()) / (1024.0 * 1024.0));
+            }
+        }
+    }
+
+}
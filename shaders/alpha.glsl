@@ -0,0 +1,65 @@
+#ifndef ALPHA_GLSL
+#define ALPHA_GLSL
+
+// Alpha test of candidate hits on non-opaque triangles, run by alpha.rahit and by the ray-query tracer
+// for every candidate triangle it is handed. Requires scene.glsl and sampler.glsl.
+
+// Scene::AlphaCoverage: 8x8 micro-triangles per mixed MASK triangle, opaque bits in xy and transparent
+// bits in zw.
+#define ALPHA_SUBDIVISIONS 8
+#define NO_ALPHA_MASK 0xffffffffu
+
+layout(set = 1, binding = 13, scalar) buffer AlphaMasks
+{
+    uvec4 masks[];
+} alphaMasks;
+
+// Scene::AlphaCoverage::GetMicroTriangle.
+uint MicroTriangleIndex(vec2 barycentric)
+{
+    const int n = ALPHA_SUBDIVISIONS;
+
+    int j = clamp(int(floor(barycentric.y * n)), 0, n - 1);
+    int i = clamp(int(floor(barycentric.x * n)), 0, n - 1 - j);
+
+    bool inverted = i + j < n - 1 && (barycentric.x * n - i) + (barycentric.y * n - j) > 1.0;
+
+    return uint(j * (2 * n - j) + 2 * i) + (inverted ? 1u : 0u);
+}
+
+// Only ever reached for geometry built without VK_GEOMETRY_OPAQUE_BIT_KHR: BLEND primitives and the mixed
+// triangles of MASK primitives, whose fully opaque and fully transparent triangles were split off or
+// dropped on the CPU. MASK materials are cut at alphaCutoff, after the micro-triangle bits had their
+// chance to decide without a texture fetch; BLEND materials are kept with probability alpha, which is
+// their coverage in expectation. rayHash decorrelates that choice between rays.
+bool AlphaTest(uint objID, uint primitive, vec2 attribs, float hitT, uint rayHash)
+{
+    uint alphaMask = objs.objects[objID].alphaMask;
+
+    if (alphaMask != NO_ALPHA_MASK) {
+        uvec4 mask = alphaMasks.masks[alphaMask + primitive];
+        uint micro = MicroTriangleIndex(attribs);
+        uint bit = 1u << (micro & 31u);
+
+        if (((micro < 32u ? mask.x : mask.y) & bit) != 0u) return true;
+        if (((micro < 32u ? mask.z : mask.w) & bit) != 0u) return false;
+    }
+
+    SurfaceHit surface = FetchSurface(objID, primitive, attribs, mat4x3(1.0));
+    Material mat = materials.mat[surface.material];
+
+    float alpha = GetAlpha(mat, surface.uv);
+
+    if (mat.alphaMode == ALPHA_MODE_MASK) return alpha >= mat.alphaCutoff;
+
+    if (mat.alphaMode == ALPHA_MODE_BLEND) {
+        uint hash = SamplerHash(rayHash);
+        hash = SamplerHashCombine(hash, primitive);
+        hash = SamplerHashCombine(hash, floatBitsToUint(hitT));
+        return SamplerToUnitFloat(SamplerHash(hash)) < alpha;
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef AOV_GLSL
+#define AOV_GLSL
+
+// First-hit auxiliary outputs. Filled by a dedicated hit group and miss shader (SBT offset 1, miss
+// index 1) that raygen only invokes when the AOV specialisation constant is set, so the radiance path
+// keeps its own small payload.
+
+#define AOV_PAYLOAD_LOCATION 1
+#define AOV_SBT_OFFSET 1
+#define AOV_MISS_INDEX 1
+
+#define AOV_INVALID_ID 0xFFFFFFFFu
+
+struct AOVPayload
+{
+    vec3 albedo;
+    vec3 normal;
+    float hitT;
+    uint material;
+    uint instance;
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef CLOSESTHIT_GLSL
+#define CLOSESTHIT_GLSL
+
+// Radiance payload of the triangle and procedural closest-hit shaders, the RT pipeline side of
+// shading.glsl. Requires shading.glsl and shadow.glsl.
+
+layout(location = RADIANCE_PAYLOAD_LOCATION) rayPayloadInEXT RadiancePayload payload;
+
+void ShadeHit(vec3 normal, vec2 uv, uint material)
+{
+    ShadeVertex(payload, gl_WorldRayOriginEXT, gl_WorldRayDirectionEXT, gl_HitTEXT, normal, uv, material);
+}
+
+#endif
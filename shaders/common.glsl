@@ -0,0 +1,82 @@
+#ifndef COMMON_GLSL
+#define COMMON_GLSL
+
+// Push constants and the radiance payload shared by raygen and the hit shaders.
+
+layout(push_constant) uniform PushConts
+{
+    uvec2 offset;
+    uvec2 resolution;
+    uint samples;
+    uint sequence;
+    uint seed;
+    uint lightCount;
+    uint lightTree;
+    int environment;
+    uint maxDepth;
+    uint pathStats;
+    uint primary;
+    // gl_RayFlagsOpaqueEXT when the alpha test is switched off for timing, else 0.
+    uint rayFlags;
+} pc;
+
+// One path vertex per trace. Hit shaders return the light gathered at the vertex and the BSDF-sampled
+// continuation; raygen owns the throughput and the loop, so nothing recurses past the shadow ray.
+// The pixel, sample index and depth let hit shaders draw from the same stateless sequence as raygen.
+struct RadiancePayload
+{
+    vec3 radiance;
+    float hitT;
+    vec3 weight;
+    uint direction;
+    uint pixel;
+    uint sampleIndex;
+    uint depth;
+};
+
+#define RADIANCE_PAYLOAD_LOCATION 0
+
+#define SHADOW_PAYLOAD_LOCATION 2
+#define SHADOW_MISS_INDEX 2
+
+// Sequence dimensions: 0-1 pixel jitter, then per path vertex 2-3 point on the light, 4 light selection,
+// 5 BSDF lobe, 6-7 BSDF direction and 8 Russian roulette, offset by DIMENSIONS_PER_BOUNCE for each
+// bounce. Pairs never straddle a group of four Sobol dimensions.
+#define DIMENSION_LIGHT_POINT 2u
+#define DIMENSION_LIGHT_SELECT 4u
+#define DIMENSION_BSDF_LOBE 5u
+#define DIMENSION_BSDF_DIRECTION 6u
+#define DIMENSION_ROULETTE 8u
+#define DIMENSIONS_PER_BOUNCE 8u
+
+uint BounceDimension(uint dimension, uint depth)
+{
+    return dimension + depth * DIMENSIONS_PER_BOUNCE;
+}
+
+// Octahedral unit vector in two snorm16 halves; well under 1e-4 rad of error.
+uint EncodeDirection(vec3 direction)
+{
+    direction /= abs(direction.x) + abs(direction.y) + abs(direction.z);
+
+    vec2 p = direction.xy;
+    if (direction.z < 0.0) {
+        p = (1.0 - abs(direction.yx)) * vec2(direction.x >= 0.0 ? 1.0 : -1.0, direction.y >= 0.0 ? 1.0 : -1.0);
+    }
+
+    return packSnorm2x16(p);
+}
+
+vec3 DecodeDirection(uint encoded)
+{
+    vec2 p = unpackSnorm2x16(encoded);
+    vec3 direction = vec3(p, 1.0 - abs(p.x) - abs(p.y));
+
+    float t = max(-direction.z, 0.0);
+    direction.x += direction.x >= 0.0 ? -t : t;
+    direction.y += direction.y >= 0.0 ? -t : t;
+
+    return normalize(direction);
+}
+
+#endif
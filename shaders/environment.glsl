@@ -0,0 +1,89 @@
+#ifndef ENVIRONMENT_GLSL
+#define ENVIRONMENT_GLSL
+
+// Equirectangular environment lighting, built by Scene::EnvironmentMap: radiance lives in the bindless
+// texture pc.environment (-1 when no map is loaded) and the sampling tables in the buffer below. Requires
+// common.glsl and g_Textures from scene.glsl.
+
+const float ENVIRONMENT_PI = 3.14159265359;
+
+// Marginal CDF over size.y rows, then size.y conditional CDFs of size.x entries; all inclusive, ending at 1.
+layout(set = 1, binding = 11, scalar) buffer EnvironmentDistribution
+{
+    uvec2 size;
+    float cdf[];
+} environment;
+
+vec2 EnvironmentUV(vec3 direction)
+{
+    const float phi = atan(direction.z, direction.x);
+    const float theta = acos(clamp(direction.y, -1.0, 1.0));
+
+    return vec2(phi / (2.0 * ENVIRONMENT_PI) + 0.5, theta / ENVIRONMENT_PI);
+}
+
+vec3 EnvironmentDirection(vec2 uv)
+{
+    const float phi = 2.0 * ENVIRONMENT_PI * (uv.x - 0.5);
+    const float theta = ENVIRONMENT_PI * uv.y;
+
+    return vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+}
+
+vec3 EvaluateEnvironment(vec3 direction)
+{
+    return textureLod(g_Textures[nonuniformEXT(pc.environment)], EnvironmentUV(direction), 0.0).rgb;
+}
+
+// Radiance of a path segment leaving the scene along the unit direction at the given path vertex.
+vec3 EvaluateMiss(vec3 direction, uint depth)
+{
+    if (pc.environment >= 0) {
+        // Bounces escaping to the map were already covered by its light sample at the previous vertex.
+        return depth == 0u ? EvaluateEnvironment(direction) : vec3(0.0);
+    }
+
+    float t = 0.5 * (direction.y + 1.0);
+    return (1.0 - t) * vec3(1.0, 1.0, 1.0) + t * vec3(0.5, 0.7, 1.0);
+}
+
+// Continuous index of u in the CDF at [first, first + count): the bucket holding u plus u's position
+// inside it, with the bucket's probability in pmf.
+float SampleEnvironmentCDF(uint first, uint count, float u, out float pmf)
+{
+    uint lo = 0u;
+    uint hi = count - 1u;
+
+    while (lo < hi) {
+        const uint mid = (lo + hi) / 2u;
+        if (environment.cdf[first + mid] > u) hi = mid;
+        else lo = mid + 1u;
+    }
+
+    const float previous = lo > 0u ? environment.cdf[first + lo - 1u] : 0.0;
+    pmf = environment.cdf[first + lo] - previous;
+
+    const float offset = pmf > 0.0 ? (u - previous) / pmf : 0.5;
+    return float(lo) + clamp(offset, 0.0, 0.99999994);
+}
+
+// Direction drawn in proportion to luminance; pdf is in solid angle.
+void SampleEnvironment(vec2 u, out vec3 direction, out vec3 radiance, out float pdf)
+{
+    const uvec2 size = environment.size;
+
+    float pmfRow;
+    const float row = SampleEnvironmentCDF(0u, size.y, u.y, pmfRow);
+
+    float pmfColumn;
+    const float column = SampleEnvironmentCDF(size.y + uint(row) * size.x, size.x, u.x, pmfColumn);
+
+    const vec2 uv = vec2(column, row) / vec2(size);
+    const float sinTheta = sin(ENVIRONMENT_PI * uv.y);
+
+    direction = EnvironmentDirection(uv);
+    radiance = EvaluateEnvironment(direction);
+    pdf = sinTheta > 0.0 ? pmfRow * pmfColumn * float(size.x) * float(size.y) / (2.0 * ENVIRONMENT_PI * ENVIRONMENT_PI * sinTheta) : 0.0;
+}
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef LIGHTS_GLSL
+#define LIGHTS_GLSL
+
+// Emissive triangles with a power-weighted alias table, built by Scene::LightTable, and a light BVH over
+// the same triangles, built by Scene::LightTree. Requires scene.glsl for the material buffer and bindless
+// textures.
+
+struct LightTriangle
+{
+    vec3 p0;
+    uint material;
+    vec3 p1;
+    float area;
+    vec3 p2;
+    float pdf;
+    vec2 uv0;
+    vec2 uv1;
+    vec2 uv2;
+    float threshold;
+    uint alias;
+};
+
+layout(set = 1, binding = 9, scalar) buffer Lights
+{
+    LightTriangle tri[];
+} lights;
+
+#define LIGHT_LEAF_BIT 0x80000000u
+
+// Matches Scene::LightTree::Node: left child at index + 1, right child (or LIGHT_LEAF_BIT | triangle) in
+// child. The orientation cone is folded for double-sided emitters.
+struct LightNode
+{
+    vec3 boundsMin;
+    float power;
+    vec3 boundsMax;
+    float cosThetaO;
+    vec3 axis;
+    uint child;
+};
+
+layout(set = 1, binding = 10, scalar) buffer LightNodes
+{
+    LightNode node[];
+} lightTree;
+
+struct LightSample
+{
+    vec3 direction;
+    float distance;
+    vec3 radiance;
+    float pdf;
+};
+
+uint SelectLight(float u, uint count)
+{
+    const float scaled = u * float(count);
+    const uint index = min(uint(scaled), count - 1u);
+
+    return scaled - float(index) < lights.tri[index].threshold ? index : lights.tri[index].alias;
+}
+
+float CosSubClamped(float sinA, float cosA, float sinB, float cosB)
+{
+    return cosA > cosB ? 1.0 : cosA * cosB + sinA * sinB;
+}
+
+float SinSubClamped(float sinA, float cosA, float sinB, float cosB)
+{
+    return cosA > cosB ? 0.0 : sinA * cosB - cosA * sinB;
+}
+
+// Same bound as Scene::LightTree::Importance; the two must agree for CPU and GPU to pick alike.
+float LightImportance(LightNode node, vec3 position, vec3 normal)
+{
+    const vec3 center = 0.5 * (node.boundsMin + node.boundsMax);
+    const vec3 diagonal = node.boundsMax - node.boundsMin;
+
+    const vec3 toPoint = position - center;
+    const float distance2 = dot(toPoint, toPoint);
+    const float d2 = max(distance2, 0.5 * length(diagonal));
+
+    const float radius2 = 0.25 * dot(diagonal, diagonal);
+    const float cosThetaB = distance2 < radius2 ? -1.0 : sqrt(max(1.0 - radius2 / distance2, 0.0));
+    const float sinThetaB = sqrt(max(1.0 - cosThetaB * cosThetaB, 0.0));
+
+    const vec3 wi = distance2 > 0.0 ? toPoint * inversesqrt(distance2) : vec3(0.0, 0.0, 1.0);
+
+    const float cosThetaW = abs(dot(node.axis, wi));
+    const float sinThetaW = sqrt(max(1.0 - cosThetaW * cosThetaW, 0.0));
+    const float sinThetaO = sqrt(max(1.0 - node.cosThetaO * node.cosThetaO, 0.0));
+
+    const float cosThetaX = CosSubClamped(sinThetaW, cosThetaW, sinThetaO, node.cosThetaO);
+    const float sinThetaX = SinSubClamped(sinThetaW, cosThetaW, sinThetaO, node.cosThetaO);
+    const float cosThetaP = CosSubClamped(sinThetaX, cosThetaX, sinThetaB, cosThetaB);
+
+    if (cosThetaP <= 0.0) return 0.0;
+
+    const float cosThetaI = abs(dot(wi, normal));
+    const float sinThetaI = sqrt(max(1.0 - cosThetaI * cosThetaI, 0.0));
+
+    return max(node.power * cosThetaP / d2 * CosSubClamped(sinThetaI, cosThetaI, sinThetaB, cosThetaB), 0.0);
+}
+
+// Walks the light tree from the root with one rescaled uniform. Returns false if no light can reach the
+// receiver.
+bool SelectLightTree(vec3 position, vec3 normal, float u, out uint index, out float pmf)
+{
+    pmf = 1.0;
+    index = 0u;
+
+    while ((lightTree.node[index].child & LIGHT_LEAF_BIT) == 0u) {
+        const uint left = index + 1u;
+        const uint right = lightTree.node[index].child;
+
+        const float importanceLeft = LightImportance(lightTree.node[left], position, normal);
+        const float importanceRight = LightImportance(lightTree.node[right], position, normal);
+
+        if (importanceLeft <= 0.0 && importanceRight <= 0.0) return false;
+
+        const float pLeft = importanceLeft / (importanceLeft + importanceRight);
+        if (u < pLeft) {
+            u = min(u / pLeft, 0.99999994);
+            pmf *= pLeft;
+            index = left;
+        } else {
+            u = min((u - pLeft) / (1.0 - pLeft), 0.99999994);
+            pmf *= 1.0 - pLeft;
+            index = right;
+        }
+    }
+
+    index = lightTree.node[index].child & ~LIGHT_LEAF_BIT;
+    return true;
+}
+
+// Picks an emissive triangle, by power alone or through the light tree when useTree is set, then a
+// uniform point on it. The pdf is in solid angle as seen from position; emitters are treated as
+// double-sided.
+LightSample SampleLight(vec3 position, vec3 normal, float uSelect, vec2 uPoint, uint count, bool useTree)
+{
+    LightSample result;
+    result.pdf = 0.0;
+
+    uint index;
+    float pmf;
+
+    if (useTree) {
+        if (!SelectLightTree(position, normal, uSelect, index, pmf)) return result;
+    } else {
+        index = SelectLight(uSelect, count);
+        pmf = lights.tri[index].pdf;
+    }
+
+    LightTriangle light = lights.tri[index];
+
+    const float su = sqrt(uPoint.x);
+    const float b1 = 1.0 - su;
+    const float b2 = uPoint.y * su;
+    const float b0 = 1.0 - b1 - b2;
+
+    const vec3 point = light.p0 * b0 + light.p1 * b1 + light.p2 * b2;
+    const vec2 uv = light.uv0 * b0 + light.uv1 * b1 + light.uv2 * b2;
+
+    const vec3 toLight = point - position;
+    const float dist2 = dot(toLight, toLight);
+    if (dist2 <= 0.0) return result;
+
+    result.distance = sqrt(dist2);
+    result.direction = toLight / result.distance;
+
+    const vec3 lightNormal = normalize(cross(light.p1 - light.p0, light.p2 - light.p0));
+    const float cosLight = abs(dot(lightNormal, result.direction));
+    if (cosLight <= 0.0) return result;
+
+    Material mat = materials.mat[light.material];
+
+    result.radiance = mat.emissiveFactor;
+    if (mat.emissiveTexture >= 0) {
+        result.radiance *= textureLod(g_Textures[nonuniformEXT(mat.emissiveTexture)], uv, 0.0).rgb;
+    }
+
+    result.pdf = pmf / light.area * dist2 / cosLight;
+    return result;
+}
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef PATH_GLSL
+#define PATH_GLSL
+
+// Per-pixel path loop shared by raygen.rgen and pathtrace.comp. Each backend defines TraceRadiance and
+// TraceAOV, through which the loop casts all of its rays, so both trace the very same paths. Requires
+// common.glsl, sampler.glsl, scene.glsl, environment.glsl, shading.glsl, aov.glsl and visibility.glsl.
+
+layout(constant_id = 0) const bool ENABLE_AOVS = false;
+
+layout(set = 1, binding = 1, rgba32f) uniform image2D image;
+
+layout(set = 1, binding = 2) uniform CameraData
+{
+    mat4 inverseView;
+    mat4 inverseProj;
+    vec4 position;
+    vec4 params;
+} cam;
+
+layout(set = 1, binding = 5, rgba16f) uniform writeonly image2D aovAlbedo;
+layout(set = 1, binding = 6, rgba16f) uniform writeonly image2D aovNormal;
+layout(set = 1, binding = 7, r32f) uniform writeonly image2D aovDepth;
+layout(set = 1, binding = 8, rg32ui) uniform writeonly uimage2D aovIDs;
+
+// Totals for the frame; every path ends in exactly one of the four terminations.
+layout(set = 1, binding = 12, std430) buffer PathStats
+{
+    uint paths;
+    uint segments;
+    uint missed;
+    uint roulette;
+    uint depthLimit;
+    uint absorbed;
+} stats;
+
+const float BOUNCE_EPSILON = 1e-3;
+
+// Russian roulette starts at this vertex and never survives with more than this probability, so
+// high-throughput paths still end eventually.
+const uint ROULETTE_MIN_DEPTH = 3u;
+const float ROULETTE_MAX_SURVIVAL = 0.95;
+
+#define TERMINATED_MISS 0u
+#define TERMINATED_ROULETTE 1u
+#define TERMINATED_DEPTH 2u
+#define TERMINATED_ABSORBED 3u
+
+// Closest hit of the segment shaded into vertex, whose pixel, sampleIndex and depth are already set; a
+// miss leaves hitT negative.
+void TraceRadiance(inout RadiancePayload vertex, vec3 origin, float tMin, vec3 direction, float tMax, uint rayFlags);
+
+// First-hit auxiliary outputs of the segment, AOV_INVALID_ID IDs on a miss.
+void TraceAOV(out AOVPayload aov, vec3 origin, float tMin, vec3 direction, float tMax);
+
+vec3 GetRayDirection(vec2 screenPos)
+{
+    vec4 target = cam.inverseProj * vec4(screenPos.x, screenPos.y, 1.0, 1.0);
+    return normalize((cam.inverseView * vec4(normalize(target.xyz), 0.0)).xyz);
+}
+
+// One unjittered ray through the pixel centre, so IDs are stable across frames and sample counts.
+void WriteAOVs(uvec2 globalID)
+{
+    const vec2 screenPos = (vec2(globalID) + vec2(0.5)) / vec2(pc.resolution) * 2.0 - 1.0;
+    const vec3 rayDir = GetRayDirection(screenPos);
+
+    AOVPayload aov;
+    TraceAOV(aov, cam.position.xyz, cam.params[2], rayDir, cam.params[3]);
+
+    // Linear depth along the view axis rather than distance along the ray.
+    const float depth = aov.hitT * dot(rayDir, GetRayDirection(vec2(0.0)));
+
+    imageStore(aovAlbedo, ivec2(globalID), vec4(aov.albedo, 1.0));
+    imageStore(aovNormal, ivec2(globalID), vec4(aov.normal, 0.0));
+    imageStore(aovDepth, ivec2(globalID), vec4(depth));
+    imageStore(aovIDs, ivec2(globalID), uvec4(aov.material, aov.instance, 0u, 0u));
+}
+
+// Camera vertex of raster primary visibility. Geometry the raster pass skipped is traced up to the
+// rasterised surface first; only if none of it is hit is that surface shaded in place.
+void ShadePrimary(inout RadiancePayload vertex, vec3 origin, float tMin, vec3 direction, bool visible, SurfaceHit surface)
+{
+    const float hitT = visible ? distance(origin, surface.position) : cam.params[3];
+
+    if ((pc.primary & PRIMARY_TRACE_NON_OPAQUE) != 0u) {
+        TraceRadiance(vertex, origin, tMin, direction, hitT, gl_RayFlagsCullOpaqueEXT);
+        if (vertex.hitT >= 0.0) return;
+    }
+
+    if (visible) {
+        ShadeVertex(vertex, origin, direction, hitT, surface.normal, surface.uv, surface.material);
+    } else {
+        vertex.hitT = -1.0;
+        vertex.radiance = EvaluateMiss(direction, vertex.depth);
+    }
+}
+
+void TracePixel(uvec2 globalID)
+{
+    if (globalID.x >= pc.resolution.x || globalID.y >= pc.resolution.y) {
+        return;
+    }
+
+    const uint pixel = globalID.y * pc.resolution.x + globalID.x;
+    const uint samples = max(pc.samples, 1u);
+    const uint maxDepth = max(pc.maxDepth, 1u);
+
+    vec3 radiance = vec3(0.0);
+    uvec4 terminations = uvec4(0u);
+    uint segments = 0u;
+
+    // The raster pass saw one surface at the pixel centre, so every sample starts from it unjittered and
+    // only the light samples and bounces differ between them.
+    const bool rasterPrimary = (pc.primary & PRIMARY_RASTER) != 0u;
+    const vec3 centreDir = GetRayDirection((vec2(globalID) + vec2(0.5)) / vec2(pc.resolution) * 2.0 - 1.0);
+
+    SurfaceHit primary;
+    const bool primaryVisible = rasterPrimary && LoadVisibility(globalID, primary);
+
+    for (uint s = 0u; s < samples; ++s) {
+        const vec2 jitter = samples > 1u ? GetSample2D(pc.sequence, pc.seed, pixel, s, 0u) : vec2(0.5);
+        const vec2 screenPos = (vec2(globalID) + jitter) / vec2(pc.resolution) * 2.0 - 1.0;
+
+        vec3 rayDir = rasterPrimary ? centreDir : GetRayDirection(screenPos);
+        vec3 rayOrigin = cam.position.xyz;
+        float tMin = cam.params[2];
+
+        vec3 throughput = vec3(1.0);
+        uint termination = TERMINATED_DEPTH;
+
+        for (uint depth = 0u; depth < maxDepth; ++depth) {
+            RadiancePayload vertex;
+            vertex.pixel = pixel;
+            vertex.sampleIndex = s;
+            vertex.depth = depth;
+
+            if (depth == 0u && rasterPrimary) {
+                ShadePrimary(vertex, rayOrigin, tMin, rayDir, primaryVisible, primary);
+            } else {
+                TraceRadiance(vertex, rayOrigin, tMin, rayDir, cam.params[3], pc.rayFlags);
+            }
+
+            radiance += throughput * vertex.radiance;
+            ++segments;
+
+            if (vertex.hitT < 0.0) {
+                termination = TERMINATED_MISS;
+                break;
+            }
+
+            if (depth + 1u == maxDepth) break;
+
+            throughput *= vertex.weight;
+
+            if (max(throughput.r, max(throughput.g, throughput.b)) <= 0.0) {
+                termination = TERMINATED_ABSORBED;
+                break;
+            }
+
+            if (depth + 1u >= ROULETTE_MIN_DEPTH) {
+                const float survival = min(max(throughput.r, max(throughput.g, throughput.b)), ROULETTE_MAX_SURVIVAL);
+
+                if (GetSample(pc.sequence, pc.seed, pixel, s, BounceDimension(DIMENSION_ROULETTE, depth)) >= survival) {
+                    termination = TERMINATED_ROULETTE;
+                    break;
+                }
+
+                throughput /= survival;
+            }
+
+            rayOrigin += rayDir * vertex.hitT;
+            rayDir = DecodeDirection(vertex.direction);
+            tMin = BOUNCE_EPSILON;
+        }
+
+        ++terminations[termination];
+    }
+
+    imageStore(image, ivec2(globalID), vec4(radiance / float(samples), 1.0));
+
+    // One set of atomics per pixel rather than per sample or per bounce.
+    if (pc.pathStats != 0u) {
+        atomicAdd(stats.paths, samples);
+        atomicAdd(stats.segments, segments);
+        atomicAdd(stats.missed, terminations[TERMINATED_MISS]);
+        atomicAdd(stats.roulette, terminations[TERMINATED_ROULETTE]);
+        atomicAdd(stats.depthLimit, terminations[TERMINATED_DEPTH]);
+        atomicAdd(stats.absorbed, terminations[TERMINATED_ABSORBED]);
+    }
+
+    if (ENABLE_AOVS) {
+        WriteAOVs(globalID);
+    }
+}
+
+#endif
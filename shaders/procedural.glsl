@@ -0,0 +1,101 @@
+#ifndef PROCEDURAL_GLSL
+#define PROCEDURAL_GLSL
+
+// Analytic spheres and rounded capsules behind AABB geometry; Scene::ProceduralPrimitive. A primitive is
+// a sphere when a == b. Each procedural instance's custom index is the offset of its first primitive.
+// Requires GL_EXT_scalar_block_layout.
+
+struct ProceduralPrimitive
+{
+    vec3 a;
+    float radius;
+    vec3 b;
+    uint material;
+};
+
+layout(set = 1, binding = 14, scalar) buffer Procedurals
+{
+    ProceduralPrimitive primitives[];
+} procedurals;
+
+ProceduralPrimitive GetProcedural(uint customIndex, uint primitive)
+{
+    return procedurals.primitives[customIndex + primitive];
+}
+
+// Entry distance along ro + t * rd, or -1 on a miss. rd need not be normalised, so the object-space ray
+// of a scaled instance works as is.
+float IntersectSphere(vec3 ro, vec3 rd, vec3 center, float radius)
+{
+    vec3 oc = ro - center;
+    float a = dot(rd, rd);
+    float b = dot(oc, rd);
+    float c = dot(oc, oc) - radius * radius;
+
+    float h = b * b - a * c;
+    if (h < 0.0) return -1.0;
+
+    return (-b - sqrt(h)) / a;
+}
+
+float IntersectCapsule(vec3 ro, vec3 rd, vec3 pa, vec3 pb, float radius)
+{
+    float len = length(rd);
+    vec3 dir = rd / len;
+
+    vec3 ba = pb - pa;
+    vec3 oa = ro - pa;
+
+    float baba = dot(ba, ba);
+    float bard = dot(ba, dir);
+    float baoa = dot(ba, oa);
+    float rdoa = dot(dir, oa);
+    float oaoa = dot(oa, oa);
+
+    float a = baba - bard * bard;
+    float b = baba * rdoa - baoa * bard;
+    float c = baba * oaoa - baoa * baoa - radius * radius * baba;
+
+    float h = b * b - a * c;
+    if (h < 0.0) return -1.0;
+
+    // A ray along the axis only ever enters through one of the end caps.
+    if (a <= 0.0) {
+        float ta = IntersectSphere(ro, rd, pa, radius);
+        float tb = IntersectSphere(ro, rd, pb, radius);
+        return min(ta, tb) >= 0.0 ? min(ta, tb) : max(ta, tb);
+    }
+
+    // Cylinder body first, then whichever end cap the body hit fell beyond.
+    float t = (-b - sqrt(h)) / a;
+    float y = baoa + t * bard;
+    if (y > 0.0 && y < baba) return t / len;
+
+    return IntersectSphere(ro, rd, y <= 0.0 ? pa : pb, radius);
+}
+
+float IntersectProcedural(ProceduralPrimitive primitive, vec3 ro, vec3 rd)
+{
+    if (primitive.a == primitive.b) return IntersectSphere(ro, rd, primitive.a, primitive.radius);
+    return IntersectCapsule(ro, rd, primitive.a, primitive.b, primitive.radius);
+}
+
+// Object-space outward normal at a point on the surface.
+vec3 ProceduralNormal(ProceduralPrimitive primitive, vec3 position)
+{
+    vec3 pa = position - primitive.a;
+    vec3 ba = primitive.b - primitive.a;
+
+    float baba = dot(ba, ba);
+    float h = baba > 0.0 ? clamp(dot(pa, ba) / baba, 0.0, 1.0) : 0.0;
+
+    return (pa - ba * h) / primitive.radius;
+}
+
+// Latitude-longitude mapping of the normal, so textured materials still get a usable uv.
+vec2 ProceduralUV(vec3 normal)
+{
+    return vec2(atan(normal.z, normal.x) * (0.5 / 3.14159265359) + 0.5, acos(clamp(normal.y, -1.0, 1.0)) / 3.14159265359);
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef SCENE_GLSL
+#define SCENE_GLSL
+
+// Scene resources shared by every hit shader and the ray-query tracer: bindless textures, per-geometry object descriptors,
+// materials and the buffer-reference vertex fetch. Requires GL_EXT_nonuniform_qualifier,
+// GL_EXT_scalar_block_layout, GL_EXT_buffer_reference2 and GL_EXT_shader_explicit_arithmetic_types_int64.
+
+layout(set = 0, binding = 0) uniform sampler2D g_Textures[];
+
+// Scene::MaterialData::AlphaMode.
+#define ALPHA_MODE_OPAQUE 0
+#define ALPHA_MODE_MASK 1
+#define ALPHA_MODE_BLEND 2
+
+struct RenderObject
+{
+    uint64_t vertex;
+    uint64_t index;
+    uint material;
+    uint alphaMask;
+};
+
+layout(set = 1, binding = 3, scalar) buffer ObjDesc
+{
+    RenderObject objects[];
+} objs;
+
+struct Material
+{
+    vec4 baseColorFactor;
+    vec3 emissiveFactor;
+    float metallicFactor;
+    float roughnessFactor;
+    float alphaCutoff;
+    int alphaMode;
+    int baseColorTexture;
+    int metallicRoughnessTexture;
+    int normalTexture;
+    int occlusionTexture;
+    int emissiveTexture;
+    int padding[3];
+};
+
+layout(set = 1, binding = 4, scalar) buffer Materials
+{
+    Material mat[];
+} materials;
+
+struct Vertex
+{
+    vec3 position;
+    vec3 normal;
+    vec2 uv;
+    vec4 tangent;
+};
+
+layout(buffer_reference, scalar) buffer Vertices { Vertex v[]; };
+layout(buffer_reference, scalar) buffer Indices { uint i[]; };
+
+struct SurfaceHit
+{
+    vec3 position;
+    vec3 normal;
+    vec2 uv;
+    uint material;
+};
+
+// Interpolated world-space position, shading normal, uv and material index of a triangle hit on
+// geometry objID, from its barycentrics and instance transform; the hit shaders, the ray-query tracer
+// and the raster visibility buffer alike.
+SurfaceHit FetchSurface(uint objID, uint primitive, vec2 attribs, mat4x3 objectToWorld)
+{
+    RenderObject obj = objs.objects[objID];
+
+    Vertices vertices = Vertices(obj.vertex);
+    Indices indices = Indices(obj.index);
+
+    uint ind0, ind1, ind2;
+    if (obj.index != 0) {
+        ind0 = indices.i[primitive * 3 + 0];
+        ind1 = indices.i[primitive * 3 + 1];
+        ind2 = indices.i[primitive * 3 + 2];
+    } else {
+        ind0 = primitive * 3 + 0;
+        ind1 = primitive * 3 + 1;
+        ind2 = primitive * 3 + 2;
+    }
+
+    Vertex v0 = vertices.v[ind0];
+    Vertex v1 = vertices.v[ind1];
+    Vertex v2 = vertices.v[ind2];
+
+    const vec3 barycentric = vec3(1.0 - attribs.x - attribs.y, attribs.x, attribs.y);
+
+    vec3 position = v0.position * barycentric.x + v1.position * barycentric.y + v2.position * barycentric.z;
+    vec3 normal = v0.normal * barycentric.x + v1.normal * barycentric.y + v2.normal * barycentric.z;
+
+    SurfaceHit surface;
+    surface.position = objectToWorld * vec4(position, 1.0);
+    surface.normal = normalize(vec3(objectToWorld * vec4(normal, 0.0)));
+    surface.uv = v0.uv * barycentric.x + v1.uv * barycentric.y + v2.uv * barycentric.z;
+    surface.material = obj.material;
+
+    return surface;
+}
+
+vec3 GetBaseColor(Material mat, vec2 uv)
+{
+    vec3 albedo = mat.baseColorFactor.rgb;
+    if (mat.baseColorTexture >= 0) {
+        vec3 texColor = texture(g_Textures[nonuniformEXT(mat.baseColorTexture)], uv).rgb;
+        albedo *= pow(texColor, vec3(2.2));
+    }
+    return albedo;
+}
+
+float GetAlpha(Material mat, vec2 uv)
+{
+    float alpha = mat.baseColorFactor.a;
+    if (mat.baseColorTexture >= 0) {
+        alpha *= texture(g_Textures[nonuniformEXT(mat.baseColorTexture)], uv).a;
+    }
+    return alpha;
+}
+
+#endif
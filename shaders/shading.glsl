@@ -0,0 +1,223 @@
+#ifndef SHADING_GLSL
+#define SHADING_GLSL
+
+// BRDF and path vertex shading shared by the closest-hit shaders and the ray-query tracer. Requires
+// common.glsl, sampler.glsl, scene.glsl, lights.glsl and environment.glsl.
+
+const float PI = 3.14159265359;
+const float SHADOW_EPSILON = 1e-3;
+
+// Share of NEE samples given to the environment when emissive triangles are present too.
+const float ENVIRONMENT_SELECT_PROBABILITY = 0.5;
+const float ENVIRONMENT_DISTANCE = 1e16;
+
+// Keeps the GGX lobe finite for perfectly smooth materials; sampled and evaluated alike.
+const float MIN_ROUGHNESS = 0.045;
+
+// Chance of sampling the GGX lobe for a dielectric and a metal; in between it follows metallic.
+const float SPECULAR_PROBABILITY_DIELECTRIC = 0.25;
+const float SPECULAR_PROBABILITY_METAL = 0.9;
+
+float DistributionGGX(vec3 N, vec3 H, float roughness)
+{
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float NdotH = max(dot(N, H), 0.0);
+    float NdotH2 = NdotH * NdotH;
+
+    float num = a2;
+    float denom = (NdotH2 * (a2 - 1.0) + 1.0);
+    denom = PI * denom * denom;
+
+    return num / denom;
+}
+
+float GeometrySchlickGGX(float NdotV, float roughness)
+{
+    float r = (roughness + 1.0);
+    float k = (r * r) / 8.0;
+
+    float num = NdotV;
+    float denom = NdotV * (1.0 - k) + k;
+
+    return num / denom;
+}
+
+float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
+{
+    float NdotV = max(dot(N, V), 0.0);
+    float NdotL = max(dot(N, L), 0.0);
+    float ggx2 = GeometrySchlickGGX(NdotV, roughness);
+    float ggx1 = GeometrySchlickGGX(NdotL, roughness);
+
+    return ggx1 * ggx2;
+}
+
+vec3 FresnelSchlick(float cosTheta, vec3 F0)
+{
+    return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+vec3 EvaluateBRDF(vec3 N, vec3 V, vec3 L, vec3 albedo, float metallic, float roughness)
+{
+    vec3 H = normalize(V + L);
+
+    vec3 F0 = vec3(0.04);
+    F0 = mix(F0, albedo, metallic);
+
+    float NDF = DistributionGGX(N, H, roughness);
+    float G = GeometrySmith(N, V, L, roughness);
+    vec3 F = FresnelSchlick(max(dot(H, V), 0.0), F0);
+
+    vec3 numerator = NDF * G * F;
+    float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
+    vec3 specular = numerator / denominator;
+
+    vec3 kS = F;
+    vec3 kD = vec3(1.0 - kS);
+    kD *= 1.0 - metallic;
+
+    return kD * albedo / PI + specular;
+}
+
+mat3 TangentFrame(vec3 N)
+{
+    float s = N.z >= 0.0 ? 1.0 : -1.0;
+    float a = -1.0 / (s + N.z);
+    float b = N.x * N.y * a;
+
+    vec3 T = vec3(1.0 + s * N.x * N.x * a, s * b, -s * N.x);
+    vec3 B = vec3(b, s + N.y * N.y * a, -N.y);
+
+    return mat3(T, B, N);
+}
+
+// Picks the diffuse or GGX lobe, samples a direction from it and returns f * cos / pdf, with the pdf
+// of the one-sample mixture of both lobes. Zero when the direction ends up below the surface.
+vec3 SampleBRDF(vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, float uLobe, vec2 u, out vec3 L)
+{
+    float specularProbability = mix(SPECULAR_PROBABILITY_DIELECTRIC, SPECULAR_PROBABILITY_METAL, metallic);
+    mat3 frame = TangentFrame(N);
+
+    float phi = 2.0 * PI * u.y;
+
+    if (uLobe < specularProbability) {
+        float a = roughness * roughness;
+        float cosTheta = sqrt((1.0 - u.x) / (1.0 + (a * a - 1.0) * u.x));
+        float sinTheta = sqrt(max(1.0 - cosTheta * cosTheta, 0.0));
+
+        vec3 H = frame * vec3(sinTheta * cos(phi), sinTheta * sin(phi), cosTheta);
+        L = reflect(-V, H);
+    } else {
+        float r = sqrt(u.x);
+        L = frame * vec3(r * cos(phi), r * sin(phi), sqrt(max(1.0 - u.x, 0.0)));
+    }
+
+    float NdotL = dot(N, L);
+    if (NdotL <= 0.0) return vec3(0.0);
+
+    vec3 H = normalize(V + L);
+    float NdotH = max(dot(N, H), 0.0);
+    float VdotH = max(dot(V, H), 1e-4);
+
+    float pdfSpecular = DistributionGGX(N, H, roughness) * NdotH / (4.0 * VdotH);
+    float pdfDiffuse = NdotL / PI;
+    float pdf = mix(pdfDiffuse, pdfSpecular, specularProbability);
+
+    if (pdf <= 0.0) return vec3(0.0);
+
+    return EvaluateBRDF(N, V, L, albedo, metallic, roughness) * NdotL / pdf;
+}
+
+// Whether anything blocks the segment; defined by each tracing backend, closesthit.glsl traces a shadow
+// ray with its miss shader and pathtrace.comp walks a ray query.
+bool TraceShadowRay(vec3 origin, float tMin, vec3 direction, float tMax);
+
+// Next-event estimation, emission and the BSDF continuation at the hit hitT along origin + t * direction,
+// with the given world-space shading normal, uv and material. Fills vertex as the radiance closest-hit
+// shader fills its payload.
+void ShadeVertex(inout RadiancePayload vertex, vec3 origin, vec3 direction, float hitT, vec3 normal, vec2 uv, uint material)
+{
+    Material mat = materials.mat[material];
+
+    vec3 albedo = GetBaseColor(mat, uv);
+
+    float metallic = mat.metallicFactor;
+    float roughness = mat.roughnessFactor;
+
+    if (mat.metallicRoughnessTexture >= 0) {
+        vec4 mrSample = texture(g_Textures[nonuniformEXT(mat.metallicRoughnessTexture)], uv);
+        roughness *= mrSample.g;
+        metallic *= mrSample.b;
+    }
+
+    roughness = max(roughness, MIN_ROUGHNESS);
+
+    vec3 V = normalize(-direction);
+    vec3 position = origin + direction * hitT;
+    uint depth = vertex.depth;
+
+    // Shade whichever side the ray arrived on, so bounces off back faces stay above the surface.
+    if (dot(normal, V) < 0.0) normal = -normal;
+
+    vec3 Lo = vec3(0.0);
+
+    if (pc.lightCount == 0u && pc.environment < 0) {
+        // Nothing emissive to sample; keep the fixed sun so such scenes are still lit.
+        vec3 L = normalize(vec3(0.5, 1.0, 0.2));
+        vec3 lightColor = vec3(3.0);
+
+        Lo = EvaluateBRDF(normal, V, L, albedo, metallic, roughness) * lightColor * max(dot(normal, L), 0.0);
+    } else {
+        float uSelect = GetSample(pc.sequence, pc.seed, vertex.pixel, vertex.sampleIndex, BounceDimension(DIMENSION_LIGHT_SELECT, depth));
+        vec2 uPoint = GetSample2D(pc.sequence, pc.seed, vertex.pixel, vertex.sampleIndex, BounceDimension(DIMENSION_LIGHT_POINT, depth));
+
+        float environmentProbability = pc.environment < 0 ? 0.0 : (pc.lightCount == 0u ? 1.0 : ENVIRONMENT_SELECT_PROBABILITY);
+
+        LightSample light;
+        if (uSelect < environmentProbability) {
+            SampleEnvironment(uPoint, light.direction, light.radiance, light.pdf);
+            light.distance = ENVIRONMENT_DISTANCE;
+            light.pdf *= environmentProbability;
+        } else {
+            uSelect = min((uSelect - environmentProbability) / (1.0 - environmentProbability), 0.99999994);
+            light = SampleLight(position, normal, uSelect, uPoint, pc.lightCount, pc.lightTree != 0u);
+            light.pdf *= 1.0 - environmentProbability;
+        }
+
+        float NdotL = dot(normal, light.direction);
+
+        if (light.pdf > 0.0 && NdotL > 0.0) {
+            // No forced opacity: opaque geometry already skips the alpha test through its geometry flag,
+            // and alpha-tested leaves must still be able to let light through.
+            if (!TraceShadowRay(position, SHADOW_EPSILON, light.direction, light.distance - SHADOW_EPSILON)) {
+                Lo = EvaluateBRDF(normal, V, light.direction, albedo, metallic, roughness) * light.radiance * NdotL / light.pdf;
+            }
+        }
+    }
+
+    vec3 emissive = mat.emissiveFactor;
+    if (mat.emissiveTexture >= 0) {
+        emissive *= texture(g_Textures[nonuniformEXT(mat.emissiveTexture)], uv).rgb;
+    }
+
+    // Emitters reached by a bounce were already light-sampled at the previous vertex; only camera rays
+    // see them directly. Without MIS this keeps every light path counted exactly once.
+    bool countEmission = depth == 0u || pc.lightCount == 0u;
+
+    vertex.radiance = Lo + (countEmission ? emissive : vec3(0.0));
+    vertex.hitT = hitT;
+    vertex.weight = vec3(0.0);
+
+    // The last vertex has no continuation to sample.
+    if (depth + 1u < pc.maxDepth) {
+        float uLobe = GetSample(pc.sequence, pc.seed, vertex.pixel, vertex.sampleIndex, BounceDimension(DIMENSION_BSDF_LOBE, depth));
+        vec2 uDirection = GetSample2D(pc.sequence, pc.seed, vertex.pixel, vertex.sampleIndex, BounceDimension(DIMENSION_BSDF_DIRECTION, depth));
+
+        vec3 L;
+        vertex.weight = SampleBRDF(normal, V, albedo, metallic, roughness, uLobe, uDirection, L);
+        vertex.direction = EncodeDirection(L);
+    }
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef SHADOW_GLSL
+#define SHADOW_GLSL
+
+// RT pipeline shadow ray behind shading.glsl's TraceShadowRay, for the closest-hit shaders and raygen.
+
+layout(location = SHADOW_PAYLOAD_LOCATION) rayPayloadEXT bool shadowed;
+
+layout(set = 1, binding = 0) uniform accelerationStructureEXT tlas;
+
+bool TraceShadowRay(vec3 origin, float tMin, vec3 direction, float tMax)
+{
+    shadowed = true;
+
+    traceRayEXT(
+        tlas,
+        gl_RayFlagsTerminateOnFirstHitEXT | gl_RayFlagsSkipClosestHitShaderEXT | pc.rayFlags,
+        0xFF,
+        0,
+        0,
+        SHADOW_MISS_INDEX,
+        origin,
+        tMin,
+        direction,
+        tMax,
+        SHADOW_PAYLOAD_LOCATION
+    );
+
+    return shadowed;
+}
+
+#endif
@@ -0,0 +1,16 @@
+#version 460
+
+#extension GL_EXT_fragment_shader_barycentric : require
+
+// Draw, primitive and barycentrics of the closest opaque triangle at the pixel centre; see
+// visibility.glsl. gl_PrimitiveID restarts at every draw, matching the primitive index within its
+// BLAS geometry.
+
+layout(location = 0) flat in uint inDraw;
+
+layout(location = 0) out uvec4 outVisibility;
+
+void main()
+{
+    outVisibility = uvec4(inDraw, uint(gl_PrimitiveID), floatBitsToUint(gl_BaryCoordEXT.y), floatBitsToUint(gl_BaryCoordEXT.z));
+}
@@ -0,0 +1,44 @@
+#ifndef VISIBILITY_GLSL
+#define VISIBILITY_GLSL
+
+// Visibility buffer of the raster primary pass and the draws it indexes, from which path.glsl rebuilds
+// the camera vertex. Requires scene.glsl.
+
+// pc.primary bits. RASTER takes the camera hit from the visibility buffer; TRACE_NON_OPAQUE also traces
+// the geometry the raster pass leaves out, alpha-tested triangles and procedurals, up to that hit.
+#define PRIMARY_RASTER 1u
+#define PRIMARY_TRACE_NON_OPAQUE 2u
+
+// R draw, G primitive within the draw, BA the barycentrics of vertices 1 and 2 as the RT attribs.
+#define NO_VISIBILITY 0xFFFFFFFFu
+
+layout(set = 1, binding = 15, rgba32ui) uniform readonly uimage2D visibility;
+
+// Matches RasterDraw in Renderer.cpp; one per opaque BLAS geometry of each instance.
+struct RasterDraw
+{
+    mat4 objectToWorld;
+    uint object;
+    uint firstIndex;
+    uint indexCount;
+    uint padding;
+};
+
+layout(set = 1, binding = 16, scalar) buffer RasterDraws
+{
+    RasterDraw d[];
+} draws;
+
+// Opaque surface the raster pass found under the pixel centre; false where it drew nothing.
+bool LoadVisibility(uvec2 pixel, out SurfaceHit surface)
+{
+    uvec4 texel = imageLoad(visibility, ivec2(pixel));
+    if (texel.x == NO_VISIBILITY) return false;
+
+    RasterDraw draw = draws.d[texel.x];
+    surface = FetchSurface(draw.object, texel.y, uintBitsToFloat(texel.zw), mat4x3(draw.objectToWorld));
+
+    return true;
+}
+
+#endif
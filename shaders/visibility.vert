@@ -0,0 +1,20 @@
+#version 460
+
+// Raster primary pass: opaque triangles from the shared vertex and index buffers, one draw per BLAS
+// geometry and instance, whose index arrives as the instance index.
+
+layout(push_constant) uniform RasterConstants
+{
+    mat4 viewProjection;
+    mat4 objectToWorld;
+} pc;
+
+layout(location = 0) in vec3 inPosition;
+
+layout(location = 0) flat out uint outDraw;
+
+void main()
+{
+    outDraw = gl_InstanceIndex;
+    gl_Position = pc.viewProjection * (pc.objectToWorld * vec4(inPosition, 1.0));
+}
@@ -0,0 +1,209 @@
+#include "BatchRenderer.hpp"
+
+#include "Scene/SceneLoader.hpp"
+#include "Scene/CameraSystem.hpp"
+#include "CPU/Checkpoint.hpp"
+
+namespace Batch {
+
+    BatchRenderer::BatchRenderer(const Settings& settings)
+        : m_Settings(settings), m_Denoiser(CPU::Denoiser::Settings {}), m_Writer(Image::ImageWriter::Settings { .threads = settings.writerThreads })
+    {
+        m_Settings.maxCachedScenes = std::max(1u, m_Settings.maxCachedScenes);
+    }
+
+    BatchRenderer::CachedScene* BatchRenderer::Acquire(const std::filesystem::path& path, Stats& stats)
+    {
+        const std::filesystem::path key = std::filesystem::weakly_canonical(path);
+
+        auto it = std::ranges::find(m_Scenes, key, &CachedScene::path);
+        if (it != m_Scenes.end()) {
+            it->lastUse = ++m_UseCounter;
+            return &*it;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        auto scene = Scene::GlTFLoader::Load(key);
+        if (!scene) return nullptr;
+
+        if (m_Scenes.size() >= m_Settings.maxCachedScenes) {
+            auto lru = std::ranges::min_element(m_Scenes, {}, &CachedScene::lastUse);
+            LOG_INFO("Evicting cached scene {}", lru->path.string());
+            m_Scenes.erase(lru);
+        }
+
+        CachedScene cached { key, nullptr, nullptr, ++m_UseCounter };
+        auto data = std::make_shared<Scene::SceneData>(std::move(*scene));
+
+        if (m_Settings.integrator == Integrator::Wavefront) {
+            cached.wavefront = std::make_unique<CPU::WavefrontIntegrator>(data, CPU::WavefrontIntegrator::Settings {
+                .width = 1,
+                .height = 1,
+                .threads = m_Settings.threads
+            });
+        } else {
+            cached.tracer = std::make_unique<CPU::Tracer>(data, Renderer::Settings {
+                .width = 1,
+                .height = 1,
+                .samples = 1,
+                .tile = m_Settings.tile
+            }, CPU::Tracer::Options {
+                .threads = m_Settings.threads,
+                .pinThreads = m_Settings.pinThreads
+            });
+        }
+
+        std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+        stats.loadTime += elapsed.count();
+        stats.sceneLoads++;
+
+        LOG_INFO("Loaded {} in {:.2f} ms", key.string(), elapsed.count() * 1000.0);
+
+        return &m_Scenes.emplace_back(std::move(cached));
+    }
+
+    CPU::TileScheduler::Stats BatchRenderer::RenderResumable(CPU::Tracer& tracer, const Job& job, const Scene::CameraData& camera, Stats& stats)
+    {
+        std::error_code ec;
+        if (std::filesystem::exists(job.checkpoint, ec) && CPU::Checkpoint::Load(job.checkpoint, tracer, camera)) {
+            stats.resumed++;
+        } else {
+            tracer.Reset();
+        }
+
+        CPU::TileScheduler::Stats renderStats;
+        auto lastSave = std::chrono::steady_clock::now();
+
+        // Continue always resolves, so a checkpoint that was already complete still produces an image.
+        do {
+            renderStats.Merge(tracer.Continue(camera, m_Settings.passSamples));
+
+            std::chrono::duration<f64> sinceSave = std::chrono::steady_clock::now() - lastSave;
+            if (sinceSave.count() >= m_Settings.checkpointInterval && !tracer.IsComplete()) {
+                if (CPU::Checkpoint::Save(job.checkpoint, tracer, camera)) stats.checkpoints++;
+                lastSave = std::chrono::steady_clock::now();
+            }
+        } while (!tracer.IsComplete());
+
+        return renderStats;
+    }
+
+    f64 BatchRenderer::RenderTracer(CPU::Tracer& tracer, const Job& job, const Scene::CameraData& camera, std::vector<glm::vec4>& pixels, Stats& stats)
+    {
+        if (tracer.GetWidth() != job.width || tracer.GetHeight() != job.height) {
+            tracer.Resize(job.width, job.height);
+        }
+
+        tracer.SetSampleCount(job.samples);
+        tracer.SetSampleSequence(CPU::SampleSequence(job.sobol ? CPU::SampleSequence::Type::Sobol : CPU::SampleSequence::Type::Random, job.seed));
+
+        auto renderStats = job.checkpoint.empty() ? tracer.Render(camera) : RenderResumable(tracer, job, camera, stats);
+
+        auto image = tracer.GetImage();
+        pixels.assign(image.begin(), image.end());
+
+        if (job.denoise) {
+            auto denoiseStart = std::chrono::steady_clock::now();
+
+            m_Denoiser.Apply(pixels, tracer.GetAccumulator(), tracer.ResolveFeatures());
+
+            std::chrono::duration<f64> denoiseTime = std::chrono::steady_clock::now() - denoiseStart;
+            stats.denoiseTime += denoiseTime.count();
+            stats.denoised++;
+        }
+
+        return renderStats.wallTime;
+    }
+
+    f64 BatchRenderer::RenderWavefront(CPU::WavefrontIntegrator& integrator, const Job& job, const Scene::CameraData& camera, std::vector<glm::vec4>& pixels)
+    {
+        if (!job.checkpoint.empty() || job.denoise) {
+            LOG_WARN("{}: the wavefront integrator ignores checkpoint= and denoise=", job.output.string());
+        }
+
+        if (integrator.GetWidth() != job.width || integrator.GetHeight() != job.height) {
+            integrator.Resize(job.width, job.height);
+        }
+
+        integrator.SetSampleCount(job.samples);
+        integrator.SetSampleSequence(CPU::SampleSequence(job.sobol ? CPU::SampleSequence::Type::Sobol : CPU::SampleSequence::Type::Random, job.seed));
+
+        auto renderStats = integrator.Render(camera);
+
+        auto image = integrator.GetImage();
+        pixels.assign(image.begin(), image.end());
+
+        return renderStats.wallTime;
+    }
+
+    BatchRenderer::Stats BatchRenderer::Run(std::span<const Job> jobs)
+    {
+        Stats stats;
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::filesystem::path> finishedCheckpoints;
+
+        for (usize i = 0; i < jobs.size(); ++i) {
+            const Job& job = jobs[i];
+
+            CachedScene* cached = Acquire(job.scene, stats);
+            if (!cached) {
+                LOG_ERROR("[{}/{}] Skipping {}: failed to load {}", i + 1, jobs.size(), job.output.string(), job.scene.string());
+                stats.failed++;
+                continue;
+            }
+
+            auto camera = Scene::CameraSystem::ComputeShaderData(job.GetCameraState(), static_cast<f32>(job.width) / static_cast<f32>(job.height));
+
+            std::vector<glm::vec4> pixels;
+            const f64 renderTime = cached->wavefront
+                ? RenderWavefront(*cached->wavefront, job, camera, pixels)
+                : RenderTracer(*cached->tracer, job, camera, pixels, stats);
+
+            const u64 samples = static_cast<u64>(job.width) * job.height * job.samples;
+            stats.renderTime += renderTime;
+            stats.samples += samples;
+            stats.jobs++;
+
+            LOG_INFO("[{}/{}] {} {}x{} @ {} spp in {:.2f} ms ({:.2f} Msamples/s)", i + 1, jobs.size(), job.output.string(),
+                job.width, job.height, job.samples, renderTime * 1000.0, static_cast<f64>(samples) / std::max(renderTime, 1e-9) / 1e6);
+
+            m_Writer.Submit(job.output, job.width, job.height, std::move(pixels));
+
+            if (!job.checkpoint.empty() && cached->tracer) finishedCheckpoints.push_back(job.checkpoint);
+        }
+
+        m_Writer.Flush();
+
+        // Checkpoints are only dropped once every output is safely on disk.
+        if (m_Writer.GetStats().failed == 0) {
+            for (const auto& checkpoint : finishedCheckpoints) {
+                std::error_code ec;
+                std::filesystem::remove(checkpoint, ec);
+            }
+        }
+
+        std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+        stats.wallTime = elapsed.count();
+
+        auto writeStats = m_Writer.GetStats();
+        stats.failed += writeStats.failed;
+
+        LOG_INFO("Batch: {} jobs ({} failed) in {:.2f} s, {:.1f} jobs/hour, {:.2f} Msamples/s",
+            stats.jobs, stats.failed, stats.wallTime, stats.wallTime > 0.0 ? stats.jobs * 3600.0 / stats.wallTime : 0.0,
+            stats.wallTime > 0.0 ? static_cast<f64>(stats.samples) / stats.wallTime / 1e6 : 0.0);
+        if (stats.denoised > 0) {
+            LOG_INFO("Batch: {} jobs denoised in {:.2f} s", stats.denoised, stats.denoiseTime);
+        }
+        if (stats.resumed > 0 || stats.checkpoints > 0) {
+            LOG_INFO("Batch: {} jobs resumed from checkpoints, {} checkpoints written", stats.resumed, stats.checkpoints);
+        }
+        LOG_INFO("Batch: {} scene loads {:.2f} s, rendering {:.2f} s; in the background: encoding {:.2f} s, writing {:.2f} s; waited {:.2f} s on the image queue",
+            stats.sceneLoads, stats.loadTime, stats.renderTime, writeStats.encodeTime, writeStats.ioTime, writeStats.stallTime);
+
+        return stats;
+    }
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "JobFile.hpp"
+
+#include "CPU/Tracer.hpp"
+#include "CPU/WavefrontIntegrator.hpp"
+#include "Image/ImageWriter.hpp"
+
+namespace Batch {
+
+    // Renders a job list back to back on the CPU tracer without a window. Scenes stay loaded together
+    // with their BVH and worker threads, so consecutive jobs on the same scene only pay for tracing.
+    class BatchRenderer
+    {
+    public:
+        enum class Integrator : u8
+        {
+            // CPU::Tracer: camera-hit direct lighting, resumable from checkpoints and denoisable.
+            Tracer,
+
+            // CPU::WavefrontIntegrator: multi-bounce paths traced breadth first. Jobs render in one go, so
+            // checkpoint= and denoise= are ignored.
+            Wavefront
+        };
+
+        struct Settings
+        {
+            Integrator integrator { Integrator::Tracer };
+
+            u32 threads { 0 };
+            u32 tile { 64 };
+            u32 maxCachedScenes { 2 };
+            u32 writerThreads { 2 };
+
+            // Jobs with a checkpoint path render in passes of passSamples spp and save at most this often.
+            f64 checkpointInterval { 300.0 };
+            u32 passSamples { 4 };
+            bool pinThreads { false };
+        };
+
+        struct Stats
+        {
+            u32 jobs { 0 };
+            u32 failed { 0 };
+            u32 sceneLoads { 0 };
+            u32 resumed { 0 };
+            u32 denoised { 0 };
+            u32 checkpoints { 0 };
+            f64 loadTime { 0.0 };
+            f64 renderTime { 0.0 };
+            f64 denoiseTime { 0.0 };
+            f64 wallTime { 0.0 };
+            u64 samples { 0 };
+        };
+
+    public:
+        BatchRenderer(const Settings& settings);
+
+        Stats Run(std::span<const Job> jobs);
+
+    private:
+        struct CachedScene
+        {
+            std::filesystem::path path;
+            std::unique_ptr<CPU::Tracer> tracer;
+            std::unique_ptr<CPU::WavefrontIntegrator> wavefront;
+            u64 lastUse { 0 };
+        };
+
+    private:
+        CachedScene* Acquire(const std::filesystem::path& path, Stats& stats);
+        CPU::TileScheduler::Stats RenderResumable(CPU::Tracer& tracer, const Job& job, const Scene::CameraData& camera, Stats& stats);
+
+        // Renders job on the tracer and returns the render time, denoising the image when the job asks for it.
+        f64 RenderTracer(CPU::Tracer& tracer, const Job& job, const Scene::CameraData& camera, std::vector<glm::vec4>& pixels, Stats& stats);
+        f64 RenderWavefront(CPU::WavefrontIntegrator& integrator, const Job& job, const Scene::CameraData& camera, std::vector<glm::vec4>& pixels);
+
+    private:
+        Settings m_Settings;
+
+        std::vector<CachedScene> m_Scenes;
+        u64 m_UseCounter { 0 };
+
+        CPU::Denoiser m_Denoiser;
+        Image::ImageWriter m_Writer;
+    };
+
+}
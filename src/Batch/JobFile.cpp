@@ -0,0 +1,143 @@
+#include "JobFile.hpp"
+
+#include <glm/gtc/quaternion.hpp>
+
+namespace Batch {
+
+    namespace {
+
+        template <typename T>
+        bool ParseNumber(std::string_view value, T& result)
+        {
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+            return ec == std::errc() && ptr == value.data() + value.size();
+        }
+
+        bool ParseVec3(std::string_view value, glm::vec3& result)
+        {
+            for (u32 i = 0; i < 3; ++i) {
+                usize comma = i < 2 ? value.find(',') : value.size();
+                if (comma == std::string_view::npos) return false;
+
+                if (!ParseNumber(value.substr(0, comma), result[i])) return false;
+                value.remove_prefix(std::min(comma + 1, value.size()));
+            }
+            return true;
+        }
+
+        std::filesystem::path Resolve(std::string_view value, const std::filesystem::path& baseDir)
+        {
+            std::filesystem::path path(value);
+            return path.is_absolute() ? path : baseDir / path;
+        }
+
+    }
+
+    Scene::CameraState Job::GetCameraState() const
+    {
+        glm::quat qPitch = glm::angleAxis(glm::radians(pitch), glm::vec3(1, 0, 0));
+        glm::quat qYaw = glm::angleAxis(glm::radians(yaw), glm::vec3(0, 1, 0));
+
+        Scene::CameraState state;
+        state.position = position;
+        state.rotation = qYaw * qPitch;
+        state.vFOV = fov;
+
+        return state;
+    }
+
+    std::optional<Job> JobFile::ParseLine(std::string_view line, const std::filesystem::path& baseDir)
+    {
+        Job job;
+
+        while (!line.empty()) {
+            usize start = line.find_first_not_of(" \t\r");
+            if (start == std::string_view::npos) break;
+            line.remove_prefix(start);
+
+            usize end = line.find_first_of(" \t\r");
+            std::string_view token = line.substr(0, end);
+            line.remove_prefix(std::min(end, line.size()));
+
+            usize eq = token.find('=');
+            if (eq == std::string_view::npos) {
+                LOG_ERROR("Expected key=value, got '{}'", token);
+                return std::nullopt;
+            }
+
+            std::string_view key = token.substr(0, eq);
+            std::string_view value = token.substr(eq + 1);
+
+            bool ok = true;
+            if (key == "scene") job.scene = Resolve(value, baseDir);
+            else if (key == "output") job.output = Resolve(value, baseDir);
+            else if (key == "checkpoint") job.checkpoint = Resolve(value, baseDir);
+            else if (key == "width") ok = ParseNumber(value, job.width);
+            else if (key == "height") ok = ParseNumber(value, job.height);
+            else if (key == "spp") ok = ParseNumber(value, job.samples);
+            else if (key == "seed") ok = ParseNumber(value, job.seed);
+            else if (key == "sequence") { ok = value == "sobol" || value == "random"; job.sobol = value == "sobol"; }
+            else if (key == "denoise") { ok = value == "on" || value == "off"; job.denoise = value == "on"; }
+            else if (key == "position") ok = ParseVec3(value, job.position);
+            else if (key == "yaw") ok = ParseNumber(value, job.yaw);
+            else if (key == "pitch") ok = ParseNumber(value, job.pitch);
+            else if (key == "fov") ok = ParseNumber(value, job.fov);
+            else {
+                LOG_ERROR("Unknown job key '{}'", key);
+                return std::nullopt;
+            }
+
+            if (!ok) {
+                LOG_ERROR("Invalid value '{}' for job key '{}'", value, key);
+                return std::nullopt;
+            }
+        }
+
+        if (job.scene.empty() || job.output.empty()) {
+            LOG_ERROR("Job needs both scene= and output=");
+            return std::nullopt;
+        }
+
+        if (job.width == 0 || job.height == 0 || job.samples == 0) {
+            LOG_ERROR("Job width, height and spp must be non-zero");
+            return std::nullopt;
+        }
+
+        return job;
+    }
+
+    std::optional<std::vector<Job>> JobFile::Load(const std::filesystem::path& path)
+    {
+        std::ifstream file(path);
+        if (!file) {
+            LOG_ERROR("Failed to open job file: {}", path.string());
+            return std::nullopt;
+        }
+
+        const std::filesystem::path baseDir = path.parent_path();
+
+        std::vector<Job> jobs;
+        std::string line;
+        u32 lineNumber = 0;
+
+        while (std::getline(file, line)) {
+            lineNumber++;
+
+            std::string_view view(line);
+            view = view.substr(0, view.find('#'));
+            if (view.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+
+            auto job = ParseLine(view, baseDir);
+            if (!job) {
+                LOG_ERROR("{}:{}: invalid job", path.string(), lineNumber);
+                return std::nullopt;
+            }
+
+            jobs.push_back(std::move(*job));
+        }
+
+        LOG_INFO("Loaded {} jobs from {}", jobs.size(), path.string());
+        return jobs;
+    }
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Scene/Camera.hpp"
+
+namespace Batch {
+
+    struct Job
+    {
+        std::filesystem::path scene;
+        std::filesystem::path output;
+
+        // Optional: progress is saved here periodically and picked up again if the job is restarted.
+        std::filesystem::path checkpoint;
+
+        u32 width { 1280 };
+        u32 height { 720 };
+        u32 samples { 16 };
+        u32 seed { 0 };
+        bool sobol { true };
+        bool denoise { false };
+
+        // Same yaw/pitch convention as FreeFlyRig, in degrees.
+        glm::vec3 position { 0.0f, 0.0f, 4.0f };
+        f32 yaw { 0.0f };
+        f32 pitch { 0.0f };
+        f32 fov { 45.0f };
+
+        Scene::CameraState GetCameraState() const;
+    };
+
+    // One job per line as whitespace separated key=value pairs, '#' starts a comment:
+    //
+    //   scene=Suzanne.glb output=out/front.png width=1920 height=1080 spp=64 position=0,0,4 yaw=0 pitch=0 fov=45
+    //
+    // checkpoint=<path> makes a job resumable and denoise=on filters the result with the CPU denoiser; both
+    // need the default tracer integrator.
+    // Relative paths resolve against the job file's directory.
+    class JobFile
+    {
+    public:
+        static std::optional<std::vector<Job>> Load(const std::filesystem::path& path);
+        static std::optional<Job> ParseLine(std::string_view line, const std::filesystem::path& baseDir);
+    };
+
+}
@@ -0,0 +1,113 @@
+#include "Accumulator.hpp"
+
+namespace CPU {
+
+    void Accumulator::Resize(u32 width, u32 height)
+    {
+        m_Width = width;
+        m_Height = height;
+        m_Pixels.assign(static_cast<usize>(width) * height, Pixel {});
+    }
+
+    void Accumulator::Reset()
+    {
+        std::fill(m_Pixels.begin(), m_Pixels.end(), Pixel {});
+    }
+
+    void Accumulator::Reset(const TileScheduler::Tile& tile)
+    {
+        for (u32 y = tile.y; y < tile.y + tile.height; ++y) {
+            auto row = m_Pixels.begin() + static_cast<usize>(y) * m_Width + tile.x;
+            std::fill(row, row + tile.width, Pixel {});
+        }
+    }
+
+    f32 Accumulator::GetRelativeError(u32 x, u32 y) const
+    {
+        const Pixel& pixel = Get(x, y);
+        if (pixel.count < 2) return std::numeric_limits<f32>::max();
+
+        f32 n = static_cast<f32>(pixel.count);
+        f32 variance = pixel.m2 / (n - 1.0f);
+        f32 standardError = std::sqrt(variance / n);
+
+        return standardError / std::max(pixel.mean, 1e-3f);
+    }
+
+    f32 Accumulator::EstimateError(const TileScheduler::Tile& tile) const
+    {
+        f32 sum = 0.0f;
+
+        for (u32 y = tile.y; y < tile.y + tile.height; ++y) {
+            for (u32 x = tile.x; x < tile.x + tile.width; ++x) {
+                f32 error = GetRelativeError(x, y);
+                if (error == std::numeric_limits<f32>::max()) return error;
+                sum += error;
+            }
+        }
+
+        return sum / static_cast<f32>(tile.width * tile.height);
+    }
+
+    u32 Accumulator::GetMinCount(const TileScheduler::Tile& tile) const
+    {
+        u32 count = std::numeric_limits<u32>::max();
+
+        for (u32 y = tile.y; y < tile.y + tile.height; ++y) {
+            for (u32 x = tile.x; x < tile.x + tile.width; ++x) {
+                count = std::min(count, GetCount(x, y));
+            }
+        }
+
+        return count;
+    }
+
+    void Accumulator::Resolve(std::span<glm::vec4> image) const
+    {
+        for (usize i = 0; i < m_Pixels.size() && i < image.size(); ++i) {
+            const Pixel& pixel = m_Pixels[i];
+            image[i] = pixel.count > 0 ? glm::vec4(pixel.sum / static_cast<f32>(pixel.count), 1.0f) : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        }
+    }
+
+    void Accumulator::Resolve(const TileScheduler::Tile& tile, std::span<glm::vec3> radiance) const
+    {
+        usize i = 0;
+        for (u32 y = tile.y; y < tile.y + tile.height; ++y) {
+            for (u32 x = tile.x; x < tile.x + tile.width && i < radiance.size(); ++x, ++i) {
+                const Pixel& pixel = Get(x, y);
+                radiance[i] = pixel.count > 0 ? pixel.sum / static_cast<f32>(pixel.count) : glm::vec3(0.0f);
+            }
+        }
+    }
+
+    u64 Accumulator::GetTotalSamples() const
+    {
+        u64 total = 0;
+        for (const auto& pixel : m_Pixels) {
+            total += pixel.count;
+        }
+        return total;
+    }
+
+    std::vector<u8> Accumulator::BuildHeatmap(u32 maxSamples) const
+    {
+        std::vector<u8> rgb(m_Pixels.size() * 3);
+
+        for (usize i = 0; i < m_Pixels.size(); ++i) {
+            f32 t = std::clamp(static_cast<f32>(m_Pixels[i].count) / static_cast<f32>(std::max(1u, maxSamples)), 0.0f, 1.0f);
+
+            // blue -> green -> red
+            glm::vec3 color = t < 0.5f
+                ? glm::mix(glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f), t * 2.0f)
+                : glm::mix(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), t * 2.0f - 1.0f);
+
+            rgb[i * 3 + 0] = static_cast<u8>(color.r * 255.0f);
+            rgb[i * 3 + 1] = static_cast<u8>(color.g * 255.0f);
+            rgb[i * 3 + 2] = static_cast<u8>(color.b * 255.0f);
+        }
+
+        return rgb;
+    }
+
+}
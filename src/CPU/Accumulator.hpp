@@ -0,0 +1,72 @@
+#pragma once
+
+#include "TileScheduler.hpp"
+
+#include <glm/glm.hpp>
+
+namespace CPU {
+
+    // Per-pixel running moments: radiance sum plus Welford mean/M2 of luminance.
+    class Accumulator
+    {
+    public:
+        struct Pixel
+        {
+            glm::vec3 sum { 0.0f };
+            u32 count { 0 };
+            f32 mean { 0.0f };
+            f32 m2 { 0.0f };
+        };
+
+    public:
+        Accumulator() = default;
+
+        void Resize(u32 width, u32 height);
+        void Reset();
+        void Reset(const TileScheduler::Tile& tile);
+
+        inline void Add(u32 x, u32 y, const glm::vec3& radiance) { Add(m_Pixels[static_cast<usize>(y) * m_Width + x], radiance); }
+
+        inline const Pixel& Get(u32 x, u32 y) const { return m_Pixels[static_cast<usize>(y) * m_Width + x]; }
+        inline u32 GetCount(u32 x, u32 y) const { return Get(x, y).count; }
+
+        f32 GetRelativeError(u32 x, u32 y) const;
+        f32 EstimateError(const TileScheduler::Tile& tile) const;
+        u32 GetMinCount(const TileScheduler::Tile& tile) const;
+
+        void Resolve(std::span<glm::vec4> image) const;
+
+        // Mean radiance of one tile, packed row by row into tile.width * tile.height entries.
+        void Resolve(const TileScheduler::Tile& tile, std::span<glm::vec3> radiance) const;
+
+        u64 GetTotalSamples() const;
+        std::vector<u8> BuildHeatmap(u32 maxSamples) const;
+
+        inline u32 GetWidth() const { return m_Width; }
+        inline u32 GetHeight() const { return m_Height; }
+        inline std::span<const Pixel> GetPixels() const { return m_Pixels; }
+        inline std::span<Pixel> GetPixels() { return m_Pixels; }
+
+        static inline f32 Luminance(const glm::vec3& c) { return glm::dot(c, glm::vec3(0.2126f, 0.7152f, 0.0722f)); }
+
+    private:
+        static inline void Add(Pixel& pixel, const glm::vec3& radiance)
+        {
+            f32 lum = Luminance(radiance);
+
+            pixel.sum += radiance;
+            pixel.count++;
+
+            f32 delta = lum - pixel.mean;
+            pixel.mean += delta / static_cast<f32>(pixel.count);
+            pixel.m2 += delta * (lum - pixel.mean);
+        }
+
+    private:
+        u32 m_Width { 0 };
+        u32 m_Height { 0 };
+
+        std::vector<Pixel> m_Pixels;
+    };
+
+}
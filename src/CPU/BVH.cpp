@@ -0,0 +1,1160 @@
+#include "BVH.hpp"
+#include "ThreadPool.hpp"
+
+namespace CPU {
+
+    namespace {
+
+        // Covers any tree up to depth 63; deeper ones (LBVH on clustered Morton codes, unbalanced PLOC
+        // merges) traverse on a per-thread stack sized from the build.
+        inline constexpr u32 TRAVERSAL_STACK_SIZE { 64 };
+
+        inline constexpr f32 TRAVERSAL_COST { 1.0f };
+        inline constexpr f32 INTERSECTION_COST { 1.0f };
+
+        inline constexpr u32 PARALLEL_GRAIN { 4096 };
+        inline constexpr u32 REFIT_GRAIN { 256 };
+
+        struct Bin
+        {
+            AABB bounds;
+            u32 count { 0 };
+        };
+
+        inline u64 ExpandBits21(u64 v)
+        {
+            v &= 0x1FFFFF;
+            v = (v | (v << 32)) & 0x001F00000000FFFFull;
+            v = (v | (v << 16)) & 0x001F0000FF0000FFull;
+            v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+            v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+            v = (v | (v << 2)) & 0x1249249249249249ull;
+            return v;
+        }
+
+        inline u32 ExpandBits10(u32 v)
+        {
+            v &= 0x3FF;
+            v = (v * 0x00010001u) & 0xFF0000FFu;
+            v = (v * 0x00000101u) & 0x0F00F00Fu;
+            v = (v * 0x00000011u) & 0xC30C30C3u;
+            v = (v * 0x00000005u) & 0x49249249u;
+            return v;
+        }
+
+        inline u64 EncodeMorton63(u32 x, u32 y, u32 z)
+        {
+            return (ExpandBits21(x) << 2) | (ExpandBits21(y) << 1) | ExpandBits21(z);
+        }
+
+        inline u64 EncodeMorton30(u32 x, u32 y, u32 z)
+        {
+            return (ExpandBits10(x) << 2) | (ExpandBits10(y) << 1) | ExpandBits10(z);
+        }
+
+        // Depth-first traversal holds at most one pending sibling per level plus the two children just
+        // pushed, so a tree of depth d never needs more than d + 1 entries.
+        inline std::span<u32> AcquireTraversalStack(std::array<u32, TRAVERSAL_STACK_SIZE>& local, u32 maxDepth)
+        {
+            if (maxDepth < TRAVERSAL_STACK_SIZE) return local;
+
+            thread_local std::vector<u32> deep;
+            if (deep.size() <= maxDepth) deep.resize(maxDepth + 1);
+
+            return deep;
+        }
+
+        // Splits [first, first + count) where the highest differing Morton bit flips, or in the middle when
+        // every code in the range is identical.
+        inline u32 FindMortonSplit(std::span<const u64> keys, u32 first, u32 count)
+        {
+            const u64 a = keys[first];
+            const u64 b = keys[first + count - 1];
+
+            if (a == b) return first + count / 2;
+
+            const u64 mask = 1ull << (63 - std::countl_zero(a ^ b));
+            auto it = std::partition_point(keys.begin() + first, keys.begin() + first + count, [mask](u64 key) {
+                return (key & mask) == 0;
+            });
+
+            return static_cast<u32>(it - keys.begin());
+        }
+
+        // LSD radix sort on 8 bit digits. Each pass builds per-chunk histograms in parallel, then scatters
+        // every chunk to its own precomputed offsets so the sort stays stable.
+        void RadixSort(std::vector<u64>& keys, std::vector<u32>& values, u32 bits)
+        {
+            const u32 count = static_cast<u32>(keys.size());
+
+            auto& pool = ThreadPool::Get();
+            const u32 chunks = std::min(pool.GetThreadCount() * 4, std::max(1u, count / PARALLEL_GRAIN));
+            const u32 chunkSize = (count + chunks - 1) / chunks;
+
+            std::vector<u64> keysTemp(count);
+            std::vector<u32> valuesTemp(count);
+            std::vector<std::array<u32, 256>> histograms(chunks);
+
+            for (u32 shift = 0; shift < bits; shift += 8) {
+                pool.ParallelFor(chunks, 1, [&](u32 begin, u32 end) {
+                    for (u32 c = begin; c < end; ++c) {
+                        auto& histogram = histograms[c];
+                        histogram.fill(0);
+
+                        for (u32 i = c * chunkSize; i < std::min(count, (c + 1) * chunkSize); ++i) {
+                            histogram[(keys[i] >> shift) & 0xFF]++;
+                        }
+                    }
+                });
+
+                u32 offset = 0;
+                bool trivial = false;
+                for (u32 digit = 0; digit < 256; ++digit) {
+                    u32 total = 0;
+                    for (u32 c = 0; c < chunks; ++c) {
+                        u32 n = histograms[c][digit];
+                        histograms[c][digit] = offset + total;
+                        total += n;
+                    }
+                    trivial |= total == count;
+                    offset += total;
+                }
+
+                if (trivial) continue;
+
+                pool.ParallelFor(chunks, 1, [&](u32 begin, u32 end) {
+                    for (u32 c = begin; c < end; ++c) {
+                        auto& histogram = histograms[c];
+
+                        for (u32 i = c * chunkSize; i < std::min(count, (c + 1) * chunkSize); ++i) {
+                            u32 dst = histogram[(keys[i] >> shift) & 0xFF]++;
+                            keysTemp[dst] = keys[i];
+                            valuesTemp[dst] = values[i];
+                        }
+                    }
+                });
+
+                std::swap(keys, keysTemp);
+                std::swap(values, valuesTemp);
+            }
+        }
+
+    }
+
+    BVH::BVH(const std::shared_ptr<Geometry>& geometry, const BuildSettings& settings)
+        : m_Geometry(geometry), m_Settings(settings)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        Build();
+        LinkParents();
+
+        if (m_Settings.packTriangles) {
+            PackTriangles();
+        }
+
+        std::chrono::duration<f64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        m_BuildSAHCost = ComputeSAHCost();
+        m_SAHCost = m_BuildSAHCost;
+
+        LOG_INFO("CPU BVH: {} nodes over {} triangles ({} references), depth {}, in {:.2f} ms (SAH cost {:.2f})",
+            m_Nodes.size(), m_Geometry->GetTriangleCount(), m_PrimIndices.size(), m_MaxDepth, elapsed.count(), m_BuildSAHCost);
+    }
+
+    void BVH::Build()
+    {
+        u32 count = m_Geometry->GetTriangleCount();
+
+        m_PrimIndices.resize(count);
+        std::iota(m_PrimIndices.begin(), m_PrimIndices.end(), 0u);
+
+        m_Nodes.clear();
+        m_Nodes.reserve(std::max(1u, count * 2));
+
+        auto& root = m_Nodes.emplace_back();
+        root.leftFirst = 0;
+        root.count = count;
+
+        if (count == 0) return;
+
+        std::vector<AABB> primBounds(count);
+        std::vector<glm::vec3> centroids(count);
+
+        ThreadPool::Get().ParallelFor(count, PARALLEL_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i) {
+                primBounds[i] = m_Geometry->GetBounds(i);
+                centroids[i] = primBounds[i].Centroid();
+            }
+        });
+
+        switch (m_Settings.method) {
+            case BuildMethod::BinnedSAH: BuildBinnedSAH(primBounds, centroids); break;
+            case BuildMethod::LBVH: BuildLBVH(primBounds, centroids); break;
+            case BuildMethod::PLOC: BuildPLOC(primBounds, centroids); break;
+            case BuildMethod::SBVH: BuildSBVH(primBounds); break;
+        }
+
+        m_Nodes.shrink_to_fit();
+    }
+
+    void BVH::BuildBinnedSAH(std::span<const AABB> primBounds, std::span<const glm::vec3> centroids)
+    {
+        UpdateBounds(0, primBounds);
+
+        std::vector<u32> stack { 0 };
+        while (!stack.empty()) {
+            u32 nodeIndex = stack.back();
+            stack.pop_back();
+
+            Node node = m_Nodes[nodeIndex];
+            if (node.count <= 1) continue;
+
+            u32 axis = 0;
+            f32 split = 0.0f;
+            f32 splitCost = FindBestSplit(node, centroids, primBounds, axis, split);
+            f32 leafCost = GetLeafCost(node.count);
+
+            if (splitCost >= leafCost && node.count <= m_Settings.maxLeafSize) continue;
+            if (splitCost == std::numeric_limits<f32>::max()) continue;
+
+            auto first = m_PrimIndices.begin() + node.leftFirst;
+            auto last = first + node.count;
+            auto middle = std::partition(first, last, [&](u32 prim) {
+                return centroids[prim][axis] < split;
+            });
+
+            u32 leftCount = static_cast<u32>(middle - first);
+            if (leftCount == 0 || leftCount == node.count) continue;
+
+            u32 leftIndex = static_cast<u32>(m_Nodes.size());
+
+            m_Nodes.push_back(Node { .bounds = {}, .leftFirst = node.leftFirst, .count = leftCount });
+            m_Nodes.push_back(Node { .bounds = {}, .leftFirst = node.leftFirst + leftCount, .count = node.count - leftCount });
+
+            m_Nodes[nodeIndex].leftFirst = leftIndex;
+            m_Nodes[nodeIndex].count = 0;
+
+            UpdateBounds(leftIndex, primBounds);
+            UpdateBounds(leftIndex + 1, primBounds);
+
+            stack.push_back(leftIndex + 1);
+            stack.push_back(leftIndex);
+        }
+    }
+
+    std::vector<u64> BVH::SortMortonCodes(std::span<const glm::vec3> centroids)
+    {
+        const u32 count = static_cast<u32>(centroids.size());
+        const bool wide = m_Settings.mortonBits > 30;
+
+        AABB centroidBounds;
+        for (const auto& c : centroids) {
+            centroidBounds.Grow(c);
+        }
+
+        const glm::vec3 origin = centroidBounds.min;
+        const glm::vec3 scale = 1.0f / glm::max(centroidBounds.Extent(), glm::vec3(1e-20f));
+        const f32 resolution = wide ? 2097151.0f : 1023.0f;
+
+        std::vector<u64> keys(count);
+
+        ThreadPool::Get().ParallelFor(count, PARALLEL_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i) {
+                glm::vec3 p = glm::clamp((centroids[i] - origin) * scale, 0.0f, 1.0f) * resolution;
+                keys[i] = wide
+                    ? EncodeMorton63(static_cast<u32>(p.x), static_cast<u32>(p.y), static_cast<u32>(p.z))
+                    : EncodeMorton30(static_cast<u32>(p.x), static_cast<u32>(p.y), static_cast<u32>(p.z));
+            }
+        });
+
+        RadixSort(keys, m_PrimIndices, wide ? 63 : 30);
+
+        return keys;
+    }
+
+    // Karras-style top-down LBVH emitted one level at a time: every node splits its Morton range at the
+    // highest differing bit, and siblings are appended next to each other so the result uses the same
+    // node layout as the SAH builder.
+    void BVH::BuildLBVH(std::span<const AABB> primBounds, std::span<const glm::vec3> centroids)
+    {
+        const u32 count = static_cast<u32>(m_PrimIndices.size());
+        const u32 maxLeafSize = std::max(1u, m_Settings.maxLeafSize);
+
+        std::vector<u64> keys = SortMortonCodes(centroids);
+
+        auto& pool = ThreadPool::Get();
+
+        m_Nodes.resize(std::max(1u, count * 2 - 1));
+
+        std::vector<u32> levels { 0, 1 };
+        std::vector<u32> splits;
+        std::vector<u32> offsets;
+
+        u32 nodeCount = 1;
+
+        while (true) {
+            const u32 levelBegin = levels[levels.size() - 2];
+            const u32 levelSize = levels.back() - levelBegin;
+
+            splits.assign(levelSize, 0);
+
+            pool.ParallelFor(levelSize, PARALLEL_GRAIN, [&](u32 begin, u32 end) {
+                for (u32 i = begin; i < end; ++i) {
+                    const Node& node = m_Nodes[levelBegin + i];
+                    if (node.count > maxLeafSize) {
+                        splits[i] = FindMortonSplit(keys, node.leftFirst, node.count);
+                    }
+                }
+            });
+
+            offsets.resize(levelSize);
+
+            u32 children = 0;
+            for (u32 i = 0; i < levelSize; ++i) {
+                offsets[i] = nodeCount + children;
+                children += splits[i] != 0 ? 2 : 0;
+            }
+
+            if (children == 0) break;
+
+            pool.ParallelFor(levelSize, PARALLEL_GRAIN, [&](u32 begin, u32 end) {
+                for (u32 i = begin; i < end; ++i) {
+                    if (splits[i] == 0) continue;
+
+                    Node& node = m_Nodes[levelBegin + i];
+                    const u32 first = node.leftFirst;
+                    const u32 leftCount = splits[i] - first;
+
+                    m_Nodes[offsets[i]] = Node { .bounds = {}, .leftFirst = first, .count = leftCount };
+                    m_Nodes[offsets[i] + 1] = Node { .bounds = {}, .leftFirst = splits[i], .count = node.count - leftCount };
+
+                    node.leftFirst = offsets[i];
+                    node.count = 0;
+                }
+            });
+
+            nodeCount += children;
+            levels.push_back(nodeCount);
+        }
+
+        m_Nodes.resize(nodeCount);
+
+        // Bounds bottom-up, deepest level first, so every child is final before its parent reads it.
+        for (usize level = levels.size() - 1; level > 0; --level) {
+            const u32 levelBegin = levels[level - 1];
+            const u32 levelSize = levels[level] - levelBegin;
+
+            pool.ParallelFor(levelSize, PARALLEL_GRAIN, [&](u32 begin, u32 end) {
+                for (u32 i = levelBegin + begin; i < levelBegin + end; ++i) {
+                    Node& node = m_Nodes[i];
+
+                    if (node.IsLeaf()) {
+                        UpdateBounds(i, primBounds);
+                    } else {
+                        node.bounds = m_Nodes[node.leftFirst].bounds;
+                        node.bounds.Grow(m_Nodes[node.leftFirst + 1].bounds);
+                    }
+                }
+            });
+        }
+    }
+
+    // PLOC (Meister and Bittner, "Parallel Locally-Ordered Clustering for Bounding Volume Hierarchy
+    // Construction"), seeded with the LBVH leaves so leaf contents stay contiguous in m_PrimIndices.
+    void BVH::BuildPLOC(std::span<const AABB> primBounds, std::span<const glm::vec3> centroids)
+    {
+        BuildLBVH(primBounds, centroids);
+
+        struct Cluster
+        {
+            AABB bounds;
+            u32 left { INVALID_INDEX };
+            u32 right { INVALID_INDEX };
+            u32 first { 0 };
+            u32 count { 0 };
+        };
+
+        const u32 primCount = static_cast<u32>(m_PrimIndices.size());
+
+        std::vector<u32> leafAt(primCount, INVALID_INDEX);
+        for (u32 i = 0; i < m_Nodes.size(); ++i) {
+            if (m_Nodes[i].IsLeaf()) leafAt[m_Nodes[i].leftFirst] = i;
+        }
+
+        std::vector<Cluster> clusterNodes;
+        std::vector<u32> clusters;
+
+        for (u32 i = 0; i < primCount; ++i) {
+            if (leafAt[i] == INVALID_INDEX) continue;
+
+            const Node& leaf = m_Nodes[leafAt[i]];
+            clusters.push_back(static_cast<u32>(clusterNodes.size()));
+            clusterNodes.push_back(Cluster { .bounds = leaf.bounds, .first = leaf.leftFirst, .count = leaf.count });
+        }
+
+        if (clusters.size() < 2) return;
+
+        const i64 radius = std::max(1u, m_Settings.plocRadius);
+
+        clusterNodes.resize(clusters.size() * 2 - 1);
+        std::atomic<u32> clusterCount { static_cast<u32>(clusters.size()) };
+
+        std::vector<u32> nearest;
+        std::vector<u32> merged;
+
+        auto& pool = ThreadPool::Get();
+
+        while (clusters.size() > 1) {
+            const i64 size = static_cast<i64>(clusters.size());
+
+            nearest.resize(clusters.size());
+            merged.resize(clusters.size());
+
+            pool.ParallelFor(static_cast<u32>(size), PARALLEL_GRAIN, [&](u32 begin, u32 end) {
+                for (i64 i = begin; i < end; ++i) {
+                    const AABB& bounds = clusterNodes[clusters[i]].bounds;
+
+                    f32 best = std::numeric_limits<f32>::max();
+                    for (i64 j = std::max<i64>(0, i - radius); j < std::min(size, i + radius + 1); ++j) {
+                        if (j == i) continue;
+
+                        AABB box = bounds;
+                        box.Grow(clusterNodes[clusters[j]].bounds);
+
+                        f32 area = box.Area();
+                        if (area < best) {
+                            best = area;
+                            nearest[i] = static_cast<u32>(j);
+                        }
+                    }
+                }
+            });
+
+            pool.ParallelFor(static_cast<u32>(size), PARALLEL_GRAIN, [&](u32 begin, u32 end) {
+                for (u32 i = begin; i < end; ++i) {
+                    u32 j = nearest[i];
+
+                    if (nearest[j] != i) {
+                        merged[i] = clusters[i];
+                        continue;
+                    }
+
+                    if (i > j) {
+                        merged[i] = INVALID_INDEX;
+                        continue;
+                    }
+
+                    u32 index = clusterCount.fetch_add(1, std::memory_order_relaxed);
+
+                    Cluster& cluster = clusterNodes[index];
+                    cluster.bounds = clusterNodes[clusters[i]].bounds;
+                    cluster.bounds.Grow(clusterNodes[clusters[j]].bounds);
+                    cluster.left = clusters[i];
+                    cluster.right = clusters[j];
+
+                    merged[i] = index;
+                }
+            });
+
+            std::erase(merged, INVALID_INDEX);
+
+            // Exact ties can leave no mutual pair; force progress by merging the first two clusters.
+            if (merged.size() == clusters.size()) {
+                u32 index = clusterCount.fetch_add(1, std::memory_order_relaxed);
+
+                Cluster& cluster = clusterNodes[index];
+                cluster.bounds = clusterNodes[merged[0]].bounds;
+                cluster.bounds.Grow(clusterNodes[merged[1]].bounds);
+                cluster.left = merged[0];
+                cluster.right = merged[1];
+
+                merged.erase(merged.begin());
+                merged[0] = index;
+            }
+
+            std::swap(clusters, merged);
+        }
+
+        m_Nodes.clear();
+        m_Nodes.reserve(clusterCount.load());
+
+        std::vector<std::pair<u32, u32>> queue { { clusters[0], 0u } };
+        m_Nodes.emplace_back();
+
+        for (usize head = 0; head < queue.size(); ++head) {
+            auto [source, target] = queue[head];
+            const Cluster& cluster = clusterNodes[source];
+
+            if (cluster.left == INVALID_INDEX) {
+                m_Nodes[target] = Node { .bounds = cluster.bounds, .leftFirst = cluster.first, .count = cluster.count };
+                continue;
+            }
+
+            u32 left = static_cast<u32>(m_Nodes.size());
+            m_Nodes[target] = Node { .bounds = cluster.bounds, .leftFirst = left, .count = 0 };
+
+            m_Nodes.emplace_back();
+            m_Nodes.emplace_back();
+
+            queue.emplace_back(cluster.left, left);
+            queue.emplace_back(cluster.right, left + 1);
+        }
+    }
+
+    // SBVH (Stich et al., "Spatial Splits in Bounding Volume Hierarchies"). Nodes work on references
+    // with clipped bounds; when the best object split leaves children overlapping by more than
+    // spatialSplitAlpha of the root area, spatial splits that clip straddling triangles are also tried.
+    void BVH::BuildSBVH(std::span<const AABB> primBounds)
+    {
+        const u32 count = static_cast<u32>(primBounds.size());
+        const u32 referenceBudget = count + static_cast<u32>(count * std::max(0.0f, m_Settings.maxReferenceGrowth));
+
+        struct Task
+        {
+            u32 node { 0 };
+            std::vector<Reference> references;
+        };
+
+        std::vector<Task> stack(1);
+        stack[0].references.resize(count);
+        for (u32 i = 0; i < count; ++i) {
+            stack[0].references[i] = Reference { .bounds = primBounds[i], .prim = i };
+        }
+
+        AABB rootBounds;
+        for (const auto& bounds : primBounds) {
+            rootBounds.Grow(bounds);
+        }
+
+        const f32 minOverlap = rootBounds.Area() * m_Settings.spatialSplitAlpha;
+
+        u32 referenceCount = count;
+
+        m_PrimIndices.clear();
+        m_PrimIndices.reserve(referenceBudget);
+
+        while (!stack.empty()) {
+            Task task = std::move(stack.back());
+            stack.pop_back();
+
+            auto& references = task.references;
+            const u32 size = static_cast<u32>(references.size());
+
+            AABB bounds;
+            for (const auto& ref : references) {
+                bounds.Grow(ref.bounds);
+            }
+
+            m_Nodes[task.node].bounds = bounds;
+
+            auto MakeLeaf = [&]() {
+                m_Nodes[task.node].leftFirst = static_cast<u32>(m_PrimIndices.size());
+                m_Nodes[task.node].count = size;
+
+                for (const auto& ref : references) {
+                    m_PrimIndices.push_back(ref.prim);
+                }
+            };
+
+            if (size <= 1) {
+                MakeLeaf();
+                continue;
+            }
+
+            SplitCandidate object = FindObjectSplit(references, bounds);
+
+            SplitCandidate spatial;
+            if (referenceCount < referenceBudget) {
+                AABB overlap = object.left;
+                overlap.min = glm::max(overlap.min, object.right.min);
+                overlap.max = glm::min(overlap.max, object.right.max);
+
+                if (overlap.Area() > minOverlap) {
+                    spatial = FindSpatialSplit(references, bounds);
+                }
+            }
+
+            const bool useSpatial = spatial.cost < object.cost;
+            const SplitCandidate& best = useSpatial ? spatial : object;
+
+            if (best.cost == std::numeric_limits<f32>::max()) {
+                MakeLeaf();
+                continue;
+            }
+
+            if (best.cost >= GetLeafCost(size) && size <= m_Settings.maxLeafSize) {
+                MakeLeaf();
+                continue;
+            }
+
+            std::vector<Reference> left;
+            std::vector<Reference> right;
+
+            if (useSpatial) {
+                for (const auto& ref : references) {
+                    if (ref.bounds.max[best.axis] <= best.position) {
+                        left.push_back(ref);
+                    } else if (ref.bounds.min[best.axis] >= best.position) {
+                        right.push_back(ref);
+                    } else {
+                        // Clipped bounds are conservative, so one side can come back empty.
+                        auto [leftRef, rightRef] = SplitReference(ref, best.axis, best.position);
+                        if (leftRef.bounds.IsValid()) left.push_back(leftRef);
+                        if (rightRef.bounds.IsValid()) right.push_back(rightRef);
+                        if (leftRef.bounds.IsValid() && rightRef.bounds.IsValid()) referenceCount++;
+                    }
+                }
+            } else {
+                for (const auto& ref : references) {
+                    (ref.bounds.Centroid()[best.axis] < best.position ? left : right).push_back(ref);
+                }
+            }
+
+            if (left.empty() || right.empty()) {
+                MakeLeaf();
+                continue;
+            }
+
+            u32 leftIndex = static_cast<u32>(m_Nodes.size());
+            m_Nodes.emplace_back();
+            m_Nodes.emplace_back();
+
+            m_Nodes[task.node].leftFirst = leftIndex;
+            m_Nodes[task.node].count = 0;
+
+            stack.push_back(Task { leftIndex + 1, std::move(right) });
+            stack.push_back(Task { leftIndex, std::move(left) });
+        }
+
+        if (referenceCount > count) {
+            LOG_DEBUG("SBVH: {} references for {} triangles (+{:.1f}%)", referenceCount, count, (referenceCount - count) * 100.0 / count);
+        }
+    }
+
+    BVH::SplitCandidate BVH::FindObjectSplit(std::span<const Reference> references, const AABB& bounds) const
+    {
+        SplitCandidate best;
+
+        AABB centroidBounds;
+        for (const auto& ref : references) {
+            centroidBounds.Grow(ref.bounds.Centroid());
+        }
+
+        const u32 binCount = m_Settings.binCount;
+        const f32 parentArea = bounds.Area();
+
+        std::vector<Bin> bins(binCount);
+        std::vector<AABB> leftBox(binCount - 1);
+        std::vector<u32> leftCount(binCount - 1);
+
+        for (u32 a = 0; a < 3; ++a) {
+            f32 lo = centroidBounds.min[a];
+            f32 hi = centroidBounds.max[a];
+            if (hi <= lo) continue;
+
+            std::fill(bins.begin(), bins.end(), Bin {});
+
+            f32 scale = binCount / (hi - lo);
+            for (const auto& ref : references) {
+                u32 bin = std::min(binCount - 1, static_cast<u32>((ref.bounds.Centroid()[a] - lo) * scale));
+                bins[bin].count++;
+                bins[bin].bounds.Grow(ref.bounds);
+            }
+
+            AABB box;
+            u32 sum = 0;
+            for (u32 i = 0; i < binCount - 1; ++i) {
+                sum += bins[i].count;
+                box.Grow(bins[i].bounds);
+                leftCount[i] = sum;
+                leftBox[i] = box;
+            }
+
+            AABB rightBox;
+            u32 rightSum = 0;
+            for (u32 i = binCount - 1; i > 0; --i) {
+                rightSum += bins[i].count;
+                rightBox.Grow(bins[i].bounds);
+
+                if (leftCount[i - 1] == 0 || rightSum == 0) continue;
+
+                f32 cost = TRAVERSAL_COST + (GetLeafCost(leftCount[i - 1]) * leftBox[i - 1].Area() + GetLeafCost(rightSum) * rightBox.Area()) / parentArea;
+                if (cost < best.cost) {
+                    best = SplitCandidate { .cost = cost, .axis = a, .position = lo + i / scale, .left = leftBox[i - 1], .right = rightBox };
+                }
+            }
+        }
+
+        return best;
+    }
+
+    BVH::SplitCandidate BVH::FindSpatialSplit(std::span<const Reference> references, const AABB& bounds) const
+    {
+        struct SpatialBin
+        {
+            AABB bounds;
+            u32 enter { 0 };
+            u32 exit { 0 };
+        };
+
+        SplitCandidate best;
+
+        const u32 binCount = m_Settings.binCount;
+        const f32 parentArea = bounds.Area();
+
+        std::vector<SpatialBin> bins(binCount);
+        std::vector<AABB> leftBox(binCount - 1);
+        std::vector<u32> leftCount(binCount - 1);
+
+        for (u32 a = 0; a < 3; ++a) {
+            f32 lo = bounds.min[a];
+            f32 hi = bounds.max[a];
+            if (hi <= lo) continue;
+
+            std::fill(bins.begin(), bins.end(), SpatialBin {});
+
+            const f32 binSize = (hi - lo) / binCount;
+            auto BinOf = [&](f32 x) { return std::min(binCount - 1, static_cast<u32>(std::max(0.0f, (x - lo) / binSize))); };
+
+            for (const auto& ref : references) {
+                u32 first = BinOf(ref.bounds.min[a]);
+                u32 last = BinOf(ref.bounds.max[a]);
+
+                // Chop the reference at every bin boundary it crosses, growing each bin by its clipped piece.
+                Reference rest = ref;
+                for (u32 b = first; b < last; ++b) {
+                    auto [piece, remainder] = SplitReference(rest, a, lo + (b + 1) * binSize);
+                    bins[b].bounds.Grow(piece.bounds);
+                    rest = remainder;
+                }
+
+                bins[last].bounds.Grow(rest.bounds);
+                bins[first].enter++;
+                bins[last].exit++;
+            }
+
+            AABB box;
+            u32 sum = 0;
+            for (u32 i = 0; i < binCount - 1; ++i) {
+                sum += bins[i].enter;
+                box.Grow(bins[i].bounds);
+                leftCount[i] = sum;
+                leftBox[i] = box;
+            }
+
+            AABB rightBox;
+            u32 rightSum = 0;
+            for (u32 i = binCount - 1; i > 0; --i) {
+                rightSum += bins[i].exit;
+                rightBox.Grow(bins[i].bounds);
+
+                if (leftCount[i - 1] == 0 || rightSum == 0) continue;
+
+                f32 cost = TRAVERSAL_COST + (GetLeafCost(leftCount[i - 1]) * leftBox[i - 1].Area() + GetLeafCost(rightSum) * rightBox.Area()) / parentArea;
+                if (cost < best.cost) {
+                    best = SplitCandidate { .cost = cost, .axis = a, .position = lo + i * binSize, .left = leftBox[i - 1], .right = rightBox };
+                }
+            }
+        }
+
+        return best;
+    }
+
+    std::pair<BVH::Reference, BVH::Reference> BVH::SplitReference(const Reference& ref, u32 axis, f32 position) const
+    {
+        Reference left { .bounds = {}, .prim = ref.prim };
+        Reference right { .bounds = {}, .prim = ref.prim };
+
+        for (u32 i = 0; i < 3; ++i) {
+            const glm::vec3& v0 = m_Geometry->GetVertex(ref.prim, i).position;
+            const glm::vec3& v1 = m_Geometry->GetVertex(ref.prim, (i + 1) % 3).position;
+
+            const f32 p0 = v0[axis];
+            const f32 p1 = v1[axis];
+
+            if (p0 <= position) left.bounds.Grow(v0);
+            if (p0 >= position) right.bounds.Grow(v0);
+
+            if ((p0 < position && p1 > position) || (p0 > position && p1 < position)) {
+                glm::vec3 t = glm::mix(v0, v1, std::clamp((position - p0) / (p1 - p0), 0.0f, 1.0f));
+                left.bounds.Grow(t);
+                right.bounds.Grow(t);
+            }
+        }
+
+        left.bounds.max[axis] = position;
+        right.bounds.min[axis] = position;
+
+        left.bounds.min = glm::max(left.bounds.min, ref.bounds.min);
+        left.bounds.max = glm::min(left.bounds.max, ref.bounds.max);
+        right.bounds.min = glm::max(right.bounds.min, ref.bounds.min);
+        right.bounds.max = glm::min(right.bounds.max, ref.bounds.max);
+
+        return { left, right };
+    }
+
+    f32 BVH::GetLeafCost(u32 count) const
+    {
+        // Packed leaves are tested a block at a time, so partially filled blocks cost as much as full ones.
+        if (m_Settings.packTriangles) {
+            return ((count + TriangleBlock::WIDTH - 1) / TriangleBlock::WIDTH) * INTERSECTION_COST;
+        }
+
+        return count * INTERSECTION_COST;
+    }
+
+    void BVH::LinkParents()
+    {
+        m_Parents.assign(m_Nodes.size(), INVALID_INDEX);
+        m_Leaves.clear();
+        m_MaxDepth = 0;
+
+        // An empty build leaves a childless root with a zero count, which would read as an interior node.
+        if (m_PrimIndices.empty()) return;
+
+        for (u32 i = 0; i < m_Nodes.size(); ++i) {
+            const Node& node = m_Nodes[i];
+
+            if (node.IsLeaf()) {
+                m_Leaves.push_back(i);
+            } else {
+                m_Parents[node.leftFirst] = i;
+                m_Parents[node.leftFirst + 1] = i;
+            }
+        }
+
+        std::vector<std::pair<u32, u32>> pending { { 0u, 0u } };
+        while (!pending.empty()) {
+            auto [index, depth] = pending.back();
+            pending.pop_back();
+
+            const Node& node = m_Nodes[index];
+            if (node.IsLeaf()) {
+                m_MaxDepth = std::max(m_MaxDepth, depth);
+                continue;
+            }
+
+            pending.emplace_back(node.leftFirst, depth + 1);
+            pending.emplace_back(node.leftFirst + 1, depth + 1);
+        }
+
+        if (m_MaxDepth >= TRAVERSAL_STACK_SIZE) {
+            LOG_WARN("CPU BVH is {} levels deep; traversal falls back to a per-thread stack", m_MaxDepth);
+        }
+    }
+
+    void BVH::PackTriangles()
+    {
+        m_LeafBlocks.assign(m_Nodes.size(), 0);
+
+        u32 blockCount = 0;
+        for (u32 leaf : m_Leaves) {
+            m_LeafBlocks[leaf] = blockCount;
+            blockCount += (m_Nodes[leaf].count + TriangleBlock::WIDTH - 1) / TriangleBlock::WIDTH;
+        }
+
+        m_Blocks.assign(blockCount, TriangleBlock {});
+
+        ThreadPool::Get().ParallelFor(static_cast<u32>(m_Leaves.size()), PARALLEL_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i) {
+                PackLeaf(m_Leaves[i]);
+            }
+        });
+    }
+
+    void BVH::PackLeaf(u32 nodeIndex)
+    {
+        const Node& node = m_Nodes[nodeIndex];
+
+        for (u32 first = 0; first < node.count; first += TriangleBlock::WIDTH) {
+            auto& block = m_Blocks[m_LeafBlocks[nodeIndex] + first / TriangleBlock::WIDTH];
+
+            for (u32 lane = 0; lane < TriangleBlock::WIDTH && first + lane < node.count; ++lane) {
+                u32 prim = m_PrimIndices[node.leftFirst + first + lane];
+                block.Set(lane, prim,
+                    m_Geometry->GetVertex(prim, 0).position,
+                    m_Geometry->GetVertex(prim, 1).position,
+                    m_Geometry->GetVertex(prim, 2).position);
+            }
+        }
+    }
+
+    // Every leaf climbs towards the root; the first child to reach a parent stops, the second one
+    // merges both children's bounds and carries on, so each node is written exactly once without locks.
+    f32 BVH::Refit()
+    {
+        if (m_PrimIndices.empty()) return 0.0f;
+
+        std::vector<std::atomic<u32>> visits(m_Nodes.size());
+        std::atomic<f64> weightedArea { 0.0 };
+
+        ThreadPool::Get().ParallelFor(static_cast<u32>(m_Leaves.size()), REFIT_GRAIN, [&](u32 begin, u32 end) {
+            f64 localArea = 0.0;
+
+            for (u32 i = begin; i < end; ++i) {
+                u32 nodeIndex = m_Leaves[i];
+                Node& leaf = m_Nodes[nodeIndex];
+
+                leaf.bounds = AABB {};
+                for (u32 p = 0; p < leaf.count; ++p) {
+                    leaf.bounds.Grow(m_Geometry->GetBounds(m_PrimIndices[leaf.leftFirst + p]));
+                }
+
+                if (!m_Blocks.empty()) {
+                    PackLeaf(nodeIndex);
+                }
+
+                localArea += leaf.bounds.Area() * GetLeafCost(leaf.count);
+
+                u32 parent = m_Parents[nodeIndex];
+                while (parent != INVALID_INDEX) {
+                    if (visits[parent].fetch_add(1, std::memory_order_acq_rel) == 0) break;
+
+                    Node& node = m_Nodes[parent];
+                    node.bounds = m_Nodes[node.leftFirst].bounds;
+                    node.bounds.Grow(m_Nodes[node.leftFirst + 1].bounds);
+
+                    localArea += node.bounds.Area() * TRAVERSAL_COST;
+
+                    parent = m_Parents[parent];
+                }
+            }
+
+            weightedArea.fetch_add(localArea, std::memory_order_relaxed);
+        });
+
+        f32 rootArea = m_Nodes[0].bounds.Area();
+        m_SAHCost = rootArea > 0.0f ? static_cast<f32>(weightedArea.load() / rootArea) : 0.0f;
+
+        return m_SAHCost;
+    }
+
+    void BVH::UpdateBounds(u32 nodeIndex, std::span<const AABB> primBounds)
+    {
+        Node& node = m_Nodes[nodeIndex];
+        node.bounds = AABB {};
+
+        for (u32 i = 0; i < node.count; ++i) {
+            node.bounds.Grow(primBounds[m_PrimIndices[node.leftFirst + i]]);
+        }
+    }
+
+    f32 BVH::FindBestSplit(const Node& node, std::span<const glm::vec3> centroids, std::span<const AABB> primBounds, u32& axis, f32& split) const
+    {
+        AABB centroidBounds;
+        for (u32 i = 0; i < node.count; ++i) {
+            centroidBounds.Grow(centroids[m_PrimIndices[node.leftFirst + i]]);
+        }
+
+        const u32 binCount = m_Settings.binCount;
+
+        std::vector<Bin> bins(binCount);
+        std::vector<f32> leftArea(binCount - 1);
+        std::vector<u32> leftCount(binCount - 1);
+
+        f32 bestCost = std::numeric_limits<f32>::max();
+        f32 parentArea = node.bounds.Area();
+
+        for (u32 a = 0; a < 3; ++a) {
+            f32 lo = centroidBounds.min[a];
+            f32 hi = centroidBounds.max[a];
+            if (hi <= lo) continue;
+
+            std::fill(bins.begin(), bins.end(), Bin {});
+
+            f32 scale = binCount / (hi - lo);
+            for (u32 i = 0; i < node.count; ++i) {
+                u32 prim = m_PrimIndices[node.leftFirst + i];
+                u32 bin = std::min(binCount - 1, static_cast<u32>((centroids[prim][a] - lo) * scale));
+
+                bins[bin].count++;
+                bins[bin].bounds.Grow(primBounds[prim]);
+            }
+
+            AABB leftBox;
+            u32 leftSum = 0;
+            for (u32 i = 0; i < binCount - 1; ++i) {
+                leftSum += bins[i].count;
+                leftBox.Grow(bins[i].bounds);
+                leftCount[i] = leftSum;
+                leftArea[i] = leftBox.Area();
+            }
+
+            AABB rightBox;
+            u32 rightSum = 0;
+            for (u32 i = binCount - 1; i > 0; --i) {
+                rightSum += bins[i].count;
+                rightBox.Grow(bins[i].bounds);
+
+                if (leftCount[i - 1] == 0 || rightSum == 0) continue;
+
+                f32 cost = TRAVERSAL_COST + (GetLeafCost(leftCount[i - 1]) * leftArea[i - 1] + GetLeafCost(rightSum) * rightBox.Area()) / parentArea;
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    axis = a;
+                    split = lo + i / scale;
+                }
+            }
+        }
+
+        return bestCost;
+    }
+
+    bool BVH::Intersect(const Ray& ray, Hit& hit) const
+    {
+        if (m_PrimIndices.empty()) return false;
+
+        glm::vec3 invDir = 1.0f / ray.direction;
+
+        std::array<u32, TRAVERSAL_STACK_SIZE> local;
+        std::span<u32> stack = AcquireTraversalStack(local, m_MaxDepth);
+        u32 stackSize = 0;
+
+        f32 tNear = 0.0f;
+        if (!IntersectAABB(ray, invDir, m_Nodes[0].bounds, std::min(ray.tMax, hit.t), tNear)) return false;
+
+        stack[stackSize++] = 0;
+
+        bool found = false;
+
+        while (stackSize > 0) {
+            const Node& node = m_Nodes[stack[--stackSize]];
+
+            if (node.IsLeaf() && !m_Blocks.empty()) {
+                const u32 first = m_LeafBlocks[&node - m_Nodes.data()];
+                const u32 count = (node.count + TriangleBlock::WIDTH - 1) / TriangleBlock::WIDTH;
+
+                for (u32 b = first; b < first + count; ++b) {
+                    std::array<f32, TriangleBlock::WIDTH> t, u, v;
+                    u32 mask = IntersectTriangleBlock(ray, m_Blocks[b], std::min(ray.tMax, hit.t), t, u, v);
+
+                    while (mask != 0) {
+                        u32 lane = static_cast<u32>(std::countr_zero(mask));
+                        mask &= mask - 1;
+
+                        if (t[lane] >= hit.t) continue;
+
+                        hit.t = t[lane];
+                        hit.u = u[lane];
+                        hit.v = v[lane];
+                        hit.primitive = m_Blocks[b].primitive[lane];
+                        found = true;
+                    }
+                }
+                continue;
+            }
+
+            if (node.IsLeaf()) {
+                for (u32 i = 0; i < node.count; ++i) {
+                    u32 prim = m_PrimIndices[node.leftFirst + i];
+
+                    f32 t, u, v;
+                    if (IntersectTriangle(ray,
+                        m_Geometry->GetVertex(prim, 0).position,
+                        m_Geometry->GetVertex(prim, 1).position,
+                        m_Geometry->GetVertex(prim, 2).position,
+                        std::min(ray.tMax, hit.t), t, u, v))
+                    {
+                        hit.t = t;
+                        hit.u = u;
+                        hit.v = v;
+                        hit.primitive = prim;
+                        found = true;
+                    }
+                }
+                continue;
+            }
+
+            u32 left = node.leftFirst;
+            u32 right = node.leftFirst + 1;
+
+            f32 tLeft = 0.0f;
+            f32 tRight = 0.0f;
+            f32 tMax = std::min(ray.tMax, hit.t);
+
+            bool hitLeft = IntersectAABB(ray, invDir, m_Nodes[left].bounds, tMax, tLeft);
+            bool hitRight = IntersectAABB(ray, invDir, m_Nodes[right].bounds, tMax, tRight);
+
+            if (hitLeft && hitRight) {
+                if (tLeft > tRight) std::swap(left, right);
+                stack[stackSize++] = right;
+                stack[stackSize++] = left;
+            } else if (hitLeft) {
+                stack[stackSize++] = left;
+            } else if (hitRight) {
+                stack[stackSize++] = right;
+            }
+        }
+
+        return found;
+    }
+
+    bool BVH::Occluded(const Ray& ray) const
+    {
+        if (m_PrimIndices.empty()) return false;
+
+        glm::vec3 invDir = 1.0f / ray.direction;
+
+        std::array<u32, TRAVERSAL_STACK_SIZE> local;
+        std::span<u32> stack = AcquireTraversalStack(local, m_MaxDepth);
+        u32 stackSize = 0;
+
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            const Node& node = m_Nodes[stack[--stackSize]];
+
+            f32 tNear = 0.0f;
+            if (!IntersectAABB(ray, invDir, node.bounds, ray.tMax, tNear)) continue;
+
+            if (node.IsLeaf() && !m_Blocks.empty()) {
+                const u32 first = m_LeafBlocks[&node - m_Nodes.data()];
+                const u32 count = (node.count + TriangleBlock::WIDTH - 1) / TriangleBlock::WIDTH;
+
+                for (u32 b = first; b < first + count; ++b) {
+                    std::array<f32, TriangleBlock::WIDTH> t, u, v;
+                    if (IntersectTriangleBlock(ray, m_Blocks[b], ray.tMax, t, u, v) != 0) return true;
+                }
+                continue;
+            }
+
+            if (node.IsLeaf()) {
+                for (u32 i = 0; i < node.count; ++i) {
+                    u32 prim = m_PrimIndices[node.leftFirst + i];
+
+                    f32 t, u, v;
+                    if (IntersectTriangle(ray,
+                        m_Geometry->GetVertex(prim, 0).position,
+                        m_Geometry->GetVertex(prim, 1).position,
+                        m_Geometry->GetVertex(prim, 2).position,
+                        ray.tMax, t, u, v))
+                    {
+                        return true;
+                    }
+                }
+                continue;
+            }
+
+            stack[stackSize++] = node.leftFirst + 1;
+            stack[stackSize++] = node.leftFirst;
+        }
+
+        return false;
+    }
+
+    f32 BVH::ComputeSAHCost() const
+    {
+        f32 rootArea = m_Nodes[0].bounds.Area();
+        if (rootArea <= 0.0f) return 0.0f;
+
+        f32 cost = 0.0f;
+        for (const auto& node : m_Nodes) {
+            f32 area = node.bounds.Area() / rootArea;
+            cost += node.IsLeaf() ? area * GetLeafCost(node.count) : area * TRAVERSAL_COST;
+        }
+
+        return cost;
+    }
+
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Math.hpp"
+#include "Geometry.hpp"
+#include "TriangleBlock.hpp"
+
+namespace CPU {
+
+    class BVH
+    {
+    public:
+        struct Node
+        {
+            AABB bounds;
+            u32 leftFirst { 0 };
+            u32 count { 0 };
+
+            inline bool IsLeaf() const { return count > 0; }
+        };
+
+        enum class BuildMethod : u8
+        {
+            BinnedSAH,
+            LBVH,
+            PLOC,
+            SBVH
+        };
+
+        struct BuildSettings
+        {
+            BuildMethod method { BuildMethod::BinnedSAH };
+            u32 maxLeafSize { 4 };
+            u32 binCount { 16 };
+            u32 mortonBits { 63 };
+            u32 plocRadius { 16 };
+            f32 spatialSplitAlpha { 1e-5f };
+            f32 maxReferenceGrowth { 0.5f };
+            bool packTriangles { true };
+        };
+
+    public:
+        BVH(const std::shared_ptr<Geometry>& geometry, const BuildSettings& settings);
+
+        bool Intersect(const Ray& ray, Hit& hit) const;
+        bool Occluded(const Ray& ray) const;
+
+        // Recomputes node bounds and packed triangles from the current Geometry vertex positions, keeping the
+        // topology. Returns the SAH cost of the refitted tree.
+        f32 Refit();
+
+        f32 ComputeSAHCost() const;
+
+        inline f32 GetBuildSAHCost() const { return m_BuildSAHCost; }
+        inline f32 GetSAHCost() const { return m_SAHCost; }
+        inline f32 GetSAHDegradation() const { return m_BuildSAHCost > 0.0f ? m_SAHCost / m_BuildSAHCost : 1.0f; }
+
+        inline u32 GetNodeCount() const { return static_cast<u32>(m_Nodes.size()); }
+        inline u32 GetMaxDepth() const { return m_MaxDepth; }
+        inline u32 GetReferenceCount() const { return static_cast<u32>(m_PrimIndices.size()); }
+        inline usize GetMemoryUsage() const { return m_Nodes.size() * sizeof(Node) + m_PrimIndices.size() * sizeof(u32) + GetTriangleMemoryUsage() + GetRefitMemoryUsage(); }
+        inline usize GetRefitMemoryUsage() const { return (m_Parents.size() + m_Leaves.size()) * sizeof(u32); }
+        inline usize GetTriangleMemoryUsage() const { return m_Blocks.size() * sizeof(TriangleBlock) + m_LeafBlocks.size() * sizeof(u32); }
+
+        inline const AABB& GetBounds() const { return m_Nodes[0].bounds; }
+        inline std::span<const Node> GetNodes() const { return m_Nodes; }
+        inline std::span<const u32> GetPrimIndices() const { return m_PrimIndices; }
+        inline std::span<const TriangleBlock> GetTriangleBlocks() const { return m_Blocks; }
+        inline const std::shared_ptr<Geometry>& GetGeometry() const { return m_Geometry; }
+        inline const BuildSettings& GetSettings() const { return m_Settings; }
+
+    private:
+        struct Reference
+        {
+            AABB bounds;
+            u32 prim { INVALID_INDEX };
+        };
+
+        struct SplitCandidate
+        {
+            f32 cost { std::numeric_limits<f32>::max() };
+            u32 axis { 0 };
+            f32 position { 0.0f };
+            AABB left;
+            AABB right;
+        };
+
+    private:
+        void Build();
+        void BuildBinnedSAH(std::span<const AABB> primBounds, std::span<const glm::vec3> centroids);
+        void BuildLBVH(std::span<const AABB> primBounds, std::span<const glm::vec3> centroids);
+        void BuildPLOC(std::span<const AABB> primBounds, std::span<const glm::vec3> centroids);
+        void BuildSBVH(std::span<const AABB> primBounds);
+        SplitCandidate FindObjectSplit(std::span<const Reference> references, const AABB& bounds) const;
+        SplitCandidate FindSpatialSplit(std::span<const Reference> references, const AABB& bounds) const;
+        std::pair<Reference, Reference> SplitReference(const Reference& ref, u32 axis, f32 position) const;
+        std::vector<u64> SortMortonCodes(std::span<const glm::vec3> centroids);
+        void LinkParents();
+        void PackTriangles();
+        void PackLeaf(u32 nodeIndex);
+        f32 GetLeafCost(u32 count) const;
+        void UpdateBounds(u32 nodeIndex, std::span<const AABB> primBounds);
+        f32 FindBestSplit(const Node& node, std::span<const glm::vec3> centroids, std::span<const AABB> primBounds, u32& axis, f32& split) const;
+
+    private:
+        std::shared_ptr<Geometry> m_Geometry;
+        BuildSettings m_Settings;
+
+        std::vector<Node> m_Nodes;
+        std::vector<u32> m_PrimIndices;
+
+        std::vector<u32> m_Parents;
+        std::vector<u32> m_Leaves;
+
+        // Deepest leaf, root at 0. Refit keeps the topology, so it only changes with a build.
+        u32 m_MaxDepth { 0 };
+
+        f32 m_BuildSAHCost { 0.0f };
+        f32 m_SAHCost { 0.0f };
+
+        // Leaf-ordered copy of the triangles; m_LeafBlocks holds each leaf's first block, indexed by node.
+        std::vector<TriangleBlock> m_Blocks;
+        std::vector<u32> m_LeafBlocks;
+    };
+
+}
@@ -0,0 +1,251 @@
+#include "Checkpoint.hpp"
+
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+namespace CPU {
+
+    namespace {
+
+        inline constexpr u64 HASH_SEED { 0xcbf29ce484222325ull };
+        inline constexpr u64 HASH_PRIME { 0x100000001b3ull };
+
+        // FNV-1a over 64-bit words with a byte-wise tail; only used to recognise identical inputs.
+        u64 HashBytes(const void* data, usize size, u64 hash = HASH_SEED)
+        {
+            const auto* bytes = static_cast<const u8*>(data);
+
+            usize i = 0;
+            for (; i + sizeof(u64) <= size; i += sizeof(u64)) {
+                u64 word;
+                std::memcpy(&word, bytes + i, sizeof(u64));
+                hash = (hash ^ word) * HASH_PRIME;
+            }
+
+            for (; i < size; ++i) {
+                hash = (hash ^ bytes[i]) * HASH_PRIME;
+            }
+
+            return hash;
+        }
+
+        template <typename T>
+        u64 HashSpan(std::span<const T> values, u64 hash)
+        {
+            hash = (hash ^ values.size()) * HASH_PRIME;
+            return HashBytes(values.data(), values.size_bytes(), hash);
+        }
+
+        bool FlushToDisk(std::FILE* file)
+        {
+            if (std::fflush(file) != 0) return false;
+#if defined(_WIN32)
+            return _commit(_fileno(file)) == 0;
+#else
+            return fsync(fileno(file)) == 0;
+#endif
+        }
+
+        template <typename T>
+        bool ReadArray(std::ifstream& file, u64 offset, std::vector<T>& values)
+        {
+            file.seekg(static_cast<std::streamoff>(offset));
+            return static_cast<bool>(file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T))));
+        }
+
+    }
+
+    u64 Checkpoint::HashScene(const Scene::SceneData& scene)
+    {
+        u64 hash = HASH_SEED;
+
+        hash = HashSpan(std::span<const Scene::Vertex>(scene.vertices), hash);
+        hash = HashSpan(std::span<const u32>(scene.indices), hash);
+        hash = HashSpan(std::span<const Scene::MaterialData>(scene.materials), hash);
+
+        for (const auto& mesh : scene.meshes) {
+            hash = HashSpan(std::span<const Scene::MeshPrimitive>(mesh.primitives), hash);
+        }
+
+        // Node has tail padding, so hash its fields rather than its bytes.
+        for (const auto& node : scene.nodes) {
+            hash = HashBytes(&node.transform, sizeof(node.transform), hash);
+            hash = HashBytes(&node.meshIndex, sizeof(node.meshIndex), hash);
+        }
+
+        for (const auto& texture : scene.textures) {
+            hash = HashBytes(&texture.width, sizeof(u32) * 3, hash);
+            hash = HashSpan(std::span<const std::byte>(texture.pixels), hash);
+        }
+
+        return hash;
+    }
+
+    u64 Checkpoint::HashCamera(const Scene::CameraData& camera)
+    {
+        return HashBytes(&camera, sizeof(Scene::CameraData));
+    }
+
+    bool Checkpoint::Save(const std::filesystem::path& path, const Tracer& tracer, const Scene::CameraData& camera)
+    {
+        const auto& accumulator = tracer.GetAccumulator();
+        const auto& options = tracer.GetOptions();
+        const auto pixels = accumulator.GetPixels();
+        const auto features = tracer.GetFeatureSums();
+
+        Header header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.width = accumulator.GetWidth();
+        header.height = accumulator.GetHeight();
+        header.samples = tracer.GetSampleCount();
+        header.sequenceType = static_cast<u32>(tracer.GetSampleSequence().GetType());
+        header.sequenceSeed = tracer.GetSampleSequence().GetSeed();
+        header.adaptive = options.adaptive ? 1 : 0;
+        header.errorThreshold = options.errorThreshold;
+        header.minSamples = options.minSamples;
+        header.batchSamples = options.batchSamples;
+        header.pixelSize = sizeof(Accumulator::Pixel);
+        header.sceneHash = HashScene(*tracer.GetScene());
+        header.cameraHash = HashCamera(camera);
+        header.pixelOffset = PIXEL_ALIGNMENT;
+        header.pixelCount = pixels.size();
+        header.pixelChecksum = HashBytes(pixels.data(), pixels.size_bytes());
+        header.totalSamples = accumulator.GetTotalSamples();
+        header.featureSize = sizeof(Tracer::FeatureSum);
+        header.featureOffset = (header.pixelOffset + pixels.size_bytes() + PIXEL_ALIGNMENT - 1) / PIXEL_ALIGNMENT * PIXEL_ALIGNMENT;
+        header.featureChecksum = HashBytes(features.data(), features.size_bytes());
+
+        std::error_code ec;
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path(), ec);
+        }
+
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+
+        std::FILE* file = std::fopen(temp.string().c_str(), "wb");
+        if (!file) {
+            LOG_ERROR("Failed to open checkpoint {}", temp.string());
+            return false;
+        }
+
+        std::array<u8, PIXEL_ALIGNMENT> page {};
+        std::memcpy(page.data(), &header, sizeof(Header));
+
+        bool ok = std::fwrite(page.data(), 1, page.size(), file) == page.size();
+        ok = ok && std::fwrite(pixels.data(), 1, pixels.size_bytes(), file) == pixels.size_bytes();
+
+        page.fill(0);
+        const usize padding = header.featureOffset - header.pixelOffset - pixels.size_bytes();
+        ok = ok && std::fwrite(page.data(), 1, padding, file) == padding;
+        ok = ok && std::fwrite(features.data(), 1, features.size_bytes(), file) == features.size_bytes();
+        ok = ok && FlushToDisk(file);
+        ok = std::fclose(file) == 0 && ok;
+
+        if (ok) {
+            std::filesystem::rename(temp, path, ec);
+            ok = !ec;
+        }
+
+        if (!ok) {
+            LOG_ERROR("Failed to write checkpoint {}", path.string());
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    std::optional<Checkpoint::Header> Checkpoint::ReadHeader(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return std::nullopt;
+
+        Header header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(Header))) return std::nullopt;
+
+        if (header.magic != MAGIC || header.version != VERSION || header.pixelSize != sizeof(Accumulator::Pixel)
+            || header.featureSize != sizeof(Tracer::FeatureSum)) {
+            LOG_ERROR("{} is not a compatible checkpoint", path.string());
+            return std::nullopt;
+        }
+
+        return header;
+    }
+
+    bool Checkpoint::Load(const std::filesystem::path& path, Tracer& tracer, const Scene::CameraData& camera)
+    {
+        auto header = ReadHeader(path);
+        if (!header) return false;
+
+        const auto& options = tracer.GetOptions();
+
+        if (header->sceneHash != HashScene(*tracer.GetScene())) {
+            LOG_ERROR("Checkpoint {} was written for a different scene", path.string());
+            return false;
+        }
+
+        if (header->cameraHash != HashCamera(camera)) {
+            LOG_ERROR("Checkpoint {} was written for a different camera", path.string());
+            return false;
+        }
+
+        if ((header->adaptive != 0) != options.adaptive || (options.adaptive && (header->errorThreshold != options.errorThreshold
+            || header->minSamples != options.minSamples || header->batchSamples != options.batchSamples))) {
+            LOG_ERROR("Checkpoint {} was written with different adaptive sampling settings", path.string());
+            return false;
+        }
+
+        // The caller has already set up the tracer for its job; a checkpoint of another resolution, sample
+        // target or sequence would resume a different render, so it is rejected rather than adopted.
+        const SampleSequence& sequence = tracer.GetSampleSequence();
+
+        if (header->width != tracer.GetWidth() || header->height != tracer.GetHeight()) {
+            LOG_WARN("Checkpoint {} is {}x{}, the render is {}x{}", path.string(), header->width, header->height, tracer.GetWidth(), tracer.GetHeight());
+            return false;
+        }
+
+        if (header->samples != tracer.GetSampleCount()) {
+            LOG_WARN("Checkpoint {} targets {} spp, the render {} spp", path.string(), header->samples, tracer.GetSampleCount());
+            return false;
+        }
+
+        if (header->sequenceType != static_cast<u32>(sequence.GetType()) || header->sequenceSeed != sequence.GetSeed()) {
+            LOG_WARN("Checkpoint {} was written with a different sample sequence or seed", path.string());
+            return false;
+        }
+
+        if (header->pixelCount != static_cast<u64>(header->width) * header->height) {
+            LOG_ERROR("Checkpoint {} is corrupt", path.string());
+            return false;
+        }
+
+        std::vector<Accumulator::Pixel> pixels(header->pixelCount);
+        std::vector<Tracer::FeatureSum> features(header->pixelCount);
+
+        std::ifstream file(path, std::ios::binary);
+        if (!ReadArray(file, header->pixelOffset, pixels) || !ReadArray(file, header->featureOffset, features)) {
+            LOG_ERROR("Checkpoint {} is truncated", path.string());
+            return false;
+        }
+
+        if (HashBytes(pixels.data(), pixels.size() * sizeof(Accumulator::Pixel)) != header->pixelChecksum
+            || HashBytes(features.data(), features.size() * sizeof(Tracer::FeatureSum)) != header->featureChecksum) {
+            LOG_ERROR("Checkpoint {} failed its checksum", path.string());
+            return false;
+        }
+
+        std::ranges::copy(pixels, tracer.GetAccumulator().GetPixels().begin());
+        std::ranges::copy(features, tracer.GetFeatureSums().begin());
+
+        LOG_INFO("Resumed {}x{} render from {} ({:.1f} of {} spp on average)", header->width, header->height, path.string(),
+            static_cast<f64>(header->totalSamples) / static_cast<f64>(std::max<u64>(1, header->pixelCount)), header->samples);
+
+        return true;
+    }
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Tracer.hpp"
+
+namespace CPU {
+
+    // Crash-safe snapshot of a progressive Tracer render. The file is a fixed header followed, at page
+    // aligned offsets, by the raw Accumulator::Pixel array and the denoiser feature sums, so both can be
+    // mapped and used in place. With the stateless sample sequence, per-pixel sample counts are the whole
+    // RNG state, so a resume against the same scene and camera continues bit-exactly.
+    class Checkpoint
+    {
+    public:
+        struct Header
+        {
+            u32 magic { 0 };
+            u32 version { 0 };
+
+            u32 width { 0 };
+            u32 height { 0 };
+            u32 samples { 0 };
+            u32 sequenceType { 0 };
+            u32 sequenceSeed { 0 };
+
+            u32 adaptive { 0 };
+            f32 errorThreshold { 0.0f };
+            u32 minSamples { 0 };
+            u32 batchSamples { 0 };
+            u32 pixelSize { 0 };
+            u32 featureSize { 0 };
+            u32 reserved { 0 };
+
+            u64 sceneHash { 0 };
+            u64 cameraHash { 0 };
+
+            u64 pixelOffset { 0 };
+            u64 pixelCount { 0 };
+            u64 pixelChecksum { 0 };
+            u64 totalSamples { 0 };
+
+            // One FeatureSum per pixel, so a resumed render denoises against the features of every sample.
+            u64 featureOffset { 0 };
+            u64 featureChecksum { 0 };
+        };
+
+        static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) == 120);
+        static_assert(std::is_trivially_copyable_v<Tracer::FeatureSum>);
+
+        inline static constexpr u32 MAGIC { 0x4B435450 }; // "PTCK"
+        inline static constexpr u32 VERSION { 2 };
+        inline static constexpr u64 PIXEL_ALIGNMENT { 4096 };
+
+    public:
+        // Written to "<path>.tmp", flushed to disk, then renamed over path.
+        static bool Save(const std::filesystem::path& path, const Tracer& tracer, const Scene::CameraData& camera);
+
+        // Restores the accumulation and feature sums into tracer. Fails without touching the tracer if the file is damaged or
+        // was written for a different scene, camera, resolution, sample target, sequence or adaptive setup.
+        static bool Load(const std::filesystem::path& path, Tracer& tracer, const Scene::CameraData& camera);
+
+        static std::optional<Header> ReadHeader(const std::filesystem::path& path);
+
+        static u64 HashScene(const Scene::SceneData& scene);
+        static u64 HashCamera(const Scene::CameraData& camera);
+    };
+
+}
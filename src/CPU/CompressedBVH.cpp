@@ -0,0 +1,393 @@
+#include "CompressedBVH.hpp"
+
+namespace CPU {
+
+    namespace {
+
+        // Enough for 73 wide levels; deeper trees traverse on a per-thread stack sized from the build.
+        inline constexpr u32 TRAVERSAL_STACK_SIZE { 512 };
+        inline constexpr u32 MAX_LEAF_TRIANGLES { 255 * TriangleBlock::WIDTH };
+        inline constexpr u32 COLLAPSED_LEAF_TRIANGLES { 2 * TriangleBlock::WIDTH };
+
+        template <typename T>
+        std::span<T> AcquireTraversalStack(std::array<T, TRAVERSAL_STACK_SIZE>& local, u32 required)
+        {
+            if (required <= TRAVERSAL_STACK_SIZE) return local;
+
+            thread_local std::vector<T> deep;
+            if (deep.size() < required) deep.resize(required);
+
+            return deep;
+        }
+
+        inline f32 ExponentToScale(i8 exponent)
+        {
+            return std::bit_cast<f32>(static_cast<u32>(exponent + 127) << 23);
+        }
+
+        i8 ComputeExponent(f32 extent)
+        {
+            if (extent <= 0.0f) return -126;
+
+            i32 exponent = static_cast<i32>(std::ceil(std::log2(extent / 255.0f)));
+            exponent = std::clamp(exponent, -126, 127);
+
+            if (exponent < 127 && ExponentToScale(static_cast<i8>(exponent)) * 255.0f < extent) exponent++;
+
+            return static_cast<i8>(exponent);
+        }
+
+#if defined(PATHTRACER_SSE)
+        inline __m128 LoadQuantized(const u8* data)
+        {
+            i32 bits;
+            std::memcpy(&bits, data, sizeof(bits));
+
+            const __m128i zero = _mm_setzero_si128();
+            __m128i v = _mm_cvtsi32_si128(bits);
+            v = _mm_unpacklo_epi8(v, zero);
+            v = _mm_unpacklo_epi16(v, zero);
+
+            return _mm_cvtepi32_ps(v);
+        }
+#endif
+
+    }
+
+    CompressedBVH::CompressedBVH(const BVH& bvh)
+        : m_Geometry(bvh.GetGeometry())
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<BVH::Node> nodes(bvh.GetNodes().begin(), bvh.GetNodes().end());
+        std::span<const u32> prims = bvh.GetPrimIndices();
+
+        // Block counts are stored in a byte, so halve any leaf that would need more than 255 blocks.
+        for (u32 i = 0; i < nodes.size(); ++i) {
+            BVH::Node node = nodes[i];
+            if (!node.IsLeaf() || node.count <= MAX_LEAF_TRIANGLES) continue;
+
+            u32 half = node.count / 2;
+            u32 left = static_cast<u32>(nodes.size());
+
+            for (auto [first, count] : { std::pair { node.leftFirst, half }, std::pair { node.leftFirst + half, node.count - half } }) {
+                AABB bounds;
+                for (u32 p = 0; p < count; ++p) {
+                    bounds.Grow(m_Geometry->GetBounds(prims[first + p]));
+                }
+                nodes.push_back(BVH::Node { .bounds = bounds, .leftFirst = first, .count = count });
+            }
+
+            nodes[i].leftFirst = left;
+            nodes[i].count = 0;
+        }
+
+        // Small subtrees become a single leaf child instead of a mostly empty wide node. Children always
+        // come after their parent in every builder, so one reverse pass gives subtree sizes.
+        std::vector<u32> subtreeCounts(nodes.size());
+        for (u32 i = static_cast<u32>(nodes.size()); i > 0; --i) {
+            const BVH::Node& node = nodes[i - 1];
+            subtreeCounts[i - 1] = node.IsLeaf() ? node.count : subtreeCounts[node.leftFirst] + subtreeCounts[node.leftFirst + 1];
+        }
+
+        auto IsLeafChild = [&](u32 index) {
+            return nodes[index].IsLeaf() || subtreeCounts[index] <= COLLAPSED_LEAF_TRIANGLES;
+        };
+
+        std::vector<u32> leafPrims;
+        auto GatherPrims = [&](u32 index) {
+            leafPrims.clear();
+
+            std::vector<u32> stack { index };
+            while (!stack.empty()) {
+                const BVH::Node& node = nodes[stack.back()];
+                stack.pop_back();
+
+                if (node.IsLeaf()) {
+                    leafPrims.insert(leafPrims.end(), prims.begin() + node.leftFirst, prims.begin() + node.leftFirst + node.count);
+                } else {
+                    stack.push_back(node.leftFirst + 1);
+                    stack.push_back(node.leftFirst);
+                }
+            }
+        };
+
+        m_Bounds = nodes[0].bounds;
+        m_Nodes.emplace_back();
+
+        std::vector<u32> depths { 0 };
+
+        std::vector<std::pair<u32, u32>> queue { { 0u, 0u } };
+
+        for (usize head = 0; head < queue.size(); ++head) {
+            auto [source, target] = queue[head];
+            const BVH::Node& parent = nodes[source];
+
+            // Pull grandchildren up into this node, always opening the largest internal child first.
+            std::array<u32, WIDTH> children;
+            u32 childCount = 0;
+
+            if (IsLeafChild(source)) {
+                children[childCount++] = source;
+            } else {
+                children[childCount++] = parent.leftFirst;
+                children[childCount++] = parent.leftFirst + 1;
+            }
+
+            while (childCount < WIDTH) {
+                i32 best = -1;
+                f32 bestArea = -1.0f;
+
+                for (u32 c = 0; c < childCount; ++c) {
+                    const BVH::Node& child = nodes[children[c]];
+                    if (!IsLeafChild(children[c]) && child.bounds.Area() > bestArea) {
+                        best = static_cast<i32>(c);
+                        bestArea = child.bounds.Area();
+                    }
+                }
+
+                if (best < 0) break;
+
+                u32 expanded = children[best];
+                children[best] = nodes[expanded].leftFirst;
+                children[childCount++] = nodes[expanded].leftFirst + 1;
+            }
+
+            Node wide;
+            wide.origin = parent.bounds.min;
+
+            glm::vec3 extent = parent.bounds.Extent();
+            glm::vec3 scale;
+            for (u32 a = 0; a < 3; ++a) {
+                wide.exponent[a] = ComputeExponent(extent[a]);
+                scale[a] = ExponentToScale(wide.exponent[a]);
+            }
+
+            wide.childBase = static_cast<u32>(m_Nodes.size());
+            wide.blockBase = static_cast<u32>(m_Blocks.size());
+
+            for (u32 c = 0; c < childCount; ++c) {
+                const BVH::Node& child = nodes[children[c]];
+
+                for (u32 a = 0; a < 3; ++a) {
+                    i32 lo = std::clamp(static_cast<i32>(std::floor((child.bounds.min[a] - wide.origin[a]) / scale[a])), 0, 255);
+                    i32 hi = std::clamp(static_cast<i32>(std::ceil((child.bounds.max[a] - wide.origin[a]) / scale[a])), 0, 255);
+
+                    // Guard against the decode rounding inwards.
+                    while (lo > 0 && wide.origin[a] + lo * scale[a] > child.bounds.min[a]) lo--;
+                    while (hi < 255 && wide.origin[a] + hi * scale[a] < child.bounds.max[a]) hi++;
+
+                    wide.lo[a][c] = static_cast<u8>(lo);
+                    wide.hi[a][c] = static_cast<u8>(hi);
+                }
+
+                if (!IsLeafChild(children[c])) {
+                    wide.internalMask |= static_cast<u8>(1u << c);
+                    queue.emplace_back(children[c], static_cast<u32>(m_Nodes.size()));
+                    m_Nodes.emplace_back();
+                    depths.push_back(depths[target] + 1);
+                    m_MaxDepth = std::max(m_MaxDepth, depths.back());
+                    continue;
+                }
+
+                GatherPrims(children[c]);
+
+                u32 blockCount = (static_cast<u32>(leafPrims.size()) + TriangleBlock::WIDTH - 1) / TriangleBlock::WIDTH;
+                wide.blockCounts[c] = static_cast<u8>(blockCount);
+
+                for (u32 first = 0; first < leafPrims.size(); first += TriangleBlock::WIDTH) {
+                    auto& block = m_Blocks.emplace_back();
+
+                    for (u32 lane = 0; lane < TriangleBlock::WIDTH && first + lane < leafPrims.size(); ++lane) {
+                        u32 prim = leafPrims[first + lane];
+                        block.Set(lane, prim,
+                            m_Geometry->GetVertex(prim, 0).position,
+                            m_Geometry->GetVertex(prim, 1).position,
+                            m_Geometry->GetVertex(prim, 2).position);
+                    }
+                }
+            }
+
+            m_Nodes[target] = wide;
+        }
+
+        std::chrono::duration<f64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        LOG_INFO("Compressed BVH: {} nodes ({:.1f} KiB) from {} binary nodes ({:.1f} KiB) in {:.2f} ms",
+            m_Nodes.size(), GetNodeMemoryUsage() / 1024.0, bvh.GetNodeCount(), bvh.GetNodeCount() * sizeof(BVH::Node) / 1024.0, elapsed.count());
+    }
+
+    u32 CompressedBVH::IntersectChildren(const Node& node, const Ray& ray, const glm::vec3& invDir, f32 tMax, std::array<f32, WIDTH>& tNear) const
+    {
+        u32 used = node.internalMask;
+        for (u32 c = 0; c < WIDTH; ++c) {
+            if (node.blockCounts[c] != 0) used |= 1u << c;
+        }
+
+        const glm::vec3 scale(ExponentToScale(node.exponent[0]), ExponentToScale(node.exponent[1]), ExponentToScale(node.exponent[2]));
+        const glm::vec3 offset = node.origin - ray.origin;
+
+        u32 mask = 0;
+
+#if defined(PATHTRACER_SSE)
+        for (u32 half = 0; half < WIDTH / 4; ++half) {
+            __m128 tEnter = _mm_set1_ps(ray.tMin);
+            __m128 tExit = _mm_set1_ps(tMax);
+
+            for (u32 a = 0; a < 3; ++a) {
+                const __m128 o = _mm_set1_ps(offset[a]);
+                const __m128 s = _mm_set1_ps(scale[a]);
+                const __m128 inv = _mm_set1_ps(invDir[a]);
+
+                __m128 lo = _mm_mul_ps(_mm_add_ps(o, _mm_mul_ps(LoadQuantized(node.lo[a].data() + half * 4), s)), inv);
+                __m128 hi = _mm_mul_ps(_mm_add_ps(o, _mm_mul_ps(LoadQuantized(node.hi[a].data() + half * 4), s)), inv);
+
+                tEnter = _mm_max_ps(tEnter, _mm_min_ps(lo, hi));
+                tExit = _mm_min_ps(tExit, _mm_max_ps(lo, hi));
+            }
+
+            _mm_storeu_ps(tNear.data() + half * 4, tEnter);
+            mask |= static_cast<u32>(_mm_movemask_ps(_mm_cmple_ps(tEnter, tExit))) << (half * 4);
+        }
+#else
+        for (u32 c = 0; c < WIDTH; ++c) {
+            f32 tEnter = ray.tMin;
+            f32 tExit = tMax;
+
+            for (u32 a = 0; a < 3; ++a) {
+                f32 lo = (offset[a] + node.lo[a][c] * scale[a]) * invDir[a];
+                f32 hi = (offset[a] + node.hi[a][c] * scale[a]) * invDir[a];
+
+                tEnter = std::max(tEnter, std::min(lo, hi));
+                tExit = std::min(tExit, std::max(lo, hi));
+            }
+
+            tNear[c] = tEnter;
+            if (tEnter <= tExit) mask |= 1u << c;
+        }
+#endif
+
+        return mask & used;
+    }
+
+    bool CompressedBVH::Intersect(const Ray& ray, Hit& hit) const
+    {
+        if (m_Blocks.empty()) return false;
+
+        glm::vec3 invDir = 1.0f / ray.direction;
+
+        std::array<std::pair<f32, u32>, TRAVERSAL_STACK_SIZE> local;
+        std::span<std::pair<f32, u32>> stack = AcquireTraversalStack(local, (WIDTH - 1) * m_MaxDepth + 1);
+        u32 stackSize = 0;
+
+        stack[stackSize++] = { ray.tMin, 0 };
+
+        bool found = false;
+
+        while (stackSize > 0) {
+            auto [tEntry, index] = stack[--stackSize];
+            if (tEntry > std::min(ray.tMax, hit.t)) continue;
+
+            const Node& node = m_Nodes[index];
+
+            std::array<f32, WIDTH> tNear;
+            u32 mask = IntersectChildren(node, ray, invDir, std::min(ray.tMax, hit.t), tNear);
+
+            u32 leaves = mask & ~static_cast<u32>(node.internalMask);
+            while (leaves != 0) {
+                u32 c = static_cast<u32>(std::countr_zero(leaves));
+                leaves &= leaves - 1;
+
+                u32 first = node.blockBase;
+                for (u32 j = 0; j < c; ++j) {
+                    first += node.blockCounts[j];
+                }
+
+                for (u32 b = first; b < first + node.blockCounts[c]; ++b) {
+                    std::array<f32, TriangleBlock::WIDTH> t, u, v;
+                    u32 lanes = IntersectTriangleBlock(ray, m_Blocks[b], std::min(ray.tMax, hit.t), t, u, v);
+
+                    while (lanes != 0) {
+                        u32 lane = static_cast<u32>(std::countr_zero(lanes));
+                        lanes &= lanes - 1;
+
+                        if (t[lane] >= hit.t) continue;
+
+                        hit.t = t[lane];
+                        hit.u = u[lane];
+                        hit.v = v[lane];
+                        hit.primitive = m_Blocks[b].primitive[lane];
+                        found = true;
+                    }
+                }
+            }
+
+            // Push internal children far to near so the closest one is popped first.
+            std::array<std::pair<f32, u32>, WIDTH> children;
+            u32 childCount = 0;
+
+            u32 internal = mask & node.internalMask;
+            while (internal != 0) {
+                u32 c = static_cast<u32>(std::countr_zero(internal));
+                internal &= internal - 1;
+
+                u32 child = node.childBase + static_cast<u32>(std::popcount(static_cast<u32>(node.internalMask) & ((1u << c) - 1)));
+                children[childCount++] = { tNear[c], child };
+            }
+
+            std::sort(children.begin(), children.begin() + childCount, [](const auto& a, const auto& b) { return a.first > b.first; });
+
+            for (u32 c = 0; c < childCount; ++c) {
+                stack[stackSize++] = children[c];
+            }
+        }
+
+        return found;
+    }
+
+    bool CompressedBVH::Occluded(const Ray& ray) const
+    {
+        if (m_Blocks.empty()) return false;
+
+        glm::vec3 invDir = 1.0f / ray.direction;
+
+        std::array<u32, TRAVERSAL_STACK_SIZE> local;
+        std::span<u32> stack = AcquireTraversalStack(local, (WIDTH - 1) * m_MaxDepth + 1);
+        u32 stackSize = 0;
+
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            const Node& node = m_Nodes[stack[--stackSize]];
+
+            std::array<f32, WIDTH> tNear;
+            u32 mask = IntersectChildren(node, ray, invDir, ray.tMax, tNear);
+
+            u32 leaves = mask & ~static_cast<u32>(node.internalMask);
+            while (leaves != 0) {
+                u32 c = static_cast<u32>(std::countr_zero(leaves));
+                leaves &= leaves - 1;
+
+                u32 first = node.blockBase;
+                for (u32 j = 0; j < c; ++j) {
+                    first += node.blockCounts[j];
+                }
+
+                for (u32 b = first; b < first + node.blockCounts[c]; ++b) {
+                    std::array<f32, TriangleBlock::WIDTH> t, u, v;
+                    if (IntersectTriangleBlock(ray, m_Blocks[b], ray.tMax, t, u, v) != 0) return true;
+                }
+            }
+
+            u32 internal = mask & node.internalMask;
+            while (internal != 0) {
+                u32 c = static_cast<u32>(std::countr_zero(internal));
+                internal &= internal - 1;
+
+                stack[stackSize++] = node.childBase + static_cast<u32>(std::popcount(static_cast<u32>(node.internalMask) & ((1u << c) - 1)));
+            }
+        }
+
+        return false;
+    }
+
+}
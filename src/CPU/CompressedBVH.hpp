@@ -0,0 +1,58 @@
+#pragma once
+
+#include "BVH.hpp"
+
+namespace CPU {
+
+    // Eight-wide BVH with quantised child bounds, collapsed from a binary BVH. Each node stores its
+    // own bounds origin and a power-of-two scale per axis; child boxes are 8-bit offsets in that frame,
+    // rounded outwards so they always contain the original child.
+    class CompressedBVH
+    {
+    public:
+        inline static constexpr u32 WIDTH { 8 };
+
+        struct alignas(16) Node
+        {
+            glm::vec3 origin { 0.0f };
+            std::array<i8, 3> exponent { 0, 0, 0 };
+            u8 internalMask { 0 };
+            u32 childBase { 0 };
+            u32 blockBase { 0 };
+            std::array<u8, WIDTH> blockCounts { 0 };
+            std::array<std::array<u8, WIDTH>, 3> lo {};
+            std::array<std::array<u8, WIDTH>, 3> hi {};
+        };
+
+        static_assert(sizeof(Node) == 80);
+
+    public:
+        CompressedBVH(const BVH& bvh);
+
+        bool Intersect(const Ray& ray, Hit& hit) const;
+        bool Occluded(const Ray& ray) const;
+
+        inline u32 GetNodeCount() const { return static_cast<u32>(m_Nodes.size()); }
+        inline u32 GetMaxDepth() const { return m_MaxDepth; }
+        inline usize GetNodeMemoryUsage() const { return m_Nodes.size() * sizeof(Node); }
+        inline usize GetMemoryUsage() const { return GetNodeMemoryUsage() + m_Blocks.size() * sizeof(TriangleBlock); }
+
+        inline const AABB& GetBounds() const { return m_Bounds; }
+        inline std::span<const Node> GetNodes() const { return m_Nodes; }
+        inline const std::shared_ptr<Geometry>& GetGeometry() const { return m_Geometry; }
+
+    private:
+        u32 IntersectChildren(const Node& node, const Ray& ray, const glm::vec3& invDir, f32 tMax, std::array<f32, WIDTH>& tNear) const;
+
+    private:
+        std::shared_ptr<Geometry> m_Geometry;
+        AABB m_Bounds;
+
+        std::vector<Node> m_Nodes;
+        std::vector<TriangleBlock> m_Blocks;
+
+        // Deepest wide node, root at 0; traversal needs (WIDTH - 1) * m_MaxDepth + 1 stack entries.
+        u32 m_MaxDepth { 0 };
+    };
+
+}
@@ -0,0 +1,400 @@
+#include "Denoiser.hpp"
+
+#include "Math.hpp"
+#include "ThreadPool.hpp"
+
+namespace CPU {
+
+    namespace {
+
+        inline constexpr std::array<f32, 5> KERNEL { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+        inline constexpr f32 LOG2E { std::numbers::log2e_v<f32> };
+        inline constexpr f32 MIN_ALBEDO { 1e-3f };
+        inline constexpr f32 MIN_COSINE { 1e-8f };
+        inline constexpr f32 EPSILON { 1e-4f };
+
+        inline constexpr u32 ROW_GRAIN { 4 };
+
+        inline f32 Luminance(f32 r, f32 g, f32 b)
+        {
+            return 0.2126f * r + 0.7152f * g + 0.0722f * b;
+        }
+
+#if defined(PATHTRACER_SSE)
+        // Taylor series of 2^f on [0, 1) after splitting off the integer part; relative error < 2e-4,
+        // which is far below what the edge-stopping weights can resolve.
+        inline __m128 FastExp2(__m128 x)
+        {
+            x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(126.0f));
+
+            __m128 whole = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+            whole = _mm_sub_ps(whole, _mm_and_ps(_mm_cmpgt_ps(whole, x), _mm_set1_ps(1.0f)));
+
+            const __m128 f = _mm_sub_ps(x, whole);
+
+            __m128 p = _mm_set1_ps(1.3333558e-3f);
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(9.6181291e-3f));
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(5.5504109e-2f));
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(2.4022651e-1f));
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(6.9314718e-1f));
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+
+            const __m128i exponent = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(whole), _mm_set1_epi32(127)), 23);
+            return _mm_mul_ps(p, _mm_castsi128_ps(exponent));
+        }
+
+        // log2 for positive inputs: exponent bits plus the atanh series of the mantissa in [1, 2).
+        inline __m128 FastLog2(__m128 x)
+        {
+            const __m128i bits = _mm_castps_si128(x);
+
+            const __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+            const __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 s = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+            const __m128 s2 = _mm_mul_ps(s, s);
+
+            __m128 p = _mm_set1_ps(1.0f / 7.0f);
+            p = _mm_add_ps(_mm_mul_ps(p, s2), _mm_set1_ps(1.0f / 5.0f));
+            p = _mm_add_ps(_mm_mul_ps(p, s2), _mm_set1_ps(1.0f / 3.0f));
+            p = _mm_add_ps(_mm_mul_ps(p, s2), one);
+
+            return _mm_add_ps(exponent, _mm_mul_ps(_mm_mul_ps(s, p), _mm_set1_ps(2.0f * LOG2E)));
+        }
+
+        inline __m128 Abs(__m128 x)
+        {
+            return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+        }
+
+        inline __m128 Luminance(__m128 r, __m128 g, __m128 b)
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(0.2126f)), _mm_mul_ps(g, _mm_set1_ps(0.7152f))), _mm_mul_ps(b, _mm_set1_ps(0.0722f)));
+        }
+
+        inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+#endif
+
+    }
+
+    void FeatureBuffer::Resize(u32 w, u32 h)
+    {
+        width = w;
+        height = h;
+
+        const usize count = static_cast<usize>(w) * h;
+        albedo.assign(count, glm::vec3(0.0f));
+        normal.assign(count, glm::vec3(0.0f));
+        depth.assign(count, 0.0f);
+    }
+
+    Denoiser::Denoiser(const Settings& settings)
+        : m_Settings(settings)
+    {
+    }
+
+    void Denoiser::Apply(std::span<glm::vec4> image, const Accumulator& accumulator, const FeatureBuffer& features)
+    {
+        const usize count = static_cast<usize>(features.width) * features.height;
+        if (image.size() != count || accumulator.GetPixels().size() != count || features.depth.size() != count) {
+            LOG_ERROR("Denoiser inputs do not match: image {} pixels, accumulator {}, features {}x{}",
+                image.size(), accumulator.GetPixels().size(), features.width, features.height);
+            return;
+        }
+
+        if (m_Settings.iterations == 0) return;
+
+        Prepare(image, accumulator, features);
+
+        auto& pool = ThreadPool::Get();
+
+        u32 current = 0;
+        for (u32 i = 0; i < m_Settings.iterations; ++i) {
+            const Planes& src = m_Planes[current];
+            Planes& dst = m_Planes[current ^ 1];
+
+            BlurVariance(src);
+
+            pool.ParallelFor(m_Height, ROW_GRAIN, [&, step = 1u << i](u32 begin, u32 end) {
+                FilterRows(src, dst, step, begin, end);
+            });
+
+            current ^= 1;
+        }
+
+        const Planes& result = m_Planes[current];
+
+        pool.ParallelFor(m_Height, ROW_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 y = begin; y < end; ++y) {
+                for (u32 x = 0; x < m_Width; ++x) {
+                    const usize p = Index(x, y);
+                    glm::vec3 color(result.color[0][p], result.color[1][p], result.color[2][p]);
+
+                    if (m_Settings.demodulateAlbedo) {
+                        color *= glm::max(glm::vec3(m_Albedo[0][p], m_Albedo[1][p], m_Albedo[2][p]), glm::vec3(MIN_ALBEDO));
+                    }
+
+                    image[static_cast<usize>(y) * m_Width + x] = glm::vec4(color, 1.0f);
+                }
+            }
+        });
+    }
+
+    void Denoiser::Prepare(std::span<const glm::vec4> image, const Accumulator& accumulator, const FeatureBuffer& features)
+    {
+        m_Width = features.width;
+        m_Height = features.height;
+
+        // Taps reach two steps out, and rows are processed four pixels at a time.
+        const u32 maxStep = 1u << (m_Settings.iterations - 1);
+        m_Border = (2 * maxStep + 3) & ~3u;
+        m_Stride = m_Border + ((m_Width + 3) & ~3u) + m_Border;
+
+        const usize size = m_Stride * (m_Height + 2 * static_cast<usize>(m_Border));
+
+        auto Allocate = [size](std::vector<f32>& plane) { plane.assign(size, 0.0f); };
+
+        for (auto& planes : m_Planes) {
+            std::ranges::for_each(planes.color, Allocate);
+            Allocate(planes.variance);
+        }
+
+        Allocate(m_BlurredVariance);
+        Allocate(m_Depth);
+        std::ranges::for_each(m_Normal, Allocate);
+        std::ranges::for_each(m_Albedo, Allocate);
+
+        Planes& planes = m_Planes[0];
+
+        ThreadPool::Get().ParallelFor(m_Height, ROW_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 y = begin; y < end; ++y) {
+                for (u32 x = 0; x < m_Width; ++x) {
+                    const usize i = static_cast<usize>(y) * m_Width + x;
+                    const usize p = Index(x, y);
+
+                    const glm::vec3& normal = features.normal[i];
+                    const bool hit = normal != glm::vec3(0.0f);
+
+                    // Misses keep a unit albedo so the sky passes through unchanged.
+                    const glm::vec3 albedo = hit ? features.albedo[i] : glm::vec3(1.0f);
+
+                    glm::vec3 color(image[i]);
+
+                    // Variance of the pixel mean, not of individual samples.
+                    const auto& pixel = accumulator.GetPixels()[i];
+                    f32 variance = pixel.count > 1 ? pixel.m2 / static_cast<f32>(pixel.count - 1) / static_cast<f32>(pixel.count) : -1.0f;
+
+                    if (m_Settings.demodulateAlbedo) {
+                        const glm::vec3 clamped = glm::max(albedo, glm::vec3(MIN_ALBEDO));
+                        color /= clamped;
+
+                        const f32 lum = std::max(Accumulator::Luminance(clamped), MIN_ALBEDO);
+                        if (variance > 0.0f) variance /= lum * lum;
+                    }
+
+                    for (u32 c = 0; c < 3; ++c) {
+                        planes.color[c][p] = color[c];
+                        m_Normal[c][p] = normal[c];
+                        m_Albedo[c][p] = albedo[c];
+                    }
+
+                    planes.variance[p] = variance;
+                    m_Depth[p] = features.depth[i];
+                }
+            }
+        });
+
+        // With a single sample there are no moments to go on, so fall back to the luminance variance of
+        // the 3x3 neighbourhood, the same spatial estimate SVGF uses for short histories.
+        ThreadPool::Get().ParallelFor(m_Height, ROW_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 y = begin; y < end; ++y) {
+                for (u32 x = 0; x < m_Width; ++x) {
+                    const usize p = Index(x, y);
+                    if (planes.variance[p] >= 0.0f) continue;
+
+                    f32 sum = 0.0f;
+                    f32 sumSquared = 0.0f;
+                    u32 count = 0;
+
+                    for (i32 dy = -1; dy <= 1; ++dy) {
+                        for (i32 dx = -1; dx <= 1; ++dx) {
+                            const usize q = static_cast<usize>(static_cast<std::ptrdiff_t>(p) + dy * static_cast<std::ptrdiff_t>(m_Stride) + dx);
+                            if (m_Normal[0][q] == 0.0f && m_Normal[1][q] == 0.0f && m_Normal[2][q] == 0.0f && q != p) continue;
+
+                            const f32 lum = Luminance(planes.color[0][q], planes.color[1][q], planes.color[2][q]);
+                            sum += lum;
+                            sumSquared += lum * lum;
+                            count++;
+                        }
+                    }
+
+                    const f32 mean = sum / static_cast<f32>(count);
+                    planes.variance[p] = std::max(0.0f, sumSquared / static_cast<f32>(count) - mean * mean);
+                }
+            }
+        });
+    }
+
+    void Denoiser::BlurVariance(const Planes& src)
+    {
+        // 3x3 Gaussian, as in SVGF, so a single noisy variance estimate does not switch the luminance
+        // edge stop off.
+        ThreadPool::Get().ParallelFor(m_Height, ROW_GRAIN, [&](u32 begin, u32 end) {
+            const f32* variance = src.variance.data();
+
+            for (u32 y = begin; y < end; ++y) {
+                for (u32 x = 0; x < m_Width; ++x) {
+                    const usize p = Index(x, y);
+                    const usize up = p - m_Stride;
+                    const usize down = p + m_Stride;
+
+                    m_BlurredVariance[p] =
+                        0.0625f * (variance[up - 1] + variance[up + 1] + variance[down - 1] + variance[down + 1]) +
+                        0.125f * (variance[up] + variance[down] + variance[p - 1] + variance[p + 1]) +
+                        0.25f * variance[p];
+                }
+            }
+        });
+    }
+
+    void Denoiser::FilterRows(const Planes& src, Planes& dst, u32 step, u32 begin, u32 end) const
+    {
+        const f32 sigmaLuminance = m_Settings.sigmaLuminance;
+        const f32 sigmaNormal = m_Settings.sigmaNormal;
+        const f32 sigmaDepth = m_Settings.sigmaDepth * static_cast<f32>(step);
+
+        const f32* r = src.color[0].data();
+        const f32* g = src.color[1].data();
+        const f32* b = src.color[2].data();
+        const f32* variance = src.variance.data();
+        const f32* nx = m_Normal[0].data();
+        const f32* ny = m_Normal[1].data();
+        const f32* nz = m_Normal[2].data();
+        const f32* depth = m_Depth.data();
+
+        const std::ptrdiff_t rowStep = static_cast<std::ptrdiff_t>(m_Stride) * step;
+
+#if defined(PATHTRACER_SSE)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 minCosine = _mm_set1_ps(MIN_COSINE);
+        const __m128 epsilon = _mm_set1_ps(EPSILON);
+        const __m128 log2e = _mm_set1_ps(LOG2E);
+        const __m128 normalPower = _mm_set1_ps(sigmaNormal);
+
+        for (u32 y = begin; y < end; ++y) {
+            for (u32 x = 0; x < m_Width; x += 4) {
+                const usize p = Index(x, y);
+
+                const __m128 pr = _mm_loadu_ps(r + p);
+                const __m128 pg = _mm_loadu_ps(g + p);
+                const __m128 pb = _mm_loadu_ps(b + p);
+                const __m128 pnx = _mm_loadu_ps(nx + p);
+                const __m128 pny = _mm_loadu_ps(ny + p);
+                const __m128 pnz = _mm_loadu_ps(nz + p);
+                const __m128 pz = _mm_loadu_ps(depth + p);
+                const __m128 pl = Luminance(pr, pg, pb);
+
+                const __m128 luminanceScale = _mm_div_ps(_mm_set1_ps(LOG2E),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(sigmaLuminance), _mm_sqrt_ps(_mm_loadu_ps(m_BlurredVariance.data() + p))), epsilon));
+                const __m128 depthScale = _mm_div_ps(log2e, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(sigmaDepth), pz), epsilon));
+
+                __m128 sumWeight = zero;
+                __m128 sumR = zero;
+                __m128 sumG = zero;
+                __m128 sumB = zero;
+                __m128 sumVariance = zero;
+
+                for (i32 dy = -2; dy <= 2; ++dy) {
+                    for (i32 dx = -2; dx <= 2; ++dx) {
+                        const usize q = static_cast<usize>(static_cast<std::ptrdiff_t>(p) + dy * rowStep + dx * static_cast<std::ptrdiff_t>(step));
+
+                        const __m128 qr = _mm_loadu_ps(r + q);
+                        const __m128 qg = _mm_loadu_ps(g + q);
+                        const __m128 qb = _mm_loadu_ps(b + q);
+
+                        __m128 cosine = _mm_mul_ps(pnx, _mm_loadu_ps(nx + q));
+                        cosine = _mm_add_ps(cosine, _mm_mul_ps(pny, _mm_loadu_ps(ny + q)));
+                        cosine = _mm_add_ps(cosine, _mm_mul_ps(pnz, _mm_loadu_ps(nz + q)));
+
+                        const __m128 luminanceTerm = _mm_mul_ps(Abs(_mm_sub_ps(Luminance(qr, qg, qb), pl)), luminanceScale);
+                        const __m128 depthTerm = _mm_mul_ps(Abs(_mm_sub_ps(_mm_loadu_ps(depth + q), pz)), depthScale);
+
+                        // All three edge stops share one exp2: pow(cos, n) * exp(-dl) * exp(-dz).
+                        const __m128 exponent = _mm_sub_ps(_mm_mul_ps(normalPower, FastLog2(_mm_max_ps(cosine, minCosine))), _mm_add_ps(luminanceTerm, depthTerm));
+                        // Back-facing or missing normals (sky, padding) are masked out exactly rather than left
+                        // at FastExp2's smallest representable weight.
+                        const __m128 weight = _mm_and_ps(_mm_cmpgt_ps(cosine, minCosine),
+                            _mm_mul_ps(_mm_set1_ps(KERNEL[dy + 2] * KERNEL[dx + 2]), FastExp2(exponent)));
+
+                        sumWeight = _mm_add_ps(sumWeight, weight);
+                        sumR = _mm_add_ps(sumR, _mm_mul_ps(weight, qr));
+                        sumG = _mm_add_ps(sumG, _mm_mul_ps(weight, qg));
+                        sumB = _mm_add_ps(sumB, _mm_mul_ps(weight, qb));
+                        sumVariance = _mm_add_ps(sumVariance, _mm_mul_ps(_mm_mul_ps(weight, weight), _mm_loadu_ps(variance + q)));
+                    }
+                }
+
+                // Pixels without a surface (misses, padding) get no weight from anyone and pass through.
+                const __m128 valid = _mm_cmpgt_ps(sumWeight, zero);
+                const __m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_or_ps(sumWeight, _mm_andnot_ps(valid, _mm_set1_ps(1.0f))));
+
+                _mm_storeu_ps(dst.color[0].data() + p, Select(valid, _mm_mul_ps(sumR, inverse), pr));
+                _mm_storeu_ps(dst.color[1].data() + p, Select(valid, _mm_mul_ps(sumG, inverse), pg));
+                _mm_storeu_ps(dst.color[2].data() + p, Select(valid, _mm_mul_ps(sumB, inverse), pb));
+                _mm_storeu_ps(dst.variance.data() + p, Select(valid, _mm_mul_ps(sumVariance, _mm_mul_ps(inverse, inverse)), _mm_loadu_ps(variance + p)));
+            }
+        }
+#else
+        for (u32 y = begin; y < end; ++y) {
+            for (u32 x = 0; x < m_Width; ++x) {
+                const usize p = Index(x, y);
+
+                const f32 pl = Luminance(r[p], g[p], b[p]);
+                const f32 luminanceScale = 1.0f / (sigmaLuminance * std::sqrt(m_BlurredVariance[p]) + EPSILON);
+                const f32 depthScale = 1.0f / (sigmaDepth * depth[p] + EPSILON);
+
+                f32 sumWeight = 0.0f;
+                glm::vec3 sum(0.0f);
+                f32 sumVariance = 0.0f;
+
+                for (i32 dy = -2; dy <= 2; ++dy) {
+                    for (i32 dx = -2; dx <= 2; ++dx) {
+                        const usize q = static_cast<usize>(static_cast<std::ptrdiff_t>(p) + dy * rowStep + dx * static_cast<std::ptrdiff_t>(step));
+
+                        const f32 cosine = nx[p] * nx[q] + ny[p] * ny[q] + nz[p] * nz[q];
+                        if (cosine <= MIN_COSINE) continue;
+
+                        const f32 luminanceTerm = std::abs(Luminance(r[q], g[q], b[q]) - pl) * luminanceScale;
+                        const f32 depthTerm = std::abs(depth[q] - depth[p]) * depthScale;
+
+                        const f32 weight = KERNEL[dy + 2] * KERNEL[dx + 2] * std::pow(cosine, sigmaNormal) * std::exp(-(luminanceTerm + depthTerm));
+
+                        sumWeight += weight;
+                        sum += weight * glm::vec3(r[q], g[q], b[q]);
+                        sumVariance += weight * weight * variance[q];
+                    }
+                }
+
+                if (sumWeight > 0.0f) {
+                    sum /= sumWeight;
+                    sumVariance /= sumWeight * sumWeight;
+                } else {
+                    sum = glm::vec3(r[p], g[p], b[p]);
+                    sumVariance = variance[p];
+                }
+
+                dst.color[0][p] = sum.r;
+                dst.color[1][p] = sum.g;
+                dst.color[2][p] = sum.b;
+                dst.variance[p] = sumVariance;
+            }
+        }
+#endif
+    }
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Accumulator.hpp"
+
+namespace CPU {
+
+    // First-hit surface attributes per pixel. Misses have a zero normal and depth.
+    struct FeatureBuffer
+    {
+        u32 width { 0 };
+        u32 height { 0 };
+
+        std::vector<glm::vec3> albedo;
+        std::vector<glm::vec3> normal;
+        std::vector<f32> depth;
+
+        void Resize(u32 w, u32 h);
+    };
+
+    // Edge-avoiding à-trous wavelet filter in the style of SVGF (Schied et al. 2017): repeated 5x5
+    // B3-spline passes with doubling tap spacing, weighted by normal, depth and variance-normalised
+    // luminance differences. Lighting is filtered with albedo divided out so texture detail survives.
+    class Denoiser
+    {
+    public:
+        struct Settings
+        {
+            u32 iterations { 5 };
+
+            // Edge-stopping strengths: luminance in standard deviations, normal as the cosine exponent,
+            // depth as the allowed relative change per pixel of tap distance.
+            f32 sigmaLuminance { 4.0f };
+            f32 sigmaNormal { 128.0f };
+            f32 sigmaDepth { 0.02f };
+
+            bool demodulateAlbedo { true };
+        };
+
+    public:
+        Denoiser(const Settings& settings);
+
+        // Filters `image` in place. Variance comes from the accumulator's per-pixel luminance moments.
+        void Apply(std::span<glm::vec4> image, const Accumulator& accumulator, const FeatureBuffer& features);
+
+        inline const Settings& GetSettings() const { return m_Settings; }
+        inline void SetSettings(const Settings& settings) { m_Settings = settings; }
+
+    private:
+        struct Planes
+        {
+            std::array<std::vector<f32>, 3> color;
+            std::vector<f32> variance;
+        };
+
+    private:
+        void Prepare(std::span<const glm::vec4> image, const Accumulator& accumulator, const FeatureBuffer& features);
+        void BlurVariance(const Planes& src);
+        void FilterRows(const Planes& src, Planes& dst, u32 step, u32 begin, u32 end) const;
+
+        inline usize Index(u32 x, u32 y) const { return static_cast<usize>(y + m_Border) * m_Stride + x + m_Border; }
+
+    private:
+        Settings m_Settings;
+
+        u32 m_Width { 0 };
+        u32 m_Height { 0 };
+        u32 m_Border { 0 };
+        usize m_Stride { 0 };
+
+        // Planar copies with a border wide enough for the largest tap, so the inner loop never bounds
+        // checks. Border pixels have a zero normal, which gives them zero weight.
+        std::array<Planes, 2> m_Planes;
+        std::vector<f32> m_BlurredVariance;
+        std::array<std::vector<f32>, 3> m_Normal;
+        std::vector<f32> m_Depth;
+        std::array<std::vector<f32>, 3> m_Albedo;
+    };
+
+}
@@ -0,0 +1,84 @@
+#include "Geometry.hpp"
+
+namespace CPU {
+
+    Geometry::Geometry(const Scene::SceneData& scene)
+    {
+        struct MeshRange
+        {
+            u32 firstVertex { std::numeric_limits<u32>::max() };
+            u32 lastVertex { 0 };
+            u32 firstObject { 0 };
+        };
+
+        std::vector<MeshRange> ranges(scene.meshes.size());
+
+        u32 objectCount = 0;
+        for (usize m = 0; m < scene.meshes.size(); ++m) {
+            auto& range = ranges[m];
+            range.firstObject = objectCount;
+
+            for (const auto& prim : scene.meshes[m].primitives) {
+                for (u32 i = 0; i < prim.indexCount; ++i) {
+                    u32 index = scene.indices[prim.indexOffset + i];
+                    range.firstVertex = std::min(range.firstVertex, index);
+                    range.lastVertex = std::max(range.lastVertex, index);
+                }
+            }
+
+            objectCount += static_cast<u32>(scene.meshes[m].primitives.size());
+        }
+
+        for (usize n = 0; n < scene.nodes.size(); ++n) {
+            const auto& node = scene.nodes[n];
+            const auto& mesh = scene.meshes[node.meshIndex];
+            const auto& range = ranges[node.meshIndex];
+
+            if (range.firstVertex > range.lastVertex) continue;
+
+            glm::mat3 linear = glm::mat3(node.transform);
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+
+            u32 base = static_cast<u32>(m_Vertices.size());
+
+            for (u32 v = range.firstVertex; v <= range.lastVertex; ++v) {
+                Scene::Vertex vertex = scene.vertices[v];
+
+                vertex.position = glm::vec3(node.transform * glm::vec4(vertex.position, 1.0f));
+                vertex.normal = glm::normalize(normalMatrix * vertex.normal);
+                vertex.tangent = glm::vec4(linear * glm::vec3(vertex.tangent), vertex.tangent.w);
+
+                m_Vertices.push_back(vertex);
+            }
+
+            for (usize p = 0; p < mesh.primitives.size(); ++p) {
+                const auto& prim = mesh.primitives[p];
+
+                for (u32 i = 0; i < prim.indexCount; ++i) {
+                    m_Indices.push_back(scene.indices[prim.indexOffset + i] - range.firstVertex + base);
+                }
+
+                for (u32 t = 0; t < prim.indexCount / 3; ++t) {
+                    m_Triangles.push_back(TriangleInfo {
+                        .material = prim.materialIndex,
+                        .instance = static_cast<u32>(n),
+                        .object = range.firstObject + static_cast<u32>(p),
+                        .primitive = t
+                    });
+                }
+            }
+        }
+
+        LOG_INFO("CPU geometry: {} triangles, {} vertices across {} instances", m_Triangles.size(), m_Vertices.size(), scene.nodes.size());
+    }
+
+    AABB Geometry::GetBounds(u32 triangle) const
+    {
+        AABB box;
+        box.Grow(GetVertex(triangle, 0).position);
+        box.Grow(GetVertex(triangle, 1).position);
+        box.Grow(GetVertex(triangle, 2).position);
+        return box;
+    }
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Math.hpp"
+#include "Scene/SceneData.hpp"
+
+namespace CPU {
+
+    class Geometry
+    {
+    public:
+        struct TriangleInfo
+        {
+            u32 material { 0 };
+            u32 instance { 0 };
+            u32 object { 0 };
+            u32 primitive { 0 };
+        };
+
+    public:
+        Geometry(const Scene::SceneData& scene);
+
+        inline u32 GetTriangleCount() const { return static_cast<u32>(m_Triangles.size()); }
+
+        inline std::span<const Scene::Vertex> GetVertices() const { return m_Vertices; }
+        inline std::span<Scene::Vertex> GetVertices() { return m_Vertices; }
+        inline std::span<const u32> GetIndices() const { return m_Indices; }
+
+        inline const TriangleInfo& GetTriangle(u32 triangle) const { return m_Triangles[triangle]; }
+        inline const Scene::Vertex& GetVertex(u32 triangle, u32 corner) const { return m_Vertices[m_Indices[triangle * 3 + corner]]; }
+
+        AABB GetBounds(u32 triangle) const;
+
+    private:
+        std::vector<Scene::Vertex> m_Vertices;
+        std::vector<u32> m_Indices;
+        std::vector<TriangleInfo> m_Triangles;
+    };
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define PATHTRACER_SSE 1
+    #include <emmintrin.h>
+#endif
+
+namespace CPU {
+
+    inline constexpr u32 INVALID_INDEX { std::numeric_limits<u32>::max() };
+
+    struct Ray
+    {
+        glm::vec3 origin { 0.0f };
+        f32 tMin { 0.0f };
+        glm::vec3 direction { 0.0f, 0.0f, -1.0f };
+        f32 tMax { std::numeric_limits<f32>::max() };
+    };
+
+    struct Hit
+    {
+        f32 t { std::numeric_limits<f32>::max() };
+        f32 u { 0.0f };
+        f32 v { 0.0f };
+        u32 primitive { INVALID_INDEX };
+
+        inline bool IsValid() const { return primitive != INVALID_INDEX; }
+    };
+
+    struct AABB
+    {
+        glm::vec3 min { std::numeric_limits<f32>::max() };
+        glm::vec3 max { -std::numeric_limits<f32>::max() };
+
+        inline void Grow(const glm::vec3& p)
+        {
+            min = glm::min(min, p);
+            max = glm::max(max, p);
+        }
+
+        inline void Grow(const AABB& other)
+        {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        inline bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+        inline glm::vec3 Extent() const { return max - min; }
+        inline glm::vec3 Centroid() const { return (min + max) * 0.5f; }
+
+        inline f32 Area() const
+        {
+            if (!IsValid()) return 0.0f;
+
+            glm::vec3 e = Extent();
+            return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+        }
+
+        inline u32 LongestAxis() const
+        {
+            glm::vec3 e = Extent();
+            if (e.x > e.y && e.x > e.z) return 0;
+            return e.y > e.z ? 1 : 2;
+        }
+    };
+
+    inline bool IntersectAABB(const Ray& ray, const glm::vec3& invDir, const AABB& box, f32 tMax, f32& tNear)
+    {
+        glm::vec3 t0 = (box.min - ray.origin) * invDir;
+        glm::vec3 t1 = (box.max - ray.origin) * invDir;
+
+        glm::vec3 tSmall = glm::min(t0, t1);
+        glm::vec3 tLarge = glm::max(t0, t1);
+
+        f32 tEnter = std::max(std::max(tSmall.x, tSmall.y), std::max(tSmall.z, ray.tMin));
+        f32 tExit = std::min(std::min(tLarge.x, tLarge.y), std::min(tLarge.z, tMax));
+
+        tNear = tEnter;
+        return tEnter <= tExit;
+    }
+
+    // Möller-Trumbore, two-sided to match VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR
+    inline bool IntersectTriangle(const Ray& ray, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, f32 tMax, f32& t, f32& u, f32& v)
+    {
+        glm::vec3 e1 = p1 - p0;
+        glm::vec3 e2 = p2 - p0;
+
+        glm::vec3 p = glm::cross(ray.direction, e2);
+        f32 det = glm::dot(e1, p);
+
+        if (std::abs(det) < 1e-12f) return false;
+
+        f32 invDet = 1.0f / det;
+
+        glm::vec3 s = ray.origin - p0;
+        u = glm::dot(s, p) * invDet;
+        if (u < 0.0f || u > 1.0f) return false;
+
+        glm::vec3 q = glm::cross(s, e1);
+        v = glm::dot(ray.direction, q) * invDet;
+        if (v < 0.0f || u + v > 1.0f) return false;
+
+        t = glm::dot(e2, q) * invDet;
+        return t > ray.tMin && t < tMax;
+    }
+
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Math.hpp"
+
+namespace CPU {
+
+    // Stateless sample sequence keyed by (pixel, sample index, dimension), so the value a pixel sees does
+    // not depend on which thread or tile order produced it. Sobol uses Burley's hash-based Owen scrambling
+    // ("Practical Hash-based Owen Scrambling", JCGT 2020) with dimensions padded in groups of four;
+    // Random hashes the key with PCG. shaders/sampler.glsl mirrors this bit for bit.
+    class SampleSequence
+    {
+    public:
+        enum class Type : u8
+        {
+            Sobol,
+            Random
+        };
+
+        inline static constexpr u32 SOBOL_DIMENSIONS { 4 };
+
+    public:
+        SampleSequence(Type type = Type::Sobol, u32 seed = 0)
+            : m_Type(type), m_Seed(seed) {}
+
+        inline f32 Get(u32 pixel, u32 sample, u32 dimension) const
+        {
+            if (m_Type == Type::Random) {
+                return ToUnitFloat(Hash(dimension + Hash(sample + Hash(pixel + Hash(m_Seed)))));
+            }
+
+            const u32 seed = Hash(pixel + Hash((dimension / SOBOL_DIMENSIONS) + Hash(m_Seed)));
+            const u32 index = NestedUniformScramble(sample, seed);
+
+            return ToUnitFloat(NestedUniformScramble(Sobol(index, dimension % SOBOL_DIMENSIONS), HashCombine(seed, dimension % SOBOL_DIMENSIONS)));
+        }
+
+        // Even dimensions keep both components inside one Sobol group, preserving their 2D stratification.
+        inline glm::vec2 Get2D(u32 pixel, u32 sample, u32 dimension) const
+        {
+            return glm::vec2(Get(pixel, sample, dimension), Get(pixel, sample, dimension + 1));
+        }
+
+        inline Type GetType() const { return m_Type; }
+        inline u32 GetSeed() const { return m_Seed; }
+
+        static inline u32 Hash(u32 x)
+        {
+            u32 state = x * 747796405u + 2891336453u;
+            u32 word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+            return (word >> 22u) ^ word;
+        }
+
+        static inline f32 ToUnitFloat(u32 x)
+        {
+            return static_cast<f32>(x >> 8) * (1.0f / 16777216.0f);
+        }
+
+    private:
+        using DirectionTable = std::array<std::array<u32, 32>, SOBOL_DIMENSIONS>;
+
+        // Joe-Kuo direction numbers; the first dimension is the van der Corput sequence.
+        static consteval DirectionTable BuildDirections()
+        {
+            struct Polynomial { u32 degree; u32 coefficients; std::array<u32, 3> m; };
+
+            constexpr std::array<Polynomial, SOBOL_DIMENSIONS - 1> polynomials {
+                Polynomial { 1, 0, { 1, 0, 0 } },
+                Polynomial { 2, 1, { 1, 3, 0 } },
+                Polynomial { 3, 1, { 1, 3, 1 } }
+            };
+
+            DirectionTable table {};
+
+            for (u32 bit = 0; bit < 32; ++bit) {
+                table[0][bit] = 1u << (31 - bit);
+            }
+
+            for (u32 d = 1; d < SOBOL_DIMENSIONS; ++d) {
+                const auto& poly = polynomials[d - 1];
+                auto& v = table[d];
+
+                for (u32 bit = 0; bit < 32; ++bit) {
+                    if (bit < poly.degree) {
+                        v[bit] = poly.m[bit] << (31 - bit);
+                        continue;
+                    }
+
+                    v[bit] = v[bit - poly.degree] ^ (v[bit - poly.degree] >> poly.degree);
+                    for (u32 k = 1; k < poly.degree; ++k) {
+                        if ((poly.coefficients >> (poly.degree - 1 - k)) & 1u) {
+                            v[bit] ^= v[bit - k];
+                        }
+                    }
+                }
+            }
+
+            return table;
+        }
+
+        static inline u32 Sobol(u32 index, u32 dimension)
+        {
+            static constexpr DirectionTable s_Directions { BuildDirections() };
+
+            u32 result = 0;
+            for (u32 bit = 0; index != 0; index >>= 1, ++bit) {
+                if (index & 1u) result ^= s_Directions[dimension][bit];
+            }
+            return result;
+        }
+
+        static inline u32 ReverseBits(u32 x)
+        {
+            x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+            x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+            x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+            x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+            return (x >> 16) | (x << 16);
+        }
+
+        static inline u32 LaineKarrasPermutation(u32 x, u32 seed)
+        {
+            x ^= x * 0x3d20adeau;
+            x += seed;
+            x *= (seed >> 16) | 1u;
+            x ^= x * 0x05526c56u;
+            x ^= x * 0x53a22864u;
+            return x;
+        }
+
+        static inline u32 NestedUniformScramble(u32 x, u32 seed)
+        {
+            return ReverseBits(LaineKarrasPermutation(ReverseBits(x), seed));
+        }
+
+        static inline u32 HashCombine(u32 seed, u32 value)
+        {
+            return seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+        }
+
+    private:
+        Type m_Type { Type::Sobol };
+        u32 m_Seed { 0 };
+    };
+
+}
@@ -0,0 +1,178 @@
+#include "Shading.hpp"
+
+namespace CPU {
+
+    namespace {
+
+        inline constexpr f32 PI { std::numbers::pi_v<f32> };
+
+        inline constexpr f32 SPECULAR_PROBABILITY_DIELECTRIC { 0.25f };
+        inline constexpr f32 SPECULAR_PROBABILITY_METAL { 0.9f };
+
+        f32 DistributionGGX(const glm::vec3& N, const glm::vec3& H, f32 roughness)
+        {
+            f32 a = roughness * roughness;
+            f32 a2 = a * a;
+            f32 NdotH = std::max(glm::dot(N, H), 0.0f);
+
+            f32 denom = NdotH * NdotH * (a2 - 1.0f) + 1.0f;
+            return a2 / (PI * denom * denom);
+        }
+
+        f32 GeometrySchlickGGX(f32 NdotV, f32 roughness)
+        {
+            f32 r = roughness + 1.0f;
+            f32 k = (r * r) / 8.0f;
+            return NdotV / (NdotV * (1.0f - k) + k);
+        }
+
+        f32 GeometrySmith(const glm::vec3& N, const glm::vec3& V, const glm::vec3& L, f32 roughness)
+        {
+            f32 NdotV = std::max(glm::dot(N, V), 0.0f);
+            f32 NdotL = std::max(glm::dot(N, L), 0.0f);
+            return GeometrySchlickGGX(NdotV, roughness) * GeometrySchlickGGX(NdotL, roughness);
+        }
+
+        glm::vec3 FresnelSchlick(f32 cosTheta, const glm::vec3& F0)
+        {
+            return F0 + (glm::vec3(1.0f) - F0) * std::pow(std::clamp(1.0f - cosTheta, 0.0f, 1.0f), 5.0f);
+        }
+
+        // Branchless orthonormal basis around N (Duff et al. 2017).
+        glm::mat3 TangentFrame(const glm::vec3& N)
+        {
+            f32 s = N.z >= 0.0f ? 1.0f : -1.0f;
+            f32 a = -1.0f / (s + N.z);
+            f32 b = N.x * N.y * a;
+
+            glm::vec3 T(1.0f + s * N.x * N.x * a, s * b, -s * N.x);
+            glm::vec3 B(b, s + N.y * N.y * a, -N.y);
+
+            return glm::mat3(T, B, N);
+        }
+
+    }
+
+    ShadingPoint EvaluateMaterial(const Scene::SceneData& scene, const Scene::MaterialData& material, const glm::vec2& uv)
+    {
+        ShadingPoint point;
+        point.albedo = EvaluateAlbedo(scene, material, uv);
+        point.metallic = material.metallicFactor;
+        point.roughness = material.roughnessFactor;
+
+        if (material.metallicRoughnessTexture >= 0) {
+            glm::vec4 mr = SampleTexture(scene, material.metallicRoughnessTexture, uv);
+            point.roughness *= mr.g;
+            point.metallic *= mr.b;
+        }
+
+        point.emissive = material.emissiveFactor;
+        if (material.emissiveTexture >= 0) {
+            point.emissive *= glm::vec3(SampleTexture(scene, material.emissiveTexture, uv));
+        }
+
+        return point;
+    }
+
+    glm::vec3 EvaluateAlbedo(const Scene::SceneData& scene, const Scene::MaterialData& material, const glm::vec2& uv)
+    {
+        glm::vec3 albedo(material.baseColorFactor);
+        if (material.baseColorTexture >= 0) {
+            albedo *= glm::pow(glm::vec3(SampleTexture(scene, material.baseColorTexture, uv)), glm::vec3(2.2f));
+        }
+
+        return albedo;
+    }
+
+    glm::vec3 EvaluateBRDF(const glm::vec3& N, const glm::vec3& V, const glm::vec3& L, const glm::vec3& albedo, f32 metallic, f32 roughness)
+    {
+        glm::vec3 H = glm::normalize(V + L);
+        glm::vec3 F0 = glm::mix(glm::vec3(0.04f), albedo, metallic);
+
+        f32 NDF = DistributionGGX(N, H, roughness);
+        f32 G = GeometrySmith(N, V, L, roughness);
+        glm::vec3 F = FresnelSchlick(std::max(glm::dot(H, V), 0.0f), F0);
+
+        f32 NdotL = std::max(glm::dot(N, L), 0.0f);
+        f32 denominator = 4.0f * std::max(glm::dot(N, V), 0.0f) * NdotL + 0.0001f;
+        glm::vec3 specular = NDF * G * F / denominator;
+
+        glm::vec3 kD = (glm::vec3(1.0f) - F) * (1.0f - metallic);
+
+        return kD * albedo / PI + specular;
+    }
+
+    glm::vec3 SampleBRDF(const glm::vec3& N, const glm::vec3& V, const glm::vec3& albedo, f32 metallic, f32 roughness, f32 uLobe, const glm::vec2& u, glm::vec3& L)
+    {
+        const f32 specularProbability = glm::mix(SPECULAR_PROBABILITY_DIELECTRIC, SPECULAR_PROBABILITY_METAL, metallic);
+        const glm::mat3 frame = TangentFrame(N);
+
+        const f32 phi = 2.0f * PI * u.y;
+
+        if (uLobe < specularProbability) {
+            f32 a = roughness * roughness;
+            f32 cosTheta = std::sqrt((1.0f - u.x) / (1.0f + (a * a - 1.0f) * u.x));
+            f32 sinTheta = std::sqrt(std::max(1.0f - cosTheta * cosTheta, 0.0f));
+
+            glm::vec3 H = frame * glm::vec3(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+            L = glm::reflect(-V, H);
+        } else {
+            f32 r = std::sqrt(u.x);
+            L = frame * glm::vec3(r * std::cos(phi), r * std::sin(phi), std::sqrt(std::max(1.0f - u.x, 0.0f)));
+        }
+
+        const f32 NdotL = glm::dot(N, L);
+        if (NdotL <= 0.0f) return glm::vec3(0.0f);
+
+        const glm::vec3 H = glm::normalize(V + L);
+        const f32 NdotH = std::max(glm::dot(N, H), 0.0f);
+        const f32 VdotH = std::max(glm::dot(V, H), 1e-4f);
+
+        const f32 pdfSpecular = DistributionGGX(N, H, roughness) * NdotH / (4.0f * VdotH);
+        const f32 pdfDiffuse = NdotL / PI;
+        const f32 pdf = glm::mix(pdfDiffuse, pdfSpecular, specularProbability);
+
+        if (pdf <= 0.0f) return glm::vec3(0.0f);
+
+        return EvaluateBRDF(N, V, L, albedo, metallic, roughness) * NdotL / pdf;
+    }
+
+    glm::vec4 SampleTexture(const Scene::SceneData& scene, i32 index, const glm::vec2& uv)
+    {
+        if (index < 0 || static_cast<usize>(index) >= scene.textures.size()) return glm::vec4(1.0f);
+
+        const auto& tex = scene.textures[index];
+        if (tex.width == 0 || tex.height == 0 || tex.channels < 3) return glm::vec4(1.0f);
+
+        const i32 width = static_cast<i32>(tex.width);
+        const i32 height = static_cast<i32>(tex.height);
+
+        auto Fetch = [&](i32 x, i32 y) {
+            x = ((x % width) + width) % width;
+            y = ((y % height) + height) % height;
+
+            const std::byte* p = tex.pixels.data() + (static_cast<usize>(y) * tex.width + x) * tex.channels;
+            return glm::vec4(
+                std::to_integer<u8>(p[0]),
+                std::to_integer<u8>(p[1]),
+                std::to_integer<u8>(p[2]),
+                tex.channels > 3 ? std::to_integer<u8>(p[3]) : 255
+            ) / 255.0f;
+        };
+
+        f32 fx = uv.x * tex.width - 0.5f;
+        f32 fy = uv.y * tex.height - 0.5f;
+
+        i32 x0 = static_cast<i32>(std::floor(fx));
+        i32 y0 = static_cast<i32>(std::floor(fy));
+
+        f32 tx = fx - x0;
+        f32 ty = fy - y0;
+
+        glm::vec4 top = glm::mix(Fetch(x0, y0), Fetch(x0 + 1, y0), tx);
+        glm::vec4 bottom = glm::mix(Fetch(x0, y0 + 1), Fetch(x0 + 1, y0 + 1), tx);
+
+        return glm::mix(top, bottom, ty);
+    }
+
+}
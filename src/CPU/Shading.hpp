@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Math.hpp"
+#include "Scene/SceneData.hpp"
+
+namespace CPU {
+
+    // Metallic-roughness inputs of one surface point, textures applied.
+    struct ShadingPoint
+    {
+        glm::vec3 albedo { 0.0f };
+        glm::vec3 emissive { 0.0f };
+        f32 metallic { 0.0f };
+        f32 roughness { 1.0f };
+    };
+
+    ShadingPoint EvaluateMaterial(const Scene::SceneData& scene, const Scene::MaterialData& material, const glm::vec2& uv);
+
+    // Base colour only, for callers that need the albedo before deciding to shade.
+    glm::vec3 EvaluateAlbedo(const Scene::SceneData& scene, const Scene::MaterialData& material, const glm::vec2& uv);
+
+    // Cook-Torrance GGX plus Lambert, the same BRDF as shaders/shading.glsl.
+    glm::vec3 EvaluateBRDF(const glm::vec3& N, const glm::vec3& V, const glm::vec3& L, const glm::vec3& albedo, f32 metallic, f32 roughness);
+
+    // Samples L from the diffuse/GGX lobe mixture and returns f * cos / pdf, or 0 below the surface.
+    // Mirrors SampleBRDF in shaders/shading.glsl.
+    glm::vec3 SampleBRDF(const glm::vec3& N, const glm::vec3& V, const glm::vec3& albedo, f32 metallic, f32 roughness, f32 uLobe, const glm::vec2& u, glm::vec3& L);
+
+    // Bilinear, wrapping lookup of an 8-bit texture; white for missing or unsupported textures.
+    glm::vec4 SampleTexture(const Scene::SceneData& scene, i32 index, const glm::vec2& uv);
+
+}
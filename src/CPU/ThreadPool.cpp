@@ -0,0 +1,108 @@
+#include "ThreadPool.hpp"
+
+namespace CPU {
+
+    namespace {
+
+        thread_local bool s_InsideLoop = false;
+
+    }
+
+    ThreadPool::ThreadPool(u32 threads)
+    {
+        u32 count = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+
+        m_Workers.reserve(count - 1);
+        for (u32 i = 1; i < count; ++i) {
+            m_Workers.emplace_back([this](std::stop_token stop) { Worker(stop); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        for (auto& worker : m_Workers) {
+            worker.request_stop();
+        }
+
+        m_Wake.notify_all();
+    }
+
+    ThreadPool& ThreadPool::Get()
+    {
+        static ThreadPool s_Pool(0);
+        return s_Pool;
+    }
+
+    void ThreadPool::ParallelFor(u32 count, u32 grain, const RangeFn& fn)
+    {
+        if (count == 0) return;
+
+        grain = std::max(1u, grain);
+
+        if (m_Workers.empty() || count <= grain || s_InsideLoop) {
+            fn(0, count);
+            return;
+        }
+
+        std::scoped_lock dispatch(m_DispatchMutex);
+
+        Job job;
+        job.fn = &fn;
+        job.count = count;
+        job.grain = grain;
+
+        {
+            std::scoped_lock lock(m_Mutex);
+            m_Job = &job;
+            m_Generation++;
+        }
+
+        m_Wake.notify_all();
+
+        s_InsideLoop = true;
+        Run(job);
+        s_InsideLoop = false;
+
+        // Workers that already picked the job up may still be inside their last chunk.
+        std::unique_lock lock(m_Mutex);
+        m_Job = nullptr;
+        m_Done.wait(lock, [this]() { return m_Busy == 0; });
+    }
+
+    void ThreadPool::Worker(std::stop_token stop)
+    {
+        s_InsideLoop = true;
+        u64 seen = 0;
+
+        while (true) {
+            std::unique_lock lock(m_Mutex);
+            if (!m_Wake.wait(lock, stop, [&]() { return m_Generation != seen; })) return;
+
+            seen = m_Generation;
+
+            Job* job = m_Job;
+            if (!job) continue;
+
+            m_Busy++;
+            lock.unlock();
+
+            Run(*job);
+
+            lock.lock();
+            if (--m_Busy == 0) {
+                m_Done.notify_all();
+            }
+        }
+    }
+
+    void ThreadPool::Run(Job& job)
+    {
+        while (true) {
+            u32 begin = job.next.fetch_add(job.grain, std::memory_order_relaxed);
+            if (begin >= job.count) return;
+
+            (*job.fn)(begin, std::min(begin + job.grain, job.count));
+        }
+    }
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+namespace CPU {
+
+    // Persistent workers for data-parallel loops. The calling thread takes part in every loop, and
+    // nested calls from inside a loop body run serially on the calling worker.
+    class ThreadPool
+    {
+    public:
+        using RangeFn = std::function<void(u32 begin, u32 end)>;
+
+    public:
+        ThreadPool(u32 threads);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void ParallelFor(u32 count, u32 grain, const RangeFn& fn);
+
+        inline u32 GetThreadCount() const { return static_cast<u32>(m_Workers.size()) + 1; }
+
+        static ThreadPool& Get();
+
+    private:
+        struct Job
+        {
+            const RangeFn* fn { nullptr };
+            u32 count { 0 };
+            u32 grain { 1 };
+            std::atomic<u32> next { 0 };
+        };
+
+    private:
+        void Worker(std::stop_token stop);
+        static void Run(Job& job);
+
+    private:
+        std::vector<std::jthread> m_Workers;
+
+        std::mutex m_DispatchMutex;
+        std::mutex m_Mutex;
+        std::condition_variable_any m_Wake;
+        std::condition_variable m_Done;
+
+        Job* m_Job { nullptr };
+        u64 m_Generation { 0 };
+        u32 m_Busy { 0 };
+    };
+
+}
@@ -0,0 +1,274 @@
+#include "TileScheduler.hpp"
+
+#if defined(_WIN32)
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace CPU {
+
+    namespace {
+
+        inline u64 PackTile(const TileScheduler::Tile& tile)
+        {
+            return static_cast<u64>(tile.x)
+                | (static_cast<u64>(tile.y) << 16)
+                | (static_cast<u64>(tile.width) << 32)
+                | (static_cast<u64>(tile.height) << 48);
+        }
+
+        inline TileScheduler::Tile UnpackTile(u64 packed)
+        {
+            return TileScheduler::Tile {
+                .x = static_cast<u32>(packed & 0xFFFF),
+                .y = static_cast<u32>((packed >> 16) & 0xFFFF),
+                .width = static_cast<u32>((packed >> 32) & 0xFFFF),
+                .height = static_cast<u32>((packed >> 48) & 0xFFFF)
+            };
+        }
+
+        inline u64 NextRandom(u64& state)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+
+        void PinCurrentThread(u32 core)
+        {
+#if defined(_WIN32)
+            SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (core % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(core, &set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) != 0) {
+                LOG_WARN("Failed to pin worker thread to core {}", core);
+            }
+#else
+            (void)core;
+#endif
+        }
+
+    }
+
+    u64 TileScheduler::Stats::GetStealCount() const
+    {
+        u64 steals = 0;
+        for (const auto& thread : threads) {
+            steals += thread.steals;
+        }
+        return steals;
+    }
+
+    f64 TileScheduler::Stats::GetAverageUtilisation() const
+    {
+        if (threads.empty()) return 0.0;
+
+        f64 sum = 0.0;
+        for (u32 i = 0; i < threads.size(); ++i) {
+            sum += GetUtilisation(i);
+        }
+        return sum / threads.size();
+    }
+
+    void TileScheduler::Stats::Merge(const Stats& other)
+    {
+        wallTime += other.wallTime;
+        threads.resize(std::max(threads.size(), other.threads.size()));
+
+        for (u32 i = 0; i < other.threads.size(); ++i) {
+            auto& thread = threads[i];
+            const auto& source = other.threads[i];
+
+            thread.tiles += source.tiles;
+            thread.pixels += source.pixels;
+            thread.steals += source.steals;
+            thread.failedSteals += source.failedSteals;
+            thread.splits += source.splits;
+            thread.busyTime += source.busyTime;
+        }
+    }
+
+    TileScheduler::TileScheduler(const Settings& settings)
+        : m_Settings(settings)
+    {
+        m_ThreadCount = m_Settings.threads > 0 ? m_Settings.threads : std::max(1u, std::thread::hardware_concurrency());
+        m_Settings.tile = std::clamp(m_Settings.tile, 1u, 0xFFFFu);
+        m_Settings.minTile = std::clamp(m_Settings.minTile, 1u, m_Settings.tile);
+    }
+
+    TileScheduler::Stats TileScheduler::Dispatch(u32 width, u32 height, const Kernel& kernel)
+    {
+        Stats stats;
+        stats.threads.resize(m_ThreadCount);
+
+        if (width == 0 || height == 0) return stats;
+
+        if (width > 0xFFFF || height > 0xFFFF) {
+            LOG_ERROR("Tile scheduler does not support images larger than 65535x65535 ({}x{})", width, height);
+            return stats;
+        }
+
+        const u32 tile = m_Settings.tile;
+
+        std::vector<Tile> tiles;
+        tiles.reserve(static_cast<usize>((width + tile - 1) / tile) * ((height + tile - 1) / tile));
+
+        for (u32 y = 0; y < height; y += tile) {
+            for (u32 x = 0; x < width; x += tile) {
+                tiles.push_back(Tile {
+                    .x = x,
+                    .y = y,
+                    .width = std::min(tile, width - x),
+                    .height = std::min(tile, height - y)
+                });
+            }
+        }
+
+        return Dispatch(tiles, kernel);
+    }
+
+    TileScheduler::Stats TileScheduler::Dispatch(std::span<const Tile> tiles, const Kernel& kernel)
+    {
+        Stats stats;
+        stats.threads.resize(m_ThreadCount);
+
+        if (tiles.empty()) return stats;
+
+        const u32 tileCount = static_cast<u32>(tiles.size());
+
+        m_Deques.clear();
+        for (u32 i = 0; i < m_ThreadCount; ++i) {
+            m_Deques.push_back(std::make_unique<WorkStealingDeque<u64>>(tileCount / m_ThreadCount + 1));
+        }
+
+        u64 pixels = 0;
+
+        // Each worker owns a contiguous run of tiles, pushed in reverse so the owner walks its run in
+        // scanline order while thieves take from the far end.
+        for (u32 t = 0; t < m_ThreadCount; ++t) {
+            u32 begin = static_cast<u32>(static_cast<u64>(tileCount) * t / m_ThreadCount);
+            u32 end = static_cast<u32>(static_cast<u64>(tileCount) * (t + 1) / m_ThreadCount);
+
+            for (u32 i = end; i > begin; --i) {
+                const Tile& tile = tiles[i - 1];
+                pixels += static_cast<u64>(tile.width) * tile.height;
+
+                m_Deques[t]->Push(PackTile(tile));
+            }
+        }
+
+        m_RemainingPixels.store(pixels, std::memory_order_release);
+
+        auto start = std::chrono::steady_clock::now();
+
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(m_ThreadCount);
+
+            for (u32 i = 0; i < m_ThreadCount; ++i) {
+                workers.emplace_back([this, i, &kernel, &stats]() {
+                    if (m_Settings.pinThreads) {
+                        PinCurrentThread(i % std::max(1u, std::thread::hardware_concurrency()));
+                    }
+
+                    Worker(i, kernel, stats.threads[i]);
+                });
+            }
+        }
+
+        std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+        stats.wallTime = elapsed.count();
+
+        return stats;
+    }
+
+    void TileScheduler::Worker(u32 index, const Kernel& kernel, ThreadStats& stats)
+    {
+        auto& deque = *m_Deques[index];
+        u64 rng = 0x9E3779B97F4A7C15ull * (index + 1);
+
+        while (m_RemainingPixels.load(std::memory_order_acquire) > 0) {
+            std::optional<u64> packed = deque.Pop();
+
+            if (!packed) {
+                packed = Steal(index, rng, stats);
+            }
+
+            if (!packed) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            Tile tile = UnpackTile(*packed);
+
+            auto start = std::chrono::steady_clock::now();
+            kernel(tile, index);
+            std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+
+            u64 pixels = static_cast<u64>(tile.width) * tile.height;
+
+            stats.busyTime += elapsed.count();
+            stats.tiles++;
+            stats.pixels += pixels;
+
+            m_RemainingPixels.fetch_sub(pixels, std::memory_order_acq_rel);
+        }
+    }
+
+    std::optional<u64> TileScheduler::Steal(u32 thief, u64& rng, ThreadStats& stats)
+    {
+        if (m_ThreadCount < 2) return std::nullopt;
+
+        for (u32 attempt = 0; attempt < m_ThreadCount * 2; ++attempt) {
+            u32 victim = static_cast<u32>(NextRandom(rng) % (m_ThreadCount - 1));
+            if (victim >= thief) victim++;
+
+            std::optional<u64> packed = m_Deques[victim]->Steal();
+            if (!packed) {
+                stats.failedSteals++;
+                continue;
+            }
+
+            stats.steals++;
+
+            // Stolen work is the oldest and therefore largest in the victim's run, so hand half of it
+            // back to our own deque where other idle threads can take it.
+            Tile tile = UnpackTile(*packed);
+            const u32 minTile = m_Settings.minTile;
+
+            if (tile.width >= tile.height && tile.width >= minTile * 2) {
+                u32 half = tile.width / 2;
+                m_Deques[thief]->Push(PackTile(Tile { tile.x + half, tile.y, tile.width - half, tile.height }));
+                tile.width = half;
+                stats.splits++;
+            } else if (tile.height >= minTile * 2) {
+                u32 half = tile.height / 2;
+                m_Deques[thief]->Push(PackTile(Tile { tile.x, tile.y + half, tile.width, tile.height - half }));
+                tile.height = half;
+                stats.splits++;
+            }
+
+            return PackTile(tile);
+        }
+
+        return std::nullopt;
+    }
+
+    void TileScheduler::LogStats(const Stats& stats)
+    {
+        LOG_INFO("Tile scheduler: {:.2f} ms wall, {} threads, {} steals, {:.1f}% average utilisation",
+            stats.wallTime * 1000.0, stats.threads.size(), stats.GetStealCount(), stats.GetAverageUtilisation() * 100.0);
+
+        for (u32 i = 0; i < stats.threads.size(); ++i) {
+            const auto& thread = stats.threads[i];
+            LOG_INFO(" - thread {:>2}: {:>5} tiles, {:>8} pixels, {:>4} steals ({} failed), {:>4} splits, {:5.1f}% busy",
+                i, thread.tiles, thread.pixels, thread.steals, thread.failedSteals, thread.splits, stats.GetUtilisation(i) * 100.0);
+        }
+    }
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "WorkStealingDeque.hpp"
+
+namespace CPU {
+
+    class TileScheduler
+    {
+    public:
+        struct Settings
+        {
+            u32 threads { 0 };
+            u32 tile { 64 };
+            u32 minTile { 8 };
+            bool pinThreads { false };
+        };
+
+        struct Tile
+        {
+            u32 x { 0 };
+            u32 y { 0 };
+            u32 width { 0 };
+            u32 height { 0 };
+        };
+
+        struct alignas(64) ThreadStats
+        {
+            u64 tiles { 0 };
+            u64 pixels { 0 };
+            u64 steals { 0 };
+            u64 failedSteals { 0 };
+            u64 splits { 0 };
+            f64 busyTime { 0.0 };
+        };
+
+        struct Stats
+        {
+            f64 wallTime { 0.0 };
+            std::vector<ThreadStats> threads;
+
+            inline f64 GetUtilisation(u32 thread) const { return wallTime > 0.0 ? threads[thread].busyTime / wallTime : 0.0; }
+
+            u64 GetStealCount() const;
+            f64 GetAverageUtilisation() const;
+
+            void Merge(const Stats& other);
+        };
+
+        using Kernel = std::function<void(const Tile& tile, u32 thread)>;
+
+    public:
+        TileScheduler(const Settings& settings);
+
+        Stats Dispatch(u32 width, u32 height, const Kernel& kernel);
+        Stats Dispatch(std::span<const Tile> tiles, const Kernel& kernel);
+
+        inline u32 GetThreadCount() const { return m_ThreadCount; }
+        inline u32 GetTileSize() const { return m_Settings.tile; }
+
+        static void LogStats(const Stats& stats);
+
+    private:
+        void Worker(u32 index, const Kernel& kernel, ThreadStats& stats);
+        std::optional<u64> Steal(u32 thief, u64& rng, ThreadStats& stats);
+
+    private:
+        Settings m_Settings;
+        u32 m_ThreadCount { 1 };
+
+        std::vector<std::unique_ptr<WorkStealingDeque<u64>>> m_Deques;
+        std::atomic<u64> m_RemainingPixels { 0 };
+    };
+
+}
@@ -0,0 +1,292 @@
+#include "Tracer.hpp"
+
+namespace CPU {
+
+    namespace {
+
+        inline constexpr u32 DIMENSION_PIXEL { 0 };
+
+        // Length of the mean first-hit normal below which a pixel is treated as covering several surfaces.
+        inline constexpr f32 MIN_FEATURE_AGREEMENT { 0.95f };
+
+    }
+
+    Tracer::Tracer(const std::shared_ptr<Scene::SceneData>& scene, const Renderer::Settings& settings, const Options& options)
+        : m_Scene(scene), m_Options(options), m_Sequence(settings.sobol ? SampleSequence::Type::Sobol : SampleSequence::Type::Random, settings.seed),
+          m_Samples(std::max(1u, settings.samples))
+    {
+        m_Geometry = std::make_shared<Geometry>(*m_Scene);
+        m_BVH = std::make_unique<BVH>(m_Geometry, BVH::BuildSettings {});
+
+        m_Scheduler = std::make_unique<TileScheduler>(TileScheduler::Settings {
+            .threads = options.threads,
+            .tile = settings.tile,
+            .minTile = std::max(1u, settings.tile / 8),
+            .pinThreads = options.pinThreads
+        });
+
+        Resize(settings.width, settings.height);
+    }
+
+    void Tracer::Resize(u32 width, u32 height)
+    {
+        m_Width = width;
+        m_Height = height;
+        m_Image.assign(static_cast<usize>(width) * height, glm::vec4(0.0f));
+        m_Accumulator.Resize(width, height);
+        m_FeatureSums.assign(static_cast<usize>(width) * height, FeatureSum {});
+    }
+
+    TileScheduler::Stats Tracer::Render(const Scene::CameraData& camera)
+    {
+        Reset();
+
+        TileScheduler::Stats stats;
+        while (!IsComplete()) {
+            stats.Merge(Continue(camera, m_Samples));
+        }
+
+        return stats;
+    }
+
+    TileScheduler::Stats Tracer::Continue(const Scene::CameraData& camera, u32 samples)
+    {
+        samples = std::max(1u, samples);
+
+        TileScheduler::Stats stats;
+
+        if (!m_Options.adaptive) {
+            auto active = GetActiveTiles();
+            if (!active.empty()) stats = RenderPass(camera, active, samples);
+
+            m_Accumulator.Resolve(m_Image);
+            return stats;
+        }
+
+        // Every pixel first gets the minimum sample count, then tiles above the error threshold receive
+        // batchSamples more per pass.
+        const u32 initial = GetInitialSamples();
+
+        std::vector<TileScheduler::Tile> warmup;
+        std::vector<TileScheduler::Tile> refine;
+
+        for (const auto& tile : GetActiveTiles()) {
+            if (m_Accumulator.GetMinCount(tile) < initial) warmup.push_back(tile);
+            else refine.push_back(tile);
+        }
+
+        if (!warmup.empty()) {
+            stats.Merge(RenderPass(camera, warmup, std::min(samples, initial)));
+        }
+
+        if (!refine.empty()) {
+            stats.Merge(RenderPass(camera, refine, std::min(samples, std::max(1u, m_Options.batchSamples))));
+        }
+
+        m_Accumulator.Resolve(m_Image);
+        return stats;
+    }
+
+    TileScheduler::Stats Tracer::RenderTile(const Scene::CameraData& camera, const TileScheduler::Tile& tile, std::span<glm::vec3> radiance)
+    {
+        m_Accumulator.Reset(tile);
+        for (u32 y = tile.y; y < tile.y + tile.height; ++y) {
+            auto row = m_FeatureSums.begin() + static_cast<usize>(y) * m_Width + tile.x;
+            std::fill(row, row + tile.width, FeatureSum {});
+        }
+
+        auto stats = RenderPass(camera, SplitTiles(tile), m_Samples);
+        m_Accumulator.Resolve(tile, radiance);
+
+        return stats;
+    }
+
+    void Tracer::Reset()
+    {
+        m_Accumulator.Reset();
+        std::fill(m_FeatureSums.begin(), m_FeatureSums.end(), FeatureSum {});
+    }
+
+    const FeatureBuffer& Tracer::ResolveFeatures()
+    {
+        if (m_Features.width != m_Width || m_Features.height != m_Height) {
+            m_Features.Resize(m_Width, m_Height);
+        }
+
+        for (usize i = 0; i < m_FeatureSums.size(); ++i) {
+            const FeatureSum& sum = m_FeatureSums[i];
+
+            // Pixels whose samples did not all land on one surface (silhouettes against the background, or
+            // between surfaces facing different ways) mix signals the features cannot describe, so they are
+            // reported as misses and left unfiltered.
+            const f32 agreement = sum.hits > 0 ? glm::length(sum.normal) / static_cast<f32>(sum.hits) : 0.0f;
+
+            if (sum.hits > 0 && sum.hits == sum.samples && agreement >= MIN_FEATURE_AGREEMENT) {
+                m_Features.albedo[i] = sum.albedo / static_cast<f32>(sum.hits);
+                m_Features.normal[i] = glm::normalize(sum.normal);
+                m_Features.depth[i] = sum.depth / static_cast<f32>(sum.hits);
+            } else {
+                m_Features.albedo[i] = glm::vec3(0.0f);
+                m_Features.normal[i] = glm::vec3(0.0f);
+                m_Features.depth[i] = 0.0f;
+            }
+        }
+
+        return m_Features;
+    }
+
+    std::vector<TileScheduler::Tile> Tracer::SplitTiles(const TileScheduler::Tile& region) const
+    {
+        const u32 tileSize = m_Scheduler->GetTileSize();
+
+        std::vector<TileScheduler::Tile> tiles;
+        for (u32 y = region.y; y < region.y + region.height; y += tileSize) {
+            for (u32 x = region.x; x < region.x + region.width; x += tileSize) {
+                tiles.push_back(TileScheduler::Tile {
+                    .x = x,
+                    .y = y,
+                    .width = std::min(tileSize, region.x + region.width - x),
+                    .height = std::min(tileSize, region.y + region.height - y)
+                });
+            }
+        }
+
+        return tiles;
+    }
+
+    bool Tracer::IsComplete() const
+    {
+        return GetActiveTiles().empty();
+    }
+
+    u32 Tracer::GetInitialSamples() const
+    {
+        return std::min(std::max(m_Options.minSamples, 2u), m_Samples);
+    }
+
+    std::vector<TileScheduler::Tile> Tracer::GetActiveTiles() const
+    {
+        const u32 tileSize = m_Scheduler->GetTileSize();
+        const u32 initial = GetInitialSamples();
+
+        std::vector<TileScheduler::Tile> tiles;
+        for (u32 y = 0; y < m_Height; y += tileSize) {
+            for (u32 x = 0; x < m_Width; x += tileSize) {
+                TileScheduler::Tile tile {
+                    .x = x,
+                    .y = y,
+                    .width = std::min(tileSize, m_Width - x),
+                    .height = std::min(tileSize, m_Height - y)
+                };
+
+                const u32 count = m_Accumulator.GetMinCount(tile);
+                if (count >= m_Samples) continue;
+
+                if (m_Options.adaptive && count >= initial && m_Accumulator.EstimateError(tile) <= m_Options.errorThreshold) continue;
+
+                tiles.push_back(tile);
+            }
+        }
+
+        return tiles;
+    }
+
+    TileScheduler::Stats Tracer::RenderPass(const Scene::CameraData& camera, std::span<const TileScheduler::Tile> tiles, u32 samples)
+    {
+        return m_Scheduler->Dispatch(tiles, [&](const TileScheduler::Tile& tile, u32) {
+            for (u32 y = tile.y; y < tile.y + tile.height; ++y) {
+                for (u32 x = tile.x; x < tile.x + tile.width; ++x) {
+                    const u32 first = m_Accumulator.GetCount(x, y);
+                    const u32 last = std::min(first + samples, m_Samples);
+
+                    for (u32 s = first; s < last; ++s) {
+                        m_Accumulator.Add(x, y, TracePixel(camera, x, y, s, m_FeatureSums[static_cast<usize>(y) * m_Width + x]));
+                    }
+                }
+            }
+        });
+    }
+
+    Ray Tracer::GenerateRay(const Scene::CameraData& camera, u32 x, u32 y, u32 sample) const
+    {
+        glm::vec2 jitter(0.5f);
+        if (m_Samples > 1) {
+            jitter = m_Sequence.Get2D(y * m_Width + x, sample, DIMENSION_PIXEL);
+        }
+
+        const glm::vec2 pixel = glm::vec2(static_cast<f32>(x), static_cast<f32>(y)) + jitter;
+        const glm::vec2 screenPos = pixel / glm::vec2(static_cast<f32>(m_Width), static_cast<f32>(m_Height)) * 2.0f - 1.0f;
+
+        glm::vec4 target = camera.inverseProj * glm::vec4(screenPos.x, screenPos.y, 1.0f, 1.0f);
+
+        Ray ray;
+        ray.origin = glm::vec3(camera.position);
+        ray.direction = glm::normalize(glm::vec3(camera.inverseView * glm::vec4(glm::normalize(glm::vec3(target)), 0.0f)));
+        ray.tMin = camera.params[2];
+        ray.tMax = camera.params[3];
+
+        return ray;
+    }
+
+    glm::vec3 Tracer::TracePixel(const Scene::CameraData& camera, u32 x, u32 y, u32 sample, FeatureSum& features) const
+    {
+        const Ray ray = GenerateRay(camera, x, y, sample);
+
+        features.samples++;
+
+        Hit hit;
+        if (!m_BVH->Intersect(ray, hit)) {
+            return Miss(ray);
+        }
+
+        const Surface surface = GetSurface(hit);
+
+        // Features come from the very samples that make up the pixel, so dividing the radiance by this
+        // albedo is consistent even where a texture varies inside the pixel footprint.
+        features.albedo += surface.shading.albedo;
+        features.normal += surface.normal;
+        features.depth += hit.t;
+        features.hits++;
+
+        return Shade(ray, surface);
+    }
+
+    Tracer::Surface Tracer::GetSurface(const Hit& hit) const
+    {
+        const auto& tri = m_Geometry->GetTriangle(hit.primitive);
+        const auto& v0 = m_Geometry->GetVertex(hit.primitive, 0);
+        const auto& v1 = m_Geometry->GetVertex(hit.primitive, 1);
+        const auto& v2 = m_Geometry->GetVertex(hit.primitive, 2);
+
+        const glm::vec3 barycentric(1.0f - hit.u - hit.v, hit.u, hit.v);
+
+        Surface surface;
+        surface.normal = glm::normalize(v0.normal * barycentric.x + v1.normal * barycentric.y + v2.normal * barycentric.z);
+        surface.uv = v0.uv0 * barycentric.x + v1.uv0 * barycentric.y + v2.uv0 * barycentric.z;
+        surface.shading = EvaluateMaterial(*m_Scene, m_Scene->materials[tri.material], surface.uv);
+
+        return surface;
+    }
+
+    glm::vec3 Tracer::Shade(const Ray& ray, const Surface& surface) const
+    {
+        const ShadingPoint& point = surface.shading;
+
+        glm::vec3 V = -ray.direction;
+        glm::vec3 L = glm::normalize(glm::vec3(0.5f, 1.0f, 0.2f));
+
+        glm::vec3 lightColor(3.0f);
+
+        f32 NdotL = std::max(glm::dot(surface.normal, L), 0.0f);
+        glm::vec3 Lo = EvaluateBRDF(surface.normal, V, L, point.albedo, point.metallic, point.roughness) * lightColor * NdotL;
+
+        return Lo + point.emissive;
+    }
+
+    glm::vec3 Tracer::Miss(const Ray& ray) const
+    {
+        f32 t = 0.5f * (ray.direction.y + 1.0f);
+        return (1.0f - t) * glm::vec3(1.0f) + t * glm::vec3(0.5f, 0.7f, 1.0f);
+    }
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "BVH.hpp"
+#include "TileScheduler.hpp"
+#include "Accumulator.hpp"
+#include "SampleSequence.hpp"
+#include "Denoiser.hpp"
+#include "Shading.hpp"
+
+#include "Renderer/Renderer.hpp"
+#include "Scene/Camera.hpp"
+#include "Scene/SceneData.hpp"
+
+namespace CPU {
+
+    class Tracer
+    {
+    public:
+        struct Options
+        {
+            u32 threads { 0 };
+            bool pinThreads { false };
+
+            // Adaptive sampling: every pixel gets minSamples, then tiles whose mean relative error is
+            // above errorThreshold receive batchSamples more per pass until Settings::samples is reached.
+            bool adaptive { false };
+            f32 errorThreshold { 0.01f };
+            u32 minSamples { 4 };
+            u32 batchSamples { 4 };
+        };
+
+        // Running per-pixel sums behind ResolveFeatures; part of the progressive state a checkpoint keeps.
+        struct FeatureSum
+        {
+            glm::vec3 albedo { 0.0f };
+            f32 depth { 0.0f };
+            glm::vec3 normal { 0.0f };
+            u32 hits { 0 };
+            u32 samples { 0 };
+        };
+
+    public:
+        Tracer(const std::shared_ptr<Scene::SceneData>& scene, const Renderer::Settings& settings, const Options& options);
+
+        TileScheduler::Stats Render(const Scene::CameraData& camera);
+
+        // Progressive rendering: adds up to `samples` per pixel (one adaptive round when adaptive) to the
+        // current accumulation without resetting it, then resolves the image.
+        TileScheduler::Stats Continue(const Scene::CameraData& camera, u32 samples);
+        bool IsComplete() const;
+        void Reset();
+
+        // Renders one tile from scratch with the full sample count and returns its mean radiance, packed
+        // row by row. Used by distributed workers that only ever see part of a frame.
+        TileScheduler::Stats RenderTile(const Scene::CameraData& camera, const TileScheduler::Tile& tile, std::span<glm::vec3> radiance);
+
+        // First-hit albedo, normal and depth for the denoiser, averaged over the camera rays accumulated
+        // so far. Gathered while rendering, so this costs no extra rays.
+        const FeatureBuffer& ResolveFeatures();
+
+        void Resize(u32 width, u32 height);
+
+        inline u32 GetWidth() const { return m_Width; }
+        inline u32 GetHeight() const { return m_Height; }
+        inline std::span<const glm::vec4> GetImage() const { return m_Image; }
+        inline const Accumulator& GetAccumulator() const { return m_Accumulator; }
+        inline Accumulator& GetAccumulator() { return m_Accumulator; }
+        inline const FeatureBuffer& GetFeatures() const { return m_Features; }
+        inline std::span<const FeatureSum> GetFeatureSums() const { return m_FeatureSums; }
+        inline std::span<FeatureSum> GetFeatureSums() { return m_FeatureSums; }
+
+        inline u32 GetSampleCount() const { return m_Samples; }
+        inline void SetSampleCount(u32 samples) { m_Samples = std::max(1u, samples); }
+
+        inline const SampleSequence& GetSampleSequence() const { return m_Sequence; }
+        inline void SetSampleSequence(const SampleSequence& sequence) { m_Sequence = sequence; }
+
+        inline const Options& GetOptions() const { return m_Options; }
+        inline void SetAdaptive(bool enabled, f32 errorThreshold) { m_Options.adaptive = enabled; m_Options.errorThreshold = errorThreshold; }
+
+        inline const std::shared_ptr<Scene::SceneData>& GetScene() const { return m_Scene; }
+        inline const BVH& GetBVH() const { return *m_BVH; }
+        inline TileScheduler& GetScheduler() { return *m_Scheduler; }
+
+    private:
+        struct Surface
+        {
+            glm::vec3 normal { 0.0f };
+            glm::vec2 uv { 0.0f };
+            ShadingPoint shading;
+        };
+
+    private:
+        std::vector<TileScheduler::Tile> GetActiveTiles() const;
+        std::vector<TileScheduler::Tile> SplitTiles(const TileScheduler::Tile& region) const;
+        u32 GetInitialSamples() const;
+
+        TileScheduler::Stats RenderPass(const Scene::CameraData& camera, std::span<const TileScheduler::Tile> tiles, u32 samples);
+
+        Ray GenerateRay(const Scene::CameraData& camera, u32 x, u32 y, u32 sample) const;
+        glm::vec3 TracePixel(const Scene::CameraData& camera, u32 x, u32 y, u32 sample, FeatureSum& features) const;
+
+        Surface GetSurface(const Hit& hit) const;
+
+        glm::vec3 Shade(const Ray& ray, const Surface& surface) const;
+        glm::vec3 Miss(const Ray& ray) const;
+
+    private:
+        std::shared_ptr<Scene::SceneData> m_Scene;
+        std::shared_ptr<Geometry> m_Geometry;
+        std::unique_ptr<BVH> m_BVH;
+        std::unique_ptr<TileScheduler> m_Scheduler;
+        Options m_Options;
+        SampleSequence m_Sequence;
+
+        u32 m_Width { 0 };
+        u32 m_Height { 0 };
+        u32 m_Samples { 1 };
+
+        Accumulator m_Accumulator;
+        std::vector<FeatureSum> m_FeatureSums;
+        FeatureBuffer m_Features;
+        std::vector<glm::vec4> m_Image;
+    };
+
+}
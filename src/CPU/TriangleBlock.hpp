@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Math.hpp"
+
+namespace CPU {
+
+    // Four triangles in SoA form with precomputed edges, so a leaf test touches 160 contiguous bytes
+    // instead of chasing indices into 48 byte vertices. Unused lanes are degenerate and never hit.
+    struct alignas(16) TriangleBlock
+    {
+        inline static constexpr u32 WIDTH { 4 };
+
+        std::array<f32, WIDTH> v0x { 0.0f };
+        std::array<f32, WIDTH> v0y { 0.0f };
+        std::array<f32, WIDTH> v0z { 0.0f };
+        std::array<f32, WIDTH> e1x { 0.0f };
+        std::array<f32, WIDTH> e1y { 0.0f };
+        std::array<f32, WIDTH> e1z { 0.0f };
+        std::array<f32, WIDTH> e2x { 0.0f };
+        std::array<f32, WIDTH> e2y { 0.0f };
+        std::array<f32, WIDTH> e2z { 0.0f };
+        std::array<u32, WIDTH> primitive { INVALID_INDEX, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX };
+
+        inline void Set(u32 lane, u32 prim, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+        {
+            glm::vec3 e1 = p1 - p0;
+            glm::vec3 e2 = p2 - p0;
+
+            v0x[lane] = p0.x; v0y[lane] = p0.y; v0z[lane] = p0.z;
+            e1x[lane] = e1.x; e1y[lane] = e1.y; e1z[lane] = e1.z;
+            e2x[lane] = e2.x; e2y[lane] = e2.y; e2z[lane] = e2.z;
+            primitive[lane] = prim;
+        }
+    };
+
+    static_assert(sizeof(TriangleBlock) == 160);
+
+    // Möller-Trumbore against all four lanes. Returns a bitmask of lanes hit within (tMin, tMax) and
+    // writes their t/u/v.
+    inline u32 IntersectTriangleBlock(const Ray& ray, const TriangleBlock& block, f32 tMax, std::array<f32, TriangleBlock::WIDTH>& t, std::array<f32, TriangleBlock::WIDTH>& u, std::array<f32, TriangleBlock::WIDTH>& v)
+    {
+#if defined(PATHTRACER_SSE)
+        const __m128 dx = _mm_set1_ps(ray.direction.x);
+        const __m128 dy = _mm_set1_ps(ray.direction.y);
+        const __m128 dz = _mm_set1_ps(ray.direction.z);
+
+        const __m128 e1x = _mm_load_ps(block.e1x.data());
+        const __m128 e1y = _mm_load_ps(block.e1y.data());
+        const __m128 e1z = _mm_load_ps(block.e1z.data());
+        const __m128 e2x = _mm_load_ps(block.e2x.data());
+        const __m128 e2y = _mm_load_ps(block.e2y.data());
+        const __m128 e2z = _mm_load_ps(block.e2z.data());
+
+        // p = cross(d, e2)
+        const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(e2y, dz));
+        const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(e2z, dx));
+        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(e2x, dy));
+
+        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        const __m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+        const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+        const __m128 sx = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_load_ps(block.v0x.data()));
+        const __m128 sy = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_load_ps(block.v0y.data()));
+        const __m128 sz = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_load_ps(block.v0z.data()));
+
+        const __m128 uu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+
+        // q = cross(s, e1)
+        const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(e1y, sz));
+        const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(e1z, sx));
+        const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(e1x, sy));
+
+        const __m128 vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+        const __m128 tt = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        __m128 mask = _mm_cmpge_ps(absDet, _mm_set1_ps(1e-12f));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(uu, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(uu, one));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(vv, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(uu, vv), one));
+        mask = _mm_and_ps(mask, _mm_cmpgt_ps(tt, _mm_set1_ps(ray.tMin)));
+        mask = _mm_and_ps(mask, _mm_cmplt_ps(tt, _mm_set1_ps(tMax)));
+
+        _mm_storeu_ps(t.data(), tt);
+        _mm_storeu_ps(u.data(), uu);
+        _mm_storeu_ps(v.data(), vv);
+
+        return static_cast<u32>(_mm_movemask_ps(mask));
+#else
+        u32 mask = 0;
+        for (u32 lane = 0; lane < TriangleBlock::WIDTH; ++lane) {
+            glm::vec3 p0(block.v0x[lane], block.v0y[lane], block.v0z[lane]);
+            glm::vec3 p1 = p0 + glm::vec3(block.e1x[lane], block.e1y[lane], block.e1z[lane]);
+            glm::vec3 p2 = p0 + glm::vec3(block.e2x[lane], block.e2y[lane], block.e2z[lane]);
+
+            if (IntersectTriangle(ray, p0, p1, p2, tMax, t[lane], u[lane], v[lane])) {
+                mask |= 1u << lane;
+            }
+        }
+        return mask;
+#endif
+    }
+
+}
@@ -0,0 +1,646 @@
+#include "WavefrontIntegrator.hpp"
+#include "Shading.hpp"
+
+namespace CPU {
+
+    namespace {
+
+        // Same dimension layout as shaders/common.glsl, so both integrators consume the sequence alike.
+        inline constexpr u32 DIMENSION_PIXEL { 0 };
+        inline constexpr u32 DIMENSION_LIGHT_POINT { 2 };
+        inline constexpr u32 DIMENSION_LIGHT_SELECT { 4 };
+        inline constexpr u32 DIMENSION_BSDF_LOBE { 5 };
+        inline constexpr u32 DIMENSION_BSDF_DIRECTION { 6 };
+        inline constexpr u32 DIMENSION_ROULETTE { 8 };
+        inline constexpr u32 DIMENSIONS_PER_BOUNCE { 8 };
+
+        inline constexpr u32 ROULETTE_MIN_DEPTH { 3 };
+        inline constexpr f32 ROULETTE_MAX_SURVIVAL { 0.95f };
+
+        inline constexpr f32 MIN_ROUGHNESS { 0.045f };
+        inline constexpr f32 BOUNCE_EPSILON { 1e-3f };
+
+        inline constexpr f32 SUN_INTENSITY { 3.0f };
+        const glm::vec3 SUN_DIRECTION { glm::normalize(glm::vec3(0.5f, 1.0f, 0.2f)) };
+
+        inline constexpr u32 RAY_GRAIN { 256 };
+        inline constexpr u32 PIXEL_GRAIN { 64 };
+
+        // Shading works on blocks small enough to stage their outputs on the stack before reserving
+        // queue space with one atomic per block.
+        inline constexpr u32 SHADE_BLOCK { 256 };
+
+        // Entries per material histogram; larger blocks mean fewer histograms to prefix-sum.
+        inline constexpr u32 SORT_BLOCK { 4096 };
+
+        inline u32 Dimension(u32 dimension, u32 depth)
+        {
+            return dimension + depth * DIMENSIONS_PER_BOUNCE;
+        }
+
+        inline f32 MaxComponent(const glm::vec3& v)
+        {
+            return std::max(v.x, std::max(v.y, v.z));
+        }
+
+        inline f64 SecondsSince(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        template <typename T>
+        usize GetVectorMemory(const std::vector<T>& vector)
+        {
+            return vector.capacity() * sizeof(T);
+        }
+
+    }
+
+    void WavefrontIntegrator::RayQueue::Resize(u32 capacity)
+    {
+        origins.resize(capacity);
+        directions.resize(capacity);
+        tMins.resize(capacity);
+        paths.resize(capacity);
+        hits.resize(capacity);
+        count = 0;
+    }
+
+    usize WavefrontIntegrator::RayQueue::GetMemoryUsage() const
+    {
+        return GetVectorMemory(origins) + GetVectorMemory(directions) + GetVectorMemory(tMins) + GetVectorMemory(paths) + GetVectorMemory(hits);
+    }
+
+    void WavefrontIntegrator::ShadowQueue::Resize(u32 capacity)
+    {
+        origins.resize(capacity);
+        directions.resize(capacity);
+        tMaxs.resize(capacity);
+        contributions.resize(capacity);
+        paths.resize(capacity);
+        count = 0;
+    }
+
+    usize WavefrontIntegrator::ShadowQueue::GetMemoryUsage() const
+    {
+        return GetVectorMemory(origins) + GetVectorMemory(directions) + GetVectorMemory(tMaxs) + GetVectorMemory(contributions) + GetVectorMemory(paths);
+    }
+
+    WavefrontIntegrator::WavefrontIntegrator(const std::shared_ptr<Scene::SceneData>& scene, const Settings& settings)
+        : m_Scene(scene), m_Settings(settings)
+    {
+        m_Settings.samples = std::max(1u, m_Settings.samples);
+        m_Settings.maxDepth = std::max(1u, m_Settings.maxDepth);
+
+        m_Geometry = std::make_shared<Geometry>(*m_Scene);
+        m_BVH = std::make_unique<BVH>(m_Geometry, BVH::BuildSettings {});
+        m_Lights = Scene::LightTable::Build(*m_Scene);
+        if (m_Settings.lightTree) m_LightTree = Scene::LightTree::Build(m_Lights);
+
+        if (m_Settings.threads > 0) {
+            m_Pool = std::make_unique<ThreadPool>(m_Settings.threads);
+        }
+
+        Resize(m_Settings.width, m_Settings.height);
+    }
+
+    void WavefrontIntegrator::Resize(u32 width, u32 height)
+    {
+        m_Settings.width = width;
+        m_Settings.height = height;
+
+        const u32 pixels = m_Settings.width * m_Settings.height;
+        const u32 capacity = std::max(1u, std::min(m_Settings.wavefrontSize, pixels));
+
+        m_Throughput.assign(capacity, glm::vec3(0.0f));
+        m_Radiance.assign(capacity, glm::vec3(0.0f));
+
+        for (auto& queue : m_RayQueues) {
+            queue.Resize(capacity);
+        }
+        m_ShadowQueue.Resize(capacity);
+
+        m_ShadeOrder.assign(capacity, 0);
+
+        m_Sums.assign(pixels, glm::vec3(0.0f));
+        m_Image.assign(pixels, glm::vec4(0.0f));
+    }
+
+    usize WavefrontIntegrator::GetQueueMemoryUsage() const
+    {
+        return GetVectorMemory(m_Throughput) + GetVectorMemory(m_Radiance)
+            + m_RayQueues[0].GetMemoryUsage() + m_RayQueues[1].GetMemoryUsage() + m_ShadowQueue.GetMemoryUsage()
+            + GetVectorMemory(m_ShadeOrder) + GetVectorMemory(m_Histograms);
+    }
+
+    WavefrontIntegrator::Stats WavefrontIntegrator::Render(const Scene::CameraData& camera)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        const u32 pixels = m_Settings.width * m_Settings.height;
+        const u64 total = static_cast<u64>(pixels) * m_Settings.samples;
+        const u32 capacity = static_cast<u32>(m_Throughput.size());
+
+        Stats stats;
+        stats.paths = total;
+
+        std::ranges::fill(m_Sums, glm::vec3(0.0f));
+
+        // Batches run sample by sample over the image, so each pixel's samples are summed in order.
+        for (u64 first = 0; first < total; first += capacity) {
+            const u32 count = static_cast<u32>(std::min<u64>(capacity, total - first));
+
+            auto stage = std::chrono::steady_clock::now();
+            Generate(camera, first, count);
+            stats.generateTime += SecondsSince(stage);
+
+            for (u32 depth = 0; depth < m_Settings.maxDepth; ++depth) {
+                RayQueue& current = m_RayQueues[depth & 1];
+                RayQueue& next = m_RayQueues[(depth + 1) & 1];
+
+                if (current.count == 0) break;
+
+                stats.extensionRays += current.count;
+
+                stage = std::chrono::steady_clock::now();
+                Extend(current, camera.params[3]);
+                stats.extendTime += SecondsSince(stage);
+
+                if (m_Settings.sortByMaterial) {
+                    stage = std::chrono::steady_clock::now();
+                    SortByMaterial(current);
+                    stats.sortTime += SecondsSince(stage);
+                }
+
+                stage = std::chrono::steady_clock::now();
+                Shade(current, next, first, depth);
+                stats.shadeTime += SecondsSince(stage);
+
+                stats.shadowRays += m_ShadowQueue.count;
+
+                stage = std::chrono::steady_clock::now();
+                Connect();
+                stats.connectTime += SecondsSince(stage);
+            }
+
+            Resolve(first, count);
+        }
+
+        const f32 scale = 1.0f / static_cast<f32>(m_Settings.samples);
+        ParallelFor(pixels, PIXEL_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i) {
+                m_Image[i] = glm::vec4(m_Sums[i] * scale, 1.0f);
+            }
+        });
+
+        stats.wallTime = SecondsSince(start);
+        return stats;
+    }
+
+    WavefrontIntegrator::Stats WavefrontIntegrator::RenderPerPixel(const Scene::CameraData& camera)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        const u32 pixels = m_Settings.width * m_Settings.height;
+        const f32 scale = 1.0f / static_cast<f32>(m_Settings.samples);
+
+        std::atomic<u64> extensionRays { 0 };
+        std::atomic<u64> shadowRays { 0 };
+
+        ParallelFor(pixels, PIXEL_GRAIN, [&](u32 begin, u32 end) {
+            u64 extensions = 0;
+            u64 shadows = 0;
+
+            for (u32 pixel = begin; pixel < end; ++pixel) {
+                glm::vec3 sum(0.0f);
+
+                for (u32 sample = 0; sample < m_Settings.samples; ++sample) {
+                    Ray ray = GenerateRay(camera, pixel, sample);
+
+                    glm::vec3 throughput(1.0f);
+                    glm::vec3 radiance(0.0f);
+
+                    for (u32 depth = 0; depth < m_Settings.maxDepth; ++depth) {
+                        extensions++;
+
+                        Hit hit;
+                        if (!m_BVH->Intersect(ray, hit)) {
+                            radiance += throughput * Miss(ray.direction);
+                            break;
+                        }
+
+                        const Interaction interaction = ShadeHit(ray, hit, throughput, pixel, sample, depth);
+                        radiance += interaction.emitted;
+
+                        if (interaction.connect) {
+                            shadows++;
+                            if (!m_BVH->Occluded(interaction.shadow)) radiance += interaction.shadowContribution;
+                        }
+
+                        if (!interaction.extend) break;
+
+                        ray = interaction.next;
+                        ray.tMax = camera.params[3];
+                        throughput = interaction.throughput;
+                    }
+
+                    sum += radiance;
+                }
+
+                m_Sums[pixel] = sum;
+                m_Image[pixel] = glm::vec4(sum * scale, 1.0f);
+            }
+
+            extensionRays.fetch_add(extensions, std::memory_order_relaxed);
+            shadowRays.fetch_add(shadows, std::memory_order_relaxed);
+        });
+
+        Stats stats;
+        stats.paths = static_cast<u64>(pixels) * m_Settings.samples;
+        stats.extensionRays = extensionRays.load();
+        stats.shadowRays = shadowRays.load();
+        stats.wallTime = SecondsSince(start);
+
+        return stats;
+    }
+
+    void WavefrontIntegrator::Generate(const Scene::CameraData& camera, u64 first, u32 count)
+    {
+        const u32 pixels = m_Settings.width * m_Settings.height;
+        RayQueue& queue = m_RayQueues[0];
+
+        ParallelFor(count, RAY_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 slot = begin; slot < end; ++slot) {
+                const u64 path = first + slot;
+                const Ray ray = GenerateRay(camera, static_cast<u32>(path % pixels), static_cast<u32>(path / pixels));
+
+                queue.origins[slot] = ray.origin;
+                queue.directions[slot] = ray.direction;
+                queue.tMins[slot] = ray.tMin;
+                queue.paths[slot] = slot;
+
+                m_Throughput[slot] = glm::vec3(1.0f);
+                m_Radiance[slot] = glm::vec3(0.0f);
+            }
+        });
+
+        queue.count = count;
+    }
+
+    void WavefrontIntegrator::Extend(RayQueue& queue, f32 tMax)
+    {
+        ParallelFor(queue.count, RAY_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i) {
+                const Ray ray {
+                    .origin = queue.origins[i],
+                    .tMin = queue.tMins[i],
+                    .direction = queue.directions[i],
+                    .tMax = tMax
+                };
+
+                queue.hits[i] = Hit {};
+                m_BVH->Intersect(ray, queue.hits[i]);
+            }
+        });
+    }
+
+    // Stable counting sort of the queue by material, misses first: per-block histograms, one prefix sum
+    // over (material, block) and a scatter that keeps every block's entries in queue order.
+    void WavefrontIntegrator::SortByMaterial(const RayQueue& queue)
+    {
+        const u32 keys = static_cast<u32>(m_Scene->materials.size()) + 1;
+        const u32 blocks = (queue.count + SORT_BLOCK - 1) / SORT_BLOCK;
+
+        m_Histograms.assign(static_cast<usize>(blocks) * keys, 0);
+
+        auto Key = [&](u32 i) { return queue.hits[i].IsValid() ? GetMaterial(queue.hits[i]) + 1 : 0u; };
+
+        ParallelFor(blocks, 1, [&](u32 firstBlock, u32 lastBlock) {
+            for (u32 block = firstBlock; block < lastBlock; ++block) {
+                u32* histogram = m_Histograms.data() + static_cast<usize>(block) * keys;
+
+                const u32 end = std::min(queue.count, (block + 1) * SORT_BLOCK);
+                for (u32 i = block * SORT_BLOCK; i < end; ++i) {
+                    histogram[Key(i)]++;
+                }
+            }
+        });
+
+        u32 offset = 0;
+        for (u32 key = 0; key < keys; ++key) {
+            for (u32 block = 0; block < blocks; ++block) {
+                u32& bucket = m_Histograms[static_cast<usize>(block) * keys + key];
+                const u32 size = bucket;
+                bucket = offset;
+                offset += size;
+            }
+        }
+
+        ParallelFor(blocks, 1, [&](u32 firstBlock, u32 lastBlock) {
+            for (u32 block = firstBlock; block < lastBlock; ++block) {
+                u32* offsets = m_Histograms.data() + static_cast<usize>(block) * keys;
+
+                const u32 end = std::min(queue.count, (block + 1) * SORT_BLOCK);
+                for (u32 i = block * SORT_BLOCK; i < end; ++i) {
+                    m_ShadeOrder[offsets[Key(i)]++] = i;
+                }
+            }
+        });
+    }
+
+    void WavefrontIntegrator::Shade(const RayQueue& queue, RayQueue& next, u64 first, u32 depth)
+    {
+        const u32 pixels = m_Settings.width * m_Settings.height;
+        const bool sorted = m_Settings.sortByMaterial;
+        const u32 blocks = (queue.count + SHADE_BLOCK - 1) / SHADE_BLOCK;
+
+        std::atomic<u32> extendCount { 0 };
+        std::atomic<u32> connectCount { 0 };
+
+        ParallelFor(blocks, 1, [&](u32 firstBlock, u32 lastBlock) {
+            std::array<Interaction, SHADE_BLOCK> interactions;
+            std::array<u32, SHADE_BLOCK> slots;
+
+            for (u32 block = firstBlock; block < lastBlock; ++block) {
+                const u32 begin = block * SHADE_BLOCK;
+                const u32 end = std::min(queue.count, begin + SHADE_BLOCK);
+
+                u32 extends = 0;
+                u32 connects = 0;
+
+                for (u32 i = begin; i < end; ++i) {
+                    const u32 entry = sorted ? m_ShadeOrder[i] : i;
+                    const u32 slot = queue.paths[entry];
+                    const Hit& hit = queue.hits[entry];
+
+                    Interaction& interaction = interactions[i - begin];
+                    slots[i - begin] = slot;
+
+                    if (!hit.IsValid()) {
+                        m_Radiance[slot] += m_Throughput[slot] * Miss(queue.directions[entry]);
+                        interaction.connect = false;
+                        interaction.extend = false;
+                        continue;
+                    }
+
+                    const Ray ray {
+                        .origin = queue.origins[entry],
+                        .tMin = queue.tMins[entry],
+                        .direction = queue.directions[entry]
+                    };
+
+                    const u64 path = first + slot;
+                    interaction = ShadeHit(ray, hit, m_Throughput[slot], static_cast<u32>(path % pixels), static_cast<u32>(path / pixels), depth);
+
+                    m_Radiance[slot] += interaction.emitted;
+                    if (interaction.extend) {
+                        m_Throughput[slot] = interaction.throughput;
+                        extends++;
+                    }
+                    if (interaction.connect) connects++;
+                }
+
+                // One reservation per block keeps each block's survivors together, in shading order.
+                u32 extendBase = extendCount.fetch_add(extends, std::memory_order_relaxed);
+                u32 connectBase = connectCount.fetch_add(connects, std::memory_order_relaxed);
+
+                for (u32 i = 0; i < end - begin; ++i) {
+                    const Interaction& interaction = interactions[i];
+
+                    if (interaction.extend) {
+                        next.origins[extendBase] = interaction.next.origin;
+                        next.directions[extendBase] = interaction.next.direction;
+                        next.tMins[extendBase] = interaction.next.tMin;
+                        next.paths[extendBase] = slots[i];
+                        extendBase++;
+                    }
+
+                    if (interaction.connect) {
+                        m_ShadowQueue.origins[connectBase] = interaction.shadow.origin;
+                        m_ShadowQueue.directions[connectBase] = interaction.shadow.direction;
+                        m_ShadowQueue.tMaxs[connectBase] = interaction.shadow.tMax;
+                        m_ShadowQueue.contributions[connectBase] = interaction.shadowContribution;
+                        m_ShadowQueue.paths[connectBase] = slots[i];
+                        connectBase++;
+                    }
+                }
+            }
+        });
+
+        next.count = extendCount.load();
+        m_ShadowQueue.count = connectCount.load();
+    }
+
+    void WavefrontIntegrator::Connect()
+    {
+        ParallelFor(m_ShadowQueue.count, RAY_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i) {
+                const Ray ray {
+                    .origin = m_ShadowQueue.origins[i],
+                    .tMin = BOUNCE_EPSILON,
+                    .direction = m_ShadowQueue.directions[i],
+                    .tMax = m_ShadowQueue.tMaxs[i]
+                };
+
+                if (!m_BVH->Occluded(ray)) {
+                    m_Radiance[m_ShadowQueue.paths[i]] += m_ShadowQueue.contributions[i];
+                }
+            }
+        });
+
+        m_ShadowQueue.count = 0;
+    }
+
+    void WavefrontIntegrator::Resolve(u64 first, u32 count)
+    {
+        const u32 pixels = m_Settings.width * m_Settings.height;
+
+        ParallelFor(count, RAY_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 slot = begin; slot < end; ++slot) {
+                m_Sums[static_cast<u32>((first + slot) % pixels)] += m_Radiance[slot];
+            }
+        });
+    }
+
+    Ray WavefrontIntegrator::GenerateRay(const Scene::CameraData& camera, u32 pixel, u32 sample) const
+    {
+        const u32 x = pixel % m_Settings.width;
+        const u32 y = pixel / m_Settings.width;
+
+        glm::vec2 jitter(0.5f);
+        if (m_Settings.samples > 1) {
+            jitter = m_Settings.sequence.Get2D(pixel, sample, DIMENSION_PIXEL);
+        }
+
+        const glm::vec2 position = glm::vec2(static_cast<f32>(x), static_cast<f32>(y)) + jitter;
+        const glm::vec2 screenPos = position / glm::vec2(static_cast<f32>(m_Settings.width), static_cast<f32>(m_Settings.height)) * 2.0f - 1.0f;
+
+        glm::vec4 target = camera.inverseProj * glm::vec4(screenPos.x, screenPos.y, 1.0f, 1.0f);
+
+        Ray ray;
+        ray.origin = glm::vec3(camera.position);
+        ray.direction = glm::normalize(glm::vec3(camera.inverseView * glm::vec4(glm::normalize(glm::vec3(target)), 0.0f)));
+        ray.tMin = camera.params[2];
+        ray.tMax = camera.params[3];
+
+        return ray;
+    }
+
+    WavefrontIntegrator::Interaction WavefrontIntegrator::ShadeHit(const Ray& ray, const Hit& hit, const glm::vec3& throughput, u32 pixel, u32 sample, u32 depth) const
+    {
+        const auto& tri = m_Geometry->GetTriangle(hit.primitive);
+        const auto& v0 = m_Geometry->GetVertex(hit.primitive, 0);
+        const auto& v1 = m_Geometry->GetVertex(hit.primitive, 1);
+        const auto& v2 = m_Geometry->GetVertex(hit.primitive, 2);
+
+        const glm::vec3 barycentric(1.0f - hit.u - hit.v, hit.u, hit.v);
+
+        glm::vec3 normal = glm::normalize(v0.normal * barycentric.x + v1.normal * barycentric.y + v2.normal * barycentric.z);
+        const glm::vec2 uv = v0.uv0 * barycentric.x + v1.uv0 * barycentric.y + v2.uv0 * barycentric.z;
+
+        const ShadingPoint point = EvaluateMaterial(*m_Scene, m_Scene->materials[tri.material], uv);
+        const f32 roughness = std::max(point.roughness, MIN_ROUGHNESS);
+
+        const glm::vec3 V = -ray.direction;
+        if (glm::dot(normal, V) < 0.0f) normal = -normal;
+
+        const glm::vec3 position = ray.origin + ray.direction * hit.t;
+
+        Interaction interaction;
+
+        // Emitters reached by a bounce were already light-sampled at the previous vertex, as on the GPU.
+        if (depth == 0 || m_Lights.IsEmpty()) interaction.emitted = throughput * point.emissive;
+
+        if (m_Lights.IsEmpty()) {
+            const f32 NdotL = glm::dot(normal, SUN_DIRECTION);
+            if (NdotL > 0.0f) {
+                interaction.connect = true;
+                interaction.shadow.origin = position;
+                interaction.shadow.tMin = BOUNCE_EPSILON;
+                interaction.shadow.direction = SUN_DIRECTION;
+                interaction.shadowContribution = throughput * EvaluateBRDF(normal, V, SUN_DIRECTION, point.albedo, point.metallic, roughness) * SUN_INTENSITY * NdotL;
+            }
+        } else {
+            const f32 uSelect = m_Settings.sequence.Get(pixel, sample, Dimension(DIMENSION_LIGHT_SELECT, depth));
+            const glm::vec2 uPoint = m_Settings.sequence.Get2D(pixel, sample, Dimension(DIMENSION_LIGHT_POINT, depth));
+
+            const LightSample light = SampleLight(position, normal, uSelect, uPoint);
+            const f32 NdotL = glm::dot(normal, light.direction);
+
+            if (light.pdf > 0.0f && NdotL > 0.0f) {
+                interaction.connect = true;
+                interaction.shadow.origin = position;
+                interaction.shadow.tMin = BOUNCE_EPSILON;
+                interaction.shadow.direction = light.direction;
+                interaction.shadow.tMax = light.distance - BOUNCE_EPSILON;
+                interaction.shadowContribution = throughput * EvaluateBRDF(normal, V, light.direction, point.albedo, point.metallic, roughness) * light.radiance * (NdotL / light.pdf);
+            }
+        }
+
+        if (depth + 1 >= m_Settings.maxDepth) return interaction;
+
+        const f32 uLobe = m_Settings.sequence.Get(pixel, sample, Dimension(DIMENSION_BSDF_LOBE, depth));
+        const glm::vec2 uDirection = m_Settings.sequence.Get2D(pixel, sample, Dimension(DIMENSION_BSDF_DIRECTION, depth));
+
+        glm::vec3 L;
+        glm::vec3 next = throughput * SampleBRDF(normal, V, point.albedo, point.metallic, roughness, uLobe, uDirection, L);
+
+        const f32 maxThroughput = MaxComponent(next);
+        if (maxThroughput <= 0.0f) return interaction;
+
+        if (depth + 1 >= ROULETTE_MIN_DEPTH) {
+            const f32 survival = std::min(maxThroughput, ROULETTE_MAX_SURVIVAL);
+            if (m_Settings.sequence.Get(pixel, sample, Dimension(DIMENSION_ROULETTE, depth)) >= survival) return interaction;
+
+            next /= survival;
+        }
+
+        interaction.extend = true;
+        interaction.next.origin = position;
+        interaction.next.tMin = BOUNCE_EPSILON;
+        interaction.next.direction = L;
+        interaction.throughput = next;
+
+        return interaction;
+    }
+
+    // An emissive triangle, through the light tree or by power alone, and a uniform point on it, as
+    // SampleLight in shaders/lights.glsl; emitters are double-sided.
+    WavefrontIntegrator::LightSample WavefrontIntegrator::SampleLight(const glm::vec3& position, const glm::vec3& normal, f32 uSelect, const glm::vec2& uPoint) const
+    {
+        LightSample result;
+
+        u32 index = 0;
+        f32 pmf = 0.0f;
+
+        if (!m_LightTree.IsEmpty()) {
+            const auto selected = m_LightTree.Sample(position, normal, uSelect, pmf);
+            if (!selected) return result;
+
+            index = *selected;
+        } else {
+            index = m_Lights.Sample(uSelect);
+            pmf = m_Lights.GetTriangles()[index].pdf;
+        }
+
+        const auto& light = m_Lights.GetTriangles()[index];
+
+        const f32 su = std::sqrt(uPoint.x);
+        const f32 b1 = 1.0f - su;
+        const f32 b2 = uPoint.y * su;
+        const f32 b0 = 1.0f - b1 - b2;
+
+        const glm::vec3 point = light.p0 * b0 + light.p1 * b1 + light.p2 * b2;
+        const glm::vec2 uv = light.uv0 * b0 + light.uv1 * b1 + light.uv2 * b2;
+
+        const glm::vec3 toLight = point - position;
+        const f32 dist2 = glm::dot(toLight, toLight);
+        if (dist2 <= 0.0f) return result;
+
+        result.distance = std::sqrt(dist2);
+        result.direction = toLight / result.distance;
+
+        const glm::vec3 lightNormal = glm::normalize(glm::cross(light.p1 - light.p0, light.p2 - light.p0));
+        const f32 cosLight = std::abs(glm::dot(lightNormal, result.direction));
+        if (cosLight <= 0.0f) return result;
+
+        const auto& material = m_Scene->materials[light.material];
+
+        result.radiance = material.emissiveFactor;
+        if (material.emissiveTexture >= 0) {
+            result.radiance *= glm::vec3(SampleTexture(*m_Scene, material.emissiveTexture, uv));
+        }
+
+        result.pdf = pmf / light.area * dist2 / cosLight;
+        return result;
+    }
+
+    glm::vec3 WavefrontIntegrator::Miss(const glm::vec3& direction)
+    {
+        f32 t = 0.5f * (direction.y + 1.0f);
+        return (1.0f - t) * glm::vec3(1.0f) + t * glm::vec3(0.5f, 0.7f, 1.0f);
+    }
+
+    u32 WavefrontIntegrator::GetMaterial(const Hit& hit) const
+    {
+        return m_Geometry->GetTriangle(hit.primitive).material;
+    }
+
+    void WavefrontIntegrator::ParallelFor(u32 count, u32 grain, const ThreadPool::RangeFn& fn)
+    {
+        (m_Pool ? *m_Pool : ThreadPool::Get()).ParallelFor(count, grain, fn);
+    }
+
+    void WavefrontIntegrator::LogStats(const Stats& stats)
+    {
+        LOG_INFO("{:.1f} ms | {} paths | {} extension + {} shadow rays | {:.2f} Mrays/s",
+            stats.wallTime * 1000.0, stats.paths, stats.extensionRays, stats.shadowRays, static_cast<f64>(stats.GetRayCount()) / stats.wallTime * 1e-6);
+
+        const f64 staged = stats.generateTime + stats.extendTime + stats.sortTime + stats.shadeTime + stats.connectTime;
+        if (staged <= 0.0) return;
+
+        LOG_INFO("generate {:.1f} ms | extend {:.1f} ms | sort {:.1f} ms | shade {:.1f} ms | connect {:.1f} ms",
+            stats.generateTime * 1000.0, stats.extendTime * 1000.0, stats.sortTime * 1000.0, stats.shadeTime * 1000.0, stats.connectTime * 1000.0);
+    }
+
+}
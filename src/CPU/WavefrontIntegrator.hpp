@@ -0,0 +1,185 @@
+#pragma once
+
+#include "BVH.hpp"
+#include "ThreadPool.hpp"
+#include "SampleSequence.hpp"
+
+#include "Scene/Camera.hpp"
+#include "Scene/LightTree.hpp"
+#include "Scene/SceneData.hpp"
+
+namespace CPU {
+
+    // Breadth-first multi-bounce path tracer. A batch of paths moves through the stages together, and
+    // each stage is one parallel loop over a structure-of-arrays queue:
+    // - generate: camera rays
+    // - extend: closest hits
+    // - shade: emission, light connection and BSDF continuation, over hits counting-sorted by material
+    // - connect: shadow rays
+    // Surviving paths are compacted into the next extension queue after every bounce. Each stage then
+    // streams through one kind of data (BVH nodes, one material's textures, shadow rays) instead of
+    // switching between all of them per pixel.
+    // RenderPerPixel traces the very same paths depth first, one pixel at a time, as the baseline.
+    // Direct lighting follows shaders/shading.glsl: one emissive triangle per vertex, emission counted on
+    // camera hits only, and the fixed sun for scenes without emitters.
+    class WavefrontIntegrator
+    {
+    public:
+        struct Settings
+        {
+            u32 width { 0 };
+            u32 height { 0 };
+            u32 samples { 1 };
+
+            // Path vertices per sample, the camera hit included, as Renderer::Settings::maxDepth.
+            u32 maxDepth { 8 };
+
+            // Paths in flight per batch, capped at one sample per pixel so a batch never holds two
+            // paths of the same pixel.
+            u32 wavefrontSize { 1u << 20 };
+            bool sortByMaterial { true };
+
+            // Emitters are picked through Scene::LightTree, as Renderer::Settings::lightTree; false uses
+            // the power-only alias table.
+            bool lightTree { true };
+
+            // 0 uses the shared CPU::ThreadPool.
+            u32 threads { 0 };
+
+            SampleSequence sequence {};
+        };
+
+        struct Stats
+        {
+            f64 wallTime { 0.0 };
+
+            // Seconds spent in each stage; zero for RenderPerPixel.
+            f64 generateTime { 0.0 };
+            f64 extendTime { 0.0 };
+            f64 sortTime { 0.0 };
+            f64 shadeTime { 0.0 };
+            f64 connectTime { 0.0 };
+
+            u64 paths { 0 };
+            u64 extensionRays { 0 };
+            u64 shadowRays { 0 };
+
+            inline u64 GetRayCount() const { return extensionRays + shadowRays; }
+        };
+
+    public:
+        WavefrontIntegrator(const std::shared_ptr<Scene::SceneData>& scene, const Settings& settings);
+
+        Stats Render(const Scene::CameraData& camera);
+        Stats RenderPerPixel(const Scene::CameraData& camera);
+
+        // Reallocates the per-pixel buffers and batch queues; the BVH is kept.
+        void Resize(u32 width, u32 height);
+
+        inline u32 GetWidth() const { return m_Settings.width; }
+        inline u32 GetHeight() const { return m_Settings.height; }
+        inline std::span<const glm::vec4> GetImage() const { return m_Image; }
+
+        inline const Settings& GetSettings() const { return m_Settings; }
+        inline void SetSortByMaterial(bool enabled) { m_Settings.sortByMaterial = enabled; }
+        inline void SetSampleCount(u32 samples) { m_Settings.samples = std::max(1u, samples); }
+        inline void SetSampleSequence(const SampleSequence& sequence) { m_Settings.sequence = sequence; }
+
+        // Bytes held by the path, ray, shadow and sort queues of one batch.
+        usize GetQueueMemoryUsage() const;
+
+        static void LogStats(const Stats& stats);
+
+    private:
+        // Everything one path vertex hands to the next stages; throughput is already folded into the
+        // emitted and shadow terms.
+        struct Interaction
+        {
+            glm::vec3 emitted { 0.0f };
+
+            bool connect { false };
+            Ray shadow;
+            glm::vec3 shadowContribution { 0.0f };
+
+            bool extend { false };
+            Ray next;
+            glm::vec3 throughput { 0.0f };
+        };
+
+        // A point on an emissive triangle as seen from a shading point; pdf in solid angle, 0 if invalid.
+        struct LightSample
+        {
+            glm::vec3 direction { 0.0f };
+            f32 distance { 0.0f };
+            glm::vec3 radiance { 0.0f };
+            f32 pdf { 0.0f };
+        };
+
+        struct RayQueue
+        {
+            std::vector<glm::vec3> origins;
+            std::vector<glm::vec3> directions;
+            std::vector<f32> tMins;
+            std::vector<u32> paths;
+            std::vector<Hit> hits;
+            u32 count { 0 };
+
+            void Resize(u32 capacity);
+            usize GetMemoryUsage() const;
+        };
+
+        struct ShadowQueue
+        {
+            std::vector<glm::vec3> origins;
+            std::vector<glm::vec3> directions;
+            std::vector<f32> tMaxs;
+            std::vector<glm::vec3> contributions;
+            std::vector<u32> paths;
+            u32 count { 0 };
+
+            void Resize(u32 capacity);
+            usize GetMemoryUsage() const;
+        };
+
+    private:
+        void Generate(const Scene::CameraData& camera, u64 first, u32 count);
+        void Extend(RayQueue& queue, f32 tMax);
+        void SortByMaterial(const RayQueue& queue);
+        void Shade(const RayQueue& queue, RayQueue& next, u64 first, u32 depth);
+        void Connect();
+        void Resolve(u64 first, u32 count);
+
+        Ray GenerateRay(const Scene::CameraData& camera, u32 pixel, u32 sample) const;
+        Interaction ShadeHit(const Ray& ray, const Hit& hit, const glm::vec3& throughput, u32 pixel, u32 sample, u32 depth) const;
+        LightSample SampleLight(const glm::vec3& position, const glm::vec3& normal, f32 uSelect, const glm::vec2& uPoint) const;
+        static glm::vec3 Miss(const glm::vec3& direction);
+
+        u32 GetMaterial(const Hit& hit) const;
+
+        void ParallelFor(u32 count, u32 grain, const ThreadPool::RangeFn& fn);
+
+    private:
+        std::shared_ptr<Scene::SceneData> m_Scene;
+        std::shared_ptr<Geometry> m_Geometry;
+        std::unique_ptr<BVH> m_BVH;
+        Scene::LightTable m_Lights;
+        Scene::LightTree m_LightTree;
+        std::unique_ptr<ThreadPool> m_Pool;
+        Settings m_Settings;
+
+        // Per-path state of the current batch, indexed by path slot.
+        std::vector<glm::vec3> m_Throughput;
+        std::vector<glm::vec3> m_Radiance;
+
+        std::array<RayQueue, 2> m_RayQueues;
+        ShadowQueue m_ShadowQueue;
+
+        // Shading order of the extension queue and the per-block material histograms that build it.
+        std::vector<u32> m_ShadeOrder;
+        std::vector<u32> m_Histograms;
+
+        std::vector<glm::vec3> m_Sums;
+        std::vector<glm::vec4> m_Image;
+    };
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+namespace CPU {
+
+    // Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models").
+    // The owning thread pushes and pops at the bottom, other threads steal from the top.
+    template <typename T>
+        requires std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free
+    class WorkStealingDeque
+    {
+    public:
+        WorkStealingDeque(i64 capacity = 256)
+        {
+            m_Array.store(Allocate(std::bit_ceil(static_cast<u64>(std::max<i64>(capacity, 2)))), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        void Push(T item)
+        {
+            i64 bottom = m_Bottom.load(std::memory_order_relaxed);
+            i64 top = m_Top.load(std::memory_order_acquire);
+            Array* array = m_Array.load(std::memory_order_relaxed);
+
+            if (bottom - top > array->mask) {
+                array = Grow(array, top, bottom);
+            }
+
+            array->Put(bottom, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        std::optional<T> Pop()
+        {
+            i64 bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+            Array* array = m_Array.load(std::memory_order_relaxed);
+            m_Bottom.store(bottom, std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            i64 top = m_Top.load(std::memory_order_relaxed);
+
+            if (top > bottom) {
+                m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+
+            T item = array->Get(bottom);
+
+            if (top == bottom) {
+                bool won = m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+                if (!won) return std::nullopt;
+            }
+
+            return item;
+        }
+
+        std::optional<T> Steal()
+        {
+            i64 top = m_Top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            i64 bottom = m_Bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom) return std::nullopt;
+
+            Array* array = m_Array.load(std::memory_order_acquire);
+            T item = array->Get(top);
+
+            if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return std::nullopt;
+            }
+
+            return item;
+        }
+
+        inline i64 Size() const
+        {
+            i64 bottom = m_Bottom.load(std::memory_order_relaxed);
+            i64 top = m_Top.load(std::memory_order_relaxed);
+            return std::max<i64>(bottom - top, 0);
+        }
+
+        inline bool Empty() const { return Size() == 0; }
+
+    private:
+        struct Array
+        {
+            i64 mask { 0 };
+            std::unique_ptr<std::atomic<T>[]> data;
+
+            inline T Get(i64 index) const { return data[index & mask].load(std::memory_order_relaxed); }
+            inline void Put(i64 index, T item) { data[index & mask].store(item, std::memory_order_relaxed); }
+        };
+
+    private:
+        Array* Allocate(u64 capacity)
+        {
+            auto& array = m_Arrays.emplace_back(std::make_unique<Array>());
+            array->mask = static_cast<i64>(capacity) - 1;
+            array->data = std::make_unique<std::atomic<T>[]>(capacity);
+            return array.get();
+        }
+
+        // Old arrays stay alive until the deque is destroyed since a thief may still be reading them.
+        Array* Grow(Array* array, i64 top, i64 bottom)
+        {
+            Array* grown = Allocate(static_cast<u64>(array->mask + 1) * 2);
+            for (i64 i = top; i < bottom; ++i) {
+                grown->Put(i, array->Get(i));
+            }
+
+            m_Array.store(grown, std::memory_order_release);
+            return grown;
+        }
+
+    private:
+        alignas(64) std::atomic<i64> m_Top { 0 };
+        alignas(64) std::atomic<i64> m_Bottom { 0 };
+        alignas(64) std::atomic<Array*> m_Array { nullptr };
+
+        std::vector<std::unique_ptr<Array>> m_Arrays;
+    };
+
+}
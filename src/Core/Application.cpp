@@ -5,18 +5,78 @@
 
 #define BIND_EVENT_FN(fn) [this](auto&&... args) -> decltype(auto) { return this->fn(std::forward<decltype(args)>(args)...); }
 
-Application::Application()
+namespace {
+
+    inline constexpr f32 PATH_STATS_INTERVAL { 1.0f };
+
+    // Backend, primary visibility and alpha test comparisons: alternating blocks per variant, each starting with
+    // frames left out of the timings while caches and clocks settle after the switch.
+    inline constexpr u32 COMPARISON_ROUNDS { 4 };
+    inline constexpr u32 COMPARISON_WARMUP { 8 };
+
+    std::string_view ToString(Renderer::TraceBackend backend)
+    {
+        return backend == Renderer::TraceBackend::RayQuery ? "ray query" : "RT pipeline";
+    }
+
+    std::string_view ToString(Renderer::PrimaryVisibility primary)
+    {
+        return primary == Renderer::PrimaryVisibility::Rasterized ? "rasterized" : "traced";
+    }
+
+    std::string_view ToAlphaTestString(usize variant)
+    {
+        return variant == 0 ? "alpha test" : "opaque";
+    }
+
+    void LogPathStats(const Renderer::PathStats& stats)
+    {
+        if (stats.paths == 0) return;
+
+        auto Percent = [&](u32 count) { return 100.0 * static_cast<f64>(count) / static_cast<f64>(stats.paths); };
+
+        LOG_INFO("Paths: {} at {:.2f} vertices avg | miss {:.1f}% | roulette {:.1f}% | depth {:.1f}% | absorbed {:.1f}%",
+            stats.paths, stats.GetAverageDepth(), Percent(stats.missed), Percent(stats.roulette), Percent(stats.depthLimit), Percent(stats.absorbed));
+    }
+
+}
+
+Application::Application(const Settings& settings)
 {
-    m_Window = std::make_shared<Window>(1280, 720, "PathTracer");
+    m_Window = std::make_shared<Window>(settings.width, settings.height, "PathTracer");
     m_Window->BindEventCallback(BIND_EVENT_FN(Application::DispatchEvents));
 
     m_Renderer = std::make_unique<Renderer>(m_Window, Renderer::Settings {
         .width = m_Window->GetWidth(),
         .height = m_Window->GetHeight(),
         .samples = 32,
-        .tile = 128
+        .tile = 128,
+        .environment = settings.environment,
+        .particles = settings.particles,
+        .backend = settings.backend,
+        .primary = settings.primary
     });
 
+    if (settings.compareFrames > 0) {
+        if (m_Renderer->IsRayQuerySupported()) {
+            m_Comparison = Comparison { .mode = Comparison::Mode::Backends, .framesPerRound = settings.compareFrames };
+        } else {
+            LOG_WARN("Backend comparison needs VK_KHR_ray_query; running interactively");
+        }
+    } else if (settings.comparePrimaryFrames > 0) {
+        if (m_Renderer->IsRasterPrimarySupported()) {
+            m_Comparison = Comparison { .mode = Comparison::Mode::Primary, .framesPerRound = settings.comparePrimaryFrames };
+        } else {
+            LOG_WARN("Primary visibility comparison needs VK_KHR_fragment_shader_barycentric; running interactively");
+        }
+    } else if (settings.compareAlphaFrames > 0) {
+        if (m_Renderer->HasNonOpaqueGeometry()) {
+            m_Comparison = Comparison { .mode = Comparison::Mode::AlphaTest, .framesPerRound = settings.compareAlphaFrames };
+        } else {
+            LOG_WARN("Alpha test comparison needs MASK or BLEND materials in the scene; running interactively");
+        }
+    }
+
     m_Camera = std::make_unique<Scene::CameraSystem>(m_Window->GetWidth(), m_Window->GetHeight());
     m_Camera->AddRig<Scene::FreeFlyRig>(Scene::FreeFlyRig::Settings {
         .moveSpeed = 5.0f,
@@ -29,6 +89,7 @@ Application::Application()
 void Application::Run()
 {
     auto last = std::chrono::steady_clock::now();
+    f32 statsTimer = 0.0f;
 
     while (m_Running) {
         auto now = std::chrono::steady_clock::now();
@@ -42,7 +103,44 @@ void Application::Run()
             m_Running = false;
         }
 
-        m_Camera->Update(dt);
+        if (m_Comparison && !StepComparison()) {
+            LogComparison();
+            m_Running = false;
+            continue;
+        }
+
+        if (!m_Comparison && Input::IsKeyPressed(KeyCode::F10)) {
+            const bool rayQuery = m_Renderer->GetTraceBackend() == Renderer::TraceBackend::RayQuery;
+            m_Renderer->SetTraceBackend(rayQuery ? Renderer::TraceBackend::RayTracingPipeline : Renderer::TraceBackend::RayQuery);
+            LOG_INFO("Trace backend: {}", ToString(m_Renderer->GetTraceBackend()));
+        }
+
+        if (!m_Comparison && Input::IsKeyPressed(KeyCode::F9)) {
+            const bool raster = m_Renderer->GetPrimaryVisibility() == Renderer::PrimaryVisibility::Rasterized;
+            m_Renderer->SetPrimaryVisibility(raster ? Renderer::PrimaryVisibility::Traced : Renderer::PrimaryVisibility::Rasterized);
+            if (m_Renderer->GetPrimaryVisibility() == Renderer::PrimaryVisibility::Rasterized) {
+                LOG_INFO("Primary visibility: rasterized, one camera hit per pixel centre (no edge anti-aliasing)");
+            } else {
+                LOG_INFO("Primary visibility: traced");
+            }
+        }
+
+        if (Input::IsKeyPressed(KeyCode::F12)) {
+            const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            m_Renderer->CaptureAOVs("capture_" + std::to_string(seconds));
+        }
+
+        if (Input::IsKeyPressed(KeyCode::F11)) {
+            m_Renderer->SetPathStatsEnabled(!m_Renderer->IsPathStatsEnabled());
+            statsTimer = 0.0f;
+        }
+
+        if (m_Renderer->IsPathStatsEnabled() && (statsTimer += dt) >= PATH_STATS_INTERVAL) {
+            LogPathStats(m_Renderer->GetPathStats());
+            statsTimer = 0.0f;
+        }
+
+        if (!m_Comparison) m_Camera->Update(dt);
 
         if (!m_Minimized) {
             auto cam = m_Camera->GetShaderData();
@@ -53,6 +151,90 @@ void Application::Run()
     }
 }
 
+bool Application::StepComparison()
+{
+    auto& comparison = *m_Comparison;
+
+    const auto& timing = m_Renderer->GetTraceTiming();
+    if (timing.serial != comparison.lastSerial) {
+        comparison.lastSerial = timing.serial;
+
+        usize variant = static_cast<usize>(timing.backend);
+        if (comparison.mode == Comparison::Mode::Primary) variant = static_cast<usize>(timing.primary);
+        else if (comparison.mode == Comparison::Mode::AlphaTest) variant = timing.alphaTest ? 0 : 1;
+
+        if (variant != comparison.lastVariant) {
+            comparison.lastVariant = variant;
+            comparison.warmup = COMPARISON_WARMUP;
+        }
+
+        if (comparison.warmup > 0) comparison.warmup--;
+        else comparison.milliseconds[variant].push_back(timing.GetFrameMilliseconds());
+    }
+
+    // Frames still in flight at the end are left untimed.
+    if (comparison.frame == COMPARISON_ROUNDS * 2 * comparison.framesPerRound) return false;
+
+    const u32 block = comparison.frame++ / comparison.framesPerRound;
+
+    switch (comparison.mode) {
+        case Comparison::Mode::Backends:
+            m_Renderer->SetTraceBackend(block % 2 == 0 ? Renderer::TraceBackend::RayTracingPipeline : Renderer::TraceBackend::RayQuery);
+            break;
+        case Comparison::Mode::Primary:
+            m_Renderer->SetPrimaryVisibility(block % 2 == 0 ? Renderer::PrimaryVisibility::Traced : Renderer::PrimaryVisibility::Rasterized);
+            break;
+        case Comparison::Mode::AlphaTest:
+            m_Renderer->SetAlphaTestEnabled(block % 2 == 0);
+            break;
+    }
+
+    return true;
+}
+
+void Application::LogComparison() const
+{
+    const Comparison::Mode mode = m_Comparison->mode;
+
+    auto Name = [&](usize variant) {
+        switch (mode) {
+            case Comparison::Mode::Primary: return ToString(static_cast<Renderer::PrimaryVisibility>(variant));
+            case Comparison::Mode::AlphaTest: return ToAlphaTestString(variant);
+            default: return ToString(static_cast<Renderer::TraceBackend>(variant));
+        }
+    };
+
+    std::string_view title = "Trace backends";
+    std::string_view column = "backend";
+    if (mode == Comparison::Mode::Primary) { title = "Primary visibility"; column = "primary"; }
+    else if (mode == Comparison::Mode::AlphaTest) { title = "Alpha test"; column = "traversal"; }
+
+    // Resolution is part of the header so runs at different sizes can be told apart.
+    LOG_INFO("{} at {}x{}, {} rounds of {} frames each:", title, m_Window->GetWidth(), m_Window->GetHeight(),
+        COMPARISON_ROUNDS, m_Comparison->framesPerRound);
+    LOG_INFO("{:>12} | {:>7} | {:>11} | {:>11} | {:>11}", column, "frames", "mean (ms)", "median (ms)", "min (ms)");
+
+    std::array<f64, 2> medians {};
+
+    for (usize variant = 0; variant < 2; ++variant) {
+        auto times = m_Comparison->milliseconds[variant];
+        if (times.empty()) {
+            LOG_WARN("{:>12} | no timings", Name(variant));
+            continue;
+        }
+
+        std::ranges::sort(times);
+        const f64 mean = std::accumulate(times.begin(), times.end(), 0.0) / static_cast<f64>(times.size());
+        medians[variant] = times[times.size() / 2];
+
+        LOG_INFO("{:>12} | {:>7} | {:>11.3f} | {:>11.3f} | {:>11.3f}", Name(variant), times.size(), mean, medians[variant], times.front());
+    }
+
+    if (medians[0] > 0.0 && medians[1] > 0.0) {
+        LOG_INFO("{} / {} median: {:.2f}x", Name(1), Name(0), medians[1] / medians[0]);
+    }
+}
+
 void Application::DispatchEvents(const Event& event)
 {
     EventDispatcher dispatcher(event);
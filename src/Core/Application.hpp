@@ -8,14 +8,65 @@
 class Application
 {
 public:
-    Application();
+    struct Settings
+    {
+        u32 width { 1280 };
+        u32 height { 720 };
+
+        std::filesystem::path environment;
+        u32 particles { 0 };
+        Renderer::TraceBackend backend { Renderer::TraceBackend::RayTracingPipeline };
+        Renderer::PrimaryVisibility primary { Renderer::PrimaryVisibility::Traced };
+
+        // Non-zero runs an A/B comparison of the two trace backends instead of the interactive loop:
+        // this many frames per backend and round, the camera held still, then logs the GPU trace times
+        // and exits.
+        u32 compareFrames { 0 };
+
+        // The same for traced against rasterised primary visibility on the chosen backend, timing the
+        // trace plus the visibility pass.
+        u32 comparePrimaryFrames { 0 };
+
+        // The same for alpha-tested against forced-opaque traversal, to measure what the any-hit test costs
+        // on scenes with MASK or BLEND materials.
+        u32 compareAlphaFrames { 0 };
+    };
+
+public:
+    Application(const Settings& settings);
     ~Application() = default;
 
     void Run();
 
+private:
+    // Alternates the two trace backends, the two primary visibility modes, or the alpha test on and off;
+    // variant 0 and 1 follow the enum order of whichever is compared, alpha-tested first.
+    struct Comparison
+    {
+        enum class Mode : u8
+        {
+            Backends,
+            Primary,
+            AlphaTest
+        };
+
+        Mode mode { Mode::Backends };
+        u32 framesPerRound { 0 };
+        u32 frame { 0 };
+
+        std::array<std::vector<f64>, 2> milliseconds;
+        u64 lastSerial { 0 };
+        std::optional<usize> lastVariant;
+        u32 warmup { 0 };
+    };
+
 private:
     void DispatchEvents(const Event& event);
 
+    // Picks the variant of the next frame and collects the timings read back so far; false once done.
+    bool StepComparison();
+    void LogComparison() const;
+
 private:
     bool m_Running { true };
     bool m_Minimized { false };
@@ -24,4 +75,6 @@ private:
     std::unique_ptr<Renderer> m_Renderer;
 
     std::unique_ptr<Scene::CameraSystem> m_Camera;
+
+    std::optional<Comparison> m_Comparison;
 };
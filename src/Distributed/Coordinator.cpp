@@ -0,0 +1,387 @@
+#include "Coordinator.hpp"
+
+#include "Scene/CameraSystem.hpp"
+
+#if !defined(_WIN32)
+    #include <poll.h>
+    #include <spawn.h>
+    #include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+namespace Distributed {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        inline f64 SecondsSince(Clock::time_point start)
+        {
+            std::chrono::duration<f64> elapsed = Clock::now() - start;
+            return elapsed.count();
+        }
+
+        inline std::span<const u8> AsBytes(std::string_view text)
+        {
+            return std::span<const u8>(reinterpret_cast<const u8*>(text.data()), text.size());
+        }
+
+    }
+
+    Coordinator::Coordinator(const Settings& settings)
+        : m_Settings(settings), m_Writer(Image::ImageWriter::Settings { .threads = settings.writerThreads })
+    {
+        m_Settings.tile = std::max(1u, m_Settings.tile);
+        m_Settings.inflight = std::max(1u, m_Settings.inflight);
+    }
+
+    Coordinator::~Coordinator()
+    {
+        Shutdown();
+    }
+
+    bool Coordinator::Listen()
+    {
+        auto listener = Socket::Listen(m_Settings.address, 64);
+        if (!listener) return false;
+
+        m_Listener = std::move(*listener);
+        LOG_INFO("Coordinator listening on {}", m_Settings.address);
+
+        return true;
+    }
+
+    bool Coordinator::SpawnLocalWorkers(const std::filesystem::path& executable, u32 count, u32 threadsPerWorker)
+    {
+#if defined(_WIN32)
+        (void)executable; (void)count; (void)threadsPerWorker;
+        LOG_ERROR("Spawning local workers is not supported on Windows yet");
+        return false;
+#else
+        const std::string program = executable.string();
+        const std::string threads = std::to_string(threadsPerWorker);
+
+        for (u32 i = 0; i < count; ++i) {
+            std::array<const char*, 6> argv { program.c_str(), "--worker", m_Settings.address.c_str(), "--threads", threads.c_str(), nullptr };
+
+            pid_t pid = 0;
+            if (posix_spawn(&pid, program.c_str(), nullptr, nullptr, const_cast<char* const*>(argv.data()), environ) != 0) {
+                LOG_ERROR("Failed to spawn worker {} from {}", i, program);
+                return false;
+            }
+
+            m_Children.push_back(static_cast<i32>(pid));
+        }
+
+        LOG_INFO("Spawned {} local workers with {} threads each", count, threadsPerWorker == 0 ? std::string("all") : threads);
+        return true;
+#endif
+    }
+
+    Coordinator::Stats Coordinator::Run(std::span<const Batch::Job> jobs)
+    {
+        Stats stats;
+
+        if (!m_Listener.IsValid() && !Listen()) {
+            stats.failed = static_cast<u32>(jobs.size());
+            return stats;
+        }
+
+        auto start = Clock::now();
+
+        for (usize i = 0; i < jobs.size(); ++i) {
+            const Batch::Job& job = jobs[i];
+
+            Frame frame;
+            frame.id = ++m_NextFrameId;
+            frame.job = &job;
+            frame.scene = std::filesystem::weakly_canonical(job.scene).string();
+            frame.camera = Scene::CameraSystem::ComputeShaderData(job.GetCameraState(), static_cast<f32>(job.width) / static_cast<f32>(job.height));
+
+            for (u32 y = 0; y < job.height; y += m_Settings.tile) {
+                for (u32 x = 0; x < job.width; x += m_Settings.tile) {
+                    frame.tiles.push_back(CPU::TileScheduler::Tile {
+                        .x = x,
+                        .y = y,
+                        .width = std::min(m_Settings.tile, job.width - x),
+                        .height = std::min(m_Settings.tile, job.height - y)
+                    });
+                }
+            }
+
+            frame.pending.resize(frame.tiles.size());
+            std::iota(frame.pending.begin(), frame.pending.end(), 0u);
+            frame.done.assign(frame.tiles.size(), false);
+            frame.remaining = static_cast<u32>(frame.tiles.size());
+            frame.image.assign(static_cast<usize>(job.width) * job.height, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+            auto frameStart = Clock::now();
+
+            if (!RenderFrame(frame, stats)) {
+                LOG_ERROR("[{}/{}] Failed to render {}", i + 1, jobs.size(), job.output.string());
+                stats.failed++;
+                continue;
+            }
+
+            const f64 frameTime = SecondsSince(frameStart);
+            const u64 samples = static_cast<u64>(job.width) * job.height * job.samples;
+            stats.samples += samples;
+            stats.jobs++;
+
+            LOG_INFO("[{}/{}] {} {}x{} @ {} spp in {:.2f} ms ({:.2f} Msamples/s)", i + 1, jobs.size(), job.output.string(),
+                job.width, job.height, job.samples, frameTime * 1000.0, static_cast<f64>(samples) / std::max(frameTime, 1e-9) / 1e6);
+
+            m_Writer.Submit(job.output, job.width, job.height, std::move(frame.image));
+        }
+
+        m_Writer.Flush();
+        stats.failed += m_Writer.GetStats().failed;
+        stats.wallTime = SecondsSince(start);
+
+        Shutdown();
+
+        LOG_INFO("Distributed: {} jobs ({} failed) in {:.2f} s, {:.2f} Msamples/s; {} tiles, {} reassigned after {} workers were lost",
+            stats.jobs, stats.failed, stats.wallTime, stats.wallTime > 0.0 ? static_cast<f64>(stats.samples) / stats.wallTime / 1e6 : 0.0,
+            stats.tiles, stats.reassigned, stats.workersLost);
+
+        return stats;
+    }
+
+    bool Coordinator::RenderFrame(Frame& frame, Stats& stats)
+    {
+#if defined(_WIN32)
+        (void)frame; (void)stats;
+        return false;
+#else
+        // Tiles still queued on a worker from an aborted frame come back tagged with the old frame id and
+        // are ignored, so they must not count against this frame's queue depth.
+        for (auto& connection : m_Connections) {
+            connection->inflight.clear();
+        }
+
+        auto lastWorker = Clock::now();
+        std::vector<pollfd> fds;
+
+        while (frame.remaining > 0 && !frame.failed) {
+            Dispatch(frame);
+
+            fds.clear();
+            fds.push_back(pollfd { .fd = m_Listener.GetHandle(), .events = POLLIN, .revents = 0 });
+            for (const auto& connection : m_Connections) {
+                fds.push_back(pollfd { .fd = connection->socket.GetHandle(), .events = POLLIN, .revents = 0 });
+            }
+
+            if (poll(fds.data(), static_cast<nfds_t>(fds.size()), 250) < 0 && errno != EINTR) {
+                LOG_ERROR("poll failed on coordinator sockets");
+                return false;
+            }
+
+            // Connections accepted below are appended past the polled range and handled next iteration.
+            const usize polled = m_Connections.size();
+
+            for (usize i = 0; i < polled; ++i) {
+                if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    Handle(*m_Connections[i], frame, stats);
+                }
+            }
+
+            if (fds[0].revents & POLLIN) Accept();
+
+            for (usize i = 0; i < polled; ++i) {
+                auto& connection = *m_Connections[i];
+                if (!connection.closed && !connection.inflight.empty() && SecondsSince(connection.lastResult) > m_Settings.tileTimeout) {
+                    Drop(connection, frame, stats, "timed out");
+                }
+            }
+
+            std::erase_if(m_Connections, [](const auto& connection) { return connection->closed; });
+
+            if (std::ranges::any_of(m_Connections, &Connection::ready)) {
+                lastWorker = Clock::now();
+            } else if (SecondsSince(lastWorker) > m_Settings.workerTimeout) {
+                LOG_ERROR("No workers connected for {:.0f} s", m_Settings.workerTimeout);
+                return false;
+            }
+        }
+
+        return !frame.failed;
+#endif
+    }
+
+    void Coordinator::Accept()
+    {
+        auto socket = m_Listener.Accept();
+        if (!socket) return;
+
+        auto connection = std::make_unique<Connection>();
+        connection->socket = std::move(*socket);
+        connection->id = m_NextConnectionId++;
+        connection->lastResult = Clock::now();
+
+        m_Connections.push_back(std::move(connection));
+    }
+
+    void Coordinator::Dispatch(Frame& frame)
+    {
+        for (auto& connection : m_Connections) {
+            if (!connection->ready || connection->closed) continue;
+
+            while (connection->inflight.size() < m_Settings.inflight && !frame.pending.empty()) {
+                if (connection->frameId != frame.id) {
+                    const Batch::Job& job = *frame.job;
+
+                    FrameMessage message {
+                        .frameId = frame.id,
+                        .width = job.width,
+                        .height = job.height,
+                        .samples = job.samples,
+                        .seed = job.seed,
+                        .sobol = job.sobol ? 1u : 0u,
+                        .camera = frame.camera
+                    };
+
+                    if (!SendMessage(connection->socket, MessageType::Frame, message, AsBytes(frame.scene))) break;
+                    connection->frameId = frame.id;
+                }
+
+                const u32 tileId = frame.pending.front();
+                const auto& tile = frame.tiles[tileId];
+
+                TileMessage message {
+                    .frameId = frame.id,
+                    .tileId = tileId,
+                    .x = tile.x,
+                    .y = tile.y,
+                    .width = tile.width,
+                    .height = tile.height
+                };
+
+                if (!SendMessage(connection->socket, MessageType::Tile, message)) break;
+
+                if (connection->inflight.empty()) connection->lastResult = Clock::now();
+                connection->inflight.push_back(tileId);
+                frame.pending.pop_front();
+            }
+        }
+    }
+
+    void Coordinator::Handle(Connection& connection, Frame& frame, Stats& stats)
+    {
+        auto message = ReceiveMessage(connection.socket);
+        if (!message) {
+            Drop(connection, frame, stats, "disconnected");
+            return;
+        }
+
+        switch (message->type) {
+            case MessageType::Hello: {
+                auto hello = message->Get<HelloMessage>();
+                if (!hello || hello->version != PROTOCOL_VERSION) {
+                    Drop(connection, frame, stats, "protocol version mismatch");
+                    return;
+                }
+
+                connection.threads = hello->threads;
+                connection.ready = true;
+                LOG_INFO("Worker {} joined with {} threads", connection.id, connection.threads);
+            } break;
+            case MessageType::TileResult: {
+                auto result = message->Get<TileResultMessage>();
+                if (!result) {
+                    Drop(connection, frame, stats, "sent a malformed tile");
+                    return;
+                }
+
+                if (result->frameId != frame.id) break;
+
+                auto it = std::ranges::find(connection.inflight, result->tileId);
+                if (it == connection.inflight.end()) break;
+
+                connection.inflight.erase(it);
+                connection.lastResult = Clock::now();
+
+                const auto& tile = frame.tiles[result->tileId];
+                auto pixels = message->GetTail<TileResultMessage>();
+
+                if (pixels.size() != static_cast<usize>(tile.width) * tile.height * sizeof(glm::vec3)) {
+                    frame.pending.push_front(result->tileId);
+                    Drop(connection, frame, stats, "sent a tile of the wrong size");
+                    return;
+                }
+
+                connection.tiles++;
+                connection.renderTime += result->renderTime;
+
+                if (frame.done[result->tileId]) break;
+
+                const u32 width = frame.job->width;
+                for (u32 row = 0; row < tile.height; ++row) {
+                    glm::vec4* dst = frame.image.data() + static_cast<usize>(tile.y + row) * width + tile.x;
+                    for (u32 x = 0; x < tile.width; ++x) {
+                        glm::vec3 radiance;
+                        std::memcpy(&radiance, pixels.data() + (static_cast<usize>(row) * tile.width + x) * sizeof(glm::vec3), sizeof(glm::vec3));
+                        dst[x] = glm::vec4(radiance, 1.0f);
+                    }
+                }
+
+                frame.done[result->tileId] = true;
+                frame.remaining--;
+                stats.tiles++;
+            } break;
+            case MessageType::Error: {
+                auto error = message->Get<ErrorMessage>();
+                auto text = message->GetTail<ErrorMessage>();
+                if (!error || error->frameId != frame.id) break;
+
+                LOG_ERROR("Worker {}: {}", connection.id, std::string_view(reinterpret_cast<const char*>(text.data()), text.size()));
+                frame.failed = true;
+            } break;
+            default:
+                LOG_WARN("Worker {} sent unexpected message {}", connection.id, static_cast<u32>(message->type));
+                break;
+        }
+    }
+
+    void Coordinator::Drop(Connection& connection, Frame& frame, Stats& stats, std::string_view reason)
+    {
+        // Requeue at the front so the frame's stragglers are picked up first.
+        u32 requeued = 0;
+        for (auto it = connection.inflight.rbegin(); it != connection.inflight.rend(); ++it) {
+            if (frame.done[*it]) continue;
+
+            frame.pending.push_front(*it);
+            requeued++;
+        }
+
+        LOG_WARN("Worker {} {} after {} tiles, requeued {} tiles", connection.id, reason, connection.tiles, requeued);
+
+        stats.reassigned += requeued;
+        if (connection.ready) stats.workersLost++;
+
+        connection.inflight.clear();
+        connection.socket.Close();
+        connection.closed = true;
+    }
+
+    void Coordinator::Shutdown()
+    {
+        for (auto& connection : m_Connections) {
+            if (connection->ready) {
+                SendMessage(connection->socket, MessageType::Shutdown, std::span<const u8>());
+                LOG_INFO("Worker {}: {} tiles, {:.2f} s rendering", connection->id, connection->tiles, connection->renderTime);
+            }
+        }
+
+        m_Connections.clear();
+        m_Listener.Close();
+
+#if !defined(_WIN32)
+        for (i32 pid : m_Children) {
+            waitpid(static_cast<pid_t>(pid), nullptr, 0);
+        }
+#endif
+        m_Children.clear();
+    }
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Protocol.hpp"
+
+#include "Batch/JobFile.hpp"
+#include "CPU/TileScheduler.hpp"
+#include "Image/ImageWriter.hpp"
+
+namespace Distributed {
+
+    // Splits each job's frame into tiles and hands them out to connected workers on demand: a worker
+    // gets its next tile as soon as it returns one, so faster machines naturally take more of the frame.
+    // Tiles owned by a worker that disconnects or stops responding go back into the queue. Workers may
+    // join at any time; scene paths are sent as absolute paths and must be valid on every worker.
+    class Coordinator
+    {
+    public:
+        struct Settings
+        {
+            std::string address { "unix:/tmp/pathtracer.sock" };
+            u32 tile { 128 };
+
+            // Tiles queued per worker, so it never sits idle waiting for the next one to arrive.
+            u32 inflight { 2 };
+
+            // Give up on a frame when no worker has been connected for this long.
+            f64 workerTimeout { 30.0 };
+
+            // Drop a worker that has tiles outstanding but has returned nothing for this long.
+            f64 tileTimeout { 300.0 };
+
+            u32 writerThreads { 2 };
+        };
+
+        struct Stats
+        {
+            u32 jobs { 0 };
+            u32 failed { 0 };
+            u32 tiles { 0 };
+            u32 reassigned { 0 };
+            u32 workersLost { 0 };
+            f64 wallTime { 0.0 };
+            u64 samples { 0 };
+        };
+
+    public:
+        Coordinator(const Settings& settings);
+        ~Coordinator();
+
+        Coordinator(const Coordinator&) = delete;
+        Coordinator& operator=(const Coordinator&) = delete;
+
+        bool Listen();
+
+        // Launches `count` workers from `executable` on this machine, connecting back to our address.
+        bool SpawnLocalWorkers(const std::filesystem::path& executable, u32 count, u32 threadsPerWorker);
+
+        Stats Run(std::span<const Batch::Job> jobs);
+
+    private:
+        struct Connection
+        {
+            Socket socket;
+            u32 id { 0 };
+            u32 threads { 0 };
+            bool ready { false };
+            bool closed { false };
+
+            std::optional<u32> frameId;
+            std::vector<u32> inflight;
+            std::chrono::steady_clock::time_point lastResult;
+
+            u32 tiles { 0 };
+            f64 renderTime { 0.0 };
+        };
+
+        struct Frame
+        {
+            u32 id { 0 };
+            const Batch::Job* job { nullptr };
+            std::string scene;
+            Scene::CameraData camera {};
+
+            std::vector<CPU::TileScheduler::Tile> tiles;
+            std::deque<u32> pending;
+            std::vector<bool> done;
+            u32 remaining { 0 };
+            bool failed { false };
+
+            std::vector<glm::vec4> image;
+        };
+
+    private:
+        bool RenderFrame(Frame& frame, Stats& stats);
+
+        void Accept();
+        void Dispatch(Frame& frame);
+        void Handle(Connection& connection, Frame& frame, Stats& stats);
+        void Drop(Connection& connection, Frame& frame, Stats& stats, std::string_view reason);
+
+        void Shutdown();
+
+    private:
+        Settings m_Settings;
+        Socket m_Listener;
+
+        std::vector<std::unique_ptr<Connection>> m_Connections;
+        u32 m_NextConnectionId { 0 };
+        u32 m_NextFrameId { 0 };
+
+        std::vector<i32> m_Children;
+
+        Image::ImageWriter m_Writer;
+    };
+
+}
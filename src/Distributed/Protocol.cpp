@@ -0,0 +1,51 @@
+#include "Protocol.hpp"
+
+namespace Distributed {
+
+    bool SendMessage(const Socket& socket, MessageType type, std::span<const u8> body, std::span<const u8> tail)
+    {
+        const usize size = body.size() + tail.size();
+        if (size > MAX_MESSAGE_SIZE) {
+            LOG_ERROR("Message of {} bytes exceeds the protocol limit", size);
+            return false;
+        }
+
+        MessageHeader header {
+            .type = type,
+            .size = static_cast<u32>(size)
+        };
+
+        // Header and fixed body go out in one write; large tails are sent directly from the caller's buffer.
+        std::array<u8, sizeof(MessageHeader) + 256> prefix;
+        if (body.size() <= prefix.size() - sizeof(MessageHeader)) {
+            std::memcpy(prefix.data(), &header, sizeof(header));
+            if (!body.empty()) std::memcpy(prefix.data() + sizeof(header), body.data(), body.size());
+
+            if (!socket.SendAll(prefix.data(), sizeof(header) + body.size())) return false;
+        } else if (!socket.SendAll(&header, sizeof(header)) || !socket.SendAll(body.data(), body.size())) {
+            return false;
+        }
+
+        return tail.empty() || socket.SendAll(tail.data(), tail.size());
+    }
+
+    std::optional<Message> ReceiveMessage(const Socket& socket)
+    {
+        MessageHeader header;
+        if (!socket.ReceiveAll(&header, sizeof(header))) return std::nullopt;
+
+        if (header.magic != PROTOCOL_MAGIC || header.size > MAX_MESSAGE_SIZE) {
+            LOG_ERROR("Received malformed message header");
+            return std::nullopt;
+        }
+
+        Message message;
+        message.type = header.type;
+        message.payload.resize(header.size);
+
+        if (header.size > 0 && !socket.ReceiveAll(message.payload.data(), header.size)) return std::nullopt;
+
+        return message;
+    }
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Socket.hpp"
+
+#include "Scene/Camera.hpp"
+
+namespace Distributed {
+
+    // Every message is a fixed 12 byte header followed by `size` payload bytes: a message specific
+    // struct, then an optional variable tail (scene path, pixels, error text). Fields are sent in host
+    // byte order, so coordinator and workers must share endianness.
+    inline constexpr u32 PROTOCOL_MAGIC { 0x574E5450 }; // "PTNW"
+    inline constexpr u32 PROTOCOL_VERSION { 1 };
+    inline constexpr u32 MAX_MESSAGE_SIZE { 256u << 20 };
+
+    static_assert(std::endian::native == std::endian::little);
+
+    enum class MessageType : u16
+    {
+        Hello,
+        Frame,
+        Tile,
+        TileResult,
+        Error,
+        Shutdown
+    };
+
+    struct MessageHeader
+    {
+        u32 magic { PROTOCOL_MAGIC };
+        MessageType type { MessageType::Hello };
+        u16 flags { 0 };
+        u32 size { 0 };
+    };
+
+    static_assert(sizeof(MessageHeader) == 12);
+
+    // Worker -> coordinator, once after connecting.
+    struct HelloMessage
+    {
+        u32 version { PROTOCOL_VERSION };
+        u32 threads { 0 };
+    };
+
+    // Coordinator -> worker before the first tile of a frame it sends that worker. Tail: scene path.
+    struct FrameMessage
+    {
+        u32 frameId { 0 };
+        u32 width { 0 };
+        u32 height { 0 };
+        u32 samples { 0 };
+        u32 seed { 0 };
+        u32 sobol { 1 };
+        Scene::CameraData camera {};
+    };
+
+    struct TileMessage
+    {
+        u32 frameId { 0 };
+        u32 tileId { 0 };
+        u32 x { 0 };
+        u32 y { 0 };
+        u32 width { 0 };
+        u32 height { 0 };
+    };
+
+    // Worker -> coordinator. Tail: width * height RGB f32 mean radiance, row by row.
+    struct TileResultMessage
+    {
+        u32 frameId { 0 };
+        u32 tileId { 0 };
+        f64 renderTime { 0.0 };
+    };
+
+    // Worker -> coordinator when a frame cannot be rendered at all. Tail: message text.
+    struct ErrorMessage
+    {
+        u32 frameId { 0 };
+    };
+
+    struct Message
+    {
+        MessageType type { MessageType::Hello };
+        std::vector<u8> payload;
+
+        // Fixed part of the payload, or nullopt if the message is too short to hold a T.
+        template <typename T>
+        std::optional<T> Get() const
+        {
+            if (payload.size() < sizeof(T)) return std::nullopt;
+
+            T value;
+            std::memcpy(&value, payload.data(), sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        std::span<const u8> GetTail() const
+        {
+            if (payload.size() < sizeof(T)) return {};
+            return std::span<const u8>(payload).subspan(sizeof(T));
+        }
+    };
+
+    bool SendMessage(const Socket& socket, MessageType type, std::span<const u8> body, std::span<const u8> tail = {});
+
+    template <typename T>
+    inline bool SendMessage(const Socket& socket, MessageType type, const T& body, std::span<const u8> tail = {})
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return SendMessage(socket, type, std::span<const u8>(reinterpret_cast<const u8*>(&body), sizeof(T)), tail);
+    }
+
+    std::optional<Message> ReceiveMessage(const Socket& socket);
+
+}
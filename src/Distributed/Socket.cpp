@@ -0,0 +1,273 @@
+#include "Socket.hpp"
+
+#if !defined(_WIN32)
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace Distributed {
+
+    namespace {
+
+        struct Address
+        {
+            bool local { false };
+            std::string path;
+            std::string host;
+            std::string port;
+        };
+
+#if !defined(_WIN32)
+        void ConfigureStream(i32 handle, bool tcp)
+        {
+            if (tcp) {
+                i32 noDelay = 1;
+                setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            }
+
+#if defined(SO_NOSIGPIPE)
+            i32 noSigPipe = 1;
+            setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+        }
+#endif
+
+        std::optional<Address> ParseAddress(std::string_view address)
+        {
+            Address result;
+
+            if (address.starts_with("unix:")) {
+                result.local = true;
+                result.path = address.substr(5);
+                return result.path.empty() ? std::nullopt : std::optional(result);
+            }
+
+            if (address.starts_with("tcp:")) address.remove_prefix(4);
+
+            usize colon = address.rfind(':');
+            if (colon == std::string_view::npos || colon + 1 == address.size()) {
+                LOG_ERROR("Invalid address '{}', expected unix:<path> or <host>:<port>", address);
+                return std::nullopt;
+            }
+
+            result.host = address.substr(0, colon);
+            result.port = address.substr(colon + 1);
+            if (result.host.empty()) result.host = "0.0.0.0";
+
+            return result;
+        }
+
+    }
+
+#if defined(_WIN32)
+
+    Socket::Socket(i32 handle) : m_Handle(handle) {}
+    Socket::~Socket() = default;
+    Socket::Socket(Socket&& other) noexcept : m_Handle(std::exchange(other.m_Handle, -1)) {}
+    Socket& Socket::operator=(Socket&& other) noexcept { m_Handle = std::exchange(other.m_Handle, -1); return *this; }
+
+    std::optional<Socket> Socket::Connect(std::string_view) { LOG_ERROR("Distributed rendering is not supported on Windows yet"); return std::nullopt; }
+    std::optional<Socket> Socket::Listen(std::string_view, u32) { LOG_ERROR("Distributed rendering is not supported on Windows yet"); return std::nullopt; }
+    std::optional<Socket> Socket::Accept() const { return std::nullopt; }
+    bool Socket::SendAll(const void*, usize) const { return false; }
+    bool Socket::ReceiveAll(void*, usize) const { return false; }
+    void Socket::Close() { m_Handle = -1; }
+
+#else
+
+    Socket::Socket(i32 handle)
+        : m_Handle(handle)
+    {
+    }
+
+    Socket::~Socket()
+    {
+        Close();
+    }
+
+    Socket::Socket(Socket&& other) noexcept
+        : m_Handle(std::exchange(other.m_Handle, -1)), m_UnixPath(std::move(other.m_UnixPath))
+    {
+        other.m_UnixPath.clear();
+    }
+
+    Socket& Socket::operator=(Socket&& other) noexcept
+    {
+        if (this != &other) {
+            Close();
+            m_Handle = std::exchange(other.m_Handle, -1);
+            m_UnixPath = std::move(other.m_UnixPath);
+            other.m_UnixPath.clear();
+        }
+        return *this;
+    }
+
+    std::optional<Socket> Socket::Connect(std::string_view address)
+    {
+        auto parsed = ParseAddress(address);
+        if (!parsed) return std::nullopt;
+
+        if (parsed->local) {
+            sockaddr_un addr {};
+            addr.sun_family = AF_UNIX;
+            if (parsed->path.size() >= sizeof(addr.sun_path)) {
+                LOG_ERROR("Unix socket path too long: {}", parsed->path);
+                return std::nullopt;
+            }
+            std::memcpy(addr.sun_path, parsed->path.c_str(), parsed->path.size() + 1);
+
+            Socket socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+            if (!socket.IsValid() || ::connect(socket.m_Handle, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+                return std::nullopt;
+            }
+
+            ConfigureStream(socket.m_Handle, false);
+            return socket;
+        }
+
+        addrinfo hints {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        addrinfo* results = nullptr;
+        if (getaddrinfo(parsed->host.c_str(), parsed->port.c_str(), &hints, &results) != 0) {
+            LOG_ERROR("Failed to resolve {}", address);
+            return std::nullopt;
+        }
+
+        std::optional<Socket> connected;
+        for (addrinfo* info = results; info && !connected; info = info->ai_next) {
+            Socket socket(::socket(info->ai_family, info->ai_socktype, info->ai_protocol));
+            if (!socket.IsValid()) continue;
+
+            if (::connect(socket.m_Handle, info->ai_addr, info->ai_addrlen) == 0) {
+                ConfigureStream(socket.m_Handle, true);
+                connected = std::move(socket);
+            }
+        }
+
+        freeaddrinfo(results);
+        return connected;
+    }
+
+    std::optional<Socket> Socket::Listen(std::string_view address, u32 backlog)
+    {
+        auto parsed = ParseAddress(address);
+        if (!parsed) return std::nullopt;
+
+        if (parsed->local) {
+            sockaddr_un addr {};
+            addr.sun_family = AF_UNIX;
+            if (parsed->path.size() >= sizeof(addr.sun_path)) {
+                LOG_ERROR("Unix socket path too long: {}", parsed->path);
+                return std::nullopt;
+            }
+            std::memcpy(addr.sun_path, parsed->path.c_str(), parsed->path.size() + 1);
+
+            // A stale socket file from a crashed coordinator would make bind fail.
+            ::unlink(parsed->path.c_str());
+
+            Socket socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+            if (!socket.IsValid() || ::bind(socket.m_Handle, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+                || ::listen(socket.m_Handle, static_cast<i32>(backlog)) != 0) {
+                LOG_ERROR("Failed to listen on {}", address);
+                return std::nullopt;
+            }
+
+            socket.m_UnixPath = parsed->path;
+            return socket;
+        }
+
+        addrinfo hints {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+
+        addrinfo* results = nullptr;
+        if (getaddrinfo(parsed->host.c_str(), parsed->port.c_str(), &hints, &results) != 0) {
+            LOG_ERROR("Failed to resolve {}", address);
+            return std::nullopt;
+        }
+
+        std::optional<Socket> listening;
+        for (addrinfo* info = results; info && !listening; info = info->ai_next) {
+            Socket socket(::socket(info->ai_family, info->ai_socktype, info->ai_protocol));
+            if (!socket.IsValid()) continue;
+
+            i32 reuse = 1;
+            setsockopt(socket.m_Handle, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+            if (::bind(socket.m_Handle, info->ai_addr, info->ai_addrlen) == 0 && ::listen(socket.m_Handle, static_cast<i32>(backlog)) == 0) {
+                listening = std::move(socket);
+            }
+        }
+
+        freeaddrinfo(results);
+
+        if (!listening) LOG_ERROR("Failed to listen on {}", address);
+        return listening;
+    }
+
+    std::optional<Socket> Socket::Accept() const
+    {
+        i32 handle = ::accept(m_Handle, nullptr, nullptr);
+        if (handle < 0) return std::nullopt;
+
+        ConfigureStream(handle, m_UnixPath.empty());
+        return Socket(handle);
+    }
+
+    bool Socket::SendAll(const void* data, usize size) const
+    {
+#if defined(MSG_NOSIGNAL)
+        constexpr i32 flags = MSG_NOSIGNAL;
+#else
+        constexpr i32 flags = 0;
+#endif
+
+        const auto* bytes = static_cast<const u8*>(data);
+        while (size > 0) {
+            ssize_t sent = ::send(m_Handle, bytes, size, flags);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return false;
+
+            bytes += sent;
+            size -= static_cast<usize>(sent);
+        }
+        return true;
+    }
+
+    bool Socket::ReceiveAll(void* data, usize size) const
+    {
+        auto* bytes = static_cast<u8*>(data);
+        while (size > 0) {
+            ssize_t received = ::recv(m_Handle, bytes, size, 0);
+            if (received < 0 && errno == EINTR) continue;
+            if (received <= 0) return false;
+
+            bytes += received;
+            size -= static_cast<usize>(received);
+        }
+        return true;
+    }
+
+    void Socket::Close()
+    {
+        if (m_Handle >= 0) {
+            ::close(m_Handle);
+            m_Handle = -1;
+        }
+
+        if (!m_UnixPath.empty()) {
+            ::unlink(m_UnixPath.c_str());
+            m_UnixPath.clear();
+        }
+    }
+
+#endif
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace Distributed {
+
+    // Blocking stream socket. Addresses are "unix:/path/to/socket" or "[tcp:]host:port".
+    class Socket
+    {
+    public:
+        Socket() = default;
+        explicit Socket(i32 handle);
+        ~Socket();
+
+        Socket(Socket&& other) noexcept;
+        Socket& operator=(Socket&& other) noexcept;
+
+        Socket(const Socket&) = delete;
+        Socket& operator=(const Socket&) = delete;
+
+        static std::optional<Socket> Connect(std::string_view address);
+        static std::optional<Socket> Listen(std::string_view address, u32 backlog);
+
+        std::optional<Socket> Accept() const;
+
+        bool SendAll(const void* data, usize size) const;
+        bool ReceiveAll(void* data, usize size) const;
+
+        void Close();
+
+        inline bool IsValid() const { return m_Handle >= 0; }
+        inline i32 GetHandle() const { return m_Handle; }
+
+    private:
+        i32 m_Handle { -1 };
+        std::filesystem::path m_UnixPath;
+    };
+
+}
@@ -0,0 +1,168 @@
+#include "Worker.hpp"
+
+#include "Scene/SceneLoader.hpp"
+
+namespace Distributed {
+
+    Worker::Worker(const Settings& settings)
+        : m_Settings(settings)
+    {
+        m_Settings.maxCachedScenes = std::max(1u, m_Settings.maxCachedScenes);
+    }
+
+    bool Worker::Run()
+    {
+        // The coordinator may still be starting up, so keep retrying for a while.
+        auto start = std::chrono::steady_clock::now();
+        while (true) {
+            if (auto socket = Socket::Connect(m_Settings.address)) {
+                m_Socket = std::move(*socket);
+                break;
+            }
+
+            std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= m_Settings.connectTimeout) {
+                LOG_ERROR("Failed to connect to coordinator at {}", m_Settings.address);
+                return false;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        const u32 threads = m_Settings.threads > 0 ? m_Settings.threads : std::max(1u, std::thread::hardware_concurrency());
+        if (!SendMessage(m_Socket, MessageType::Hello, HelloMessage { .threads = threads })) {
+            LOG_ERROR("Failed to send hello to {}", m_Settings.address);
+            return false;
+        }
+
+        LOG_INFO("Worker connected to {} with {} threads", m_Settings.address, threads);
+
+        u32 tiles = 0;
+        f64 renderTime = 0.0;
+
+        while (auto message = ReceiveMessage(m_Socket)) {
+            switch (message->type) {
+                case MessageType::Frame:
+                    if (!BeginFrame(*message)) return false;
+                    break;
+                case MessageType::Tile: {
+                    auto start = std::chrono::steady_clock::now();
+                    if (!RenderTile(*message)) return false;
+
+                    std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+                    renderTime += elapsed.count();
+                    tiles++;
+                } break;
+                case MessageType::Shutdown:
+                    LOG_INFO("Worker shutting down after {} tiles ({:.2f} s rendering)", tiles, renderTime);
+                    return true;
+                default:
+                    LOG_WARN("Worker ignoring unexpected message {}", static_cast<u32>(message->type));
+                    break;
+            }
+        }
+
+        LOG_ERROR("Lost connection to coordinator at {}", m_Settings.address);
+        return false;
+    }
+
+    CPU::Tracer* Worker::Acquire(const std::string& path)
+    {
+        auto it = std::ranges::find(m_Scenes, path, &CachedScene::path);
+        if (it != m_Scenes.end()) {
+            it->lastUse = ++m_UseCounter;
+            return it->tracer.get();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        auto scene = Scene::GlTFLoader::Load(path);
+        if (!scene) return nullptr;
+
+        if (m_Scenes.size() >= m_Settings.maxCachedScenes) {
+            auto lru = std::ranges::min_element(m_Scenes, {}, &CachedScene::lastUse);
+            if (lru->tracer.get() == m_Tracer) m_Tracer = nullptr;
+            m_Scenes.erase(lru);
+        }
+
+        auto tracer = std::make_unique<CPU::Tracer>(std::make_shared<Scene::SceneData>(std::move(*scene)), Renderer::Settings {
+            .width = 1,
+            .height = 1,
+            .samples = 1,
+            .tile = m_Settings.tile
+        }, CPU::Tracer::Options {
+            .threads = m_Settings.threads,
+            .pinThreads = m_Settings.pinThreads
+        });
+
+        std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+        LOG_INFO("Worker loaded {} in {:.2f} ms", path, elapsed.count() * 1000.0);
+
+        auto& cached = m_Scenes.emplace_back(CachedScene { path, std::move(tracer), ++m_UseCounter });
+        return cached.tracer.get();
+    }
+
+    bool Worker::BeginFrame(const Message& message)
+    {
+        auto frame = message.Get<FrameMessage>();
+        if (!frame) return false;
+
+        auto tail = message.GetTail<FrameMessage>();
+        std::string path(reinterpret_cast<const char*>(tail.data()), tail.size());
+
+        m_FrameId.reset();
+        m_Tracer = Acquire(path);
+
+        if (!m_Tracer) {
+            std::string error = "failed to load " + path;
+            return SendMessage(m_Socket, MessageType::Error, ErrorMessage { .frameId = frame->frameId },
+                std::span<const u8>(reinterpret_cast<const u8*>(error.data()), error.size()));
+        }
+
+        if (m_Tracer->GetWidth() != frame->width || m_Tracer->GetHeight() != frame->height) {
+            m_Tracer->Resize(frame->width, frame->height);
+        }
+
+        m_Tracer->SetSampleCount(frame->samples);
+        m_Tracer->SetSampleSequence(CPU::SampleSequence(frame->sobol ? CPU::SampleSequence::Type::Sobol : CPU::SampleSequence::Type::Random, frame->seed));
+
+        m_Camera = frame->camera;
+        m_FrameId = frame->frameId;
+
+        return true;
+    }
+
+    bool Worker::RenderTile(const Message& message)
+    {
+        auto tile = message.Get<TileMessage>();
+        if (!tile) return false;
+
+        // Tiles of a frame this worker could not set up are dropped; the coordinator already has the error.
+        if (!m_Tracer || m_FrameId != tile->frameId) return true;
+
+        if (tile->x + tile->width > m_Tracer->GetWidth() || tile->y + tile->height > m_Tracer->GetHeight()) {
+            LOG_ERROR("Tile {} lies outside the {}x{} frame", tile->tileId, m_Tracer->GetWidth(), m_Tracer->GetHeight());
+            return false;
+        }
+
+        const CPU::TileScheduler::Tile rect {
+            .x = tile->x,
+            .y = tile->y,
+            .width = tile->width,
+            .height = tile->height
+        };
+
+        m_Radiance.resize(static_cast<usize>(rect.width) * rect.height);
+        auto stats = m_Tracer->RenderTile(m_Camera, rect, m_Radiance);
+
+        TileResultMessage result {
+            .frameId = tile->frameId,
+            .tileId = tile->tileId,
+            .renderTime = stats.wallTime
+        };
+
+        return SendMessage(m_Socket, MessageType::TileResult, result,
+            std::span<const u8>(reinterpret_cast<const u8*>(m_Radiance.data()), m_Radiance.size() * sizeof(glm::vec3)));
+    }
+
+}
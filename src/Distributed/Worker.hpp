@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Protocol.hpp"
+
+#include "CPU/Tracer.hpp"
+
+namespace Distributed {
+
+    // Connects to a coordinator and renders whatever tiles it is handed until told to shut down. Scenes
+    // are loaded once and kept together with their BVH, so a worker pays the load cost only on the
+    // first frame that uses a scene.
+    class Worker
+    {
+    public:
+        struct Settings
+        {
+            std::string address;
+            u32 threads { 0 };
+            u32 tile { 32 };
+            u32 maxCachedScenes { 2 };
+            f64 connectTimeout { 30.0 };
+            bool pinThreads { false };
+        };
+
+    public:
+        Worker(const Settings& settings);
+
+        // Returns false if the connection could not be established or was lost before a shutdown request.
+        bool Run();
+
+    private:
+        struct CachedScene
+        {
+            std::string path;
+            std::unique_ptr<CPU::Tracer> tracer;
+            u64 lastUse { 0 };
+        };
+
+    private:
+        CPU::Tracer* Acquire(const std::string& path);
+
+        bool BeginFrame(const Message& message);
+        bool RenderTile(const Message& message);
+
+    private:
+        Settings m_Settings;
+        Socket m_Socket;
+
+        std::vector<CachedScene> m_Scenes;
+        u64 m_UseCounter { 0 };
+
+        CPU::Tracer* m_Tracer { nullptr };
+        Scene::CameraData m_Camera {};
+        std::optional<u32> m_FrameId;
+
+        std::vector<glm::vec3> m_Radiance;
+    };
+
+}
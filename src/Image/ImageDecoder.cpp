@@ -0,0 +1,375 @@
+#include "ImageDecoder.hpp"
+
+#include <stb_image.h>
+#include <glm/gtc/packing.hpp>
+
+namespace Image {
+
+    namespace {
+
+        static_assert(std::endian::native == std::endian::little, "EXR and PFM are read in host byte order");
+
+        inline constexpr u32 EXR_MAGIC { 20000630 };
+        inline constexpr u32 EXR_TILED_BIT { 0x200 };
+        inline constexpr u32 EXR_DEEP_BIT { 0x800 };
+        inline constexpr u32 EXR_MULTIPART_BIT { 0x1000 };
+
+        enum class EXRPixelType : i32
+        {
+            UInt,
+            Half,
+            Float
+        };
+
+        struct EXRChannel
+        {
+            std::string_view name;
+            EXRPixelType type { EXRPixelType::Half };
+            i32 target { -1 };
+        };
+
+        class Reader
+        {
+        public:
+            Reader(std::span<const u8> data, usize offset = 0)
+                : m_Data(data), m_Offset(offset) {}
+
+            template <typename T>
+            bool Read(T& value)
+            {
+                if (m_Offset + sizeof(T) > m_Data.size()) return false;
+                std::memcpy(&value, m_Data.data() + m_Offset, sizeof(T));
+                m_Offset += sizeof(T);
+                return true;
+            }
+
+            bool ReadString(std::string_view& value)
+            {
+                const auto* begin = m_Data.data() + m_Offset;
+                const auto* end = std::find(begin, m_Data.data() + m_Data.size(), u8 { 0 });
+                if (end == m_Data.data() + m_Data.size()) return false;
+
+                value = std::string_view(reinterpret_cast<const char*>(begin), static_cast<usize>(end - begin));
+                m_Offset += value.size() + 1;
+                return true;
+            }
+
+            bool Skip(usize bytes)
+            {
+                if (m_Offset + bytes > m_Data.size()) return false;
+                m_Offset += bytes;
+                return true;
+            }
+
+            inline usize GetOffset() const { return m_Offset; }
+
+        private:
+            std::span<const u8> m_Data;
+            usize m_Offset { 0 };
+        };
+
+        // Inverse of ImageEncoder's CompressEXRBlock: inflate, undo the byte delta, then re-interleave the
+        // two halves. A chunk no smaller than its raw size was stored uncompressed.
+        bool DecompressEXRBlock(std::span<const u8> chunk, std::vector<u8>& scratch, std::vector<u8>& raw)
+        {
+            const usize n = raw.size();
+            if (chunk.size() >= n) {
+                if (chunk.size() != n) return false;
+                std::memcpy(raw.data(), chunk.data(), n);
+                return true;
+            }
+
+            scratch.resize(n);
+            const i32 length = stbi_zlib_decode_buffer(reinterpret_cast<char*>(scratch.data()), static_cast<i32>(n),
+                reinterpret_cast<const char*>(chunk.data()), static_cast<i32>(chunk.size()));
+            if (length != static_cast<i32>(n)) return false;
+
+            for (usize i = 1; i < n; ++i) {
+                scratch[i] = static_cast<u8>(static_cast<i32>(scratch[i - 1]) + scratch[i] - 128);
+            }
+
+            usize half = (n + 1) / 2;
+            for (usize i = 0; i < n; ++i) {
+                raw[i] = scratch[(i & 1) ? half + i / 2 : i / 2];
+            }
+
+            return true;
+        }
+
+    }
+
+    std::optional<DecodedImage> ImageDecoder::Load(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            LOG_ERROR("Failed to open image {}", path.string());
+            return std::nullopt;
+        }
+
+        std::vector<u8> data(static_cast<usize>(file.tellg()));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+            LOG_ERROR("Failed to read image {}", path.string());
+            return std::nullopt;
+        }
+
+        auto image = Decode(ImageEncoder::FormatFromPath(path), data);
+        if (!image) {
+            LOG_ERROR("Failed to decode image {}", path.string());
+        }
+
+        return image;
+    }
+
+    std::optional<DecodedImage> ImageDecoder::Decode(std::optional<Format> format, std::span<const u8> data)
+    {
+        if (format == Format::PFM) return DecodePFM(data);
+        if (format == Format::EXRHalf || format == Format::EXRFloat) return DecodeEXR(data);
+
+        return DecodeSTB(data);
+    }
+
+    std::optional<DecodedImage> ImageDecoder::DecodeSTB(std::span<const u8> data)
+    {
+        i32 width = 0;
+        i32 height = 0;
+        i32 channels = 0;
+
+        f32* pixels = stbi_loadf_from_memory(data.data(), static_cast<i32>(data.size()), &width, &height, &channels, 4);
+        if (!pixels) return std::nullopt;
+
+        DecodedImage image;
+        image.width = static_cast<u32>(width);
+        image.height = static_cast<u32>(height);
+        image.pixels.resize(static_cast<usize>(width) * height);
+        std::memcpy(image.pixels.data(), pixels, image.pixels.size() * sizeof(glm::vec4));
+
+        stbi_image_free(pixels);
+        return image;
+    }
+
+    std::optional<DecodedImage> ImageDecoder::DecodePFM(std::span<const u8> data)
+    {
+        // Three whitespace-separated header tokens after the magic, then a single whitespace byte.
+        std::string_view text(reinterpret_cast<const char*>(data.data()), std::min<usize>(data.size(), 256));
+
+        std::array<std::string_view, 4> tokens;
+        usize cursor = 0;
+
+        for (auto& token : tokens) {
+            cursor = text.find_first_not_of(" \t\r\n", cursor);
+            if (cursor == std::string_view::npos) return std::nullopt;
+
+            const usize end = text.find_first_of(" \t\r\n", cursor);
+            if (end == std::string_view::npos) return std::nullopt;
+
+            token = text.substr(cursor, end - cursor);
+            cursor = end;
+        }
+
+        const u32 channels = tokens[0] == "PF" ? 3 : tokens[0] == "Pf" ? 1 : 0;
+        if (channels == 0) return std::nullopt;
+
+        u32 width = 0;
+        u32 height = 0;
+        f32 scale = 0.0f;
+        std::from_chars(tokens[1].data(), tokens[1].data() + tokens[1].size(), width);
+        std::from_chars(tokens[2].data(), tokens[2].data() + tokens[2].size(), height);
+        std::from_chars(tokens[3].data(), tokens[3].data() + tokens[3].size(), scale);
+
+        const usize offset = cursor + 1;
+        const usize rowFloats = static_cast<usize>(width) * channels;
+        if (width == 0 || height == 0 || scale == 0.0f || data.size() < offset + rowFloats * height * sizeof(f32)) return std::nullopt;
+
+        DecodedImage image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(static_cast<usize>(width) * height);
+
+        // A positive scale marks big-endian data; rows are stored bottom to top.
+        const bool swap = scale > 0.0f;
+        const u8* src = data.data() + offset;
+
+        for (u32 y = height; y-- > 0;) {
+            glm::vec4* row = image.pixels.data() + static_cast<usize>(y) * width;
+
+            for (u32 x = 0; x < width; ++x) {
+                glm::vec3 value;
+                for (u32 c = 0; c < channels; ++c) {
+                    u32 bits;
+                    std::memcpy(&bits, src, sizeof(u32));
+                    if (swap) bits = std::byteswap(bits);
+                    value[c] = std::bit_cast<f32>(bits);
+                    src += sizeof(u32);
+                }
+
+                row[x] = channels == 3 ? glm::vec4(value, 1.0f) : glm::vec4(glm::vec3(value.x), 1.0f);
+            }
+        }
+
+        return image;
+    }
+
+    std::optional<DecodedImage> ImageDecoder::DecodeEXR(std::span<const u8> data)
+    {
+        Reader reader(data);
+
+        u32 magic = 0;
+        u32 version = 0;
+        if (!reader.Read(magic) || !reader.Read(version) || magic != EXR_MAGIC) return std::nullopt;
+
+        if (version & (EXR_TILED_BIT | EXR_DEEP_BIT | EXR_MULTIPART_BIT)) {
+            LOG_ERROR("Only single-part scanline EXR files are supported");
+            return std::nullopt;
+        }
+
+        std::vector<EXRChannel> channels;
+        bool luminanceOnly = true;
+        u8 compression = 255;
+        std::array<i32, 4> window { 0, 0, -1, -1 };
+
+        for (;;) {
+            std::string_view name;
+            if (!reader.ReadString(name)) return std::nullopt;
+            if (name.empty()) break;
+
+            std::string_view type;
+            i32 size = 0;
+            if (!reader.ReadString(type) || !reader.Read(size) || size < 0) return std::nullopt;
+
+            const usize next = reader.GetOffset() + static_cast<usize>(size);
+
+            if (name == "channels") {
+                for (;;) {
+                    std::string_view channel;
+                    if (!reader.ReadString(channel)) return std::nullopt;
+                    if (channel.empty()) break;
+
+                    i32 pixelType = 0;
+                    i32 xSampling = 0;
+                    i32 ySampling = 0;
+                    if (!reader.Read(pixelType) || !reader.Skip(4) || !reader.Read(xSampling) || !reader.Read(ySampling)) return std::nullopt;
+
+                    if (pixelType < 0 || pixelType > 2 || xSampling != 1 || ySampling != 1) {
+                        LOG_ERROR("Unsupported EXR channel '{}'", channel);
+                        return std::nullopt;
+                    }
+
+                    i32 target = -1;
+                    if (channel == "R") target = 0;
+                    else if (channel == "G") target = 1;
+                    else if (channel == "B") target = 2;
+                    else if (channel == "A") target = 3;
+
+                    if (target >= 0 && target < 3) luminanceOnly = false;
+
+                    channels.push_back(EXRChannel { channel, static_cast<EXRPixelType>(pixelType), target });
+                }
+            } else if (name == "compression") {
+                if (!reader.Read(compression)) return std::nullopt;
+            } else if (name == "dataWindow") {
+                for (auto& value : window) {
+                    if (!reader.Read(value)) return std::nullopt;
+                }
+            }
+
+            reader = Reader(data, next);
+        }
+
+        // 0 none, 2 ZIPS (one line per chunk), 3 ZIP (16 lines).
+        if (compression != 0 && compression != 2 && compression != 3) {
+            LOG_ERROR("Unsupported EXR compression {}", compression);
+            return std::nullopt;
+        }
+
+        const i64 width = static_cast<i64>(window[2]) - window[0] + 1;
+        const i64 height = static_cast<i64>(window[3]) - window[1] + 1;
+        if (channels.empty() || width <= 0 || height <= 0) return std::nullopt;
+
+        if (luminanceOnly) {
+            for (auto& channel : channels) {
+                if (channel.name == "Y") channel.target = 0;
+            }
+        }
+
+        usize pixelBytes = 0;
+        for (const auto& channel : channels) {
+            pixelBytes += channel.type == EXRPixelType::Half ? sizeof(u16) : sizeof(u32);
+        }
+
+        const u32 linesPerBlock = compression == 3 ? 16 : 1;
+        const u32 blockCount = static_cast<u32>((height + linesPerBlock - 1) / linesPerBlock);
+
+        DecodedImage image;
+        image.width = static_cast<u32>(width);
+        image.height = static_cast<u32>(height);
+        image.pixels.assign(static_cast<usize>(width) * height, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+        std::vector<u8> raw;
+        std::vector<u8> scratch;
+
+        for (u32 block = 0; block < blockCount; ++block) {
+            u64 offset = 0;
+            if (!reader.Read(offset) || offset > data.size()) return std::nullopt;
+
+            Reader chunk(data, static_cast<usize>(offset));
+
+            i32 firstLine = 0;
+            i32 dataSize = 0;
+            if (!chunk.Read(firstLine) || !chunk.Read(dataSize) || dataSize < 0) return std::nullopt;
+
+            const i64 row = static_cast<i64>(firstLine) - window[1];
+            if (row < 0 || row >= height) return std::nullopt;
+
+            const u32 lines = static_cast<u32>(std::min<i64>(linesPerBlock, height - row));
+            if (chunk.GetOffset() + static_cast<usize>(dataSize) > data.size()) return std::nullopt;
+
+            const auto payload = data.subspan(chunk.GetOffset(), static_cast<usize>(dataSize));
+
+            raw.resize(static_cast<usize>(lines) * static_cast<usize>(width) * pixelBytes);
+            if (compression == 0) {
+                if (payload.size() != raw.size()) return std::nullopt;
+                std::memcpy(raw.data(), payload.data(), raw.size());
+            } else if (!DecompressEXRBlock(payload, scratch, raw)) {
+                return std::nullopt;
+            }
+
+            const u8* src = raw.data();
+            for (u32 line = 0; line < lines; ++line) {
+                glm::vec4* dst = image.pixels.data() + static_cast<usize>(row + line) * static_cast<usize>(width);
+
+                for (const auto& channel : channels) {
+                    for (i64 x = 0; x < width; ++x) {
+                        f32 value = 0.0f;
+
+                        if (channel.type == EXRPixelType::Half) {
+                            u16 bits;
+                            std::memcpy(&bits, src, sizeof(u16));
+                            value = glm::unpackHalf1x16(bits);
+                            src += sizeof(u16);
+                        } else if (channel.type == EXRPixelType::Float) {
+                            std::memcpy(&value, src, sizeof(f32));
+                            src += sizeof(f32);
+                        } else {
+                            u32 bits;
+                            std::memcpy(&bits, src, sizeof(u32));
+                            value = static_cast<f32>(bits);
+                            src += sizeof(u32);
+                        }
+
+                        if (channel.target >= 0) dst[x][channel.target] = value;
+                    }
+                }
+            }
+        }
+
+        if (luminanceOnly) {
+            for (auto& pixel : image.pixels) {
+                pixel = glm::vec4(glm::vec3(pixel.r), pixel.a);
+            }
+        }
+
+        return image;
+    }
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ImageEncoder.hpp"
+
+namespace Image {
+
+    struct DecodedImage
+    {
+        u32 width { 0 };
+        u32 height { 0 };
+        std::vector<glm::vec4> pixels;
+    };
+
+    // Reads linear RGBA float pixels (rows top to bottom), the inverse of ImageEncoder. EXR covers scanline
+    // files with no, ZIPS or ZIP compression and half, float or uint channels; missing channels read as
+    // 0 (alpha as 1) and a lone Y channel is spread over RGB. Everything else stb_image can open goes
+    // through stbi_loadf, which linearises 8-bit formats.
+    class ImageDecoder
+    {
+    public:
+        static std::optional<DecodedImage> Load(const std::filesystem::path& path);
+
+        static std::optional<DecodedImage> Decode(std::optional<Format> format, std::span<const u8> data);
+
+    private:
+        static std::optional<DecodedImage> DecodeSTB(std::span<const u8> data);
+        static std::optional<DecodedImage> DecodePFM(std::span<const u8> data);
+        static std::optional<DecodedImage> DecodeEXR(std::span<const u8> data);
+    };
+
+}
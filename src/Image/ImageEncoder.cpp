@@ -0,0 +1,278 @@
+#include "ImageEncoder.hpp"
+
+#include <stb_image_write.h>
+#include <glm/gtc/packing.hpp>
+
+// Not part of stb_image_write's public declarations, but exported by its implementation.
+extern "C" unsigned char* stbi_zlib_compress(unsigned char* data, int dataLength, int* outLength, int quality);
+
+namespace Image {
+
+    namespace {
+
+        static_assert(std::endian::native == std::endian::little, "EXR and PFM are written in host byte order");
+
+        inline constexpr u32 EXR_ZIP_LINES { 16 };
+        inline constexpr i32 EXR_ZLIB_QUALITY { 5 };
+
+        template <typename T>
+        void Append(std::vector<u8>& out, const T& value)
+        {
+            const auto* bytes = reinterpret_cast<const u8*>(&value);
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        }
+
+        void AppendString(std::vector<u8>& out, std::string_view value)
+        {
+            out.insert(out.end(), value.begin(), value.end());
+            out.push_back(0);
+        }
+
+        void AppendAttribute(std::vector<u8>& out, std::string_view name, std::string_view type, i32 size)
+        {
+            AppendString(out, name);
+            AppendString(out, type);
+            Append(out, size);
+        }
+
+        void StbWrite(void* context, void* data, i32 size)
+        {
+            auto* out = static_cast<std::vector<u8>*>(context);
+            const auto* bytes = static_cast<const u8*>(data);
+            out->insert(out->end(), bytes, bytes + size);
+        }
+
+        // OpenEXR's ZIP layout: split even and odd bytes, delta-encode, then deflate. Falls back to the raw
+        // bytes when compression does not help, which readers detect from the chunk size.
+        bool CompressEXRBlock(std::span<const u8> raw, std::vector<u8>& scratch, std::vector<u8>& out)
+        {
+            const usize n = raw.size();
+            scratch.resize(n);
+
+            usize half = (n + 1) / 2;
+            for (usize i = 0; i < n; ++i) {
+                scratch[(i & 1) ? half + i / 2 : i / 2] = raw[i];
+            }
+
+            u8 previous = scratch.empty() ? 0 : scratch[0];
+            for (usize i = 1; i < n; ++i) {
+                u8 current = scratch[i];
+                scratch[i] = static_cast<u8>(static_cast<i32>(current) - previous + 128 + 256);
+                previous = current;
+            }
+
+            i32 length = 0;
+            u8* compressed = stbi_zlib_compress(scratch.data(), static_cast<i32>(n), &length, EXR_ZLIB_QUALITY);
+            if (!compressed) return false;
+
+            if (static_cast<usize>(length) < n) {
+                out.insert(out.end(), compressed, compressed + length);
+            } else {
+                out.insert(out.end(), raw.begin(), raw.end());
+            }
+
+            std::free(compressed);
+            return true;
+        }
+
+    }
+
+    std::optional<Format> ImageEncoder::FormatFromPath(const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().string();
+        std::ranges::transform(extension, extension.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+
+        if (extension == ".png") return Format::PNG;
+        if (extension == ".hdr") return Format::HDR;
+        if (extension == ".pfm") return Format::PFM;
+        if (extension == ".exr") return Format::EXRHalf;
+
+        return std::nullopt;
+    }
+
+    std::string_view ImageEncoder::GetExtension(Format format)
+    {
+        switch (format) {
+            case Format::PNG: return ".png";
+            case Format::HDR: return ".hdr";
+            case Format::PFM: return ".pfm";
+            case Format::EXRHalf:
+            case Format::EXRFloat: return ".exr";
+        }
+
+        return "";
+    }
+
+    std::optional<std::vector<u8>> ImageEncoder::Encode(Format format, u32 width, u32 height, std::span<const glm::vec4> pixels, EXRCompression compression)
+    {
+        if (width == 0 || height == 0 || pixels.size() != static_cast<usize>(width) * height) {
+            LOG_ERROR("Image size {}x{} does not match {} pixels", width, height, pixels.size());
+            return std::nullopt;
+        }
+
+        switch (format) {
+            case Format::PNG: return EncodePNG(width, height, pixels);
+            case Format::HDR: return EncodeHDR(width, height, pixels);
+            case Format::PFM: return EncodePFM(width, height, pixels);
+            case Format::EXRHalf: return EncodeEXR(width, height, pixels, true, compression);
+            case Format::EXRFloat: return EncodeEXR(width, height, pixels, false, compression);
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::vector<u8>> ImageEncoder::EncodePNG(u32 width, u32 height, std::span<const glm::vec4> pixels)
+    {
+        std::vector<u8> bytes(pixels.size() * 3);
+        for (usize i = 0; i < pixels.size(); ++i) {
+            glm::vec3 color = glm::max(glm::vec3(pixels[i]), glm::vec3(0.0f));
+
+            color = color / (color + glm::vec3(1.0f));
+            color = glm::pow(color, glm::vec3(1.0f / 2.2f));
+
+            for (u32 c = 0; c < 3; ++c) {
+                bytes[i * 3 + c] = static_cast<u8>(std::clamp(color[c] * 255.0f + 0.5f, 0.0f, 255.0f));
+            }
+        }
+
+        std::vector<u8> out;
+        if (!stbi_write_png_to_func(StbWrite, &out, static_cast<i32>(width), static_cast<i32>(height), 3, bytes.data(), static_cast<i32>(width) * 3)) {
+            return std::nullopt;
+        }
+        return out;
+    }
+
+    std::optional<std::vector<u8>> ImageEncoder::EncodeHDR(u32 width, u32 height, std::span<const glm::vec4> pixels)
+    {
+        std::vector<u8> out;
+        if (!stbi_write_hdr_to_func(StbWrite, &out, static_cast<i32>(width), static_cast<i32>(height), 4, &pixels[0].x)) {
+            return std::nullopt;
+        }
+        return out;
+    }
+
+    std::vector<u8> ImageEncoder::EncodePFM(u32 width, u32 height, std::span<const glm::vec4> pixels)
+    {
+        // Negative scale marks little-endian data; rows are stored bottom to top.
+        std::string header = "PF\n" + std::to_string(width) + " " + std::to_string(height) + "\n-1.0\n";
+
+        std::vector<u8> out(header.begin(), header.end());
+
+        const usize rowBytes = static_cast<usize>(width) * 3 * sizeof(f32);
+        out.resize(header.size() + rowBytes * height);
+
+        u8* dst = out.data() + header.size();
+        for (u32 y = height; y-- > 0;) {
+            for (u32 x = 0; x < width; ++x) {
+                std::memcpy(dst, &pixels[static_cast<usize>(y) * width + x], 3 * sizeof(f32));
+                dst += 3 * sizeof(f32);
+            }
+        }
+
+        return out;
+    }
+
+    std::optional<std::vector<u8>> ImageEncoder::EncodeEXR(u32 width, u32 height, std::span<const glm::vec4> pixels, bool half, EXRCompression compression)
+    {
+        // Channels must be listed alphabetically, and are stored in that order within each scanline.
+        constexpr std::array<std::pair<std::string_view, u32>, 3> channels { {
+            { "B", 2 }, { "G", 1 }, { "R", 0 }
+        } };
+
+        const i32 pixelType = half ? 1 : 2;
+        const u32 channelSize = half ? sizeof(u16) : sizeof(f32);
+        const u32 linesPerBlock = compression == EXRCompression::ZIP ? EXR_ZIP_LINES : 1;
+        const u32 blockCount = (height + linesPerBlock - 1) / linesPerBlock;
+
+        std::vector<u8> out;
+        out.reserve(static_cast<usize>(width) * height * 3 * channelSize / (compression == EXRCompression::ZIP ? 2 : 1) + 1024);
+
+        Append(out, u32 { 20000630 });
+        Append(out, u32 { 2 });
+
+        AppendAttribute(out, "channels", "chlist", static_cast<i32>(channels.size() * 18 + 1));
+        for (const auto& [name, index] : channels) {
+            AppendString(out, name);
+            Append(out, pixelType);
+            Append(out, u32 { 0 });
+            Append(out, i32 { 1 });
+            Append(out, i32 { 1 });
+        }
+        out.push_back(0);
+
+        AppendAttribute(out, "compression", "compression", 1);
+        out.push_back(compression == EXRCompression::ZIP ? 3 : 0);
+
+        for (std::string_view window : { "dataWindow", "displayWindow" }) {
+            AppendAttribute(out, window, "box2i", 16);
+            Append(out, i32 { 0 });
+            Append(out, i32 { 0 });
+            Append(out, static_cast<i32>(width) - 1);
+            Append(out, static_cast<i32>(height) - 1);
+        }
+
+        AppendAttribute(out, "lineOrder", "lineOrder", 1);
+        out.push_back(0);
+
+        AppendAttribute(out, "pixelAspectRatio", "float", 4);
+        Append(out, 1.0f);
+
+        AppendAttribute(out, "screenWindowCenter", "v2f", 8);
+        Append(out, 0.0f);
+        Append(out, 0.0f);
+
+        AppendAttribute(out, "screenWindowWidth", "float", 4);
+        Append(out, 1.0f);
+
+        out.push_back(0);
+
+        const usize offsetTable = out.size();
+        out.resize(out.size() + blockCount * sizeof(u64));
+
+        std::vector<u8> raw;
+        std::vector<u8> scratch;
+
+        for (u32 block = 0; block < blockCount; ++block) {
+            const u32 firstLine = block * linesPerBlock;
+            const u32 lastLine = std::min(firstLine + linesPerBlock, height);
+
+            raw.resize(static_cast<usize>(lastLine - firstLine) * width * channels.size() * channelSize);
+            u8* dst = raw.data();
+
+            for (u32 y = firstLine; y < lastLine; ++y) {
+                const glm::vec4* row = pixels.data() + static_cast<usize>(y) * width;
+
+                for (const auto& [name, index] : channels) {
+                    for (u32 x = 0; x < width; ++x) {
+                        if (half) {
+                            const u16 value = static_cast<u16>(glm::packHalf1x16(row[x][index]));
+                            std::memcpy(dst, &value, sizeof(u16));
+                        } else {
+                            std::memcpy(dst, &row[x][index], sizeof(f32));
+                        }
+                        dst += channelSize;
+                    }
+                }
+            }
+
+            const u64 offset = out.size();
+            std::memcpy(out.data() + offsetTable + block * sizeof(u64), &offset, sizeof(u64));
+
+            Append(out, static_cast<i32>(firstLine));
+            const usize sizeField = out.size();
+            Append(out, i32 { 0 });
+
+            if (compression == EXRCompression::ZIP) {
+                if (!CompressEXRBlock(raw, scratch, out)) return std::nullopt;
+            } else {
+                out.insert(out.end(), raw.begin(), raw.end());
+            }
+
+            const i32 dataSize = static_cast<i32>(out.size() - sizeField - sizeof(i32));
+            std::memcpy(out.data() + sizeField, &dataSize, sizeof(i32));
+        }
+
+        return out;
+    }
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace Image {
+
+    enum class Format : u8
+    {
+        PNG,
+        HDR,
+        PFM,
+        EXRHalf,
+        EXRFloat
+    };
+
+    enum class EXRCompression : u8
+    {
+        None,
+        ZIP
+    };
+
+    // Encodes linear RGBA float pixels (rows top to bottom) into an in-memory file. Alpha is dropped by
+    // every format. PNG applies the same Reinhard and 2.2 gamma as post.frag; the others stay linear.
+    class ImageEncoder
+    {
+    public:
+        static std::optional<Format> FormatFromPath(const std::filesystem::path& path);
+        static std::string_view GetExtension(Format format);
+
+        static std::optional<std::vector<u8>> Encode(Format format, u32 width, u32 height, std::span<const glm::vec4> pixels, EXRCompression compression);
+
+    private:
+        static std::optional<std::vector<u8>> EncodePNG(u32 width, u32 height, std::span<const glm::vec4> pixels);
+        static std::optional<std::vector<u8>> EncodeHDR(u32 width, u32 height, std::span<const glm::vec4> pixels);
+        static std::vector<u8> EncodePFM(u32 width, u32 height, std::span<const glm::vec4> pixels);
+        static std::optional<std::vector<u8>> EncodeEXR(u32 width, u32 height, std::span<const glm::vec4> pixels, bool half, EXRCompression compression);
+    };
+
+}
@@ -0,0 +1,153 @@
+#include "ImageWriter.hpp"
+
+namespace Image {
+
+    ImageWriter::ImageWriter(const Settings& settings)
+        : m_Settings(settings)
+    {
+        m_Settings.threads = std::max(1u, m_Settings.threads);
+
+        for (u32 i = 0; i < m_Settings.threads; ++i) {
+            m_Workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ImageWriter::~ImageWriter()
+    {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stop = true;
+        }
+
+        m_QueueCV.notify_all();
+        for (auto& worker : m_Workers) {
+            worker.join();
+        }
+    }
+
+    void ImageWriter::Submit(const std::filesystem::path& path, u32 width, u32 height, std::vector<glm::vec4>&& pixels)
+    {
+        Submit(path, ImageEncoder::FormatFromPath(path).value_or(Format::PNG), width, height, std::move(pixels));
+    }
+
+    void ImageWriter::Submit(const std::filesystem::path& path, Format format, u32 width, u32 height, std::vector<glm::vec4>&& pixels)
+    {
+        const usize bytes = pixels.size() * sizeof(glm::vec4);
+
+        {
+            std::unique_lock lock(m_Mutex);
+
+            // An image larger than the whole budget is still accepted once the queue has drained.
+            if (m_PendingBytes > 0 && m_PendingBytes + bytes > m_Settings.maxPendingBytes) {
+                auto start = std::chrono::steady_clock::now();
+                m_SpaceCV.wait(lock, [&] { return m_PendingBytes == 0 || m_PendingBytes + bytes <= m_Settings.maxPendingBytes; });
+                std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+                m_Stats.stallTime += elapsed.count();
+            }
+
+            m_PendingBytes += bytes;
+            m_Stats.peakPendingBytes = std::max(m_Stats.peakPendingBytes, m_PendingBytes);
+            m_Queue.push_back(Request { path, format, width, height, std::move(pixels) });
+        }
+
+        m_QueueCV.notify_one();
+    }
+
+    void ImageWriter::Flush()
+    {
+        std::unique_lock lock(m_Mutex);
+        m_IdleCV.wait(lock, [this] { return m_Queue.empty() && m_Active == 0; });
+    }
+
+    ImageWriter::Stats ImageWriter::GetStats() const
+    {
+        std::lock_guard lock(m_Mutex);
+        return m_Stats;
+    }
+
+    bool ImageWriter::WriteFile(const std::filesystem::path& path, std::span<const u8> bytes)
+    {
+        std::error_code ec;
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path(), ec);
+        }
+
+        // Readers never see a partially written image.
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!file) return false;
+        }
+
+        std::filesystem::rename(temp, path, ec);
+        return !ec;
+    }
+
+    void ImageWriter::WorkerLoop()
+    {
+        while (true) {
+            Request request;
+
+            {
+                std::unique_lock lock(m_Mutex);
+                m_QueueCV.wait(lock, [this] { return m_Stop || !m_Queue.empty(); });
+
+                if (m_Queue.empty()) return;
+
+                request = std::move(m_Queue.front());
+                m_Queue.pop_front();
+                m_Active++;
+            }
+
+            const usize bytes = request.pixels.size() * sizeof(glm::vec4);
+
+            auto start = std::chrono::steady_clock::now();
+            auto encoded = ImageEncoder::Encode(request.format, request.width, request.height, request.pixels, m_Settings.exrCompression);
+            auto encodedAt = std::chrono::steady_clock::now();
+
+            // The float pixels are the bulk of the budget; release them before touching the disk.
+            request.pixels = {};
+
+            {
+                std::lock_guard lock(m_Mutex);
+                m_PendingBytes -= bytes;
+            }
+            m_SpaceCV.notify_all();
+
+            bool ok = encoded && WriteFile(request.path, *encoded);
+            auto end = std::chrono::steady_clock::now();
+
+            std::chrono::duration<f64> encodeTime = encodedAt - start;
+            std::chrono::duration<f64> ioTime = end - encodedAt;
+
+            if (ok) {
+                LOG_INFO("Wrote {} ({:.1f} KiB, encode {:.1f} ms, write {:.1f} ms)", request.path.string(), encoded->size() / 1024.0,
+                    encodeTime.count() * 1000.0, ioTime.count() * 1000.0);
+            } else {
+                LOG_ERROR("Failed to write {}", request.path.string());
+            }
+
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Active--;
+                m_Stats.encodeTime += encodeTime.count();
+                m_Stats.ioTime += ioTime.count();
+
+                if (ok) {
+                    m_Stats.written++;
+                    m_Stats.bytesWritten += encoded->size();
+                } else {
+                    m_Stats.failed++;
+                }
+            }
+
+            m_IdleCV.notify_all();
+        }
+    }
+
+}
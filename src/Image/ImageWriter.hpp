@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ImageEncoder.hpp"
+
+namespace Image {
+
+    // Encodes and writes linear RGBA float images on a small pool of background threads. Queued images
+    // are bounded by maxPendingBytes: Submit only waits when that budget is exhausted, never on the disk
+    // write of its own image.
+    class ImageWriter
+    {
+    public:
+        struct Settings
+        {
+            u32 threads { 2 };
+            usize maxPendingBytes { 512ull << 20 };
+            EXRCompression exrCompression { EXRCompression::ZIP };
+        };
+
+        struct Stats
+        {
+            u32 written { 0 };
+            u32 failed { 0 };
+            u64 bytesWritten { 0 };
+            usize peakPendingBytes { 0 };
+            f64 encodeTime { 0.0 };
+            f64 ioTime { 0.0 };
+            f64 stallTime { 0.0 };
+        };
+
+    public:
+        ImageWriter(const Settings& settings);
+        ~ImageWriter();
+
+        ImageWriter(const ImageWriter&) = delete;
+        ImageWriter& operator=(const ImageWriter&) = delete;
+
+        // Format follows the extension (.exr writes fp16); unknown extensions fall back to PNG.
+        void Submit(const std::filesystem::path& path, u32 width, u32 height, std::vector<glm::vec4>&& pixels);
+        void Submit(const std::filesystem::path& path, Format format, u32 width, u32 height, std::vector<glm::vec4>&& pixels);
+
+        // Blocks until every submitted image has been written.
+        void Flush();
+
+        Stats GetStats() const;
+        inline const Settings& GetSettings() const { return m_Settings; }
+
+        static bool WriteFile(const std::filesystem::path& path, std::span<const u8> bytes);
+
+    private:
+        struct Request
+        {
+            std::filesystem::path path;
+            Format format { Format::PNG };
+            u32 width { 0 };
+            u32 height { 0 };
+            std::vector<glm::vec4> pixels;
+        };
+
+    private:
+        void WorkerLoop();
+
+    private:
+        Settings m_Settings;
+        std::vector<std::thread> m_Workers;
+
+        mutable std::mutex m_Mutex;
+        std::condition_variable m_QueueCV;
+        std::condition_variable m_SpaceCV;
+        std::condition_variable m_IdleCV;
+        std::deque<Request> m_Queue;
+        usize m_PendingBytes { 0 };
+        u32 m_Active { 0 };
+        bool m_Stop { false };
+
+        Stats m_Stats;
+    };
+
+}
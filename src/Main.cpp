@@ -1,12 +1,175 @@
 #include "Core/Application.hpp"
+#include "Batch/BatchRenderer.hpp"
+#include "Distributed/Coordinator.hpp"
+#include "Distributed/Worker.hpp"
 
-int main()
+namespace {
+
+    u32 ParseU32(std::string_view value, u32 fallback)
+    {
+        u32 result = fallback;
+        std::from_chars(value.data(), value.data() + value.size(), result);
+        return result;
+    }
+
+    f64 ParseF64(std::string_view value, f64 fallback)
+    {
+        f64 result = fallback;
+        std::from_chars(value.data(), value.data() + value.size(), result);
+        return result;
+    }
+
+    // WxH, e.g. 1920x1080; leaves both untouched unless both dimensions parse as non-zero.
+    void ParseResolution(std::string_view value, u32& width, u32& height)
+    {
+        const usize x = value.find('x');
+        if (x == std::string_view::npos) {
+            LOG_WARN("Ignoring resolution '{}', expected WxH", value);
+            return;
+        }
+
+        const u32 w = ParseU32(value.substr(0, x), 0);
+        const u32 h = ParseU32(value.substr(x + 1), 0);
+
+        if (w == 0 || h == 0) {
+            LOG_WARN("Ignoring resolution '{}', expected WxH", value);
+            return;
+        }
+
+        width = w;
+        height = h;
+    }
+
+    Batch::BatchRenderer::Integrator ParseIntegrator(std::string_view value, Batch::BatchRenderer::Integrator fallback)
+    {
+        if (value == "tracer") return Batch::BatchRenderer::Integrator::Tracer;
+        if (value == "wavefront") return Batch::BatchRenderer::Integrator::Wavefront;
+
+        LOG_WARN("Ignoring CPU integrator '{}', expected tracer or wavefront", value);
+        return fallback;
+    }
+
+    // PathTracer --batch jobs.txt [--threads N] [--tile N] [--cache N] [--checkpoint-interval SECONDS] [--pin]
+    //     [--cpu-integrator tracer|wavefront]
+    // The wavefront integrator traces multi-bounce paths; it renders each job in one go, without
+    // checkpoints or denoising.
+    i32 RunBatch(const std::filesystem::path& jobFile, const Batch::BatchRenderer::Settings& settings)
+    {
+        auto jobs = Batch::JobFile::Load(jobFile);
+        if (!jobs) return EXIT_FAILURE;
+
+        Batch::BatchRenderer renderer(settings);
+        auto stats = renderer.Run(*jobs);
+
+        return stats.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // PathTracer --batch jobs.txt --coordinator unix:/tmp/pt.sock [--spawn N] [--threads N] [--dist-tile N]
+    i32 RunCoordinator(const std::filesystem::path& jobFile, const Distributed::Coordinator::Settings& settings, const char* executable, u32 spawn, u32 threads)
+    {
+        auto jobs = Batch::JobFile::Load(jobFile);
+        if (!jobs) return EXIT_FAILURE;
+
+        Distributed::Coordinator coordinator(settings);
+        if (!coordinator.Listen()) return EXIT_FAILURE;
+
+        if (spawn > 0) {
+            std::filesystem::path self = executable;
+#if defined(__linux__)
+            std::error_code ec;
+            if (auto resolved = std::filesystem::read_symlink("/proc/self/exe", ec); !ec) self = resolved;
+#endif
+            if (!coordinator.SpawnLocalWorkers(self, spawn, threads)) return EXIT_FAILURE;
+        }
+
+        auto stats = coordinator.Run(*jobs);
+
+        return stats.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // PathTracer --worker unix:/tmp/pt.sock [--threads N] [--tile N] [--pin]
+    // --tile sizes the tracer's own tiles inside each coordinator tile; 32 unless given.
+    i32 RunWorker(const Distributed::Worker::Settings& settings)
+    {
+        Distributed::Worker worker(settings);
+        return worker.Run() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // PathTracer [--env FILE] [--particles N] [--resolution WxH] [--ray-query] [--raster-primary]
+    //     [--compare-backends N | --compare-primary N | --compare-alpha N]
+    // --raster-primary takes the camera hit from a raster pass at each pixel centre; samples are no
+    // longer jittered across the pixel, so edges of directly visible geometry are not anti-aliased.
+    // F9 toggles it at run time, F10 the trace backend.
+    i32 RunInteractive(const Application::Settings& settings)
+    {
+        Application* app = new Application(settings);
+        app->Run();
+        delete app;
+
+        return EXIT_SUCCESS;
+    }
+
+}
+
+int main(int argc, char** argv)
 {
     Logger::Init();
 
-    Application* app = new Application();
-    app->Run();
-    delete app;
+    std::optional<std::filesystem::path> jobFile;
+    Batch::BatchRenderer::Settings batchSettings;
+
+    std::optional<std::string> coordinatorAddress;
+    std::optional<std::string> workerAddress;
+    Distributed::Coordinator::Settings coordinatorSettings;
+    Distributed::Worker::Settings workerSettings;
+    u32 spawn = 0;
+
+    Application::Settings appSettings;
+
+    for (i32 i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        std::string_view value = i + 1 < argc ? std::string_view(argv[i + 1]) : std::string_view();
+
+        if (arg == "--batch" && !value.empty()) { jobFile = value; ++i; }
+        else if (arg == "--threads" && !value.empty()) { batchSettings.threads = ParseU32(value, batchSettings.threads); ++i; }
+        else if (arg == "--tile" && !value.empty()) { batchSettings.tile = workerSettings.tile = ParseU32(value, batchSettings.tile); ++i; }
+        else if (arg == "--cache" && !value.empty()) { batchSettings.maxCachedScenes = ParseU32(value, batchSettings.maxCachedScenes); ++i; }
+        else if (arg == "--cpu-integrator" && !value.empty()) { batchSettings.integrator = ParseIntegrator(value, batchSettings.integrator); ++i; }
+        else if (arg.starts_with("--cpu-integrator=")) { batchSettings.integrator = ParseIntegrator(arg.substr(arg.find('=') + 1), batchSettings.integrator); }
+        else if (arg == "--checkpoint-interval" && !value.empty()) { batchSettings.checkpointInterval = ParseF64(value, batchSettings.checkpointInterval); ++i; }
+        else if (arg == "--coordinator" && !value.empty()) { coordinatorAddress = value; ++i; }
+        else if (arg == "--worker" && !value.empty()) { workerAddress = value; ++i; }
+        else if (arg == "--spawn" && !value.empty()) { spawn = ParseU32(value, spawn); ++i; }
+        else if (arg == "--dist-tile" && !value.empty()) { coordinatorSettings.tile = ParseU32(value, coordinatorSettings.tile); ++i; }
+        else if (arg == "--env" && !value.empty()) { appSettings.environment = value; ++i; }
+        else if (arg == "--particles" && !value.empty()) { appSettings.particles = ParseU32(value, appSettings.particles); ++i; }
+        else if (arg == "--ray-query") { appSettings.backend = Renderer::TraceBackend::RayQuery; }
+        else if (arg == "--compare-backends" && !value.empty()) { appSettings.compareFrames = ParseU32(value, appSettings.compareFrames); ++i; }
+        else if (arg == "--raster-primary") { appSettings.primary = Renderer::PrimaryVisibility::Rasterized; }
+        else if (arg == "--compare-primary" && !value.empty()) { appSettings.comparePrimaryFrames = ParseU32(value, appSettings.comparePrimaryFrames); ++i; }
+        else if (arg == "--compare-alpha" && !value.empty()) { appSettings.compareAlphaFrames = ParseU32(value, appSettings.compareAlphaFrames); ++i; }
+        else if (arg == "--resolution" && !value.empty()) { ParseResolution(value, appSettings.width, appSettings.height); ++i; }
+        else if (arg == "--pin") { batchSettings.pinThreads = true; }
+        else LOG_WARN("Ignoring unknown argument '{}'", arg);
+    }
+
+    i32 result = EXIT_SUCCESS;
+
+    if (workerAddress) {
+        workerSettings.address = *workerAddress;
+        workerSettings.threads = batchSettings.threads;
+        workerSettings.pinThreads = batchSettings.pinThreads;
+        result = RunWorker(workerSettings);
+    } else if (jobFile && coordinatorAddress) {
+        coordinatorSettings.address = *coordinatorAddress;
+        coordinatorSettings.writerThreads = batchSettings.writerThreads;
+        result = RunCoordinator(*jobFile, coordinatorSettings, argv[0], spawn, batchSettings.threads);
+    } else if (jobFile) {
+        result = RunBatch(*jobFile, batchSettings);
+    } else {
+        result = RunInteractive(appSettings);
+    }
 
     Logger::Shutdown();
+    return result;
 }
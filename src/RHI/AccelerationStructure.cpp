@@ -7,6 +7,10 @@ namespace RHI {
 
     namespace {
 
+        inline constexpr VkBuildAccelerationStructureFlagsKHR BLAS_BUILD_FLAGS {
+            VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR
+        };
+
         inline VkTransformMatrixKHR ToVkMatrix(const glm::mat4& mat)
         {
             const glm::mat4 t = glm::transpose(mat);
@@ -37,6 +41,32 @@ namespace RHI {
         ranges.reserve(geometries.size());
 
         for (const auto& geo : geometries) {
+            if (geo.type == Geometry::Type::AABBs) {
+                vkGeometries.push_back(VkAccelerationStructureGeometryKHR {
+                    .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+                    .pNext = nullptr,
+                    .geometryType = VK_GEOMETRY_TYPE_AABBS_KHR,
+                    .geometry = {
+                        .aabbs = {
+                            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_AABBS_DATA_KHR,
+                            .pNext = nullptr,
+                            .data = { .deviceAddress = geo.aabbs.buffer->GetDeviceAddress() },
+                            .stride = geo.aabbs.stride
+                        }
+                    },
+                    .flags = geo.isOpaque ? VK_GEOMETRY_OPAQUE_BIT_KHR : 0u
+                });
+
+                ranges.push_back(VkAccelerationStructureBuildRangeInfoKHR {
+                    .primitiveCount = geo.aabbs.count,
+                    .primitiveOffset = static_cast<u32>(geo.aabbs.offset),
+                    .firstVertex = 0,
+                    .transformOffset = 0
+                });
+
+                continue;
+            }
+
             vkGeometries.push_back(VkAccelerationStructureGeometryKHR {
                 .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
                 .pNext = nullptr,
@@ -68,7 +98,7 @@ namespace RHI {
             .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
             .pNext = nullptr,
             .type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
-            .flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR,
+            .flags = BLAS_BUILD_FLAGS,
             .mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
             .srcAccelerationStructure = VK_NULL_HANDLE,
             .dstAccelerationStructure = VK_NULL_HANDLE,
@@ -225,6 +255,65 @@ namespace RHI {
         m_Address = vkGetAccelerationStructureDeviceAddressKHR(m_Device->GetDevice(), &addressInfo);
     }
 
+    VkAccelerationStructureBuildSizesInfoKHR BLAS::QueryBuildSizes(const std::shared_ptr<Device>& device, Geometry::Type type, u32 primitiveCount, u32 vertexCount)
+    {
+        // Size queries ignore device addresses, so the geometry needs no buffers behind it.
+        VkAccelerationStructureGeometryKHR geometry {
+            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+            .pNext = nullptr,
+            .geometryType = type == Geometry::Type::AABBs ? VK_GEOMETRY_TYPE_AABBS_KHR : VK_GEOMETRY_TYPE_TRIANGLES_KHR,
+            .geometry = {},
+            .flags = VK_GEOMETRY_OPAQUE_BIT_KHR
+        };
+
+        if (type == Geometry::Type::AABBs) {
+            geometry.geometry.aabbs = VkAccelerationStructureGeometryAabbsDataKHR {
+                .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_AABBS_DATA_KHR,
+                .pNext = nullptr,
+                .data = { .deviceAddress = 0 },
+                .stride = sizeof(VkAabbPositionsKHR)
+            };
+        } else {
+            geometry.geometry.triangles = VkAccelerationStructureGeometryTrianglesDataKHR {
+                .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR,
+                .pNext = nullptr,
+                .vertexFormat = VK_FORMAT_R32G32B32_SFLOAT,
+                .vertexData = { .deviceAddress = 0 },
+                .vertexStride = sizeof(glm::vec3),
+                .maxVertex = vertexCount > 0 ? vertexCount - 1 : 0,
+                .indexType = VK_INDEX_TYPE_UINT32,
+                .indexData = { .deviceAddress = 0 },
+                .transformData = { 0 }
+            };
+        }
+
+        VkAccelerationStructureBuildGeometryInfoKHR buildInfo {
+            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+            .pNext = nullptr,
+            .type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+            .flags = BLAS_BUILD_FLAGS,
+            .mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+            .srcAccelerationStructure = VK_NULL_HANDLE,
+            .dstAccelerationStructure = VK_NULL_HANDLE,
+            .geometryCount = 1,
+            .pGeometries = &geometry,
+            .ppGeometries = nullptr,
+            .scratchData = { .deviceAddress = 0 }
+        };
+
+        VkAccelerationStructureBuildSizesInfoKHR sizeInfo {
+            .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR,
+            .pNext = nullptr,
+            .accelerationStructureSize = 0,
+            .updateScratchSize = 0,
+            .buildScratchSize = 0
+        };
+
+        vkGetAccelerationStructureBuildSizesKHR(device->GetDevice(), VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &buildInfo, &primitiveCount, &sizeInfo);
+
+        return sizeInfo;
+    }
+
     TLAS::TLAS(const std::shared_ptr<Device>& device, CommandContext<QueueType::Compute>& queue, const std::span<Instance>& instances)
         : AccelerationStructure(device)
     {
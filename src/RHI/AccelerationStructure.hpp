@@ -35,6 +35,14 @@ namespace RHI {
     public:
         struct Geometry
         {
+            enum class Type : u8
+            {
+                Triangles,
+                AABBs
+            };
+
+            Type type { Type::Triangles };
+
             struct
             {
                 Buffer* buffer { nullptr };
@@ -51,12 +59,25 @@ namespace RHI {
                 VkDeviceSize offset { 0 };
             } indices;
 
+            // VkAabbPositionsKHR boxes for Type::AABBs; hits inside them come from an intersection shader.
+            struct
+            {
+                Buffer* buffer { nullptr };
+                u32 count { 0 };
+                VkDeviceSize stride { sizeof(VkAabbPositionsKHR) };
+                VkDeviceSize offset { 0 };
+            } aabbs;
+
             bool isOpaque { true };
         };
 
     public:
         BLAS(const std::shared_ptr<Device>& device, CommandContext<QueueType::Compute>& queue, const std::span<Geometry>& geometries);
         virtual ~BLAS() = default;
+
+        // Uncompacted and scratch sizes the driver reports for one geometry of primitiveCount triangles
+        // (over vertexCount R32G32B32 vertices) or boxes, built with the same flags, without building it.
+        static VkAccelerationStructureBuildSizesInfoKHR QueryBuildSizes(const std::shared_ptr<Device>& device, Geometry::Type type, u32 primitiveCount, u32 vertexCount = 0);
     };
 
     class TLAS final : public AccelerationStructure
@@ -7,15 +7,21 @@ namespace RHI {
     Buffer::Buffer(const std::shared_ptr<Device>& device, const Spec& spec)
         : m_Device(device), m_Size(spec.size)
     {
+        std::vector<u32> families = spec.sharedQueues;
+        std::ranges::sort(families);
+        families.erase(std::unique(families.begin(), families.end()), families.end());
+
+        m_Concurrent = families.size() > 1;
+
         VkBufferCreateInfo bufferInfo {
             .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
             .pNext = nullptr,
             .flags = 0,
             .size = m_Size,
             .usage = spec.usage,
-            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-            .queueFamilyIndexCount = 0,
-            .pQueueFamilyIndices = nullptr
+            .sharingMode = m_Concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = m_Concurrent ? static_cast<u32>(families.size()) : 0,
+            .pQueueFamilyIndices = m_Concurrent ? families.data() : nullptr
         };
 
         VmaAllocationCreateInfo allocationInfo;
@@ -81,7 +87,8 @@ namespace RHI {
         VkBufferUsageFlags usage,
         VkDeviceSize size,
         const void* data,
-        u32 dstQueueFamily
+        u32 dstQueueFamily,
+        std::span<const u32> sharedQueues
     )
     {
         Buffer staging(device, Spec {
@@ -91,12 +98,19 @@ namespace RHI {
         });
         staging.Write(data, size);
 
+        // Shared buffers skip the ownership transfer; the transfer queue writes them too, so it joins the set.
+        std::vector<u32> families(sharedQueues.begin(), sharedQueues.end());
+        if (!families.empty()) families.push_back(device->GetQueueFamily<QueueType::Transfer>());
+
         auto buffer = std::make_unique<Buffer>(device, Spec {
             .size = size,
             .usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            .memory = VMA_MEMORY_USAGE_GPU_ONLY
+            .memory = VMA_MEMORY_USAGE_GPU_ONLY,
+            .sharedQueues = families
         });
 
+        const bool release = !buffer->IsConcurrent() && dstQueueFamily != VK_QUEUE_FAMILY_IGNORED;
+
         VkCommandBuffer stagingCmd = transfer.Record([&](VkCommandBuffer cmd) {
             VkBufferCopy copyRegion {
                 .srcOffset = 0,
@@ -113,8 +127,8 @@ namespace RHI {
                 .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
                 .dstStageMask = VK_PIPELINE_STAGE_2_NONE,
                 .dstAccessMask = VK_ACCESS_2_NONE,
-                .srcQueueFamilyIndex = device->GetQueueFamily<QueueType::Transfer>(),
-                .dstQueueFamilyIndex = dstQueueFamily,
+                .srcQueueFamilyIndex = release ? device->GetQueueFamily<QueueType::Transfer>() : VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = release ? dstQueueFamily : VK_QUEUE_FAMILY_IGNORED,
                 .buffer = buffer->GetBuffer(),
                 .offset = 0,
                 .size = size
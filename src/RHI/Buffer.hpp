@@ -15,6 +15,10 @@ namespace RHI {
             VkDeviceSize size;
             VkBufferUsageFlags usage;
             VmaMemoryUsage memory;
+
+            // Queue families reading the buffer concurrently, without ownership transfers; fewer than two
+            // distinct families keep it exclusive.
+            std::vector<u32> sharedQueues {};
         };
 
     public:
@@ -24,6 +28,7 @@ namespace RHI {
         inline VkBuffer GetBuffer() const { return m_Buffer; }
         inline VkDeviceSize GetSize() const { return m_Size; }
         inline VkDeviceAddress GetDeviceAddress() const { return m_DeviceAddress; }
+        inline bool IsConcurrent() const { return m_Concurrent; }
 
         void* Map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
         void Unmap();
@@ -36,7 +41,8 @@ namespace RHI {
             VkBufferUsageFlags usage,
             VkDeviceSize size,
             const void* data,
-            u32 dstQueueFamily = VK_QUEUE_FAMILY_IGNORED
+            u32 dstQueueFamily = VK_QUEUE_FAMILY_IGNORED,
+            std::span<const u32> sharedQueues = {}
         );
 
     private:
@@ -47,6 +53,7 @@ namespace RHI {
 
         VkDeviceSize m_Size { 0 };
         VkDeviceAddress m_DeviceAddress { 0 };
+        bool m_Concurrent { false };
 
         void* m_MappedData { nullptr };
     };
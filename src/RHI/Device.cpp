@@ -27,10 +27,14 @@ namespace RHI {
     void Device::SyncFrame()
     {
         m_HostFrameIndex += 1;
+        m_CurrentFrameIndex = m_HostFrameIndex % s_FrameInFlight;
+
+        // The last graphics submission of the frame that used this slot before, however many it made.
+        u64 wait = m_FrameTimelineValues[m_CurrentFrameIndex];
 
-        vkGetSemaphoreCounterValue(m_Device, m_GraphicsTimeline, &m_LocalFrameIndex);
-        if (m_HostFrameIndex > m_LocalFrameIndex + s_FrameInFlight) {
-            u64 wait = m_HostFrameIndex - s_FrameInFlight;
+        u64 completed = 0;
+        vkGetSemaphoreCounterValue(m_Device, m_GraphicsTimeline, &completed);
+        if (completed < wait) {
             VkSemaphoreWaitInfo waitInfo {
                 .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
                 .pNext = nullptr,
@@ -41,8 +45,6 @@ namespace RHI {
             };
             VK_CHECK(vkWaitSemaphores(m_Device, &waitInfo, std::numeric_limits<u64>::max()));
         }
-
-        m_CurrentFrameIndex = m_HostFrameIndex % s_FrameInFlight;
     }
 
     void Device::SelectPhysicalDevice()
@@ -107,6 +109,27 @@ namespace RHI {
             VK_EXT_SCALAR_BLOCK_LAYOUT_EXTENSION_NAME
         };
 
+        u32 availableCount = 0;
+        vkEnumerateDeviceExtensionProperties(m_PhysicalDevice, nullptr, &availableCount, nullptr);
+        std::vector<VkExtensionProperties> availableExtensions(availableCount);
+        vkEnumerateDeviceExtensionProperties(m_PhysicalDevice, nullptr, &availableCount, availableExtensions.data());
+
+        // Optional: only the ray-query compute tracer needs it, the RT pipeline path works without.
+        m_RayQuerySupported = std::ranges::any_of(availableExtensions, [](const VkExtensionProperties& extension) {
+            return std::string_view(extension.extensionName) == VK_KHR_RAY_QUERY_EXTENSION_NAME;
+        });
+
+        if (m_RayQuerySupported) extensions.push_back(VK_KHR_RAY_QUERY_EXTENSION_NAME);
+        else LOG_WARN("{} is not supported; the ray-query tracer is unavailable", VK_KHR_RAY_QUERY_EXTENSION_NAME);
+
+        // Optional too: the raster visibility buffer stores hardware barycentrics.
+        m_FragmentBarycentricSupported = std::ranges::any_of(availableExtensions, [](const VkExtensionProperties& extension) {
+            return std::string_view(extension.extensionName) == VK_KHR_FRAGMENT_SHADER_BARYCENTRIC_EXTENSION_NAME;
+        });
+
+        if (m_FragmentBarycentricSupported) extensions.push_back(VK_KHR_FRAGMENT_SHADER_BARYCENTRIC_EXTENSION_NAME);
+        else LOG_WARN("{} is not supported; raster primary visibility is unavailable", VK_KHR_FRAGMENT_SHADER_BARYCENTRIC_EXTENSION_NAME);
+
         VkPhysicalDeviceScalarBlockLayoutFeatures scalarBlock {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SCALAR_BLOCK_LAYOUT_FEATURES,
             .pNext = nullptr,
@@ -184,9 +207,32 @@ namespace RHI {
             .timelineSemaphore = VK_TRUE
         };
 
+        VkPhysicalDeviceRayQueryFeaturesKHR rayQuery {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_QUERY_FEATURES_KHR,
+            .pNext = &timelineSemaphore,
+            .rayQuery = VK_TRUE
+        };
+
+        VkPhysicalDeviceFragmentShaderBarycentricFeaturesKHR fragmentBarycentric {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADER_BARYCENTRIC_FEATURES_KHR,
+            .pNext = nullptr,
+            .fragmentShaderBarycentric = VK_TRUE
+        };
+
+        // Optional features go in front of the required chain.
+        void* featureChain = &timelineSemaphore;
+        if (m_RayQuerySupported) {
+            rayQuery.pNext = featureChain;
+            featureChain = &rayQuery;
+        }
+        if (m_FragmentBarycentricSupported) {
+            fragmentBarycentric.pNext = featureChain;
+            featureChain = &fragmentBarycentric;
+        }
+
         VkPhysicalDeviceFeatures2 features {
             .sType  = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
-            .pNext = &timelineSemaphore,
+            .pNext = featureChain,
             .features = {
                 .samplerAnisotropy = VK_TRUE,
                 .shaderInt64 = VK_TRUE
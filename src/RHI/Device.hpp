@@ -29,6 +29,12 @@ namespace RHI {
         inline VkPhysicalDeviceRayTracingPipelinePropertiesKHR GetRTProps() const { return m_RTProps; }
         inline VkPhysicalDeviceAccelerationStructurePropertiesKHR GetASProps() const { return m_ASProps; }
 
+        // VK_KHR_ray_query, enabled whenever the device offers it.
+        inline bool IsRayQuerySupported() const { return m_RayQuerySupported; }
+
+        // VK_KHR_fragment_shader_barycentric, likewise enabled whenever offered.
+        inline bool IsFragmentBarycentricSupported() const { return m_FragmentBarycentricSupported; }
+
         inline void WaitIdle() const { vkDeviceWaitIdle(m_Device); }
 
         template <QueueType type>
@@ -137,6 +143,8 @@ namespace RHI {
 
             VK_CHECK(vkQueueSubmit2(GetQueue<type>(), 1, &submitInfo, VK_NULL_HANDLE));
 
+            if constexpr (type == QueueType::Graphics) m_FrameTimelineValues[m_CurrentFrameIndex] = allSignal.back().value;
+
             return allSignal.back();
         }
 
@@ -186,6 +194,8 @@ namespace RHI {
         VkPhysicalDeviceProperties2 m_Props;
         VkPhysicalDeviceRayTracingPipelinePropertiesKHR m_RTProps;
         VkPhysicalDeviceAccelerationStructurePropertiesKHR m_ASProps;
+        bool m_RayQuerySupported { false };
+        bool m_FragmentBarycentricSupported { false };
 
         QueueFamilyIndices m_QueueFamily;
         VkQueue m_GraphicsQueue { VK_NULL_HANDLE };
@@ -194,7 +204,9 @@ namespace RHI {
 
         usize m_CurrentFrameIndex { 0 };
         u64 m_HostFrameIndex { 0 };
-        u64 m_LocalFrameIndex { 0 };
+
+        // Graphics timeline value of each frame slot's latest submission, waited on before the slot is reused.
+        std::array<u64, s_FrameInFlight> m_FrameTimelineValues {};
 
         VkSemaphore m_GraphicsTimeline { VK_NULL_HANDLE };
         VkSemaphore m_ComputeTimeline { VK_NULL_HANDLE };
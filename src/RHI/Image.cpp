@@ -7,6 +7,12 @@ namespace RHI {
     Image::Image(const std::shared_ptr<Device>& device, const Spec& spec)
         : m_Device(device), m_Extent(spec.extent), m_Format(spec.format)
     {
+        std::vector<u32> families = spec.sharedQueues;
+        std::ranges::sort(families);
+        families.erase(std::unique(families.begin(), families.end()), families.end());
+
+        m_Concurrent = families.size() > 1;
+
         VkImageCreateInfo imageInfo {
             .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
             .pNext = nullptr,
@@ -19,9 +25,9 @@ namespace RHI {
             .samples = VK_SAMPLE_COUNT_1_BIT,
             .tiling = VK_IMAGE_TILING_OPTIMAL,
             .usage = spec.usage,
-            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-            .queueFamilyIndexCount = 0,
-            .pQueueFamilyIndices = nullptr,
+            .sharingMode = m_Concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = m_Concurrent ? static_cast<u32>(families.size()) : 0,
+            .pQueueFamilyIndices = m_Concurrent ? families.data() : nullptr,
             .initialLayout = m_Layout
         };
 
@@ -61,6 +67,32 @@ namespace RHI {
     {
         if (m_Layout == layout && srcQueue == VK_QUEUE_FAMILY_IGNORED && dstQueue == VK_QUEUE_FAMILY_IGNORED) return;
 
+        VkImageMemoryBarrier2 barrier = MakeBarrier(layout, srcStage, dstStage, srcAccess, dstAccess, srcQueue, dstQueue);
+
+        VkDependencyInfo dependency {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr,
+            .dependencyFlags = 0,
+            .memoryBarrierCount = 0,
+            .pMemoryBarriers = nullptr,
+            .bufferMemoryBarrierCount = 0,
+            .pBufferMemoryBarriers = nullptr,
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers = &barrier
+        };
+
+        vkCmdPipelineBarrier2(cmd, &dependency);
+    }
+
+    VkImageMemoryBarrier2 Image::MakeBarrier(VkImageLayout layout,
+        VkPipelineStageFlags2 srcStage,
+        VkPipelineStageFlags2 dstStage,
+        VkAccessFlags2 srcAccess,
+        VkAccessFlags2 dstAccess,
+        u32 srcQueue,
+        u32 dstQueue
+    )
+    {
         VkImageMemoryBarrier2 barrier {
             .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
             .pNext = nullptr,
@@ -89,21 +121,9 @@ namespace RHI {
             }
         }
 
-        VkDependencyInfo dependency {
-            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-            .pNext = nullptr,
-            .dependencyFlags = 0,
-            .memoryBarrierCount = 0,
-            .pMemoryBarriers = nullptr,
-            .bufferMemoryBarrierCount = 0,
-            .pBufferMemoryBarriers = nullptr,
-            .imageMemoryBarrierCount = 1,
-            .pImageMemoryBarriers = &barrier
-        };
-
-        vkCmdPipelineBarrier2(cmd, &dependency);
-
         m_Layout = layout;
+
+        return barrier;
     }
 
     void Image::CreateView()
@@ -15,6 +15,9 @@ namespace RHI {
             VkFormat format;
             VkImageUsageFlags usage;
             VmaMemoryUsage memory;
+
+            // As Buffer::Spec::sharedQueues: concurrent across these families, no ownership transfers.
+            std::vector<u32> sharedQueues {};
         };
 
     public:
@@ -30,12 +33,25 @@ namespace RHI {
             u32 dstQueue = VK_QUEUE_FAMILY_IGNORED
         );
 
+        // The barrier TransitionLayout would record, for callers batching several into one
+        // vkCmdPipelineBarrier2. The tracked layout moves to layout straight away.
+        VkImageMemoryBarrier2 MakeBarrier(VkImageLayout layout,
+            VkPipelineStageFlags2 srcStage, VkPipelineStageFlags2 dstStage,
+            VkAccessFlags2 srcAccess, VkAccessFlags2 dstAccess,
+            u32 srcQueue = VK_QUEUE_FAMILY_IGNORED,
+            u32 dstQueue = VK_QUEUE_FAMILY_IGNORED
+        );
+
+        // Drops the contents: the next transition starts from UNDEFINED. For overwritten or aliased images.
+        inline void DiscardContents() { m_Layout = VK_IMAGE_LAYOUT_UNDEFINED; }
+
         inline VkImage GetImage() const { return m_Image; }
         inline VkImageView GetView() const { return m_View; }
 
         inline VkExtent3D GetExtent() const { return m_Extent; }
         inline VkFormat GetFormat() const { return m_Format; }
         inline VkImageLayout GetLayout() const { return m_Layout; }
+        inline bool IsConcurrent() const { return m_Concurrent; }
 
     private:
         void CreateView();
@@ -52,6 +68,7 @@ namespace RHI {
         VkExtent3D m_Extent { 0, 0, 0 };
         VkFormat m_Format { VK_FORMAT_UNDEFINED };
         VkImageLayout m_Layout { VK_IMAGE_LAYOUT_UNDEFINED };
+        bool m_Concurrent { false };
     };
 
 }
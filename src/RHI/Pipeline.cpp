@@ -65,6 +65,27 @@ namespace RHI {
         return *this;
     }
 
+    GraphicsPipelineBuilder& GraphicsPipelineBuilder::AddVertexBinding(u32 binding, u32 stride)
+    {
+        m_VertexBindings.push_back(VkVertexInputBindingDescription {
+            .binding = binding,
+            .stride = stride,
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+        });
+        return *this;
+    }
+
+    GraphicsPipelineBuilder& GraphicsPipelineBuilder::AddVertexAttribute(u32 location, u32 binding, VkFormat format, u32 offset)
+    {
+        m_VertexAttributes.push_back(VkVertexInputAttributeDescription {
+            .location = location,
+            .binding = binding,
+            .format = format,
+            .offset = offset
+        });
+        return *this;
+    }
+
     GraphicsPipelineBuilder& GraphicsPipelineBuilder::SetInputTopology(VkPrimitiveTopology topology)
     {
         m_InputAssembly.topology = topology;
@@ -189,10 +210,10 @@ namespace RHI {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
             .pNext = nullptr,
             .flags = 0,
-            .vertexBindingDescriptionCount = 0,
-            .pVertexBindingDescriptions = nullptr,
-            .vertexAttributeDescriptionCount = 0,
-            .pVertexAttributeDescriptions = nullptr
+            .vertexBindingDescriptionCount = static_cast<u32>(m_VertexBindings.size()),
+            .pVertexBindingDescriptions = m_VertexBindings.data(),
+            .vertexAttributeDescriptionCount = static_cast<u32>(m_VertexAttributes.size()),
+            .pVertexAttributeDescriptions = m_VertexAttributes.data()
         };
 
         std::vector<VkPipelineColorBlendAttachmentState> attachments(m_ColorFormats.size(), m_ColorBlendAttachment);
@@ -244,6 +265,100 @@ namespace RHI {
         return pipeline;
     }
 
+    ComputePipeline::ComputePipeline(const std::shared_ptr<Device>& device)
+        : Pipeline(device)
+    {
+    }
+
+    void ComputePipeline::Bind(VkCommandBuffer cmd)
+    {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+    }
+
+    ComputePipelineBuilder::ComputePipelineBuilder(const std::shared_ptr<Device>& device)
+        : m_Device(device)
+    {
+    }
+
+    ComputePipelineBuilder& ComputePipelineBuilder::SetShader(const std::filesystem::path& path)
+    {
+        m_Shader = std::make_unique<Shader>(m_Device, path, Shader::Stage::Compute);
+        return *this;
+    }
+
+    ComputePipelineBuilder& ComputePipelineBuilder::AddLayout(VkDescriptorSetLayout layout)
+    {
+        m_Layouts.push_back(layout);
+        return *this;
+    }
+
+    ComputePipelineBuilder& ComputePipelineBuilder::AddPushConstant(u32 size, VkShaderStageFlags stage)
+    {
+        m_PushConstants.push_back(VkPushConstantRange {
+            .stageFlags = stage,
+            .offset = 0,
+            .size = size
+        });
+        return *this;
+    }
+
+    ComputePipelineBuilder& ComputePipelineBuilder::AddSpecialization(u32 id, u32 value)
+    {
+        m_SpecEntries.push_back(VkSpecializationMapEntry {
+            .constantID = id,
+            .offset = static_cast<u32>(m_SpecData.size() * sizeof(u32)),
+            .size = sizeof(u32)
+        });
+        m_SpecData.push_back(value);
+        return *this;
+    }
+
+    std::unique_ptr<ComputePipeline> ComputePipelineBuilder::Build()
+    {
+        auto pipeline = std::unique_ptr<ComputePipeline>(new ComputePipeline(m_Device));
+
+        VkPipelineLayoutCreateInfo layoutInfo {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .setLayoutCount = static_cast<u32>(m_Layouts.size()),
+            .pSetLayouts = m_Layouts.data(),
+            .pushConstantRangeCount = static_cast<u32>(m_PushConstants.size()),
+            .pPushConstantRanges = m_PushConstants.data()
+        };
+
+        VK_CHECK(vkCreatePipelineLayout(m_Device->GetDevice(), &layoutInfo, nullptr, &pipeline->m_Layout));
+
+        VkSpecializationInfo specInfo {
+            .mapEntryCount = static_cast<u32>(m_SpecEntries.size()),
+            .pMapEntries = m_SpecEntries.data(),
+            .dataSize = m_SpecData.size() * sizeof(u32),
+            .pData = m_SpecData.data()
+        };
+
+        VkComputePipelineCreateInfo pipelineInfo {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .stage = VkPipelineShaderStageCreateInfo {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = m_Shader->GetModule(),
+                .pName = "main",
+                .pSpecializationInfo = m_SpecEntries.empty() ? nullptr : &specInfo
+            },
+            .layout = pipeline->m_Layout,
+            .basePipelineHandle = VK_NULL_HANDLE,
+            .basePipelineIndex = -1
+        };
+
+        VK_CHECK(vkCreateComputePipelines(m_Device->GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline->m_Pipeline));
+
+        return pipeline;
+    }
+
     RayTracingPipelne::RayTracingPipelne(const std::shared_ptr<Device>& device)
         : Pipeline(device)
     {
@@ -310,6 +425,42 @@ namespace RHI {
         return *this;
     }
 
+    RayTracingPipelineBuilder& RayTracingPipelineBuilder::AddHitGroup(const std::filesystem::path& closestHit, const std::filesystem::path& anyHit)
+    {
+        m_Shaders.push_back(std::make_unique<Shader>(m_Device, closestHit, Shader::Stage::ClosestHit));
+        m_Shaders.push_back(std::make_unique<Shader>(m_Device, anyHit, Shader::Stage::AnyHit));
+        m_ShaderGroups.push_back(VkRayTracingShaderGroupCreateInfoKHR {
+            .sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .type = VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR,
+            .generalShader = VK_SHADER_UNUSED_KHR,
+            .closestHitShader = static_cast<u32>(m_Shaders.size() - 2),
+            .anyHitShader = static_cast<u32>(m_Shaders.size() - 1),
+            .intersectionShader = VK_SHADER_UNUSED_KHR,
+            .pShaderGroupCaptureReplayHandle = nullptr
+        });
+        m_HitCount++;
+        return *this;
+    }
+
+    RayTracingPipelineBuilder& RayTracingPipelineBuilder::AddProceduralHitGroup(const std::filesystem::path& closestHit, const std::filesystem::path& intersection)
+    {
+        m_Shaders.push_back(std::make_unique<Shader>(m_Device, closestHit, Shader::Stage::ClosestHit));
+        m_Shaders.push_back(std::make_unique<Shader>(m_Device, intersection, Shader::Stage::Intersection));
+        m_ShaderGroups.push_back(VkRayTracingShaderGroupCreateInfoKHR {
+            .sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .type = VK_RAY_TRACING_SHADER_GROUP_TYPE_PROCEDURAL_HIT_GROUP_KHR,
+            .generalShader = VK_SHADER_UNUSED_KHR,
+            .closestHitShader = static_cast<u32>(m_Shaders.size() - 2),
+            .anyHitShader = VK_SHADER_UNUSED_KHR,
+            .intersectionShader = static_cast<u32>(m_Shaders.size() - 1),
+            .pShaderGroupCaptureReplayHandle = nullptr
+        });
+        m_HitCount++;
+        return *this;
+    }
+
     RayTracingPipelineBuilder& RayTracingPipelineBuilder::AddLayout(VkDescriptorSetLayout layout)
     {
         m_Layouts.push_back(layout);
@@ -326,6 +477,23 @@ namespace RHI {
         return *this;
     }
 
+    RayTracingPipelineBuilder& RayTracingPipelineBuilder::AddSpecialization(u32 id, u32 value)
+    {
+        m_SpecEntries.push_back(VkSpecializationMapEntry {
+            .constantID = id,
+            .offset = static_cast<u32>(m_SpecData.size() * sizeof(u32)),
+            .size = sizeof(u32)
+        });
+        m_SpecData.push_back(value);
+        return *this;
+    }
+
+    RayTracingPipelineBuilder& RayTracingPipelineBuilder::SetMaxRecursionDepth(u32 depth)
+    {
+        m_MaxRecursionDepth = depth;
+        return *this;
+    }
+
     std::unique_ptr<RayTracingPipelne> RayTracingPipelineBuilder::Build()
     {
         auto pipeline = std::unique_ptr<RayTracingPipelne>(new RayTracingPipelne(m_Device));
@@ -342,6 +510,13 @@ namespace RHI {
 
         VK_CHECK(vkCreatePipelineLayout(m_Device->GetDevice(), &layoutInfo, nullptr, &pipeline->m_Layout));
 
+        VkSpecializationInfo specInfo {
+            .mapEntryCount = static_cast<u32>(m_SpecEntries.size()),
+            .pMapEntries = m_SpecEntries.data(),
+            .dataSize = m_SpecData.size() * sizeof(u32),
+            .pData = m_SpecData.data()
+        };
+
         std::vector<VkPipelineShaderStageCreateInfo> stages;
         stages.reserve(m_Shaders.size());
         for (const auto& shader : m_Shaders) {
@@ -352,10 +527,15 @@ namespace RHI {
                 .stage = shader->GetStage(),
                 .module = shader->GetModule(),
                 .pName = "main",
-                .pSpecializationInfo = nullptr
+                .pSpecializationInfo = m_SpecEntries.empty() ? nullptr : &specInfo
             });
         }
 
+        const u32 recursionDepth = std::min(m_MaxRecursionDepth, m_Device->GetRTProps().maxRayRecursionDepth);
+        if (recursionDepth < m_MaxRecursionDepth) {
+            LOG_WARN("Ray recursion depth {} exceeds the device limit of {}", m_MaxRecursionDepth, recursionDepth);
+        }
+
         VkRayTracingPipelineCreateInfoKHR pipelineInfo {
             .sType = VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR,
             .pNext = nullptr,
@@ -364,7 +544,7 @@ namespace RHI {
             .pStages = stages.data(),
             .groupCount = static_cast<u32>(m_ShaderGroups.size()),
             .pGroups = m_ShaderGroups.data(),
-            .maxPipelineRayRecursionDepth = 8,
+            .maxPipelineRayRecursionDepth = recursionDepth,
             .pLibraryInfo = nullptr,
             .pLibraryInterface = nullptr,
             .pDynamicState = nullptr,
@@ -432,7 +612,7 @@ namespace RHI {
         pipeline->m_SBTBuffer->Unmap();
 
         pSBTBuffer = static_cast<u8*>(pipeline->m_SBTBuffer->Map(VK_WHOLE_SIZE, pipeline->m_RGenRegion.size + pipeline->m_MissRegion.size));
-        for (u32 i = 0; i < m_MissCount; ++i) {
+        for (u32 i = 0; i < m_HitCount; ++i) {
             memcpy(pSBTBuffer, pData, handleSize);
             pSBTBuffer += pipeline->m_HitRegion.stride;
             pData += handleSize;
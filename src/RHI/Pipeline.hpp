@@ -52,6 +52,10 @@ namespace RHI {
         GraphicsPipelineBuilder& SetColorFormats(const std::span<VkFormat>& formats);
         GraphicsPipelineBuilder& SetDepthFormat(VkFormat format);
 
+        // Vertex buffer bindings and the attributes read from them; with none, shaders fetch their own vertices.
+        GraphicsPipelineBuilder& AddVertexBinding(u32 binding, u32 stride);
+        GraphicsPipelineBuilder& AddVertexAttribute(u32 location, u32 binding, VkFormat format, u32 offset);
+
         GraphicsPipelineBuilder& SetInputTopology(VkPrimitiveTopology topology);
         GraphicsPipelineBuilder& SetPolygonMode(VkPolygonMode mode);
         GraphicsPipelineBuilder& SetCullMode(VkCullModeFlags mode, VkFrontFace face = VK_FRONT_FACE_COUNTER_CLOCKWISE);
@@ -72,6 +76,9 @@ namespace RHI {
         std::vector<VkFormat> m_ColorFormats;
         VkFormat m_DepthFormat { VK_FORMAT_UNDEFINED };
 
+        std::vector<VkVertexInputBindingDescription> m_VertexBindings;
+        std::vector<VkVertexInputAttributeDescription> m_VertexAttributes;
+
         VkPipelineInputAssemblyStateCreateInfo m_InputAssembly {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
             .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
@@ -113,6 +120,42 @@ namespace RHI {
         std::vector<VkPushConstantRange> m_PushConstants;
     };
 
+    class ComputePipeline : public Pipeline
+    {
+        friend class ComputePipelineBuilder;
+    public:
+        void Bind(VkCommandBuffer cmd) override;
+
+    protected:
+        ComputePipeline(const std::shared_ptr<Device>& device);
+    };
+
+    class ComputePipelineBuilder
+    {
+    public:
+        ComputePipelineBuilder(const std::shared_ptr<Device>& device);
+
+        ComputePipelineBuilder& SetShader(const std::filesystem::path& path);
+
+        ComputePipelineBuilder& AddLayout(VkDescriptorSetLayout layout);
+        ComputePipelineBuilder& AddPushConstant(u32 size, VkShaderStageFlags stage = VK_SHADER_STAGE_COMPUTE_BIT);
+
+        // 32-bit specialisation constant for constant_id = id.
+        ComputePipelineBuilder& AddSpecialization(u32 id, u32 value);
+
+        std::unique_ptr<ComputePipeline> Build();
+
+    private:
+        std::shared_ptr<Device> m_Device;
+
+        std::unique_ptr<Shader> m_Shader;
+        std::vector<VkDescriptorSetLayout> m_Layouts;
+        std::vector<VkPushConstantRange> m_PushConstants;
+
+        std::vector<VkSpecializationMapEntry> m_SpecEntries;
+        std::vector<u32> m_SpecData;
+    };
+
     class RayTracingPipelne : public Pipeline
     {
         friend class RayTracingPipelineBuilder;
@@ -145,9 +188,23 @@ namespace RHI {
         RayTracingPipelineBuilder& AddMissShader(const std::filesystem::path& path);
         RayTracingPipelineBuilder& AddClosestHitShader(const std::filesystem::path& path);
 
+        // Triangle hit group whose any-hit shader runs for candidate hits on non-opaque geometry, unless
+        // the ray forces opacity.
+        RayTracingPipelineBuilder& AddHitGroup(const std::filesystem::path& closestHit, const std::filesystem::path& anyHit);
+
+        // Hit group for AABB geometry, whose intersection shader reports the hits inside each box.
+        RayTracingPipelineBuilder& AddProceduralHitGroup(const std::filesystem::path& closestHit, const std::filesystem::path& intersection);
+
         RayTracingPipelineBuilder& AddLayout(VkDescriptorSetLayout layout);
         RayTracingPipelineBuilder& AddPushConstant(u32 size, VkShaderStageFlags stage);
 
+        // 32-bit specialisation constant applied to every stage that declares constant_id = id.
+        RayTracingPipelineBuilder& AddSpecialization(u32 id, u32 value);
+
+        // Deepest traceRayEXT nesting any shader reaches, raygen's own trace counting as 1. Clamped to the
+        // device limit.
+        RayTracingPipelineBuilder& SetMaxRecursionDepth(u32 depth);
+
         std::unique_ptr<RayTracingPipelne> Build();
 
     private:
@@ -158,9 +215,14 @@ namespace RHI {
         std::vector<VkDescriptorSetLayout> m_Layouts;
         std::vector<VkPushConstantRange> m_PushConstants;
 
+        std::vector<VkSpecializationMapEntry> m_SpecEntries;
+        std::vector<u32> m_SpecData;
+
         u32 m_RGenCount { 0 };
         u32 m_MissCount { 0 };
         u32 m_HitCount  { 0 };
+
+        u32 m_MaxRecursionDepth { 1 };
     };
 
 }
@@ -0,0 +1,839 @@
+#include "RenderGraph.hpp"
+
+#include "Image.hpp"
+#include "Buffer.hpp"
+
+namespace RHI {
+
+    namespace {
+
+        VkImageCreateInfo MakeImageInfo(const RenderGraph::TransientImageSpec& spec)
+        {
+            return VkImageCreateInfo {
+                .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .imageType = VK_IMAGE_TYPE_2D,
+                .format = spec.format,
+                .extent = { spec.extent.width, spec.extent.height, 1 },
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = VK_SAMPLE_COUNT_1_BIT,
+                .tiling = VK_IMAGE_TILING_OPTIMAL,
+                .usage = spec.usage,
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = 0,
+                .pQueueFamilyIndices = nullptr,
+                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+            };
+        }
+
+        VkBufferCreateInfo MakeBufferInfo(const RenderGraph::TransientBufferSpec& spec)
+        {
+            return VkBufferCreateInfo {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .size = spec.size,
+                .usage = spec.usage,
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = 0,
+                .pQueueFamilyIndices = nullptr
+            };
+        }
+
+        bool Overlaps(u32 firstA, u32 lastA, u32 firstB, u32 lastB)
+        {
+            return firstA <= lastB && firstB <= lastA;
+        }
+
+    }
+
+    RenderGraph::Pass::Pass(std::string_view name, QueueType queue)
+        : m_Name(name), m_Queue(queue)
+    {
+    }
+
+    RenderGraph::Pass& RenderGraph::Pass::Read(Resource resource, const Access& access)
+    {
+        m_Uses.push_back(Use { resource, access, false, false });
+        return *this;
+    }
+
+    RenderGraph::Pass& RenderGraph::Pass::Write(Resource resource, const Access& access)
+    {
+        m_Uses.push_back(Use { resource, access, true, false });
+        return *this;
+    }
+
+    RenderGraph::Pass& RenderGraph::Pass::Overwrite(Resource resource, const Access& access)
+    {
+        m_Uses.push_back(Use { resource, access, true, true });
+        return *this;
+    }
+
+    RenderGraph::Pass& RenderGraph::Pass::Wait(const VkSemaphoreSubmitInfo& semaphore)
+    {
+        m_Waits.push_back(semaphore);
+        return *this;
+    }
+
+    RenderGraph::Pass& RenderGraph::Pass::Signal(const VkSemaphoreSubmitInfo& semaphore)
+    {
+        m_Signals.push_back(semaphore);
+        return *this;
+    }
+
+    RenderGraph::Pass& RenderGraph::Pass::KeepAlive()
+    {
+        m_KeepAlive = true;
+        return *this;
+    }
+
+    RenderGraph::Pass& RenderGraph::Pass::Execute(std::function<void(VkCommandBuffer)> func)
+    {
+        m_Execute = std::move(func);
+        return *this;
+    }
+
+    RenderGraph::RenderGraph(const std::shared_ptr<Device>& device)
+        : m_Device(device)
+    {
+        for (auto& pools : m_CommandPools) {
+            for (usize q = 0; q < QUEUE_COUNT; ++q) {
+                VkCommandPoolCreateInfo poolInfo {
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                    .queueFamilyIndex = GetFamily(static_cast<QueueType>(q))
+                };
+
+                VK_CHECK(vkCreateCommandPool(m_Device->GetDevice(), &poolInfo, nullptr, &pools[q].pool));
+            }
+        }
+    }
+
+    RenderGraph::~RenderGraph()
+    {
+        for (auto& heap : m_Heaps) DestroyTransients(heap);
+
+        for (auto& pools : m_CommandPools) {
+            for (auto& pool : pools) vkDestroyCommandPool(m_Device->GetDevice(), pool.pool, nullptr);
+        }
+    }
+
+    void RenderGraph::Begin()
+    {
+        m_Passes.clear();
+        m_Resources.clear();
+        m_Transients.clear();
+        m_ImportedImages.clear();
+        m_ImportedBuffers.clear();
+
+        // SyncFrame has waited for this slot's previous frame, so its command buffers are free again.
+        for (auto& pool : m_CommandPools[m_Device->GetCurrentFrameIndex()]) {
+            VK_CHECK(vkResetCommandPool(m_Device->GetDevice(), pool.pool, 0));
+            pool.used = 0;
+        }
+    }
+
+    RenderGraph::Resource RenderGraph::Import(Image& image)
+    {
+        if (auto it = m_ImportedImages.find(image.GetImage()); it != m_ImportedImages.end()) return it->second;
+
+        const Resource handle = static_cast<Resource>(m_Resources.size());
+
+        ResourceEntry entry {
+            .name = fmt::format("image {}", handle),
+            .image = &image,
+            .concurrent = image.IsConcurrent()
+        };
+
+        if (auto it = m_ImageHistory.find(image.GetImage()); it != m_ImageHistory.end()) entry.state = it->second;
+
+        m_Resources.push_back(std::move(entry));
+        m_ImportedImages.emplace(image.GetImage(), handle);
+
+        return handle;
+    }
+
+    RenderGraph::Resource RenderGraph::Import(const Buffer& buffer)
+    {
+        if (auto it = m_ImportedBuffers.find(buffer.GetBuffer()); it != m_ImportedBuffers.end()) return it->second;
+
+        const Resource handle = static_cast<Resource>(m_Resources.size());
+
+        ResourceEntry entry {
+            .name = fmt::format("buffer {}", handle),
+            .buffer = buffer.GetBuffer(),
+            .size = buffer.GetSize(),
+            .concurrent = buffer.IsConcurrent()
+        };
+
+        if (auto it = m_BufferHistory.find(buffer.GetBuffer()); it != m_BufferHistory.end()) entry.state = it->second;
+
+        m_Resources.push_back(std::move(entry));
+        m_ImportedBuffers.emplace(buffer.GetBuffer(), handle);
+
+        return handle;
+    }
+
+    RenderGraph::Resource RenderGraph::CreateImage(std::string_view name, const TransientImageSpec& spec)
+    {
+        const Resource handle = static_cast<Resource>(m_Resources.size());
+
+        m_Resources.push_back(ResourceEntry {
+            .name = std::string(name),
+            .transient = static_cast<i32>(m_Transients.size())
+        });
+
+        m_Transients.push_back(TransientEntry {
+            .resource = handle,
+            .isImage = true,
+            .imageSpec = spec,
+            .bufferSpec = {}
+        });
+
+        return handle;
+    }
+
+    RenderGraph::Resource RenderGraph::CreateBuffer(std::string_view name, const TransientBufferSpec& spec)
+    {
+        const Resource handle = static_cast<Resource>(m_Resources.size());
+
+        m_Resources.push_back(ResourceEntry {
+            .name = std::string(name),
+            .size = spec.size,
+            .transient = static_cast<i32>(m_Transients.size())
+        });
+
+        m_Transients.push_back(TransientEntry {
+            .resource = handle,
+            .isImage = false,
+            .imageSpec = {},
+            .bufferSpec = spec
+        });
+
+        return handle;
+    }
+
+    RenderGraph::Pass& RenderGraph::AddPass(std::string_view name, QueueType queue)
+    {
+        return m_Passes.emplace_back(Pass(name, queue));
+    }
+
+    Image& RenderGraph::GetImage(Resource resource) const
+    {
+        return *m_Resources[resource].image;
+    }
+
+    VkBuffer RenderGraph::GetBuffer(Resource resource) const
+    {
+        return m_Resources[resource].buffer;
+    }
+
+    void RenderGraph::Execute()
+    {
+        m_Stats = Stats { .passes = static_cast<u32>(m_Passes.size()) };
+
+        const std::vector<bool> alive = Cull();
+
+        std::vector<u32> order;
+        for (u32 p = 0; p < m_Passes.size(); ++p) {
+            if (alive[p]) order.push_back(p);
+            else m_Stats.culled++;
+        }
+
+        PlaceTransients(order);
+
+        // Consecutive passes on one queue share a command buffer and a submit.
+        std::vector<Batch> batches;
+        std::vector<u32> passBatch(m_Passes.size(), NO_BATCH);
+
+        for (u32 p : order) {
+            const Pass& pass = m_Passes[p];
+
+            if (batches.empty() || batches.back().queue != pass.m_Queue) {
+                Batch batch { .queue = pass.m_Queue };
+                batch.dependencies.fill(NO_BATCH);
+                batches.push_back(std::move(batch));
+            }
+
+            for (const auto& wait : pass.m_Waits) batches.back().externalWaitStages |= wait.stageMask;
+
+            batches.back().passes.push_back(p);
+            passBatch[p] = static_cast<u32>(batches.size() - 1);
+        }
+
+        std::vector<std::vector<Barrier>> passBarriers(m_Passes.size());
+
+        for (u32 p : order) {
+            for (const auto& use : m_Passes[p].m_Uses) {
+                CompileUse(p, use, batches, passBatch[p], passBarriers[p]);
+            }
+        }
+
+        std::vector<VkSemaphoreSubmitInfo> batchSignals(batches.size());
+
+        for (u32 b = 0; b < batches.size(); ++b) {
+            Batch& batch = batches[b];
+            VkCommandBuffer cmd = BeginCommandBuffer(batch.queue);
+
+            // Barriers of passes without a callback wait to be flushed with the next pass that records
+            // something, unless the same resource is already in the batch: barriers within one call are
+            // unordered.
+            std::vector<Barrier> pending;
+
+            auto Flush = [&]() {
+                if (pending.empty()) return;
+
+                std::vector<VkImageMemoryBarrier2> images;
+                std::vector<VkBufferMemoryBarrier2> buffers;
+
+                for (const auto& barrier : pending) {
+                    if (barrier.isImage) images.push_back(barrier.image);
+                    else buffers.push_back(barrier.buffer);
+                }
+
+                VkDependencyInfo dependency {
+                    .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                    .pNext = nullptr,
+                    .dependencyFlags = 0,
+                    .memoryBarrierCount = 0,
+                    .pMemoryBarriers = nullptr,
+                    .bufferMemoryBarrierCount = static_cast<u32>(buffers.size()),
+                    .pBufferMemoryBarriers = buffers.data(),
+                    .imageMemoryBarrierCount = static_cast<u32>(images.size()),
+                    .pImageMemoryBarriers = images.data()
+                };
+
+                vkCmdPipelineBarrier2(cmd, &dependency);
+
+                m_Stats.barrierBatches++;
+                m_Stats.imageBarriers += static_cast<u32>(images.size());
+                m_Stats.bufferBarriers += static_cast<u32>(buffers.size());
+
+                pending.clear();
+            };
+
+            auto Push = [&](const Barrier& barrier) {
+                if (std::ranges::any_of(pending, [&](const Barrier& other) { return other.resource == barrier.resource; })) Flush();
+                pending.push_back(barrier);
+            };
+
+            for (u32 p : batch.passes) {
+                for (const auto& barrier : passBarriers[p]) Push(barrier);
+
+                if (m_Passes[p].m_Execute) {
+                    Flush();
+                    m_Passes[p].m_Execute(cmd);
+                }
+            }
+
+            for (const auto& release : batch.releases) Push(release);
+            Flush();
+
+            VK_CHECK(vkEndCommandBuffer(cmd));
+
+            std::vector<VkSemaphoreSubmitInfo> wait;
+            std::vector<VkSemaphoreSubmitInfo> signal;
+
+            for (u32 dependency : batch.dependencies) {
+                if (dependency != NO_BATCH) wait.push_back(batchSignals[dependency]);
+            }
+
+            for (u32 p : batch.passes) {
+                wait.insert(wait.end(), m_Passes[p].m_Waits.begin(), m_Passes[p].m_Waits.end());
+                signal.insert(signal.end(), m_Passes[p].m_Signals.begin(), m_Passes[p].m_Signals.end());
+            }
+
+            batchSignals[b] = Submit(batch.queue, cmd, wait, signal);
+            m_Stats.submits++;
+        }
+
+        // Later frames start from where this one left the imported resources; their batches are gone by then.
+        for (auto& resource : m_Resources) {
+            if (resource.transient >= 0) continue;
+
+            State state = resource.state;
+            state.batch = NO_BATCH;
+
+            if (resource.image) m_ImageHistory[resource.image->GetImage()] = state;
+            else m_BufferHistory[resource.buffer] = state;
+        }
+    }
+
+    std::vector<bool> RenderGraph::Cull()
+    {
+        // Backwards from the passes with effects outside the graph: imported resources outlive the frame,
+        // so any write to them counts, as do semaphore signals and KeepAlive. A pass survives if it writes
+        // something a surviving later pass reads, or partially rewrites.
+        std::vector<bool> alive(m_Passes.size(), false);
+        std::vector<bool> needed(m_Resources.size(), false);
+
+        for (usize p = m_Passes.size(); p-- > 0;) {
+            const Pass& pass = m_Passes[p];
+
+            bool keep = pass.m_KeepAlive || !pass.m_Signals.empty();
+            for (const auto& use : pass.m_Uses) {
+                if (use.write && (m_Resources[use.resource].transient < 0 || needed[use.resource])) keep = true;
+            }
+
+            if (!keep) continue;
+            alive[p] = true;
+
+            for (const auto& use : pass.m_Uses) {
+                if (use.overwrite) needed[use.resource] = false;
+            }
+
+            for (const auto& use : pass.m_Uses) {
+                if (!use.overwrite) needed[use.resource] = true;
+            }
+        }
+
+        return alive;
+    }
+
+    void RenderGraph::PlaceTransients(const std::vector<u32>& order)
+    {
+        TransientHeap& heap = m_Heaps[m_Device->GetCurrentFrameIndex()];
+
+        // Lifetimes in surviving-pass order; transients only culled passes touch are left unplaced.
+        std::vector<u32> placed;
+
+        for (u32 t = 0; t < m_Transients.size(); ++t) {
+            TransientEntry& transient = m_Transients[t];
+            transient.firstPass = NO_BATCH;
+            transient.lastPass = 0;
+
+            for (u32 i = 0; i < order.size(); ++i) {
+                for (const auto& use : m_Passes[order[i]].m_Uses) {
+                    if (use.resource != transient.resource) continue;
+
+                    transient.firstPass = std::min(transient.firstPass, i);
+                    transient.lastPass = std::max(transient.lastPass, i);
+                }
+            }
+
+            if (transient.firstPass == NO_BATCH) continue;
+
+            VkMemoryRequirements2 requirements {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+                .pNext = nullptr
+            };
+
+            if (transient.isImage) {
+                const VkImageCreateInfo imageInfo = MakeImageInfo(transient.imageSpec);
+                const VkDeviceImageMemoryRequirements info {
+                    .sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+                    .pNext = nullptr,
+                    .pCreateInfo = &imageInfo,
+                    .planeAspect = VK_IMAGE_ASPECT_NONE
+                };
+                vkGetDeviceImageMemoryRequirements(m_Device->GetDevice(), &info, &requirements);
+            } else {
+                const VkBufferCreateInfo bufferInfo = MakeBufferInfo(transient.bufferSpec);
+                const VkDeviceBufferMemoryRequirements info {
+                    .sType = VK_STRUCTURE_TYPE_DEVICE_BUFFER_MEMORY_REQUIREMENTS,
+                    .pNext = nullptr,
+                    .pCreateInfo = &bufferInfo
+                };
+                vkGetDeviceBufferMemoryRequirements(m_Device->GetDevice(), &info, &requirements);
+            }
+
+            transient.requirements = requirements.memoryRequirements;
+            placed.push_back(t);
+        }
+
+        // Largest first, each at the lowest offset clear of every placed transient alive at the same time.
+        std::ranges::sort(placed, [&](u32 a, u32 b) { return m_Transients[a].requirements.size > m_Transients[b].requirements.size; });
+
+        VkDeviceSize heapSize = 0;
+        VkDeviceSize alignment = 1;
+        u32 memoryTypes = ~0u;
+
+        // Buffers and optimal-tiling images alive at the same time must not share a bufferImageGranularity
+        // page, so between the two kinds both ends of a range are rounded out to whole pages.
+        const VkDeviceSize granularity = std::max<VkDeviceSize>(1, m_Device->GetProps().properties.limits.bufferImageGranularity);
+        bool images = false;
+        bool buffers = false;
+
+        for (usize i = 0; i < placed.size(); ++i) {
+            TransientEntry& transient = m_Transients[placed[i]];
+            const VkMemoryRequirements& req = transient.requirements;
+
+            VkDeviceSize offset = 0;
+            for (bool moved = true; moved;) {
+                moved = false;
+
+                for (usize j = 0; j < i; ++j) {
+                    const TransientEntry& other = m_Transients[placed[j]];
+                    if (!Overlaps(transient.firstPass, transient.lastPass, other.firstPass, other.lastPass)) continue;
+
+                    const VkDeviceSize page = other.isImage != transient.isImage ? granularity : 1;
+                    const VkDeviceSize otherEnd = VkUtils::AlignUp(other.offset + other.requirements.size, page);
+                    if (offset >= otherEnd || other.offset >= VkUtils::AlignUp(offset + req.size, page)) continue;
+
+                    offset = VkUtils::AlignUp(otherEnd, req.alignment);
+                    moved = true;
+                }
+            }
+
+            transient.offset = offset;
+            heapSize = std::max(heapSize, offset + req.size);
+            alignment = std::max(alignment, req.alignment);
+            memoryTypes &= req.memoryTypeBits;
+
+            if (transient.isImage) images = true;
+            else buffers = true;
+
+            m_Stats.transients++;
+            m_Stats.transientBytes += req.size;
+        }
+
+        // Pages are counted from the start of the heap, so it has to start on one.
+        if (images && buffers) alignment = std::max(alignment, granularity);
+
+        // A transient taking over memory must wait for the ones that used it before.
+        for (u32 t : placed) {
+            TransientEntry& transient = m_Transients[t];
+            transient.predecessors.clear();
+
+            for (u32 o : placed) {
+                const TransientEntry& other = m_Transients[o];
+                if (o == t || other.lastPass >= transient.firstPass) continue;
+                if (transient.offset >= other.offset + other.requirements.size || other.offset >= transient.offset + transient.requirements.size) continue;
+
+                transient.predecessors.push_back(o);
+            }
+        }
+
+        // Without a memory type every transient accepts, nothing is aliased.
+        const bool aliased = placed.empty() || memoryTypes != 0;
+        if (!aliased) {
+            LOG_WARN("Render graph transients share no memory type; allocating them separately");
+
+            heapSize = 0;
+            for (u32 t : placed) heapSize += m_Transients[t].requirements.size;
+        }
+
+        m_Stats.transientHeapBytes = heapSize;
+
+        std::vector<TransientKey> signature;
+        signature.reserve(m_Transients.size());
+
+        for (const auto& transient : m_Transients) {
+            signature.push_back(TransientKey {
+                .isImage = transient.isImage,
+                .width = transient.imageSpec.extent.width,
+                .height = transient.imageSpec.extent.height,
+                .format = transient.imageSpec.format,
+                .usage = transient.isImage ? transient.imageSpec.usage : transient.bufferSpec.usage,
+                .size = transient.bufferSpec.size,
+                .offset = transient.firstPass == NO_BATCH ? VK_WHOLE_SIZE : transient.offset
+            });
+        }
+
+        // The previous frame in this slot has finished, so a changed graph can replace its transients.
+        if (signature != heap.signature) {
+            DestroyTransients(heap);
+
+            heap.signature = std::move(signature);
+            heap.objects.resize(m_Transients.size());
+            heap.size = heapSize;
+
+            VmaAllocationCreateInfo allocationInfo;
+            memset(&allocationInfo, 0, sizeof(VmaAllocationCreateInfo));
+            allocationInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+            VmaAllocation shared = VK_NULL_HANDLE;
+            if (aliased && heapSize > 0) {
+                const VkMemoryRequirements requirements { heapSize, alignment, memoryTypes };
+                VK_CHECK(vmaAllocateMemory(m_Device->GetAllocator(), &requirements, &allocationInfo, &shared, nullptr));
+                heap.allocations.push_back(shared);
+            }
+
+            for (u32 t : placed) {
+                const TransientEntry& transient = m_Transients[t];
+                auto& object = heap.objects[t];
+
+                VmaAllocation allocation = shared;
+                VkDeviceSize offset = transient.offset;
+
+                if (!aliased) {
+                    VK_CHECK(vmaAllocateMemory(m_Device->GetAllocator(), &transient.requirements, &allocationInfo, &allocation, nullptr));
+                    heap.allocations.push_back(allocation);
+                    offset = 0;
+                }
+
+                if (transient.isImage) {
+                    const VkImageCreateInfo imageInfo = MakeImageInfo(transient.imageSpec);
+                    VK_CHECK(vkCreateImage(m_Device->GetDevice(), &imageInfo, nullptr, &object.vkImage));
+                    VK_CHECK(vmaBindImageMemory2(m_Device->GetAllocator(), allocation, offset, object.vkImage, nullptr));
+
+                    object.image = std::make_unique<Image>(m_Device, object.vkImage, Image::Spec {
+                        .extent = imageInfo.extent,
+                        .format = imageInfo.format,
+                        .usage = imageInfo.usage,
+                        .memory = VMA_MEMORY_USAGE_GPU_ONLY
+                    });
+                } else {
+                    const VkBufferCreateInfo bufferInfo = MakeBufferInfo(transient.bufferSpec);
+                    VK_CHECK(vkCreateBuffer(m_Device->GetDevice(), &bufferInfo, nullptr, &object.buffer));
+                    VK_CHECK(vmaBindBufferMemory2(m_Device->GetAllocator(), allocation, offset, object.buffer, nullptr));
+                }
+            }
+        }
+
+        for (u32 t : placed) {
+            auto& object = heap.objects[t];
+            ResourceEntry& resource = m_Resources[m_Transients[t].resource];
+
+            // Aliased memory holds nothing worth keeping from one use to the next.
+            if (object.image) {
+                object.image->DiscardContents();
+                resource.image = object.image.get();
+            } else {
+                resource.buffer = object.buffer;
+            }
+        }
+    }
+
+    void RenderGraph::DestroyTransients(TransientHeap& heap)
+    {
+        for (auto& object : heap.objects) {
+            object.image.reset();
+            if (object.vkImage != VK_NULL_HANDLE) vkDestroyImage(m_Device->GetDevice(), object.vkImage, nullptr);
+            if (object.buffer != VK_NULL_HANDLE) vkDestroyBuffer(m_Device->GetDevice(), object.buffer, nullptr);
+        }
+
+        for (VmaAllocation allocation : heap.allocations) vmaFreeMemory(m_Device->GetAllocator(), allocation);
+
+        heap.objects.clear();
+        heap.allocations.clear();
+        heap.signature.clear();
+        heap.size = 0;
+    }
+
+    void RenderGraph::CompileUse(u32 pass, const Pass::Use& use, std::vector<Batch>& batches, u32 batch, std::vector<Barrier>& barriers)
+    {
+        const QueueType queue = m_Passes[pass].m_Queue;
+        ResourceEntry& resource = m_Resources[use.resource];
+        State& state = resource.state;
+
+        // A barrier behind a semaphore wait on another queue only chains to the wait through a source stage
+        // in the wait's stage mask; ALL_COMMANDS meets it whichever stage the wait names.
+        VkPipelineStageFlags2 waitStages = batches[batch].externalWaitStages;
+
+        auto AddDependency = [&](u32 source) {
+            u32& dependency = batches[batch].dependencies[static_cast<usize>(batches[source].queue)];
+            if (dependency == NO_BATCH || dependency < source) dependency = source;
+            waitStages |= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        };
+
+        VkPipelineStageFlags2 srcStages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 srcAccess = VK_ACCESS_2_NONE;
+        bool needed = false;
+
+        // First use of an aliased transient: whatever ran in its memory before has to be done with it.
+        if (resource.transient >= 0 && !state.queue) {
+            for (u32 predecessor : m_Transients[resource.transient].predecessors) {
+                const State& previous = m_Resources[m_Transients[predecessor].resource].state;
+                if (!previous.queue) continue;
+
+                if (*previous.queue == queue) {
+                    srcStages |= previous.writeStages | previous.readStages;
+                    srcAccess |= previous.writeAccess;
+                    needed = true;
+                } else if (previous.batch != NO_BATCH) {
+                    AddDependency(previous.batch);
+                }
+            }
+        }
+
+        const bool isImage = resource.image != nullptr;
+        const VkImageLayout layout = isImage ? use.access.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+        bool discard = use.overwrite || (isImage && resource.image->GetLayout() == VK_IMAGE_LAYOUT_UNDEFINED);
+
+        bool transitioned = false;
+
+        if (state.queue && *state.queue != queue) {
+            // The semaphore orders the two queues and makes every earlier write visible; what is left is
+            // the layout and, between exclusive families, the ownership.
+            if (state.batch != NO_BATCH) AddDependency(state.batch);
+
+            const u32 srcFamily = GetFamily(*state.queue);
+            const u32 dstFamily = GetFamily(queue);
+            bool transfer = !resource.concurrent && srcFamily != dstFamily && !discard;
+
+            if (transfer && state.batch == NO_BATCH) {
+                LOG_WARN("Render graph: {} moves to another queue family across frames with its contents kept; they are dropped", resource.name);
+                transfer = false;
+                discard = true;
+            }
+
+            if (transfer) {
+                const VkImageLayout oldLayout = isImage ? resource.image->GetLayout() : VK_IMAGE_LAYOUT_UNDEFINED;
+
+                // Release at the end of the source batch, acquire here; both name the same layouts.
+                batches[state.batch].releases.push_back(MakeBarrier(resource, use.resource, oldLayout, layout,
+                    state.writeStages | state.readStages, state.writeAccess,
+                    VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+                    srcFamily, dstFamily));
+
+                barriers.push_back(MakeBarrier(resource, use.resource, oldLayout, layout,
+                    VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+                    use.access.stages, use.access.access,
+                    srcFamily, dstFamily));
+
+                m_Stats.ownershipTransfers++;
+                transitioned = true;
+            } else if (isImage && (discard || resource.image->GetLayout() != layout)) {
+                barriers.push_back(MakeBarrier(resource, use.resource,
+                    discard ? VK_IMAGE_LAYOUT_UNDEFINED : resource.image->GetLayout(), layout,
+                    srcStages | waitStages, srcAccess,
+                    use.access.stages, use.access.access,
+                    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED));
+
+                transitioned = true;
+            }
+
+            state.writeStages = VK_PIPELINE_STAGE_2_NONE;
+            state.writeAccess = VK_ACCESS_2_NONE;
+            state.readStages = VK_PIPELINE_STAGE_2_NONE;
+        } else {
+            // Read after write, unless an earlier barrier already made the write visible to these stages;
+            // write after write; write after read.
+            if (state.writeStages != VK_PIPELINE_STAGE_2_NONE && (use.write || (use.access.stages & ~state.readStages) != 0)) {
+                srcStages |= state.writeStages;
+                srcAccess |= state.writeAccess;
+                needed = true;
+            }
+
+            if (use.write && state.readStages != VK_PIPELINE_STAGE_2_NONE) {
+                srcStages |= state.readStages;
+                needed = true;
+            }
+
+            const VkImageLayout oldLayout = isImage && !discard ? resource.image->GetLayout() : VK_IMAGE_LAYOUT_UNDEFINED;
+            transitioned = isImage && oldLayout != layout;
+
+            if (transitioned) {
+                srcStages |= state.writeStages | state.readStages;
+                srcAccess |= state.writeAccess;
+                needed = true;
+            }
+
+            if (needed) {
+                barriers.push_back(MakeBarrier(resource, use.resource, transitioned ? oldLayout : layout, layout,
+                    srcStages | waitStages, srcAccess,
+                    use.access.stages, use.access.access,
+                    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED));
+            }
+        }
+
+        state.queue = queue;
+        state.batch = batch;
+
+        if (use.write) {
+            state.writeStages = use.access.stages;
+            state.writeAccess = use.access.access;
+            state.readStages = VK_PIPELINE_STAGE_2_NONE;
+        } else if (transitioned) {
+            // Later stages chain onto the barrier that moved the layout.
+            state.writeStages = use.access.stages;
+            state.writeAccess = VK_ACCESS_2_NONE;
+            state.readStages = use.access.stages;
+        } else {
+            state.readStages |= use.access.stages;
+        }
+    }
+
+    RenderGraph::Barrier RenderGraph::MakeBarrier(const ResourceEntry& resource, Resource handle, VkImageLayout oldLayout, VkImageLayout newLayout,
+        VkPipelineStageFlags2 srcStages, VkAccessFlags2 srcAccess,
+        VkPipelineStageFlags2 dstStages, VkAccessFlags2 dstAccess,
+        u32 srcFamily, u32 dstFamily)
+    {
+        Barrier barrier { .resource = handle, .isImage = resource.image != nullptr, .image = {}, .buffer = {} };
+
+        if (barrier.isImage) {
+            barrier.image = resource.image->MakeBarrier(newLayout, srcStages, dstStages, srcAccess, dstAccess, srcFamily, dstFamily);
+
+            // The tracked layout has already moved when the acquire half of a transfer is built, and
+            // Image::MakeBarrier starts undefined layouts at the top of the pipe where the source scope
+            // still has to cover earlier users of the memory and any semaphore wait.
+            barrier.image.oldLayout = oldLayout;
+            barrier.image.srcStageMask = srcStages;
+            barrier.image.srcAccessMask = srcAccess;
+        } else {
+            barrier.buffer = VkBufferMemoryBarrier2 {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask = srcStages,
+                .srcAccessMask = srcAccess,
+                .dstStageMask = dstStages,
+                .dstAccessMask = dstAccess,
+                .srcQueueFamilyIndex = srcFamily,
+                .dstQueueFamilyIndex = dstFamily,
+                .buffer = resource.buffer,
+                .offset = 0,
+                .size = VK_WHOLE_SIZE
+            };
+        }
+
+        return barrier;
+    }
+
+    VkCommandBuffer RenderGraph::BeginCommandBuffer(QueueType queue)
+    {
+        CommandPool& pool = m_CommandPools[m_Device->GetCurrentFrameIndex()][static_cast<usize>(queue)];
+
+        if (pool.used == pool.buffers.size()) {
+            VkCommandBufferAllocateInfo allocateInfo {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .commandPool = pool.pool,
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1
+            };
+
+            VK_CHECK(vkAllocateCommandBuffers(m_Device->GetDevice(), &allocateInfo, &pool.buffers.emplace_back()));
+        }
+
+        VkCommandBuffer cmd = pool.buffers[pool.used++];
+
+        VkCommandBufferBeginInfo beginInfo {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = nullptr
+        };
+
+        VK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+
+        return cmd;
+    }
+
+    VkSemaphoreSubmitInfo RenderGraph::Submit(QueueType queue, VkCommandBuffer cmd, std::vector<VkSemaphoreSubmitInfo>& wait, std::vector<VkSemaphoreSubmitInfo>& signal)
+    {
+        switch (queue) {
+            case QueueType::Graphics: return m_Device->Submit<QueueType::Graphics>(cmd, wait, signal);
+            case QueueType::Compute: return m_Device->Submit<QueueType::Compute>(cmd, wait, signal);
+            case QueueType::Transfer: return m_Device->Submit<QueueType::Transfer>(cmd, wait, signal);
+        }
+
+        return {};
+    }
+
+    u32 RenderGraph::GetFamily(QueueType queue) const
+    {
+        switch (queue) {
+            case QueueType::Graphics: return m_Device->GetQueueFamily<QueueType::Graphics>();
+            case QueueType::Compute: return m_Device->GetQueueFamily<QueueType::Compute>();
+            case QueueType::Transfer: return m_Device->GetQueueFamily<QueueType::Transfer>();
+        }
+
+        return VK_QUEUE_FAMILY_IGNORED;
+    }
+
+}
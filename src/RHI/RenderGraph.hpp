@@ -0,0 +1,284 @@
+#pragma once
+
+#include "VkTypes.hpp"
+#include "Device.hpp"
+
+namespace RHI {
+
+    class Image;
+    class Buffer;
+
+    // One frame's passes across the graphics, compute and transfer queues. Passes declare the resources
+    // they read and write; Execute culls the passes nothing observes, aliases the memory of transient
+    // resources whose lifetimes do not overlap, and records every run of same-queue passes as one submit,
+    // with the barriers, queue ownership transfers and semaphore waits between them derived from those
+    // declarations.
+    //
+    // Imported resources carry their state from one frame to the next. Work of earlier frames on other
+    // queues is taken as finished, which Device::SyncFrame guarantees for per-frame resources.
+    class RenderGraph
+    {
+    public:
+        using Resource = u32;
+
+        // One use of a resource by a pass; layout is ignored for buffers.
+        struct Access
+        {
+            VkPipelineStageFlags2 stages { VK_PIPELINE_STAGE_2_NONE };
+            VkAccessFlags2 access { VK_ACCESS_2_NONE };
+            VkImageLayout layout { VK_IMAGE_LAYOUT_UNDEFINED };
+        };
+
+        struct TransientImageSpec
+        {
+            VkExtent2D extent;
+            VkFormat format;
+            VkImageUsageFlags usage;
+        };
+
+        struct TransientBufferSpec
+        {
+            VkDeviceSize size;
+            VkBufferUsageFlags usage;
+        };
+
+        // Counts of the latest Execute.
+        struct Stats
+        {
+            u32 passes { 0 };
+            u32 culled { 0 };
+            u32 submits { 0 };
+
+            // vkCmdPipelineBarrier2 calls, and the barriers batched into them.
+            u32 barrierBatches { 0 };
+            u32 imageBarriers { 0 };
+            u32 bufferBarriers { 0 };
+
+            // Release and acquire pairs between queue families.
+            u32 ownershipTransfers { 0 };
+
+            // Transient resources, their summed sizes and the memory backing them once aliased.
+            u32 transients { 0 };
+            VkDeviceSize transientBytes { 0 };
+            VkDeviceSize transientHeapBytes { 0 };
+
+            bool operator==(const Stats&) const = default;
+        };
+
+        class Pass
+        {
+        public:
+            Pass& Read(Resource resource, const Access& access);
+            Pass& Write(Resource resource, const Access& access);
+
+            // A write covering the whole resource: its previous contents, layout and queue ownership are
+            // dropped instead of carried over.
+            Pass& Overwrite(Resource resource, const Access& access);
+
+            // Semaphores from outside the graph, waited on and signalled by the submit holding the pass.
+            Pass& Wait(const VkSemaphoreSubmitInfo& semaphore);
+            Pass& Signal(const VkSemaphoreSubmitInfo& semaphore);
+
+            // Kept even when no later pass reads what it writes, for effects outside the graph that are
+            // neither writes to imported resources nor signals, such as host reads.
+            Pass& KeepAlive();
+
+            // Recorded after the pass's barriers; a pass without one only contributes barriers.
+            Pass& Execute(std::function<void(VkCommandBuffer)> func);
+
+        private:
+            friend class RenderGraph;
+
+            struct Use
+            {
+                Resource resource;
+                Access access;
+                bool write;
+                bool overwrite;
+            };
+
+            Pass(std::string_view name, QueueType queue);
+
+        private:
+            std::string m_Name;
+            QueueType m_Queue;
+
+            std::vector<Use> m_Uses;
+            std::vector<VkSemaphoreSubmitInfo> m_Waits;
+            std::vector<VkSemaphoreSubmitInfo> m_Signals;
+
+            bool m_KeepAlive { false };
+            std::function<void(VkCommandBuffer)> m_Execute;
+        };
+
+    public:
+        RenderGraph(const std::shared_ptr<Device>& device);
+        ~RenderGraph();
+
+        // Starts the current frame slot's graph; the previous frame's passes and handles are dropped.
+        void Begin();
+
+        Resource Import(Image& image);
+        Resource Import(const Buffer& buffer);
+
+        Resource CreateImage(std::string_view name, const TransientImageSpec& spec);
+        Resource CreateBuffer(std::string_view name, const TransientBufferSpec& spec);
+
+        // The reference stays valid until the next Begin.
+        Pass& AddPass(std::string_view name, QueueType queue);
+
+        // Transients only exist once Execute has placed them, so inside pass callbacks.
+        Image& GetImage(Resource resource) const;
+        VkBuffer GetBuffer(Resource resource) const;
+
+        void Execute();
+
+        // Forgets the state carried for imported resources, for when their handles are recreated.
+        inline void ResetHistory()
+        {
+            m_ImageHistory.clear();
+            m_BufferHistory.clear();
+        }
+
+        inline const Stats& GetStats() const { return m_Stats; }
+
+    private:
+        inline static constexpr u32 NO_BATCH { std::numeric_limits<u32>::max() };
+        inline static constexpr usize QUEUE_COUNT { 3 };
+
+        // Where a resource was last touched and what a following access has to wait for: the last write,
+        // and the stages that have read it, or been made to see it, since.
+        struct State
+        {
+            std::optional<QueueType> queue;
+            u32 batch { NO_BATCH };
+
+            VkPipelineStageFlags2 writeStages { VK_PIPELINE_STAGE_2_NONE };
+            VkAccessFlags2 writeAccess { VK_ACCESS_2_NONE };
+            VkPipelineStageFlags2 readStages { VK_PIPELINE_STAGE_2_NONE };
+        };
+
+        struct ResourceEntry
+        {
+            std::string name;
+
+            Image* image { nullptr };
+            VkBuffer buffer { VK_NULL_HANDLE };
+            VkDeviceSize size { 0 };
+            bool concurrent { false };
+
+            // Index into the frame's transient list, or -1 when imported.
+            i32 transient { -1 };
+
+            State state;
+        };
+
+        struct TransientEntry
+        {
+            Resource resource;
+            bool isImage;
+            TransientImageSpec imageSpec;
+            TransientBufferSpec bufferSpec;
+
+            VkMemoryRequirements requirements;
+            u32 firstPass;
+            u32 lastPass;
+            VkDeviceSize offset;
+
+            // Transients placed over the same memory whose lifetime ends before this one's starts.
+            std::vector<u32> predecessors;
+        };
+
+        struct TransientKey
+        {
+            bool isImage;
+            u32 width;
+            u32 height;
+            VkFormat format;
+            VkFlags usage;
+            VkDeviceSize size;
+            VkDeviceSize offset;
+
+            bool operator==(const TransientKey&) const = default;
+        };
+
+        // Transients of one frame slot, kept until the graph's shape changes.
+        struct TransientHeap
+        {
+            struct Object
+            {
+                std::unique_ptr<Image> image;
+                VkImage vkImage { VK_NULL_HANDLE };
+                VkBuffer buffer { VK_NULL_HANDLE };
+            };
+
+            // Specs and offsets the objects were created for.
+            std::vector<TransientKey> signature;
+
+            std::vector<VmaAllocation> allocations;
+            std::vector<Object> objects;
+            VkDeviceSize size { 0 };
+        };
+
+        struct Barrier
+        {
+            Resource resource;
+            bool isImage;
+            VkImageMemoryBarrier2 image;
+            VkBufferMemoryBarrier2 buffer;
+        };
+
+        struct Batch
+        {
+            QueueType queue;
+            std::vector<u32> passes;
+
+            // Latest batch of each queue this one waits for.
+            std::array<u32, QUEUE_COUNT> dependencies;
+
+            std::vector<Barrier> releases;
+            VkPipelineStageFlags2 externalWaitStages { VK_PIPELINE_STAGE_2_NONE };
+        };
+
+        struct CommandPool
+        {
+            VkCommandPool pool { VK_NULL_HANDLE };
+            std::vector<VkCommandBuffer> buffers;
+            u32 used { 0 };
+        };
+
+    private:
+        std::vector<bool> Cull();
+        void PlaceTransients(const std::vector<u32>& order);
+        void DestroyTransients(TransientHeap& heap);
+
+        void CompileUse(u32 pass, const Pass::Use& use, std::vector<Batch>& batches, u32 batch, std::vector<Barrier>& barriers);
+        Barrier MakeBarrier(const ResourceEntry& resource, Resource handle, VkImageLayout oldLayout, VkImageLayout newLayout,
+            VkPipelineStageFlags2 srcStages, VkAccessFlags2 srcAccess,
+            VkPipelineStageFlags2 dstStages, VkAccessFlags2 dstAccess,
+            u32 srcFamily, u32 dstFamily);
+
+        VkCommandBuffer BeginCommandBuffer(QueueType queue);
+        VkSemaphoreSubmitInfo Submit(QueueType queue, VkCommandBuffer cmd, std::vector<VkSemaphoreSubmitInfo>& wait, std::vector<VkSemaphoreSubmitInfo>& signal);
+        u32 GetFamily(QueueType queue) const;
+
+    private:
+        std::shared_ptr<Device> m_Device;
+
+        std::deque<Pass> m_Passes;
+        std::vector<ResourceEntry> m_Resources;
+        std::vector<TransientEntry> m_Transients;
+
+        std::unordered_map<VkImage, Resource> m_ImportedImages;
+        std::unordered_map<VkBuffer, Resource> m_ImportedBuffers;
+
+        std::unordered_map<VkImage, State> m_ImageHistory;
+        std::unordered_map<VkBuffer, State> m_BufferHistory;
+
+        PerFrame<TransientHeap> m_Heaps;
+        PerFrame<std::array<CommandPool, QUEUE_COUNT>> m_CommandPools;
+
+        Stats m_Stats;
+    };
+
+}
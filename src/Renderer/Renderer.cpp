@@ -3,8 +3,16 @@
 #include "Core/Window.hpp"
 
 #include "Scene/SceneLoader.hpp"
+#include "Scene/AlphaCoverage.hpp"
+#include "Scene/ParticleField.hpp"
+#include "Scene/LightTable.hpp"
+#include "Scene/LightTree.hpp"
+#include "Scene/EnvironmentMap.hpp"
+#include "CPU/ThreadPool.hpp"
 #include "PathConfig.inl"
 
+#include <glm/gtc/packing.hpp>
+
 namespace {
 
     std::filesystem::path s_ShaderPath(PathConfig::ShaderDir);
@@ -31,15 +39,123 @@ namespace {
         u64 vertex;
         u64 index;
         u32 material;
-        u32 _p;
+        u32 alphaMask;
     };
 
+    // RenderObject::alphaMask of geometry without micro-triangle coverage bits.
+    inline constexpr u32 NO_ALPHA_MASK { ~0u };
+
     struct RTPushConstant
     {
         glm::uvec2 offset;
         glm::uvec2 resolution;
+        u32 samples;
+        u32 sequence;
+        u32 seed;
+        u32 lightCount;
+        u32 lightTree;
+        i32 environment;
+        u32 maxDepth;
+        u32 pathStats;
+        u32 primary;
+        u32 rayFlags;
+    };
+
+    struct RasterPushConstant
+    {
+        glm::mat4 viewProjection;
+        glm::mat4 objectToWorld;
+    };
+
+    inline constexpr VkShaderStageFlags RT_PUSH_STAGES { VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR };
+    inline constexpr VkShaderStageFlags RAY_QUERY_PUSH_STAGES { VK_SHADER_STAGE_COMPUTE_BIT };
+
+    // Shader stages of either trace backend; trace-side barriers name both, so none of them depends on
+    // which backend recorded the frame.
+    inline constexpr VkPipelineStageFlags2 TRACE_STAGES { VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT };
+
+    // local_size_x and local_size_y of pathtrace.comp.
+    inline constexpr u32 RAY_QUERY_GROUP_SIZE { 8 };
+
+    // Raster primary visibility; the formats, clear value and pc.primary bits match visibility.glsl.
+    inline constexpr VkFormat VISIBILITY_FORMAT { VK_FORMAT_R32G32B32A32_UINT };
+    inline constexpr VkFormat VISIBILITY_DEPTH_FORMAT { VK_FORMAT_D32_SFLOAT };
+    inline constexpr u32 NO_VISIBILITY { 0xFFFFFFFFu };
+    inline constexpr u32 PRIMARY_RASTER { 1u };
+    inline constexpr u32 PRIMARY_TRACE_NON_OPAQUE { 2u };
+
+    // gl_RayFlagsOpaqueEXT, pushed as pc.rayFlags to skip the alpha test on radiance and shadow rays.
+    inline constexpr u32 RAY_FLAG_OPAQUE { 1u };
+
+    // Per frame slot: trace begin and end on the compute queue, visibility pass begin and end on the
+    // graphics queue.
+    inline constexpr u32 TIMESTAMPS_PER_FRAME { 4 };
+
+    // Albedo, normal, depth, IDs; matches the binding order 5..8 in path.glsl.
+    inline constexpr std::array<VkFormat, 4> AOV_FORMATS {
+        VK_FORMAT_R16G16B16A16_SFLOAT,
+        VK_FORMAT_R16G16B16A16_SFLOAT,
+        VK_FORMAT_R32_SFLOAT,
+        VK_FORMAT_R32G32_UINT
     };
 
+    inline constexpr std::array<u32, 4> AOV_TEXEL_SIZES { 8, 8, 4, 8 };
+    inline constexpr std::array<std::string_view, 4> AOV_SUFFIXES { "_albedo.exr", "_normal.exr", "_depth.pfm", "_ids.pfm" };
+
+    inline constexpr u32 AOV_SPEC_CONSTANT { 0 };
+    inline constexpr u32 AOV_INVALID_ID { 0xFFFFFFFFu };
+
+    // Raygen traces each path segment and the closest-hit shader its shadow ray; nothing nests deeper.
+    inline constexpr u32 RT_RECURSION_DEPTH { 2 };
+
+    // Instance SBT offset of procedural geometry: hit groups 0 and 1 are the triangle radiance and AOV
+    // groups, 2 and 3 their procedural counterparts, so AOV_SBT_OFFSET lands on the right one for both.
+    inline constexpr u32 PROCEDURAL_SBT_OFFSET { 2 };
+
+    // Level-1 icosphere, the tessellation the procedural BLAS is compared against (bench procedural).
+    inline constexpr u64 ICOSPHERE_TRIANGLES { 80 };
+    inline constexpr u64 ICOSPHERE_VERTICES { 42 };
+
+    // Adds a particle field filling the scene's bounds, with its own plain diffuse material.
+    void ScatterParticles(Scene::SceneData& scene, u32 count)
+    {
+        glm::vec3 min(std::numeric_limits<f32>::max());
+        glm::vec3 max(std::numeric_limits<f32>::lowest());
+
+        for (const auto& node : scene.nodes) {
+            for (const auto& primitive : scene.meshes[node.meshIndex].primitives) {
+                for (u32 i = 0; i < primitive.indexCount; ++i) {
+                    const glm::vec3 position = glm::vec3(node.transform * glm::vec4(scene.vertices[scene.indices[primitive.indexOffset + i]].position, 1.0f));
+                    min = glm::min(min, position);
+                    max = glm::max(max, position);
+                }
+            }
+        }
+
+        if (min.x > max.x) {
+            min = glm::vec3(-1.0f);
+            max = glm::vec3(1.0f);
+        }
+
+        const glm::vec3 center = (min + max) * 0.5f;
+        const glm::vec3 extent = glm::max((max - min) * 0.5f, glm::vec3(1e-3f));
+
+        scene.materials.push_back(Scene::MaterialData {
+            .baseColorFactor = glm::vec4(0.8f, 0.8f, 0.8f, 1.0f),
+            .metallicFactor = 0.0f,
+            .roughnessFactor = 0.5f
+        });
+
+        scene.procedurals = Scene::ParticleField::Scatter(Scene::ParticleField::Settings {
+            .count = count,
+            .min = center - extent,
+            .max = center + extent,
+            .minRadius = glm::length(extent) * 0.004f,
+            .maxRadius = glm::length(extent) * 0.016f,
+            .material = static_cast<u32>(scene.materials.size() - 1)
+        });
+    }
+
 }
 
 Renderer::Renderer(const std::shared_ptr<Window>& window, const Settings& settings)
@@ -47,7 +163,15 @@ Renderer::Renderer(const std::shared_ptr<Window>& window, const Settings& settin
         m_Width(settings.width),
         m_Height(settings.height),
         m_Samples(settings.samples),
-        m_TileSize(settings.tile)
+        m_TileSize(settings.tile),
+        m_Sobol(settings.sobol),
+        m_Seed(settings.seed),
+        m_AOVs(settings.aovs),
+        m_LightTree(settings.lightTree),
+        m_MaxDepth(std::max(settings.maxDepth, 1u)),
+        m_PathStatsEnabled(settings.pathStats),
+        m_EnvironmentPath(settings.environment),
+        m_ParticleCount(settings.particles)
 {
     m_Instance = std::make_shared<RHI::Instance>(window);
     m_Device = std::make_shared<RHI::Device>(m_Instance);
@@ -55,7 +179,6 @@ Renderer::Renderer(const std::shared_ptr<Window>& window, const Settings& settin
     m_Swapchain = std::make_unique<RHI::Swapchain>(m_Instance, m_Device);
     m_Swapchain->Create(window->GetWidth(), window->GetHeight());
 
-    m_GraphicsCommand = std::make_unique<RHI::CommandContext<RHI::QueueType::Graphics>>(m_Device);
     m_ComputeCommand = std::make_unique<RHI::CommandContext<RHI::QueueType::Compute>>(m_Device);
     m_TransferCommand = std::make_unique<RHI::CommandContext<RHI::QueueType::Transfer>>(m_Device);
 
@@ -85,24 +208,132 @@ Renderer::Renderer(const std::shared_ptr<Window>& window, const Settings& settin
             .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
             .memory = VMA_MEMORY_USAGE_CPU_TO_GPU
         });
+
+        m_PathStatsBuffers[i] = std::make_unique<RHI::Buffer>(m_Device, RHI::Buffer::Spec {
+            .size = sizeof(PathStats),
+            .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .memory = VMA_MEMORY_USAGE_GPU_TO_CPU
+        });
     }
 
+    // Bound in place of a slot's AOV targets on frames without AOVs; the trace compiles their writes out.
+    m_AOVPlaceholders = CreateAOVTargets({ 1, 1, 1 });
+
+    // Bound as the visibility buffer when the frame has none; the raster pass renders into a graph transient.
+    m_VisibilityPlaceholder = std::make_unique<RHI::Image>(m_Device, RHI::Image::Spec {
+        .extent = { 1, 1, 1 },
+        .format = VISIBILITY_FORMAT,
+        .usage = VK_IMAGE_USAGE_STORAGE_BIT,
+        .memory = VMA_MEMORY_USAGE_GPU_ONLY
+    });
+
+    m_Graph = std::make_unique<RHI::RenderGraph>(m_Device);
+
     m_RTLayout = RHI::DescriptorLayoutBuilder(m_Device)
-        .AddBinding(0, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
-        .AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
-        .AddBinding(2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
-        .AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
-        .AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
+        .AddBinding(0, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(6, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(7, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(8, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(9, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(10, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(11, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(12, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(13, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(14, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_INTERSECTION_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(15, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(16, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT)
         .Build();
 
-    m_RayTracingPipeline = RHI::RayTracingPipelineBuilder(m_Device)
-        .AddRayGenShader(s_ShaderPath / "raygen.rgen.spv")
-        .AddMissShader(s_ShaderPath / "miss.rmiss.spv")
-        .AddClosestHitShader(s_ShaderPath / "closesthit.rchit.spv")
-        .AddLayout(m_BindlessHeap->GetLayout())
-        .AddLayout(m_RTLayout)
-        .AddPushConstant(sizeof(RTPushConstant), VK_SHADER_STAGE_RAYGEN_BIT_KHR)
-        .Build();
+    // Both variants share one layout and SBT layout; the AOV hit group and miss shader sit at offset 1 and
+    // are simply never reached when the specialisation constant compiles the AOV trace out.
+    auto BuildRayTracingPipeline = [&](bool aovs) {
+        return RHI::RayTracingPipelineBuilder(m_Device)
+            .AddRayGenShader(s_ShaderPath / "raygen.rgen.spv")
+            .AddMissShader(s_ShaderPath / "miss.rmiss.spv")
+            .AddMissShader(s_ShaderPath / "aov.rmiss.spv")
+            .AddMissShader(s_ShaderPath / "shadow.rmiss.spv")
+            .AddHitGroup(s_ShaderPath / "closesthit.rchit.spv", s_ShaderPath / "alpha.rahit.spv")
+            .AddHitGroup(s_ShaderPath / "aov.rchit.spv", s_ShaderPath / "alpha.rahit.spv")
+            .AddProceduralHitGroup(s_ShaderPath / "procedural.rchit.spv", s_ShaderPath / "procedural.rint.spv")
+            .AddProceduralHitGroup(s_ShaderPath / "procedural_aov.rchit.spv", s_ShaderPath / "procedural.rint.spv")
+            .AddLayout(m_BindlessHeap->GetLayout())
+            .AddLayout(m_RTLayout)
+            .AddPushConstant(sizeof(RTPushConstant), RT_PUSH_STAGES)
+            .AddSpecialization(AOV_SPEC_CONSTANT, aovs ? VK_TRUE : VK_FALSE)
+            .SetMaxRecursionDepth(RT_RECURSION_DEPTH)
+            .Build();
+    };
+
+    m_RayTracingPipeline = BuildRayTracingPipeline(false);
+    m_AOVPipeline = BuildRayTracingPipeline(true);
+
+    // Same layouts, push constants and AOV specialisation as the RT pipelines, so Draw only swaps the
+    // bind point and the launch.
+    if (m_Device->IsRayQuerySupported()) {
+        auto BuildRayQueryPipeline = [&](bool aovs) {
+            return RHI::ComputePipelineBuilder(m_Device)
+                .SetShader(s_ShaderPath / "pathtrace.comp.spv")
+                .AddLayout(m_BindlessHeap->GetLayout())
+                .AddLayout(m_RTLayout)
+                .AddPushConstant(sizeof(RTPushConstant), RAY_QUERY_PUSH_STAGES)
+                .AddSpecialization(AOV_SPEC_CONSTANT, aovs ? VK_TRUE : VK_FALSE)
+                .Build();
+        };
+
+        m_RayQueryPipeline = BuildRayQueryPipeline(false);
+        m_RayQueryAOVPipeline = BuildRayQueryPipeline(true);
+    }
+
+    SetTraceBackend(settings.backend);
+
+    // Rasterises instance, primitive and barycentrics into the visibility buffer; the trace rebuilds the
+    // surface from those with the same FetchSurface as a hit shader.
+    if (m_Device->IsFragmentBarycentricSupported()) {
+        std::vector<VkFormat> visibilityFormats = { VISIBILITY_FORMAT };
+
+        m_VisibilityPipeline = RHI::GraphicsPipelineBuilder(m_Device)
+            .SetVertexShader(s_ShaderPath / "visibility.vert.spv")
+            .SetFragmentShader(s_ShaderPath / "visibility.frag.spv")
+            .SetColorFormats(visibilityFormats)
+            .SetDepthTest(true, true, VK_COMPARE_OP_LESS)
+            .SetDepthFormat(VISIBILITY_DEPTH_FORMAT)
+            .AddVertexBinding(0, sizeof(Scene::Vertex))
+            .AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Scene::Vertex, position))
+            .SetInputTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+            .SetPolygonMode(VK_POLYGON_MODE_FILL)
+            .SetCullMode(VK_CULL_MODE_NONE)
+            .AddPushConstant(sizeof(RasterPushConstant), VK_SHADER_STAGE_VERTEX_BIT)
+            .Build();
+    }
+
+    SetPrimaryVisibility(settings.primary);
+
+    u32 familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_Device->GetPhysicalDevice(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_Device->GetPhysicalDevice(), &familyCount, families.data());
+
+    // The visibility pass writes its pair on the graphics queue, so both families need timestamps.
+    if (families[m_Device->GetQueueFamily<RHI::QueueType::Compute>()].timestampValidBits > 0 &&
+        families[m_Device->GetQueueFamily<RHI::QueueType::Graphics>()].timestampValidBits > 0) {
+        VkQueryPoolCreateInfo queryPoolInfo {
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .queryType = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount = TIMESTAMPS_PER_FRAME * RHI::Device::GetFrameInFlight(),
+            .pipelineStatistics = 0
+        };
+
+        VK_CHECK(vkCreateQueryPool(m_Device->GetDevice(), &queryPoolInfo, nullptr, &m_TimestampPool));
+    } else {
+        LOG_WARN("Compute or graphics queue has no timestamps; trace timings are unavailable");
+    }
 
     m_GLayout = RHI::DescriptorLayoutBuilder(m_Device)
         .AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
@@ -131,6 +362,10 @@ Renderer::~Renderer()
 {
     m_Device->WaitIdle();
 
+    if (m_ImageWriter) m_ImageWriter->Flush();
+
+    if (m_TimestampPool != VK_NULL_HANDLE) vkDestroyQueryPool(m_Device->GetDevice(), m_TimestampPool, nullptr);
+
     vkDestroyDescriptorSetLayout(m_Device->GetDevice(), m_RTLayout, nullptr);
     vkDestroyDescriptorSetLayout(m_Device->GetDevice(), m_GLayout, nullptr);
 }
@@ -153,30 +388,137 @@ void Renderer::Draw(Scene::CameraData&& cam)
 
     auto& storageTex = m_StorageTextures[m_Device->GetCurrentFrameIndex()];
     auto& camBuffer = m_CamBuffers[m_Device->GetCurrentFrameIndex()];
+    auto& pathStatsBuffer = m_PathStatsBuffers[m_Device->GetCurrentFrameIndex()];
+    bool& pathStatsPending = m_PathStatsPending[m_Device->GetCurrentFrameIndex()];
+
+    // SyncFrame has waited for this slot's previous frame, so its counters are complete.
+    if (pathStatsPending) {
+        std::memcpy(&m_PathStats, pathStatsBuffer->Map(sizeof(PathStats)), sizeof(PathStats));
+        pathStatsBuffer->Unmap();
+        pathStatsPending = false;
+    }
+
+    ReadTraceTiming(m_Device->GetCurrentFrameIndex());
+
+    const bool pathStats = m_PathStatsEnabled;
 
     camBuffer->Write(&cam, sizeof(Scene::CameraData));
 
-    VkCommandBuffer computeCmd = m_ComputeCommand->Record([&](VkCommandBuffer cmd) {
-        u32 srcQueue = m_Device->GetQueueFamily<RHI::QueueType::Graphics>();
-        u32 dstQueue = m_Device->GetQueueFamily<RHI::QueueType::Compute>();
+    const bool capture = m_CapturePath.has_value();
+    const bool aovs = m_AOVs || capture;
+
+    // A slot allocates its window-sized targets the first time it traces AOVs and keeps them after, so
+    // sessions that never enable AOVs only hold the 1x1 placeholders.
+    auto& aovSlot = m_AOVTargets[m_Device->GetCurrentFrameIndex()];
+    if (aovs && !aovSlot.albedo) aovSlot = CreateAOVTargets(storageTex->GetImage()->GetExtent());
+
+    const AOVTargets& aovTargets = aovs ? aovSlot : m_AOVPlaceholders;
+
+    const bool rayQuery = m_TraceBackend == TraceBackend::RayQuery;
+    const bool rasterPrimary = m_PrimaryVisibility == PrimaryVisibility::Rasterized;
+    const u32 timestampBase = static_cast<u32>(TIMESTAMPS_PER_FRAME * m_Device->GetCurrentFrameIndex());
+
+    u32 primaryFlags = 0;
+    if (rasterPrimary) primaryFlags = PRIMARY_RASTER | (m_NonOpaqueGeometry ? PRIMARY_TRACE_NON_OPAQUE : 0u);
+
+    auto& rtPipeline = aovs ? m_AOVPipeline : m_RayTracingPipeline;
+    auto& rayQueryPipeline = aovs ? m_RayQueryAOVPipeline : m_RayQueryPipeline;
 
-        if (storageTex->GetImage()->GetLayout() == VK_IMAGE_LAYOUT_UNDEFINED) {
-            srcQueue = VK_QUEUE_FAMILY_IGNORED;
-            dstQueue = VK_QUEUE_FAMILY_IGNORED;
+    RHI::Pipeline& pipeline = rayQuery ? static_cast<RHI::Pipeline&>(*rayQueryPipeline) : static_cast<RHI::Pipeline&>(*rtPipeline);
+    const VkPipelineBindPoint bindPoint = rayQuery ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR;
+    const VkShaderStageFlags pushStages = rayQuery ? RAY_QUERY_PUSH_STAGES : RT_PUSH_STAGES;
+
+    if (capture) {
+        const auto images = aovTargets.GetImages();
+
+        for (usize i = 0; i < images.size(); ++i) {
+            const VkExtent3D extent = images[i]->GetExtent();
+            const VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * AOV_TEXEL_SIZES[i];
+
+            if (!m_ReadbackBuffers[i] || m_ReadbackBuffers[i]->GetSize() != size) {
+                m_ReadbackBuffers[i] = std::make_unique<RHI::Buffer>(m_Device, RHI::Buffer::Spec {
+                    .size = size,
+                    .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    .memory = VMA_MEMORY_USAGE_GPU_TO_CPU
+                });
+            }
         }
+    }
 
-        storageTex->GetImage()->TransitionLayout(cmd,
-            VK_IMAGE_LAYOUT_GENERAL,
-            VK_PIPELINE_STAGE_2_NONE,
-            VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR,
-            VK_ACCESS_2_NONE,
-            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
-            srcQueue,
-            dstQueue
-        );
+    // The passes only declare what they touch; the graph places the barriers, the storage texture's and the
+    // visibility buffer's moves between the compute and graphics families, and one submit per queue run.
+    m_Graph->Begin();
+
+    auto swapchainImage = m_Swapchain->GetCurrentImage();
+
+    const RHI::RenderGraph::Resource output = m_Graph->Import(*storageTex->GetImage());
+    const RHI::RenderGraph::Resource swapchain = m_Graph->Import(*swapchainImage);
+    const RHI::RenderGraph::Resource statsBuffer = m_Graph->Import(*pathStatsBuffer);
+
+    std::array<RHI::RenderGraph::Resource, 4> aovImages;
+    for (usize i = 0; i < aovImages.size(); ++i) aovImages[i] = m_Graph->Import(*aovTargets.GetImages()[i]);
+
+    const VkExtent2D extent { storageTex->GetImage()->GetExtent().width, storageTex->GetImage()->GetExtent().height };
 
-        m_RayTracingPipeline->Bind(cmd);
-        m_BindlessHeap->Bind(cmd, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, m_RayTracingPipeline->GetLayout());
+    // Only kept when the trace reads it, so traced frames cull the raster pass and leave its memory unused.
+    RHI::RenderGraph::Resource visibility = m_Graph->Import(*m_VisibilityPlaceholder);
+
+    if (m_VisibilityPipeline) {
+        const RHI::RenderGraph::Resource rasterVisibility = m_Graph->CreateImage("Visibility", {
+            .extent = extent,
+            .format = VISIBILITY_FORMAT,
+            .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT
+        });
+
+        const RHI::RenderGraph::Resource rasterDepth = m_Graph->CreateImage("VisibilityDepth", {
+            .extent = extent,
+            .format = VISIBILITY_DEPTH_FORMAT,
+            .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+        });
+
+        m_Graph->AddPass("Visibility", RHI::QueueType::Graphics)
+            .Overwrite(rasterVisibility, {
+                VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+            })
+            .Overwrite(rasterDepth, {
+                VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+            })
+            .Execute([&, rasterVisibility, rasterDepth](VkCommandBuffer cmd) {
+                RecordVisibilityPass(cmd, m_Graph->GetImage(rasterVisibility), m_Graph->GetImage(rasterDepth), cam);
+            });
+
+        if (rasterPrimary) visibility = rasterVisibility;
+    }
+
+    if (pathStats) {
+        m_Graph->AddPass("PathStatsClear", RHI::QueueType::Compute)
+            .Overwrite(statsBuffer, { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT })
+            .Execute([&](VkCommandBuffer cmd) {
+                vkCmdFillBuffer(cmd, pathStatsBuffer->GetBuffer(), 0, sizeof(PathStats), 0);
+            });
+    }
+
+    auto& tracePass = m_Graph->AddPass("Trace", RHI::QueueType::Compute)
+        .Overwrite(output, { TRACE_STAGES, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL })
+        .Read(visibility, { TRACE_STAGES, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL });
+
+    // Frames without AOVs bind the placeholders, which still need to be in GENERAL.
+    for (RHI::RenderGraph::Resource image : aovImages) {
+        if (aovs) tracePass.Overwrite(image, { TRACE_STAGES, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL });
+        else tracePass.Read(image, { TRACE_STAGES, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL });
+    }
+
+    if (pathStats) {
+        tracePass.Write(statsBuffer, { TRACE_STAGES, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT });
+    }
+
+    tracePass.Execute([&, visibility](VkCommandBuffer cmd) {
+        pipeline.Bind(cmd);
+        m_BindlessHeap->Bind(cmd, bindPoint, pipeline.GetLayout());
 
         RHI::DescriptorWriter()
             .WriteAS(0, m_TLAS->GetAS())
@@ -184,14 +526,29 @@ void Renderer::Draw(Scene::CameraData&& cam)
             .WriteBuffer(2, camBuffer->GetBuffer(), camBuffer->GetSize(), 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
             .WriteBuffer(3, m_ObjectDescBuffer->GetBuffer(), m_ObjectDescBuffer->GetSize(), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
             .WriteBuffer(4, m_MaterialBuffer->GetBuffer(), m_MaterialBuffer->GetSize(), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
-            .Push(cmd, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, m_RayTracingPipeline->GetLayout(), 1);
-
-        auto rgen = m_RayTracingPipeline->GetRGenRegion();
-        auto miss = m_RayTracingPipeline->GetMissRegion();
-        auto hit = m_RayTracingPipeline->GetHitRegion();
-        auto call = m_RayTracingPipeline->GetCallRegion();
-
-        auto extent = storageTex->GetImage()->GetExtent();
+            .WriteImage(5, aovTargets.albedo->GetView(), VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+            .WriteImage(6, aovTargets.normal->GetView(), VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+            .WriteImage(7, aovTargets.depth->GetView(), VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+            .WriteImage(8, aovTargets.ids->GetView(), VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+            .WriteBuffer(9, m_LightBuffer->GetBuffer(), m_LightBuffer->GetSize(), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            .WriteBuffer(10, m_LightTreeBuffer->GetBuffer(), m_LightTreeBuffer->GetSize(), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            .WriteBuffer(11, m_EnvironmentBuffer->GetBuffer(), m_EnvironmentBuffer->GetSize(), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            .WriteBuffer(12, pathStatsBuffer->GetBuffer(), pathStatsBuffer->GetSize(), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            .WriteBuffer(13, m_AlphaMaskBuffer->GetBuffer(), m_AlphaMaskBuffer->GetSize(), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            .WriteBuffer(14, m_ProceduralBuffer->GetBuffer(), m_ProceduralBuffer->GetSize(), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            .WriteImage(15, m_Graph->GetImage(visibility).GetView(), VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+            .WriteBuffer(16, m_RasterDrawBuffer->GetBuffer(), m_RasterDrawBuffer->GetSize(), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            .Push(cmd, bindPoint, pipeline.GetLayout(), 1);
+
+        auto rgen = rtPipeline->GetRGenRegion();
+        auto miss = rtPipeline->GetMissRegion();
+        auto hit = rtPipeline->GetHitRegion();
+        auto call = rtPipeline->GetCallRegion();
+
+        if (m_TimestampPool != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(cmd, m_TimestampPool, timestampBase, 2);
+            vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_TimestampPool, timestampBase);
+        }
 
         for (u32 y = 0; y < extent.height; y += m_TileSize) {
             for (u32 x = 0; x < extent.width; x += m_TileSize) {
@@ -200,126 +557,170 @@ void Renderer::Draw(Scene::CameraData&& cam)
 
                 RTPushConstant pc {
                     { x, y },
-                    { extent.width, extent.height }
+                    { extent.width, extent.height },
+                    std::max(1u, m_Samples),
+                    m_Sobol ? 0u : 1u,
+                    m_Seed,
+                    m_LightCount,
+                    m_LightTree ? 1u : 0u,
+                    m_EnvironmentIndex,
+                    m_MaxDepth,
+                    pathStats ? 1u : 0u,
+                    primaryFlags,
+                    m_AlphaTest ? 0u : RAY_FLAG_OPAQUE
                 };
 
-                vkCmdPushConstants(cmd, m_RayTracingPipeline->GetLayout(), VK_SHADER_STAGE_RAYGEN_BIT_KHR, 0, sizeof(RTPushConstant), &pc);
-                vkCmdTraceRaysKHR(cmd, &rgen, &miss, &hit, &call, width, height, 1);
+                vkCmdPushConstants(cmd, pipeline.GetLayout(), pushStages, 0, sizeof(RTPushConstant), &pc);
+
+                if (rayQuery) {
+                    vkCmdDispatch(cmd, (width + RAY_QUERY_GROUP_SIZE - 1) / RAY_QUERY_GROUP_SIZE, (height + RAY_QUERY_GROUP_SIZE - 1) / RAY_QUERY_GROUP_SIZE, 1);
+                } else {
+                    vkCmdTraceRaysKHR(cmd, &rgen, &miss, &hit, &call, width, height, 1);
+                }
             }
         }
 
-        storageTex->GetImage()->TransitionLayout(cmd,
-            VK_IMAGE_LAYOUT_GENERAL,
-            VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR,
-            VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
-            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
-            VK_ACCESS_2_NONE,
-            m_Device->GetQueueFamily<RHI::QueueType::Compute>(),
-            m_Device->GetQueueFamily<RHI::QueueType::Graphics>()
-        );
+        if (m_TimestampPool != VK_NULL_HANDLE) {
+            vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_TimestampPool, timestampBase + 1);
+        }
     });
 
-    VkCommandBuffer graphicsCmd = m_GraphicsCommand->Record([&](VkCommandBuffer cmd) {
-        storageTex->GetImage()->TransitionLayout(cmd,
-            VK_IMAGE_LAYOUT_GENERAL,
-            VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-            VK_ACCESS_2_NONE,
-            VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
-            m_Device->GetQueueFamily<RHI::QueueType::Compute>(),
-            m_Device->GetQueueFamily<RHI::QueueType::Graphics>()
-        );
+    std::vector<RHI::RenderGraph::Resource> hostReads;
+    if (pathStats) hostReads.push_back(statsBuffer);
 
-        auto swapchainImage = m_Swapchain->GetCurrentImage();
+    if (capture) {
+        auto& readbackPass = m_Graph->AddPass("AOVReadback", RHI::QueueType::Compute);
 
-        swapchainImage->TransitionLayout(cmd,
-            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-            VK_ACCESS_2_NONE,
-            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
-        );
+        for (usize i = 0; i < aovImages.size(); ++i) {
+            const RHI::RenderGraph::Resource buffer = m_Graph->Import(*m_ReadbackBuffers[i]);
 
-        VkClearValue clearValue = {{{ 0.8f, 0.2f, 0.8f, 1.0f }}};
+            readbackPass
+                .Read(aovImages[i], { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL })
+                .Overwrite(buffer, { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT });
 
-        VkRenderingAttachmentInfo colorAttachment {
-            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
-            .imageView = swapchainImage->GetView(),
-            .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-            .clearValue = clearValue
-        };
+            hostReads.push_back(buffer);
+        }
 
-        VkRenderingInfo renderingInfo {
-            .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
-            .renderArea = { { 0, 0 }, m_Swapchain->GetExtent() },
-            .layerCount = 1,
-            .colorAttachmentCount = 1,
-            .pColorAttachments = &colorAttachment
-        };
+        readbackPass.Execute([&](VkCommandBuffer cmd) {
+            RecordAOVReadback(cmd, aovTargets);
+        });
+    }
 
-        vkCmdBeginRendering(cmd, &renderingInfo);
+    // Read on the host after SyncTimeline or SyncFrame; the pass only carries their barriers.
+    if (!hostReads.empty()) {
+        auto& hostPass = m_Graph->AddPass("HostReadback", RHI::QueueType::Compute).KeepAlive();
+        for (RHI::RenderGraph::Resource buffer : hostReads) hostPass.Read(buffer, { VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT });
+    }
 
-        m_GraphicsPipeline->Bind(cmd);
-        m_BindlessHeap->Bind(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline->GetLayout());
+    m_Graph->AddPass("Post", RHI::QueueType::Graphics)
+        .Read(output, { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL })
+        .Overwrite(swapchain, { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
+        .Wait(m_Swapchain->GetAcquireWaitInfo())
+        .Execute([&](VkCommandBuffer cmd) {
+            VkClearValue clearValue = {{{ 0.8f, 0.2f, 0.8f, 1.0f }}};
+
+            VkRenderingAttachmentInfo colorAttachment {
+                .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+                .imageView = swapchainImage->GetView(),
+                .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+                .clearValue = clearValue
+            };
 
-        RHI::DescriptorWriter()
-            .WriteImage(0, storageTex->GetImage()->GetView(), storageTex->GetSampler()->GetSampler(), VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
-            .Push(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline->GetLayout(), 1);
-
-        m_GraphicsPipeline->SetViewport(cmd, VkViewport {
-            .x = 0.0f, .y = 0.0f,
-            .width = static_cast<f32>(m_Swapchain->GetExtent().width),
-            .height = static_cast<f32>(m_Swapchain->GetExtent().height),
-            .minDepth = 0.0f,
-            .maxDepth = 1.0f
-        });
+            VkRenderingInfo renderingInfo {
+                .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+                .renderArea = { { 0, 0 }, m_Swapchain->GetExtent() },
+                .layerCount = 1,
+                .colorAttachmentCount = 1,
+                .pColorAttachments = &colorAttachment
+            };
 
-        m_GraphicsPipeline->SetScissor(cmd, VkRect2D {
-            .offset = VkOffset2D { 0, 0 },
-            .extent = m_Swapchain->GetExtent()
-        });
+            vkCmdBeginRendering(cmd, &renderingInfo);
 
-        vkCmdDraw(cmd, 3, 1, 0, 0);
+            m_GraphicsPipeline->Bind(cmd);
+            m_BindlessHeap->Bind(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline->GetLayout());
 
-        vkCmdEndRendering(cmd);
+            RHI::DescriptorWriter()
+                .WriteImage(0, storageTex->GetImage()->GetView(), storageTex->GetSampler()->GetSampler(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+                .Push(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline->GetLayout(), 1);
 
-        swapchainImage->TransitionLayout(cmd,
-            VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-            VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
-            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-            VK_ACCESS_2_NONE
-        );
+            m_GraphicsPipeline->SetViewport(cmd, VkViewport {
+                .x = 0.0f, .y = 0.0f,
+                .width = static_cast<f32>(m_Swapchain->GetExtent().width),
+                .height = static_cast<f32>(m_Swapchain->GetExtent().height),
+                .minDepth = 0.0f,
+                .maxDepth = 1.0f
+            });
 
-        storageTex->GetImage()->TransitionLayout(cmd,
-            VK_IMAGE_LAYOUT_GENERAL,
-            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-            VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
-            VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
-            VK_ACCESS_2_NONE,
-            m_Device->GetQueueFamily<RHI::QueueType::Graphics>(),
-            m_Device->GetQueueFamily<RHI::QueueType::Compute>()
-        );
-    });
+            m_GraphicsPipeline->SetScissor(cmd, VkRect2D {
+                .offset = VkOffset2D { 0, 0 },
+                .extent = m_Swapchain->GetExtent()
+            });
 
-    VkSemaphoreSubmitInfo computeSignal = m_Device->Submit<RHI::QueueType::Compute>(computeCmd, {}, {});
+            vkCmdDraw(cmd, 3, 1, 0, 0);
 
-    std::vector<VkSemaphoreSubmitInfo> graphicsWait {
-        computeSignal,
-        m_Swapchain->GetAcquireWaitInfo()
-    };
+            vkCmdEndRendering(cmd);
+        });
 
-    std::vector<VkSemaphoreSubmitInfo> graphicsSignal {
-        m_Swapchain->GetPresentSignalInfo()
-    };
+    m_Graph->AddPass("Present", RHI::QueueType::Graphics)
+        .Read(swapchain, { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR })
+        .Signal(m_Swapchain->GetPresentSignalInfo());
 
-    m_Device->Submit<RHI::QueueType::Graphics>(graphicsCmd, graphicsWait, graphicsSignal);
+    const RHI::RenderGraph::Stats previousStats = m_Graph->GetStats();
+    m_Graph->Execute();
+
+    // Logged when the frame's shape changes rather than every frame; it only does on mode switches.
+    if (const auto& stats = m_Graph->GetStats(); stats != previousStats) {
+        LOG_INFO("Frame graph: {} passes ({} culled), {} submits | {} barrier calls: {} image, {} buffer, {} queue transfers | {} transients: {:.1f} MiB in {:.1f} MiB",
+            stats.passes, stats.culled, stats.submits,
+            stats.barrierBatches, stats.imageBarriers, stats.bufferBarriers, stats.ownershipTransfers,
+            stats.transients, static_cast<f64>(stats.transientBytes) / (1 << 20), static_cast<f64>(stats.transientHeapBytes) / (1 << 20));
+    }
 
     if (auto result = m_Swapchain->Present()) {
         if (*result == VK_ERROR_OUT_OF_DATE_KHR) RecreateSwapchain();
     }
+
+    pathStatsPending = pathStats;
+    if (m_TimestampPool != VK_NULL_HANDLE) {
+        m_TimestampPending[m_Device->GetCurrentFrameIndex()] = TraceTiming {
+            .backend = m_TraceBackend,
+            .primary = m_PrimaryVisibility,
+            .alphaTest = m_AlphaTest
+        };
+    }
+
+    if (capture) {
+        m_Device->SyncTimeline<RHI::QueueType::Compute>();
+        WriteAOVCapture(aovTargets);
+        m_CapturePath.reset();
+    }
+}
+
+void Renderer::SetTraceBackend(TraceBackend backend)
+{
+    if (backend == TraceBackend::RayQuery && !m_RayQueryPipeline) {
+        LOG_WARN("Ray-query tracer unavailable on this device; keeping the RT pipeline");
+        backend = TraceBackend::RayTracingPipeline;
+    }
+
+    m_TraceBackend = backend;
+}
+
+void Renderer::SetPrimaryVisibility(PrimaryVisibility primary)
+{
+    if (primary == PrimaryVisibility::Rasterized && !m_VisibilityPipeline) {
+        LOG_WARN("Raster primary visibility unavailable on this device; keeping traced camera rays");
+        primary = PrimaryVisibility::Traced;
+    }
+
+    m_PrimaryVisibility = primary;
+}
+
+void Renderer::CaptureAOVs(const std::filesystem::path& prefix)
+{
+    m_CapturePath = prefix;
 }
 
 void Renderer::OnEvent(const Event& event)
@@ -334,23 +735,173 @@ void Renderer::OnEvent(const Event& event)
     });
 }
 
+std::unique_ptr<RHI::Texture> Renderer::UploadTexture(VkExtent2D extent, VkFormat format, const void* pixels, VkDeviceSize size, const RHI::Sampler::Spec& samplerSpec)
+{
+    auto image = std::make_shared<RHI::Image>(m_Device, RHI::Image::Spec {
+        .extent = { extent.width, extent.height, 1 },
+        .format = format,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .memory = VMA_MEMORY_USAGE_GPU_ONLY
+    });
+
+    RHI::Buffer staging(m_Device, RHI::Buffer::Spec {
+        .size = size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .memory = VMA_MEMORY_USAGE_CPU_ONLY
+    });
+    staging.Write(pixels, size);
+
+    VkCommandBuffer transferCmd = m_TransferCommand->Record([&](VkCommandBuffer cmd) {
+        image->TransitionLayout(cmd,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            VK_ACCESS_2_NONE,
+            VK_ACCESS_2_TRANSFER_WRITE_BIT
+        );
+
+        VkBufferImageCopy copyRegion {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = image->GetExtent()
+        };
+
+        vkCmdCopyBufferToImage(cmd, staging.GetBuffer(), image->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+
+        image->TransitionLayout(cmd,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_2_NONE,
+            VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            VK_ACCESS_2_NONE,
+            m_Device->GetQueueFamily<RHI::QueueType::Transfer>(),
+            m_Device->GetQueueFamily<RHI::QueueType::Compute>()
+        );
+    });
+
+    VkCommandBuffer computeCmd = m_ComputeCommand->Record([&](VkCommandBuffer cmd) {
+        image->TransitionLayout(cmd,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_PIPELINE_STAGE_2_NONE,
+            TRACE_STAGES,
+            VK_ACCESS_2_NONE,
+            VK_ACCESS_2_SHADER_READ_BIT,
+            m_Device->GetQueueFamily<RHI::QueueType::Transfer>(),
+            m_Device->GetQueueFamily<RHI::QueueType::Compute>()
+        );
+    });
+
+    auto semaphore = m_Device->Submit<RHI::QueueType::Transfer>(transferCmd, {}, {});
+
+    std::vector<VkSemaphoreSubmitInfo> signal = { semaphore };
+    m_Device->Submit<RHI::QueueType::Compute>(computeCmd, signal, {});
+
+    m_Device->SyncTimeline<RHI::QueueType::Compute>();
+
+    auto sampler = std::make_shared<RHI::Sampler>(m_Device, samplerSpec);
+    return std::make_unique<RHI::Texture>(image, sampler);
+}
+
 void Renderer::LoadScene()
 {
     auto model = Scene::GlTFLoader::Load(s_AssetPath / "Suzanne.glb");
 
+    if (m_ParticleCount > 0) ScatterParticles(*model, m_ParticleCount);
+
+    // The raster primary pass draws straight from the geometry the BLASes are built over, so both buffers
+    // are shared with the graphics queue instead of being transferred back and forth every frame.
+    const std::array<u32, 2> rasterQueues {
+        m_Device->GetQueueFamily<RHI::QueueType::Compute>(),
+        m_Device->GetQueueFamily<RHI::QueueType::Graphics>()
+    };
+
     m_VertexBuffer = RHI::Buffer::Stage(
         m_Device, *m_TransferCommand,
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
         model->vertices.size() * sizeof(Scene::Vertex),
         model->vertices.data(),
-        m_Device->GetQueueFamily<RHI::QueueType::Compute>()
+        m_Device->GetQueueFamily<RHI::QueueType::Compute>(),
+        rasterQueues
     );
 
+    // Alpha-masked primitives are reordered in place, fully opaque triangles first and mixed ones after,
+    // so each half becomes its own BLAS geometry: the opaque half keeps the fixed-function path and only
+    // the mixed half invokes alpha.rahit. Fully transparent triangles move to the tail and are dropped.
+    struct AlphaSplit
+    {
+        u32 opaque { 0 };
+        u32 mixed { 0 };
+        u32 alphaMask { NO_ALPHA_MASK };
+    };
+
+    const auto coverage = Scene::AlphaCoverage::Build(*model);
+    Scene::AlphaCoverage::LogStats(coverage.GetStats());
+
+    std::vector<u32> indices = model->indices;
+    std::vector<AlphaSplit> splits;
+    std::vector<Scene::AlphaCoverage::Mask> alphaMasks;
+
+    for (const auto& mesh : model->meshes) {
+        for (const auto& primitive : mesh.primitives) {
+            const auto states = coverage.GetStates(static_cast<u32>(splits.size()));
+            const auto masks = coverage.GetMasks(static_cast<u32>(splits.size()));
+
+            AlphaSplit split;
+
+            if (states.empty()) {
+                split.opaque = primitive.indexCount / 3;
+                splits.push_back(split);
+                continue;
+            }
+
+            auto Copy = [&](u32 dst, u32 src) {
+                std::copy_n(model->indices.begin() + primitive.indexOffset + src * 3, 3, indices.begin() + primitive.indexOffset + dst * 3);
+            };
+
+            for (u32 t = 0; t < states.size(); ++t) {
+                if (states[t] == Scene::AlphaCoverage::State::Opaque) Copy(split.opaque++, t);
+            }
+
+            split.alphaMask = static_cast<u32>(alphaMasks.size());
+            for (u32 t = 0; t < states.size(); ++t) {
+                if (states[t] != Scene::AlphaCoverage::State::Mixed) continue;
+
+                Copy(split.opaque + split.mixed++, t);
+                alphaMasks.push_back(masks[t]);
+            }
+
+            u32 transparent = split.opaque + split.mixed;
+            for (u32 t = 0; t < states.size(); ++t) {
+                if (states[t] == Scene::AlphaCoverage::State::Transparent) Copy(transparent++, t);
+            }
+
+            splits.push_back(split);
+        }
+    }
+
     m_IndexBuffer = RHI::Buffer::Stage(
         m_Device, *m_TransferCommand,
         VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-        model->indices.size() * sizeof(u32),
-        model->indices.data(),
+        indices.size() * sizeof(u32),
+        indices.data(),
+        m_Device->GetQueueFamily<RHI::QueueType::Compute>(),
+        rasterQueues
+    );
+
+    Scene::AlphaCoverage::Mask placeholderMask {};
+    m_AlphaMaskBuffer = RHI::Buffer::Stage(
+        m_Device, *m_TransferCommand,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        std::max<usize>(alphaMasks.size(), 1) * sizeof(Scene::AlphaCoverage::Mask),
+        alphaMasks.empty() ? &placeholderMask : alphaMasks.data(),
         m_Device->GetQueueFamily<RHI::QueueType::Compute>()
     );
 
@@ -370,87 +921,20 @@ void Renderer::LoadScene()
             continue;
         }
 
-        auto image = std::make_shared<RHI::Image>(m_Device, RHI::Image::Spec {
-            .extent = { tex.width, tex.height, 1 },
-            .format = format,
-            .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-            .memory = VMA_MEMORY_USAGE_GPU_ONLY
-        });
-
-        VkDeviceSize imageSize = tex.pixels.size();
-        RHI::Buffer staging(m_Device, RHI::Buffer::Spec {
-            .size = imageSize,
-            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            .memory = VMA_MEMORY_USAGE_CPU_ONLY
-        });
-        staging.Write(reinterpret_cast<void*>(tex.pixels.data()), imageSize);
-
-        VkCommandBuffer transferCmd = m_TransferCommand->Record([&](VkCommandBuffer cmd) {
-            image->TransitionLayout(cmd,
-                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-                VK_ACCESS_2_NONE,
-                VK_ACCESS_2_TRANSFER_WRITE_BIT
-            );
-
-            VkBufferImageCopy copyRegion {
-                .bufferOffset = 0,
-                .bufferRowLength = 0,
-                .bufferImageHeight = 0,
-                .imageSubresource = {
-                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                    .mipLevel = 0,
-                    .baseArrayLayer = 0,
-                    .layerCount = 1
-                },
-                .imageOffset = { 0, 0, 0 },
-                .imageExtent = image->GetExtent()
-            };
-
-            vkCmdCopyBufferToImage(cmd, staging.GetBuffer(), image->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
-
-            image->TransitionLayout(cmd,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-                VK_PIPELINE_STAGE_2_NONE,
-                VK_ACCESS_2_TRANSFER_WRITE_BIT,
-                VK_ACCESS_2_NONE,
-                m_Device->GetQueueFamily<RHI::QueueType::Transfer>(),
-                m_Device->GetQueueFamily<RHI::QueueType::Compute>()
-            );
-        });
-
-        VkCommandBuffer computeCmd = m_ComputeCommand->Record([&](VkCommandBuffer cmd) {
-            image->TransitionLayout(cmd,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                VK_PIPELINE_STAGE_2_NONE,
-                VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR,
-                VK_ACCESS_2_NONE,
-                VK_ACCESS_2_SHADER_READ_BIT,
-                m_Device->GetQueueFamily<RHI::QueueType::Transfer>(),
-                m_Device->GetQueueFamily<RHI::QueueType::Compute>()
-            );
-        });
-
-        auto semaphore = m_Device->Submit<RHI::QueueType::Transfer>(transferCmd, {}, {});
-
-        std::vector<VkSemaphoreSubmitInfo> signal = { semaphore };
-        m_Device->Submit<RHI::QueueType::Compute>(computeCmd, signal, {});
-
-        m_Device->SyncTimeline<RHI::QueueType::Compute>();
-
-        auto sampler = std::make_shared<RHI::Sampler>(m_Device, RHI::Sampler::Spec {
-            .magFilter = VK_FILTER_LINEAR,
-            .minFilter = VK_FILTER_LINEAR,
-            .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-            .addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-            .addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-            .maxAnisotropy = m_Device->GetProps().properties.limits.maxSamplerAnisotropy,
-            .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK
-        });
+        auto texture = UploadTexture(
+            VkExtent2D { tex.width, tex.height }, format,
+            tex.pixels.data(), tex.pixels.size(),
+            RHI::Sampler::Spec {
+                .magFilter = VK_FILTER_LINEAR,
+                .minFilter = VK_FILTER_LINEAR,
+                .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                .addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                .addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                .maxAnisotropy = m_Device->GetProps().properties.limits.maxSamplerAnisotropy,
+                .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK
+            }
+        );
 
-        auto texture = std::make_unique<RHI::Texture>(image, sampler);
         textures[i] = m_BindlessHeap->RegisterTexture(*texture);
 
         m_SceneTextures.push_back(std::move(texture));
@@ -491,17 +975,83 @@ void Renderer::LoadScene()
     VkDeviceAddress vertexAddress = m_VertexBuffer->GetDeviceAddress();
     VkDeviceAddress indexAddress = m_IndexBuffer->GetDeviceAddress();
 
-    for (const auto& mesh : model->meshes) {
+    // One render object per BLAS geometry, in the same order, since hit shaders index them by
+    // gl_InstanceCustomIndexEXT + gl_GeometryIndexEXT.
+    struct GeometryRange
+    {
+        u32 firstIndex;
+        u32 indexCount;
+        bool isOpaque;
+    };
+
+    std::vector<std::vector<GeometryRange>> meshGeometries(model->meshes.size());
+    u64 triangles = 0;
+    u64 alphaTested = 0;
+
+    for (usize m = 0, p = 0; m < model->meshes.size(); ++m) {
         objIndices.push_back(static_cast<u32>(renderObjs.size()));
-        for (const auto& prim : mesh.primitives) {
-            renderObjs.push_back(RenderObject {
-                .vertex = vertexAddress + prim.vertexOffset * sizeof(Scene::Vertex),
-                .index = indexAddress + prim.indexOffset * sizeof(u32),
-                .material = prim.materialIndex
+
+        for (const auto& prim : model->meshes[m].primitives) {
+            const AlphaSplit& split = splits[p++];
+
+            const bool opaque = prim.materialIndex >= model->materials.size()
+                || model->materials[prim.materialIndex].alphaMode == Scene::MaterialData::AlphaMode::Opaque;
+
+            auto AddGeometry = [&](u32 firstTriangle, u32 count, bool isOpaque, u32 alphaMask) {
+                if (count == 0) return;
+
+                triangles += count;
+                if (!isOpaque) alphaTested += count;
+
+                renderObjs.push_back(RenderObject {
+                    .vertex = vertexAddress + prim.vertexOffset * sizeof(Scene::Vertex),
+                    .index = indexAddress + (prim.indexOffset + firstTriangle * 3) * sizeof(u32),
+                    .material = prim.materialIndex,
+                    .alphaMask = alphaMask
+                });
+                meshGeometries[m].push_back(GeometryRange { prim.indexOffset + firstTriangle * 3, count * 3, isOpaque });
+            };
+
+            // Only BLEND primitives and the mixed half of MASK primitives drop the opaque flag; everything
+            // else stays on the fixed-function path and never invokes alpha.rahit.
+            AddGeometry(0, split.opaque, opaque || split.alphaMask != NO_ALPHA_MASK, NO_ALPHA_MASK);
+            AddGeometry(split.opaque, split.mixed, false, split.alphaMask);
+        }
+    }
+
+    LOG_INFO("Alpha-tested triangles: {} of {} ({:.1f}%)", alphaTested, triangles, triangles > 0 ? 100.0 * alphaTested / triangles : 0.0);
+
+    // One draw per opaque geometry of every instance, in TLAS order; the trace rebuilds the surface from
+    // the draw's render object, so a rasterised hit matches a traced one exactly.
+    m_RasterDraws.clear();
+
+    for (const auto& node : model->nodes) {
+        const auto& ranges = meshGeometries[node.meshIndex];
+
+        for (u32 g = 0; g < ranges.size(); ++g) {
+            if (!ranges[g].isOpaque) continue;
+
+            m_RasterDraws.push_back(RasterDraw {
+                .objectToWorld = node.transform,
+                .object = objIndices[node.meshIndex] + g,
+                .firstIndex = ranges[g].firstIndex,
+                .indexCount = ranges[g].indexCount,
+                ._p = 0
             });
         }
     }
 
+    m_NonOpaqueGeometry = alphaTested > 0 || !model->procedurals.empty();
+
+    RasterDraw placeholderDraw {};
+    m_RasterDrawBuffer = RHI::Buffer::Stage(
+        m_Device, *m_TransferCommand,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        std::max<usize>(m_RasterDraws.size(), 1) * sizeof(RasterDraw),
+        m_RasterDraws.empty() ? &placeholderDraw : m_RasterDraws.data(),
+        m_Device->GetQueueFamily<RHI::QueueType::Compute>()
+    );
+
     m_ObjectDescBuffer = RHI::Buffer::Stage(
         m_Device, *m_TransferCommand,
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
@@ -510,29 +1060,101 @@ void Renderer::LoadScene()
         m_Device->GetQueueFamily<RHI::QueueType::Compute>()
     );
 
+    // Storage buffers cannot be empty, so a scene without emitters still uploads one unused entry; the
+    // closest-hit shader keys off lightCount.
+    auto lightTable = Scene::LightTable::Build(*model);
+    auto lights = lightTable.GetTriangles();
+
+    m_LightCount = static_cast<u32>(lights.size());
+
+    Scene::LightTable::Triangle placeholder {};
+    m_LightBuffer = RHI::Buffer::Stage(
+        m_Device, *m_TransferCommand,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        std::max<usize>(lights.size(), 1) * sizeof(Scene::LightTable::Triangle),
+        lights.empty() ? &placeholder : lights.data(),
+        m_Device->GetQueueFamily<RHI::QueueType::Compute>()
+    );
+
+    auto lightTree = Scene::LightTree::Build(lightTable);
+    auto lightNodes = lightTree.GetNodes();
+
+    Scene::LightTree::Node placeholderNode {};
+    m_LightTreeBuffer = RHI::Buffer::Stage(
+        m_Device, *m_TransferCommand,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        std::max<usize>(lightNodes.size(), 1) * sizeof(Scene::LightTree::Node),
+        lightNodes.empty() ? &placeholderNode : lightNodes.data(),
+        m_Device->GetQueueFamily<RHI::QueueType::Compute>()
+    );
+
+    // 32 bytes per particle plus its 24-byte box, against kilobytes of vertices and indices for even a
+    // coarse icosphere. Binding 14 always needs a buffer, so an empty field uploads one unused entry.
+    const auto& procedurals = model->procedurals;
+    std::vector<VkAabbPositionsKHR> aabbs(procedurals.size());
+
+    CPU::ThreadPool::Get().ParallelFor(static_cast<u32>(procedurals.size()), 1u << 14, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i) {
+            const glm::vec3 min = procedurals[i].GetMin();
+            const glm::vec3 max = procedurals[i].GetMax();
+            aabbs[i] = VkAabbPositionsKHR { min.x, min.y, min.z, max.x, max.y, max.z };
+        }
+    });
+
+    Scene::ProceduralPrimitive placeholderProcedural {};
+    m_ProceduralBuffer = RHI::Buffer::Stage(
+        m_Device, *m_TransferCommand,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        std::max<usize>(procedurals.size(), 1) * sizeof(Scene::ProceduralPrimitive),
+        procedurals.empty() ? &placeholderProcedural : procedurals.data(),
+        m_Device->GetQueueFamily<RHI::QueueType::Compute>()
+    );
+
+    if (!aabbs.empty()) {
+        m_AABBBuffer = RHI::Buffer::Stage(
+            m_Device, *m_TransferCommand,
+            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            aabbs.size() * sizeof(VkAabbPositionsKHR),
+            aabbs.data(),
+            m_Device->GetQueueFamily<RHI::QueueType::Compute>()
+        );
+    }
+
+    LoadEnvironment();
+
     VkCommandBuffer acquireCmd = m_ComputeCommand->Record([&](VkCommandBuffer cmd) {
         std::vector<VkBufferMemoryBarrier2> barriers;
 
-        auto AddBarrier = [&](VkBuffer buffer, VkDeviceSize size) {
+        // Shared buffers had no release to pair with, so they take a plain barrier.
+        auto AddBarrier = [&](const RHI::Buffer& buffer) {
+            const bool concurrent = buffer.IsConcurrent();
+
             barriers.push_back(VkBufferMemoryBarrier2 {
                 .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
                 .pNext = nullptr,
                 .srcStageMask = VK_PIPELINE_STAGE_2_NONE,
                 .srcAccessMask = VK_ACCESS_2_NONE,
-                .dstStageMask = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR,
+                .dstStageMask = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | TRACE_STAGES,
                 .dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
-                .srcQueueFamilyIndex = m_Device->GetQueueFamily<RHI::QueueType::Transfer>(),
-                .dstQueueFamilyIndex = m_Device->GetQueueFamily<RHI::QueueType::Compute>(),
-                .buffer = buffer,
+                .srcQueueFamilyIndex = concurrent ? VK_QUEUE_FAMILY_IGNORED : m_Device->GetQueueFamily<RHI::QueueType::Transfer>(),
+                .dstQueueFamilyIndex = concurrent ? VK_QUEUE_FAMILY_IGNORED : m_Device->GetQueueFamily<RHI::QueueType::Compute>(),
+                .buffer = buffer.GetBuffer(),
                 .offset = 0,
-                .size = size
+                .size = buffer.GetSize()
             });
         };
 
-        AddBarrier(m_VertexBuffer->GetBuffer(), m_VertexBuffer->GetSize());
-        AddBarrier(m_IndexBuffer->GetBuffer(), m_IndexBuffer->GetSize());
-        AddBarrier(m_MaterialBuffer->GetBuffer(), m_MaterialBuffer->GetSize());
-        AddBarrier(m_ObjectDescBuffer->GetBuffer(), m_ObjectDescBuffer->GetSize());
+        AddBarrier(*m_VertexBuffer);
+        AddBarrier(*m_IndexBuffer);
+        AddBarrier(*m_MaterialBuffer);
+        AddBarrier(*m_ObjectDescBuffer);
+        AddBarrier(*m_AlphaMaskBuffer);
+        AddBarrier(*m_ProceduralBuffer);
+        if (m_AABBBuffer) AddBarrier(*m_AABBBuffer);
+        AddBarrier(*m_LightBuffer);
+        AddBarrier(*m_LightTreeBuffer);
+        AddBarrier(*m_EnvironmentBuffer);
+        AddBarrier(*m_RasterDrawBuffer);
 
         VkDependencyInfo dependency {
             .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
@@ -552,13 +1174,19 @@ void Renderer::LoadScene()
     m_Device->Submit<RHI::QueueType::Compute>(acquireCmd, {}, {});
     m_Device->SyncTimeline<RHI::QueueType::Compute>();
 
+    // A mesh whose triangles were all alpha-tested away has no geometry left and gets no BLAS.
     m_BLASes.reserve(model->meshes.size());
 
-    for (const auto& mesh : model->meshes) {
+    for (const auto& ranges : meshGeometries) {
+        if (ranges.empty()) {
+            m_BLASes.push_back(nullptr);
+            continue;
+        }
+
         std::vector<RHI::BLAS::Geometry> geometries;
-        geometries.reserve(mesh.primitives.size());
+        geometries.reserve(ranges.size());
 
-        for (const auto& primitive : mesh.primitives) {
+        for (const auto& range : ranges) {
             geometries.push_back(RHI::BLAS::Geometry {
                 .vertices = {
                     .buffer = m_VertexBuffer.get(),
@@ -569,10 +1197,10 @@ void Renderer::LoadScene()
                 },
                 .indices = {
                     .buffer = m_IndexBuffer.get(),
-                    .count = primitive.indexCount,
-                    .offset = primitive.indexOffset * sizeof(u32)
+                    .count = range.indexCount,
+                    .offset = range.firstIndex * sizeof(u32)
                 },
-                .isOpaque = true
+                .isOpaque = range.isOpaque
             });
         }
 
@@ -583,6 +1211,8 @@ void Renderer::LoadScene()
     tlasInstances.reserve(model->nodes.size());
 
     for (const auto& node : model->nodes) {
+        if (!m_BLASes[node.meshIndex]) continue;
+
         tlasInstances.push_back(RHI::TLAS::Instance {
             .blas = m_BLASes[node.meshIndex].get(),
             .transform = node.transform,
@@ -593,11 +1223,330 @@ void Renderer::LoadScene()
         });
     }
 
+    if (m_AABBBuffer) {
+        const auto start = std::chrono::steady_clock::now();
+
+        std::array<RHI::BLAS::Geometry, 1> geometry {
+            RHI::BLAS::Geometry {
+                .type = RHI::BLAS::Geometry::Type::AABBs,
+                .aabbs = {
+                    .buffer = m_AABBBuffer.get(),
+                    .count = static_cast<u32>(aabbs.size())
+                },
+                // Non-opaque so the raster primary's CullOpaque ray still finds particles in front of
+                // the visibility buffer; there is no any-hit to pay for.
+                .isOpaque = false
+            }
+        };
+
+        m_ProceduralBLAS = std::make_unique<RHI::BLAS>(m_Device, *m_ComputeCommand, geometry);
+
+        const f64 elapsed = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("Procedural BLAS: {} primitives, {:.1f} MiB input, {:.1f} MiB compacted, built in {:.1f} ms",
+            procedurals.size(), static_cast<f64>(m_ProceduralBuffer->GetSize() + m_AABBBuffer->GetSize()) / (1024.0 * 1024.0),
+            static_cast<f64>(m_ProceduralBLAS->GetBuffer()->GetSize()) / (1024.0 * 1024.0), elapsed);
+
+        // The memory side of AABBs against tessellation, from the driver's own size query for the same
+        // field as icospheres. Comparing build times would mean building the triangle BLAS as well.
+        const u64 triangles = procedurals.size() * ICOSPHERE_TRIANGLES;
+        const u64 vertices = procedurals.size() * ICOSPHERE_VERTICES;
+
+        if (triangles <= std::numeric_limits<u32>::max()) {
+            const auto boxSizes = RHI::BLAS::QueryBuildSizes(m_Device, RHI::BLAS::Geometry::Type::AABBs, static_cast<u32>(procedurals.size()));
+            const auto sphereSizes = RHI::BLAS::QueryBuildSizes(m_Device, RHI::BLAS::Geometry::Type::Triangles, static_cast<u32>(triangles), static_cast<u32>(vertices));
+
+            auto MiB = [](u64 bytes) { return static_cast<f64>(bytes) / (1024.0 * 1024.0); };
+
+            LOG_INFO("Procedural BLAS before compaction: {:.1f} MiB, {:.1f} MiB scratch; as {} icosphere triangles: {:.1f} MiB input, {:.1f} MiB, {:.1f} MiB scratch",
+                MiB(boxSizes.accelerationStructureSize), MiB(boxSizes.buildScratchSize), triangles,
+                MiB(vertices * sizeof(glm::vec3) + triangles * 3 * sizeof(u32)), MiB(sphereSizes.accelerationStructureSize), MiB(sphereSizes.buildScratchSize));
+        }
+
+        tlasInstances.push_back(RHI::TLAS::Instance {
+            .blas = m_ProceduralBLAS.get(),
+            .transform = glm::mat4(1.0f),
+            .instanceCustomIndex = 0,
+            .mask = 0xFF,
+            .sbtOffset = PROCEDURAL_SBT_OFFSET,
+            .flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR
+        });
+    }
+
     m_TLAS = std::make_unique<RHI::TLAS>(m_Device, *m_ComputeCommand, tlasInstances);
 }
 
+void Renderer::LoadEnvironment()
+{
+    // The distribution buffer always holds its (width, height) header plus at least one entry; shaders
+    // only read it when pc.environment names a bindless texture.
+    std::vector<u32> distribution { 0, 0, 0 };
+    m_EnvironmentIndex = -1;
+
+    std::optional<Scene::EnvironmentMap> environment;
+    if (!m_EnvironmentPath.empty()) environment = Scene::EnvironmentMap::Load(m_EnvironmentPath);
+
+    const u32 maxDimension = m_Device->GetProps().properties.limits.maxImageDimension2D;
+    if (environment && std::max(environment->GetWidth(), environment->GetHeight()) > maxDimension) {
+        LOG_ERROR("Environment map {} exceeds the {} texel image limit", m_EnvironmentPath.string(), maxDimension);
+        environment.reset();
+    }
+
+    if (environment) {
+        // Half floats keep a 16K map at 1 GiB of device memory.
+        const auto pixels = environment->GetPixels();
+        std::vector<u64> texels(pixels.size());
+
+        CPU::ThreadPool::Get().ParallelFor(static_cast<u32>(environment->GetHeight()), 16, [&](u32 begin, u32 end) {
+            for (usize i = static_cast<usize>(begin) * environment->GetWidth(); i < static_cast<usize>(end) * environment->GetWidth(); ++i) {
+                texels[i] = glm::packHalf4x16(pixels[i]);
+            }
+        });
+
+        m_EnvironmentTexture = UploadTexture(
+            VkExtent2D { environment->GetWidth(), environment->GetHeight() }, VK_FORMAT_R16G16B16A16_SFLOAT,
+            texels.data(), texels.size() * sizeof(u64),
+            RHI::Sampler::Spec {
+                .magFilter = VK_FILTER_LINEAR,
+                .minFilter = VK_FILTER_LINEAR,
+                .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+            }
+        );
+
+        m_EnvironmentIndex = static_cast<i32>(m_BindlessHeap->RegisterTexture(*m_EnvironmentTexture));
+
+        const auto cdf = environment->GetDistribution();
+        distribution.resize(2 + cdf.size());
+        distribution[0] = environment->GetDistributionWidth();
+        distribution[1] = environment->GetDistributionHeight();
+        std::memcpy(distribution.data() + 2, cdf.data(), cdf.size_bytes());
+    }
+
+    m_EnvironmentBuffer = RHI::Buffer::Stage(
+        m_Device, *m_TransferCommand,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        distribution.size() * sizeof(u32),
+        distribution.data(),
+        m_Device->GetQueueFamily<RHI::QueueType::Compute>()
+    );
+}
+
+void Renderer::RecordVisibilityPass(VkCommandBuffer cmd, const RHI::Image& visibility, const RHI::Image& depth, const Scene::CameraData& cam)
+{
+    const u32 timestampBase = static_cast<u32>(TIMESTAMPS_PER_FRAME * m_Device->GetCurrentFrameIndex()) + 2;
+
+    if (m_TimestampPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(cmd, m_TimestampPool, timestampBase, 2);
+        vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_TimestampPool, timestampBase);
+    }
+
+    VkClearValue visibilityClear {};
+    visibilityClear.color.uint32[0] = NO_VISIBILITY;
+
+    VkClearValue depthClear {};
+    depthClear.depthStencil.depth = 1.0f;
+
+    VkRenderingAttachmentInfo colorAttachment {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = visibility.GetView(),
+        .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        .clearValue = visibilityClear
+    };
+
+    VkRenderingAttachmentInfo depthAttachment {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = depth.GetView(),
+        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .clearValue = depthClear
+    };
+
+    const VkExtent2D extent { visibility.GetExtent().width, visibility.GetExtent().height };
+
+    VkRenderingInfo renderingInfo {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .renderArea = { { 0, 0 }, extent },
+        .layerCount = 1,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &colorAttachment,
+        .pDepthAttachment = &depthAttachment
+    };
+
+    vkCmdBeginRendering(cmd, &renderingInfo);
+
+    m_VisibilityPipeline->Bind(cmd);
+
+    m_VisibilityPipeline->SetViewport(cmd, VkViewport {
+        .x = 0.0f, .y = 0.0f,
+        .width = static_cast<f32>(extent.width),
+        .height = static_cast<f32>(extent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f
+    });
+
+    m_VisibilityPipeline->SetScissor(cmd, VkRect2D {
+        .offset = VkOffset2D { 0, 0 },
+        .extent = extent
+    });
+
+    VkBuffer vertexBuffer = m_VertexBuffer->GetBuffer();
+    VkDeviceSize vertexOffset = 0;
+    vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer, &vertexOffset);
+    vkCmdBindIndexBuffer(cmd, m_IndexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+    // CameraSystem builds an OpenGL projection with clip z in [-w, w]; Vulkan clips depth to [0, w].
+    const glm::mat4 depthRemap {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.5f, 0.0f,
+        0.0f, 0.0f, 0.5f, 1.0f
+    };
+
+    RasterPushConstant pc {
+        .viewProjection = depthRemap * glm::inverse(cam.inverseProj) * glm::inverse(cam.inverseView),
+        .objectToWorld = glm::mat4(1.0f)
+    };
+
+    // Indices are already global, and firstInstance carries the draw index to the fragment shader.
+    for (u32 i = 0; i < m_RasterDraws.size(); ++i) {
+        const auto& draw = m_RasterDraws[i];
+
+        pc.objectToWorld = draw.objectToWorld;
+        vkCmdPushConstants(cmd, m_VisibilityPipeline->GetLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(RasterPushConstant), &pc);
+        vkCmdDrawIndexed(cmd, draw.indexCount, 1, draw.firstIndex, 0, i);
+    }
+
+    vkCmdEndRendering(cmd);
+
+    if (m_TimestampPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_TimestampPool, timestampBase + 1);
+    }
+}
+
+Renderer::AOVTargets Renderer::CreateAOVTargets(VkExtent3D extent) const
+{
+    auto CreateAOVImage = [&](VkFormat format) {
+        return std::make_unique<RHI::Image>(m_Device, RHI::Image::Spec {
+            .extent = extent,
+            .format = format,
+            .usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .memory = VMA_MEMORY_USAGE_GPU_ONLY
+        });
+    };
+
+    return AOVTargets {
+        .albedo = CreateAOVImage(AOV_FORMATS[0]),
+        .normal = CreateAOVImage(AOV_FORMATS[1]),
+        .depth = CreateAOVImage(AOV_FORMATS[2]),
+        .ids = CreateAOVImage(AOV_FORMATS[3])
+    };
+}
+
+void Renderer::RecordAOVReadback(VkCommandBuffer cmd, const AOVTargets& targets)
+{
+    const auto images = targets.GetImages();
+
+    for (usize i = 0; i < images.size(); ++i) {
+        VkBufferImageCopy region {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = images[i]->GetExtent()
+        };
+
+        vkCmdCopyImageToBuffer(cmd, images[i]->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_ReadbackBuffers[i]->GetBuffer(), 1, &region);
+    }
+}
+
+void Renderer::ReadTraceTiming(usize frame)
+{
+    auto& pending = m_TimestampPending[frame];
+    if (!pending) return;
+
+    // SyncFrame has waited for this slot's previous frame, so its timestamps are written; the visibility
+    // pair only exists when that frame rasterised its primary hits.
+    const bool raster = pending->primary == PrimaryVisibility::Rasterized;
+    const u32 count = raster ? TIMESTAMPS_PER_FRAME : 2;
+
+    std::array<u64, TIMESTAMPS_PER_FRAME> timestamps {};
+    const VkResult result = vkGetQueryPoolResults(m_Device->GetDevice(), m_TimestampPool, static_cast<u32>(TIMESTAMPS_PER_FRAME * frame), count,
+        count * sizeof(u64), timestamps.data(), sizeof(u64), VK_QUERY_RESULT_64_BIT);
+
+    if (result == VK_SUCCESS) {
+        const f64 period = static_cast<f64>(m_Device->GetProps().properties.limits.timestampPeriod);
+
+        m_TraceTiming = TraceTiming {
+            .backend = pending->backend,
+            .primary = pending->primary,
+            .alphaTest = pending->alphaTest,
+            .milliseconds = static_cast<f64>(timestamps[1] - timestamps[0]) * period * 1e-6,
+            .visibilityMilliseconds = raster ? static_cast<f64>(timestamps[3] - timestamps[2]) * period * 1e-6 : 0.0,
+            .serial = m_TraceTiming.serial + 1
+        };
+    }
+
+    pending.reset();
+}
+
+void Renderer::WriteAOVCapture(const AOVTargets& targets)
+{
+    if (!m_ImageWriter) {
+        m_ImageWriter = std::make_unique<Image::ImageWriter>(Image::ImageWriter::Settings { .threads = 1 });
+    }
+
+    const VkExtent3D extent = targets.albedo->GetExtent();
+    const usize count = static_cast<usize>(extent.width) * extent.height;
+
+    for (usize i = 0; i < m_ReadbackBuffers.size(); ++i) {
+        const u8* data = static_cast<const u8*>(m_ReadbackBuffers[i]->Map());
+
+        std::vector<glm::vec4> pixels(count);
+        for (usize p = 0; p < count; ++p) {
+            const u8* texel = data + p * AOV_TEXEL_SIZES[i];
+
+            if (AOV_FORMATS[i] == VK_FORMAT_R16G16B16A16_SFLOAT) {
+                u64 packed;
+                std::memcpy(&packed, texel, sizeof(packed));
+                pixels[p] = glm::unpackHalf4x16(packed);
+            } else if (AOV_FORMATS[i] == VK_FORMAT_R32_SFLOAT) {
+                f32 depth;
+                std::memcpy(&depth, texel, sizeof(depth));
+                pixels[p] = glm::vec4(glm::vec3(depth), 1.0f);
+            } else {
+                // IDs stay exact in f32 up to 2^24, well past any material or instance count we load.
+                std::array<u32, 2> ids;
+                std::memcpy(ids.data(), texel, sizeof(ids));
+
+                auto ToFloat = [](u32 id) { return id == AOV_INVALID_ID ? -1.0f : static_cast<f32>(id); };
+                pixels[p] = glm::vec4(ToFloat(ids[0]), ToFloat(ids[1]), 0.0f, 1.0f);
+            }
+        }
+
+        m_ReadbackBuffers[i]->Unmap();
+
+        std::filesystem::path path = m_CapturePath->string() + std::string(AOV_SUFFIXES[i]);
+        m_ImageWriter->Submit(path, extent.width, extent.height, std::move(pixels));
+    }
+
+    LOG_INFO("Captured AOVs to {}_*", m_CapturePath->string());
+}
+
 void Renderer::RecreateSwapchain() const
 {
     m_Device->WaitIdle();
     m_Swapchain->Create(m_Width, m_Height);
+
+    // New swapchain images may reuse the old handles, which start out undefined again.
+    m_Graph->ResetHistory();
 }
@@ -11,20 +11,109 @@
 #include "RHI/AccelerationStructure.hpp"
 #include "RHI/DescriptorManager.hpp"
 #include "RHI/Pipeline.hpp"
+#include "RHI/RenderGraph.hpp"
 
 #include "Scene/Camera.hpp"
 
+#include "Image/ImageWriter.hpp"
+
 class Window;
 
 class Renderer
 {
 public:
+    // Both trace the same path.glsl loop with the same shading, so they produce the same image.
+    enum class TraceBackend : u8
+    {
+        // vkCmdTraceRaysKHR through the SBT: raygen, closest-hit, any-hit, intersection and miss shaders.
+        RayTracingPipeline,
+
+        // pathtrace.comp in 8x8 workgroups, casting every ray inline with VK_KHR_ray_query.
+        RayQuery
+    };
+
+    // Where each sample's camera vertex comes from; the bounces after it are traced either way.
+    enum class PrimaryVisibility : u8
+    {
+        // A jittered camera ray per sample.
+        Traced,
+
+        // The visibility buffer of a raster pass over the opaque triangles at the pixel centre, shared by
+        // all samples of the pixel. Alpha-tested and procedural geometry in front of it is still traced.
+        // With no per-sample jitter, directly visible edges stay aliased at any sample count.
+        Rasterized
+    };
+
     struct Settings
     {
         u32 width;
         u32 height;
         u32 samples;
         u32 tile;
+
+        // Pixel jitter comes from a stateless (pixel, sample, dimension) sequence: Owen-scrambled Sobol,
+        // or hashed PCG when sobol is false. Identical on the GPU and CPU::Tracer.
+        bool sobol { true };
+        u32 seed { 0 };
+
+        // First-hit albedo, normal, linear depth and material/instance IDs from one extra unjittered ray per
+        // pixel. Disabled frames use a pipeline specialised without the AOV trace.
+        bool aovs { false };
+
+        // Direct lighting picks emitters through Scene::LightTree by their estimated contribution at the
+        // shading point; false falls back to the power-only Scene::LightTable alias table.
+        bool lightTree { true };
+
+        // Equirectangular HDR/EXR/PFM radiance map lighting misses and importance sampled for direct
+        // lighting; empty keeps the sky gradient.
+        std::filesystem::path environment;
+
+        // Path vertices per sample, the camera hit included; 1 is direct lighting only. Paths past the
+        // third vertex are also ended by Russian roulette on their throughput.
+        u32 maxDepth { 8 };
+
+        // Per-frame path length and termination counters, read back with GetPathStats().
+        bool pathStats { false };
+
+        // Analytic spheres and capsules scattered through the scene bounds, traced as procedural AABB
+        // geometry with an intersection shader.
+        u32 particles { 0 };
+
+        // Falls back to the RT pipeline when the device lacks VK_KHR_ray_query.
+        TraceBackend backend { TraceBackend::RayTracingPipeline };
+
+        // Falls back to traced when the device lacks VK_KHR_fragment_shader_barycentric.
+        PrimaryVisibility primary { PrimaryVisibility::Traced };
+    };
+
+    // GPU time of one frame's trace dispatches, from compute queue timestamps, plus its raster visibility
+    // pass on the graphics queue when it had one.
+    struct TraceTiming
+    {
+        TraceBackend backend { TraceBackend::RayTracingPipeline };
+        PrimaryVisibility primary { PrimaryVisibility::Traced };
+        bool alphaTest { true };
+        f64 milliseconds { 0.0 };
+        f64 visibilityMilliseconds { 0.0 };
+
+        // Counts the timed frames read back so far; unchanged until the next one completes.
+        u64 serial { 0 };
+
+        inline f64 GetFrameMilliseconds() const { return milliseconds + visibilityMilliseconds; }
+    };
+
+    // Totals over every path traced in a frame; the four terminations add up to paths. Matches the
+    // PathStats buffer in path.glsl.
+    struct PathStats
+    {
+        u32 paths { 0 };
+        u32 segments { 0 };
+        u32 missed { 0 };
+        u32 roulette { 0 };
+        u32 depthLimit { 0 };
+        u32 absorbed { 0 };
+
+        inline f32 GetAverageDepth() const { return paths > 0 ? static_cast<f32>(segments) / static_cast<f32>(paths) : 0.0f; }
     };
 
 public:
@@ -34,10 +123,79 @@ public:
     void Draw(Scene::CameraData&& cam);
     void OnEvent(const Event& event);
 
+    inline void SetAOVsEnabled(bool enabled) { m_AOVs = enabled; }
+    inline bool IsAOVsEnabled() const { return m_AOVs; }
+
+    inline void SetMaxDepth(u32 depth) { m_MaxDepth = std::max(depth, 1u); }
+    inline u32 GetMaxDepth() const { return m_MaxDepth; }
+
+    inline void SetPathStatsEnabled(bool enabled) { m_PathStatsEnabled = enabled; }
+    inline bool IsPathStatsEnabled() const { return m_PathStatsEnabled; }
+
+    // Counters of the latest frame traced with path stats on, available once its frame slot is reused.
+    inline const PathStats& GetPathStats() const { return m_PathStats; }
+
+    void SetTraceBackend(TraceBackend backend);
+    inline TraceBackend GetTraceBackend() const { return m_TraceBackend; }
+    inline bool IsRayQuerySupported() const { return m_RayQueryPipeline != nullptr; }
+    inline bool HasNonOpaqueGeometry() const { return m_NonOpaqueGeometry; }
+
+    void SetPrimaryVisibility(PrimaryVisibility primary);
+    inline PrimaryVisibility GetPrimaryVisibility() const { return m_PrimaryVisibility; }
+    inline bool IsRasterPrimarySupported() const { return m_VisibilityPipeline != nullptr; }
+
+    // Off forces opaque traversal of radiance and shadow rays, so no alpha test runs and MASK/BLEND
+    // geometry renders solid; only meant for measuring what the any-hit test costs. The raster primary
+    // pass still traces non-opaque geometry in front of the visibility buffer with the test.
+    inline void SetAlphaTestEnabled(bool enabled) { m_AlphaTest = enabled; }
+    inline bool IsAlphaTestEnabled() const { return m_AlphaTest; }
+
+    // Latest frame whose timestamps were read back, like path stats once its frame slot is reused. Stays
+    // at serial 0 when the compute queue has no timestamp support.
+    inline const TraceTiming& GetTraceTiming() const { return m_TraceTiming; }
+
+    // Barriers, queue transfers and transient memory of the latest frame; logged whenever they change.
+    inline const RHI::RenderGraph::Stats& GetGraphStats() const { return m_Graph->GetStats(); }
+
+    // Traces the next frame with AOVs and writes them next to prefix: _albedo.exr, _normal.exr,
+    // _depth.pfm and _ids.pfm (material index in R, instance custom index in G, -1 for misses).
+    void CaptureAOVs(const std::filesystem::path& prefix);
+
+private:
+    struct AOVTargets
+    {
+        std::unique_ptr<RHI::Image> albedo;
+        std::unique_ptr<RHI::Image> normal;
+        std::unique_ptr<RHI::Image> depth;
+        std::unique_ptr<RHI::Image> ids;
+
+        inline std::array<RHI::Image*, 4> GetImages() const { return { albedo.get(), normal.get(), depth.get(), ids.get() }; }
+    };
+
+    // One indexed draw of the raster primary pass. Matches RasterDraw in visibility.glsl.
+    struct RasterDraw
+    {
+        glm::mat4 objectToWorld;
+        u32 object;
+        u32 firstIndex;
+        u32 indexCount;
+        u32 _p;
+    };
+
 private:
     void LoadScene();
+    void LoadEnvironment();
+    std::unique_ptr<RHI::Texture> UploadTexture(VkExtent2D extent, VkFormat format, const void* pixels, VkDeviceSize size, const RHI::Sampler::Spec& samplerSpec);
     void RecreateSwapchain() const;
 
+    void RecordVisibilityPass(VkCommandBuffer cmd, const RHI::Image& visibility, const RHI::Image& depth, const Scene::CameraData& cam);
+
+    AOVTargets CreateAOVTargets(VkExtent3D extent) const;
+    void RecordAOVReadback(VkCommandBuffer cmd, const AOVTargets& targets);
+    void WriteAOVCapture(const AOVTargets& targets);
+
+    void ReadTraceTiming(usize frame);
+
 private:
     std::shared_ptr<Window> m_Window;
 
@@ -45,6 +203,19 @@ private:
     u32 m_Height { 0 };
     u32 m_Samples { 0 };
     u32 m_TileSize { 0 };
+    bool m_Sobol { true };
+    u32 m_Seed { 0 };
+
+    bool m_AOVs { false };
+    bool m_LightTree { true };
+    u32 m_MaxDepth { 8 };
+    bool m_PathStatsEnabled { false };
+    std::filesystem::path m_EnvironmentPath;
+    u32 m_ParticleCount { 0 };
+    TraceBackend m_TraceBackend { TraceBackend::RayTracingPipeline };
+    PrimaryVisibility m_PrimaryVisibility { PrimaryVisibility::Traced };
+    bool m_AlphaTest { true };
+    std::optional<std::filesystem::path> m_CapturePath;
 
     bool m_ResizeRequested { false };
 
@@ -52,28 +223,68 @@ private:
     std::shared_ptr<RHI::Device> m_Device;
     std::unique_ptr<RHI::Swapchain> m_Swapchain;
 
-    std::unique_ptr<RHI::CommandContext<RHI::QueueType::Graphics>> m_GraphicsCommand;
     std::unique_ptr<RHI::CommandContext<RHI::QueueType::Compute>> m_ComputeCommand;
     std::unique_ptr<RHI::CommandContext<RHI::QueueType::Transfer>> m_TransferCommand;
 
     std::unique_ptr<RHI::BindlessHeap> m_BindlessHeap;
 
+    // Records and submits each frame's passes; also owns the raster visibility buffer as a transient.
+    std::unique_ptr<RHI::RenderGraph> m_Graph;
+
     RHI::PerFrame<std::unique_ptr<RHI::Texture>> m_StorageTextures;
     RHI::PerFrame<std::unique_ptr<RHI::Buffer>> m_CamBuffers;
+    RHI::PerFrame<AOVTargets> m_AOVTargets;
+    AOVTargets m_AOVPlaceholders;
+    std::unique_ptr<RHI::Image> m_VisibilityPlaceholder;
+
+    RHI::PerFrame<std::unique_ptr<RHI::Buffer>> m_PathStatsBuffers;
+    RHI::PerFrame<bool> m_PathStatsPending {};
+    PathStats m_PathStats;
+
+    // Four timestamps per frame slot: around the trace dispatches, then around the visibility pass.
+    VkQueryPool m_TimestampPool { VK_NULL_HANDLE };
+    RHI::PerFrame<std::optional<TraceTiming>> m_TimestampPending {};
+    TraceTiming m_TraceTiming;
+
+    std::array<std::unique_ptr<RHI::Buffer>, 4> m_ReadbackBuffers;
+    std::unique_ptr<Image::ImageWriter> m_ImageWriter;
 
     VkDescriptorSetLayout m_RTLayout { VK_NULL_HANDLE };
     VkDescriptorSetLayout m_GLayout { VK_NULL_HANDLE };
 
     std::unique_ptr<RHI::GraphicsPipeline> m_GraphicsPipeline;
     std::unique_ptr<RHI::RayTracingPipelne> m_RayTracingPipeline;
+    std::unique_ptr<RHI::RayTracingPipelne> m_AOVPipeline;
+    std::unique_ptr<RHI::ComputePipeline> m_RayQueryPipeline;
+    std::unique_ptr<RHI::ComputePipeline> m_RayQueryAOVPipeline;
+    std::unique_ptr<RHI::GraphicsPipeline> m_VisibilityPipeline;
 
     std::unique_ptr<RHI::Buffer> m_VertexBuffer;
     std::unique_ptr<RHI::Buffer> m_IndexBuffer;
 
+    std::vector<RasterDraw> m_RasterDraws;
+    std::unique_ptr<RHI::Buffer> m_RasterDrawBuffer;
+
+    // Alpha-tested triangles or procedurals exist, so raster primary visibility traces them too.
+    bool m_NonOpaqueGeometry { false };
+
     std::vector<std::unique_ptr<RHI::Texture>> m_SceneTextures;
     std::unique_ptr<RHI::Buffer> m_MaterialBuffer;
     std::unique_ptr<RHI::Buffer> m_ObjectDescBuffer;
+    std::unique_ptr<RHI::Buffer> m_AlphaMaskBuffer;
+
+    std::unique_ptr<RHI::Buffer> m_LightBuffer;
+    std::unique_ptr<RHI::Buffer> m_LightTreeBuffer;
+    u32 m_LightCount { 0 };
+
+    std::unique_ptr<RHI::Texture> m_EnvironmentTexture;
+    std::unique_ptr<RHI::Buffer> m_EnvironmentBuffer;
+    i32 m_EnvironmentIndex { -1 };
 
     std::vector<std::unique_ptr<RHI::BLAS>> m_BLASes;
+
+    std::unique_ptr<RHI::Buffer> m_ProceduralBuffer;
+    std::unique_ptr<RHI::Buffer> m_AABBBuffer;
+    std::unique_ptr<RHI::BLAS> m_ProceduralBLAS;
     std::unique_ptr<RHI::TLAS> m_TLAS;
 };
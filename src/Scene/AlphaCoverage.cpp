@@ -0,0 +1,371 @@
+#include "AlphaCoverage.hpp"
+
+#include "CPU/ThreadPool.hpp"
+
+namespace Scene {
+
+    namespace {
+
+        inline constexpr u32 ROW_GRAIN { 16 };
+        inline constexpr u32 TRIANGLE_GRAIN { 256 };
+
+        // Slack for the GPU's filtered alpha and interpolated UVs, which are not bit-exact with the
+        // float maths below; a micro-triangle this close to the cutoff stays mixed.
+        inline constexpr f32 CUTOFF_MARGIN { 1.0f / 512.0f };
+        inline constexpr f32 TEXEL_MARGIN { 1.0f / 256.0f };
+
+        struct Extent
+        {
+            u8 min { 255 };
+            u8 max { 0 };
+
+            inline void Grow(const Extent& other)
+            {
+                min = std::min(min, other.min);
+                max = std::max(max, other.max);
+            }
+        };
+
+        // Min/max alpha per power-of-two tile, so a range query of any size reads at most 2x2 entries of
+        // the level where the range spans no more than two tiles per axis.
+        class AlphaPyramid
+        {
+        public:
+            explicit AlphaPyramid(const ImageData& image)
+            {
+                Level base { image.width, image.height, std::vector<Extent>(static_cast<usize>(image.width) * image.height) };
+
+                CPU::ThreadPool::Get().ParallelFor(image.height, ROW_GRAIN, [&](u32 begin, u32 end) {
+                    for (u32 y = begin; y < end; ++y) {
+                        for (u32 x = 0; x < image.width; ++x) {
+                            const usize texel = static_cast<usize>(y) * image.width + x;
+                            const u8 alpha = std::to_integer<u8>(image.pixels[texel * image.channels + 3]);
+                            base.texels[texel] = Extent { alpha, alpha };
+                        }
+                    }
+                });
+
+                m_Levels.push_back(std::move(base));
+
+                while (m_Levels.back().width > 1 || m_Levels.back().height > 1) {
+                    const Level& fine = m_Levels.back();
+                    Level coarse { (fine.width + 1) / 2, (fine.height + 1) / 2, {} };
+                    coarse.texels.resize(static_cast<usize>(coarse.width) * coarse.height);
+
+                    CPU::ThreadPool::Get().ParallelFor(coarse.height, ROW_GRAIN, [&](u32 begin, u32 end) {
+                        for (u32 y = begin; y < end; ++y) {
+                            for (u32 x = 0; x < coarse.width; ++x) {
+                                Extent extent;
+                                for (u32 fy = 2 * y; fy < std::min(2 * y + 2, fine.height); ++fy) {
+                                    for (u32 fx = 2 * x; fx < std::min(2 * x + 2, fine.width); ++fx) {
+                                        extent.Grow(fine.texels[static_cast<usize>(fy) * fine.width + fx]);
+                                    }
+                                }
+                                coarse.texels[static_cast<usize>(y) * coarse.width + x] = extent;
+                            }
+                        }
+                    });
+
+                    m_Levels.push_back(std::move(coarse));
+                }
+            }
+
+            inline u32 GetWidth() const { return m_Levels.front().width; }
+            inline u32 GetHeight() const { return m_Levels.front().height; }
+
+            // Alpha extent over the inclusive texel range, wrapped as VK_SAMPLER_ADDRESS_MODE_REPEAT does.
+            Extent Query(i64 x0, i64 y0, i64 x1, i64 y1) const
+            {
+                std::array<std::pair<u32, u32>, 2> xs, ys;
+                const u32 xCount = Wrap(x0, x1, GetWidth(), xs);
+                const u32 yCount = Wrap(y0, y1, GetHeight(), ys);
+
+                Extent extent;
+                for (u32 j = 0; j < yCount; ++j) {
+                    for (u32 i = 0; i < xCount; ++i) {
+                        extent.Grow(QueryInside(xs[i].first, ys[j].first, xs[i].second, ys[j].second));
+                    }
+                }
+                return extent;
+            }
+
+        private:
+            struct Level
+            {
+                u32 width { 0 };
+                u32 height { 0 };
+                std::vector<Extent> texels;
+            };
+
+            static u32 Wrap(i64 first, i64 last, u32 size, std::array<std::pair<u32, u32>, 2>& ranges)
+            {
+                if (last - first + 1 >= size) {
+                    ranges[0] = { 0, size - 1 };
+                    return 1;
+                }
+
+                const i64 start = ((first % size) + size) % size;
+                const i64 end = start + (last - first);
+
+                if (end < size) {
+                    ranges[0] = { static_cast<u32>(start), static_cast<u32>(end) };
+                    return 1;
+                }
+
+                ranges[0] = { static_cast<u32>(start), size - 1 };
+                ranges[1] = { 0, static_cast<u32>(end - size) };
+                return 2;
+            }
+
+            Extent QueryInside(u32 x0, u32 y0, u32 x1, u32 y1) const
+            {
+                u32 level = 0;
+                while (level + 1 < m_Levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) {
+                    ++level;
+                }
+
+                const Level& tiles = m_Levels[level];
+
+                Extent extent;
+                for (u32 y = y0 >> level; y <= (y1 >> level); ++y) {
+                    for (u32 x = x0 >> level; x <= (x1 >> level); ++x) {
+                        extent.Grow(tiles.texels[static_cast<usize>(y) * tiles.width + x]);
+                    }
+                }
+                return extent;
+            }
+
+        private:
+            std::vector<Level> m_Levels;
+        };
+
+        // Far outside any texture, yet small enough that wrapping the range cannot overflow.
+        inline constexpr f64 TEXEL_LIMIT { 0x1p40 };
+
+        inline i64 FirstTexel(f32 lower)
+        {
+            return static_cast<i64>(std::clamp(std::floor(static_cast<f64>(lower) - 0.5 - TEXEL_MARGIN), -TEXEL_LIMIT, TEXEL_LIMIT));
+        }
+
+        inline i64 LastTexel(f32 upper)
+        {
+            return static_cast<i64>(std::clamp(std::floor(static_cast<f64>(upper) - 0.5 + TEXEL_MARGIN) + 1.0, -TEXEL_LIMIT, TEXEL_LIMIT));
+        }
+
+        struct Classification
+        {
+            AlphaCoverage::State state { AlphaCoverage::State::Mixed };
+            AlphaCoverage::Mask mask;
+        };
+
+        Classification Classify(const AlphaPyramid& pyramid, const MaterialData& material, const glm::vec2& uv0, const glm::vec2& uv1, const glm::vec2& uv2)
+        {
+            const glm::vec2 size(static_cast<f32>(pyramid.GetWidth()), static_cast<f32>(pyramid.GetHeight()));
+            const f32 scale = material.baseColorFactor.a / 255.0f;
+
+            Classification result;
+
+            for (u32 micro = 0; micro < AlphaCoverage::MICRO_TRIANGLES; ++micro) {
+                glm::vec2 lower(std::numeric_limits<f32>::max());
+                glm::vec2 upper(std::numeric_limits<f32>::lowest());
+
+                for (const auto& b : AlphaCoverage::GetMicroTriangleVertices(micro)) {
+                    const glm::vec2 texel = (uv0 + (uv1 - uv0) * b.x + (uv2 - uv0) * b.y) * size;
+                    lower = glm::min(lower, texel);
+                    upper = glm::max(upper, texel);
+                }
+
+                if (!std::isfinite(lower.x) || !std::isfinite(lower.y) || !std::isfinite(upper.x) || !std::isfinite(upper.y)) continue;
+
+                // A bilinear lookup at p blends the texels around p - 0.5, so the footprint reaches half a
+                // texel past the UV bounds on each side.
+                const Extent extent = pyramid.Query(FirstTexel(lower.x), FirstTexel(lower.y), LastTexel(upper.x), LastTexel(upper.y));
+
+                const u64 bit = u64 { 1 } << micro;
+                if (static_cast<f32>(extent.min) * scale >= material.alphaCutoff + CUTOFF_MARGIN) result.mask.opaque |= bit;
+                else if (static_cast<f32>(extent.max) * scale < material.alphaCutoff - CUTOFF_MARGIN) result.mask.transparent |= bit;
+            }
+
+            constexpr u64 ALL = AlphaCoverage::MICRO_TRIANGLES == 64 ? ~u64 { 0 } : (u64 { 1 } << AlphaCoverage::MICRO_TRIANGLES) - 1;
+
+            if (result.mask.opaque == ALL) result = Classification { AlphaCoverage::State::Opaque, {} };
+            else if (result.mask.transparent == ALL) result = Classification { AlphaCoverage::State::Transparent, {} };
+
+            return result;
+        }
+
+        inline f64 TriangleArea(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+        {
+            return 0.5 * static_cast<f64>(glm::length(glm::cross(p1 - p0, p2 - p0)));
+        }
+
+    }
+
+    AlphaCoverage AlphaCoverage::Build(const SceneData& scene)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        AlphaCoverage coverage;
+
+        auto IsMasked = [&](u32 material) {
+            return material < scene.materials.size() && scene.materials[material].alphaMode == MaterialData::AlphaMode::Mask;
+        };
+
+        auto GetTexture = [&](const MaterialData& material) -> const ImageData* {
+            if (material.baseColorTexture < 0 || static_cast<usize>(material.baseColorTexture) >= scene.textures.size()) return nullptr;
+
+            const auto& image = scene.textures[material.baseColorTexture];
+            return image.width > 0 && image.height > 0 && image.channels == 4 ? &image : nullptr;
+        };
+
+        // Triangle to primitive lookup for the flat parallel pass below.
+        std::vector<const MeshPrimitive*> primitives;
+        std::vector<u32> owners;
+
+        for (const auto& mesh : scene.meshes) {
+            for (const auto& primitive : mesh.primitives) {
+                Range range { static_cast<u32>(coverage.m_States.size()), 0 };
+
+                if (IsMasked(primitive.materialIndex)) {
+                    range.count = primitive.indexCount / 3;
+                    owners.insert(owners.end(), range.count, static_cast<u32>(coverage.m_Primitives.size()));
+                }
+
+                coverage.m_Primitives.push_back(range);
+                coverage.m_States.resize(coverage.m_States.size() + range.count, State::Mixed);
+                primitives.push_back(&primitive);
+            }
+        }
+
+        coverage.m_Masks.resize(coverage.m_States.size());
+
+        std::vector<std::unique_ptr<AlphaPyramid>> pyramids(scene.textures.size());
+        for (const auto& material : scene.materials) {
+            if (material.alphaMode != MaterialData::AlphaMode::Mask) continue;
+
+            const ImageData* image = GetTexture(material);
+            if (image && !pyramids[material.baseColorTexture]) {
+                pyramids[material.baseColorTexture] = std::make_unique<AlphaPyramid>(*image);
+            }
+        }
+
+        CPU::ThreadPool::Get().ParallelFor(static_cast<u32>(owners.size()), TRIANGLE_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 t = begin; t < end; ++t) {
+                const MeshPrimitive& primitive = *primitives[owners[t]];
+                const MaterialData& material = scene.materials[primitive.materialIndex];
+                const u32 local = t - coverage.m_Primitives[owners[t]].first;
+
+                const AlphaPyramid* pyramid = GetTexture(material) ? pyramids[material.baseColorTexture].get() : nullptr;
+
+                if (!pyramid) {
+                    coverage.m_States[t] = material.baseColorFactor.a >= material.alphaCutoff ? State::Opaque : State::Transparent;
+                    continue;
+                }
+
+                const u32* indices = scene.indices.data() + primitive.indexOffset + local * 3;
+                const auto classification = Classify(
+                    *pyramid, material,
+                    scene.vertices[indices[0]].uv0, scene.vertices[indices[1]].uv0, scene.vertices[indices[2]].uv0
+                );
+
+                coverage.m_States[t] = classification.state;
+                coverage.m_Masks[t] = classification.mask;
+            }
+        });
+
+        Stats& stats = coverage.m_Stats;
+
+        for (u32 t = 0; t < owners.size(); ++t) {
+            const MeshPrimitive& primitive = *primitives[owners[t]];
+            const u32* indices = scene.indices.data() + primitive.indexOffset + (t - coverage.m_Primitives[owners[t]].first) * 3;
+
+            const f64 area = TriangleArea(scene.vertices[indices[0]].position, scene.vertices[indices[1]].position, scene.vertices[indices[2]].position);
+
+            stats.triangles++;
+            stats.area += area;
+
+            switch (coverage.m_States[t]) {
+                case State::Opaque:
+                    stats.opaque++;
+                    stats.opaqueArea += area;
+                    stats.resolvedArea += area;
+                    break;
+                case State::Transparent:
+                    stats.transparent++;
+                    stats.transparentArea += area;
+                    stats.resolvedArea += area;
+                    break;
+                case State::Mixed: {
+                    const Mask& mask = coverage.m_Masks[t];
+                    const u32 resolved = static_cast<u32>(std::popcount(mask.opaque) + std::popcount(mask.transparent));
+
+                    stats.mixed++;
+                    stats.resolvedArea += area * resolved / MICRO_TRIANGLES;
+                    break;
+                }
+            }
+        }
+
+        stats.buildTime = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        return coverage;
+    }
+
+    std::span<const AlphaCoverage::State> AlphaCoverage::GetStates(u32 primitive) const
+    {
+        const Range& range = m_Primitives[primitive];
+        return std::span<const State>(m_States).subspan(range.first, range.count);
+    }
+
+    std::span<const AlphaCoverage::Mask> AlphaCoverage::GetMasks(u32 primitive) const
+    {
+        const Range& range = m_Primitives[primitive];
+        return std::span<const Mask>(m_Masks).subspan(range.first, range.count);
+    }
+
+    u32 AlphaCoverage::GetMicroTriangle(const glm::vec2& barycentric)
+    {
+        const f32 n = static_cast<f32>(SUBDIVISIONS);
+        const i32 last = static_cast<i32>(SUBDIVISIONS) - 1;
+
+        const i32 j = std::clamp(static_cast<i32>(std::floor(barycentric.y * n)), 0, last);
+        const i32 i = std::clamp(static_cast<i32>(std::floor(barycentric.x * n)), 0, last - j);
+
+        const bool inverted = i + j < last && (barycentric.x * n - static_cast<f32>(i)) + (barycentric.y * n - static_cast<f32>(j)) > 1.0f;
+
+        return static_cast<u32>(j * (2 * static_cast<i32>(SUBDIVISIONS) - j) + 2 * i) + (inverted ? 1u : 0u);
+    }
+
+    std::array<glm::vec2, 3> AlphaCoverage::GetMicroTriangleVertices(u32 index)
+    {
+        u32 j = 0;
+        while (index >= 2 * (SUBDIVISIONS - j) - 1) {
+            index -= 2 * (SUBDIVISIONS - j) - 1;
+            ++j;
+        }
+
+        const f32 n = static_cast<f32>(SUBDIVISIONS);
+        const f32 i = static_cast<f32>(index / 2);
+        const f32 row = static_cast<f32>(j);
+
+        if (index % 2 == 0) {
+            return { glm::vec2(i, row) / n, glm::vec2(i + 1.0f, row) / n, glm::vec2(i, row + 1.0f) / n };
+        }
+
+        return { glm::vec2(i + 1.0f, row) / n, glm::vec2(i + 1.0f, row + 1.0f) / n, glm::vec2(i, row + 1.0f) / n };
+    }
+
+    void AlphaCoverage::LogStats(const Stats& stats)
+    {
+        if (stats.triangles == 0) return;
+
+        const f64 count = static_cast<f64>(stats.triangles);
+        const f64 area = stats.area > 0.0 ? stats.area : 1.0;
+
+        LOG_INFO("Alpha coverage: {} masked triangles, {:.1f}% opaque, {:.1f}% transparent, {:.1f}% mixed, classified in {:.1f} ms",
+            stats.triangles, 100.0 * stats.opaque / count, 100.0 * stats.transparent / count, 100.0 * stats.mixed / count, stats.buildTime);
+        LOG_INFO("Alpha coverage: any-hit invocations removed for {:.1f}% of masked area, texture fetches for {:.1f}%",
+            100.0 * (stats.opaqueArea + stats.transparentArea) / area, 100.0 * stats.resolvedArea / area);
+    }
+
+}
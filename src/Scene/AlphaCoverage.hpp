@@ -0,0 +1,91 @@
+#pragma once
+
+#include "SceneData.hpp"
+
+namespace Scene {
+
+    // Conservative alpha-test classification of every MASK-material triangle against its base colour
+    // alpha. Each triangle is split into 4^SUBDIVISION_LEVEL equal micro-triangles in barycentric space,
+    // and each micro-triangle's UV footprint is tested against a min/max pyramid of the texture's alpha:
+    // - opaque: every bilinear lookup passes the cutoff
+    // - transparent: every lookup fails it
+    // - mixed: anything else
+    // A triangle whose micro-triangles all agree takes their state. Only mixed triangles keep a Mask, so
+    // the any-hit shader can skip the texture fetch wherever the bits already decide the test.
+    class AlphaCoverage
+    {
+    public:
+        inline static constexpr u32 SUBDIVISION_LEVEL { 3 };
+        inline static constexpr u32 SUBDIVISIONS { 1u << SUBDIVISION_LEVEL };
+        inline static constexpr u32 MICRO_TRIANGLES { SUBDIVISIONS * SUBDIVISIONS };
+
+        enum class State : u8
+        {
+            Opaque,
+            Transparent,
+            Mixed
+        };
+
+        // One bit per micro-triangle; a micro-triangle in neither mask still needs the texture test. Doubles
+        // as the GPU layout read by shaders/alpha.glsl.
+        struct Mask
+        {
+            u64 opaque { 0 };
+            u64 transparent { 0 };
+        };
+
+        static_assert(MICRO_TRIANGLES <= 64);
+
+        struct Stats
+        {
+            u64 triangles { 0 };
+            u64 opaque { 0 };
+            u64 transparent { 0 };
+            u64 mixed { 0 };
+
+            // Object-space area of the classified triangles and of the part of it whose alpha test is
+            // decided without a texture fetch; equal to the share of any-hit fetches removed when rays
+            // hit the surfaces uniformly.
+            f64 area { 0.0 };
+            f64 opaqueArea { 0.0 };
+            f64 transparentArea { 0.0 };
+            f64 resolvedArea { 0.0 };
+
+            f64 buildTime { 0.0 };
+        };
+
+    public:
+        AlphaCoverage() = default;
+
+        static AlphaCoverage Build(const SceneData& scene);
+
+        // Per-triangle states and masks of one primitive, addressed by its position in mesh-major order;
+        // both are empty for primitives that are not alpha-masked.
+        std::span<const State> GetStates(u32 primitive) const;
+        std::span<const Mask> GetMasks(u32 primitive) const;
+
+        inline const Stats& GetStats() const { return m_Stats; }
+
+        // Micro-triangle holding the barycentric point (b1, b2); the layout is row by row along b2, each
+        // row alternating upright and inverted micro-triangles, and matches MicroTriangleIndex in
+        // shaders/alpha.glsl.
+        static u32 GetMicroTriangle(const glm::vec2& barycentric);
+        static std::array<glm::vec2, 3> GetMicroTriangleVertices(u32 index);
+
+        static void LogStats(const Stats& stats);
+
+    private:
+        struct Range
+        {
+            u32 first { 0 };
+            u32 count { 0 };
+        };
+
+        std::vector<Range> m_Primitives;
+        std::vector<State> m_States;
+        std::vector<Mask> m_Masks;
+
+        Stats m_Stats;
+    };
+
+}
@@ -30,20 +30,28 @@ namespace Scene {
 
     void CameraSystem::UpdateMatrices()
     {
-        glm::mat4 view = glm::translate(glm::mat4_cast(glm::conjugate(m_State.rotation)), -m_State.position);
-        glm::mat4 proj = glm::perspective(glm::radians(m_State.vFOV), m_AspectRatio, 0.001f, 1000.0f);
+        m_Data = ComputeShaderData(m_State, m_AspectRatio);
+    }
+
+    CameraData CameraSystem::ComputeShaderData(const CameraState& state, f32 aspectRatio)
+    {
+        glm::mat4 view = glm::translate(glm::mat4_cast(glm::conjugate(state.rotation)), -state.position);
+        glm::mat4 proj = glm::perspective(glm::radians(state.vFOV), aspectRatio, 0.001f, 1000.0f);
 
         proj[1][1] *= -1;
 
-        m_Data.inverseView = glm::inverse(view);
-        m_Data.inverseProj = glm::inverse(proj);
-        m_Data.position = glm::vec4(m_State.position, 1.0f);
-        m_Data.params = glm::vec4(
-            m_State.vFOV,
-            m_AspectRatio,
+        CameraData data;
+        data.inverseView = glm::inverse(view);
+        data.inverseProj = glm::inverse(proj);
+        data.position = glm::vec4(state.position, 1.0f);
+        data.params = glm::vec4(
+            state.vFOV,
+            aspectRatio,
             0.001f,
             1000.0f
         );
+
+        return data;
     }
 
 }
@@ -15,6 +15,8 @@ namespace Scene {
 
         CameraData GetShaderData() const { return m_Data; }
 
+        static CameraData ComputeShaderData(const CameraState& state, f32 aspectRatio);
+
         template <typename T, typename... Args>
             requires std::is_constructible_v<T, Args...> && std::is_base_of_v<CameraRig, T>
         std::shared_ptr<T> AddRig(Args&&... args)
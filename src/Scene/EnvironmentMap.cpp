@@ -0,0 +1,222 @@
+#include "EnvironmentMap.hpp"
+
+#include "CPU/ThreadPool.hpp"
+
+namespace Scene {
+
+    namespace {
+
+        inline constexpr u32 ROW_GRAIN { 8 };
+
+        inline constexpr f32 PI { std::numbers::pi_v<f32> };
+
+        inline f32 Luminance(const glm::vec4& c)
+        {
+            const f32 y = 0.2126f * c.r + 0.7152f * c.g + 0.0722f * c.b;
+            return y > 0.0f ? y : 0.0f;
+        }
+
+        // Prefix-sums values in place into an inclusive CDF ending at 1 and returns their total. An
+        // all-zero range becomes uniform so sampling never divides by zero; its total still reports 0.
+        f64 BuildCDF(std::span<f32> values)
+        {
+            f64 sum = 0.0;
+            for (auto& value : values) {
+                sum += value;
+                value = static_cast<f32>(sum);
+            }
+
+            if (sum > 0.0) {
+                const f64 scale = 1.0 / sum;
+                for (auto& value : values) {
+                    value = static_cast<f32>(value * scale);
+                }
+            } else {
+                for (usize i = 0; i < values.size(); ++i) {
+                    values[i] = static_cast<f32>(i + 1) / static_cast<f32>(values.size());
+                }
+            }
+
+            values.back() = 1.0f;
+            return sum;
+        }
+
+        // Continuous index into a CDF: the bucket holding u plus u's position inside it.
+        f32 SampleCDF(std::span<const f32> cdf, f32 u, f32& pmf)
+        {
+            const usize index = std::min<usize>(std::ranges::upper_bound(cdf, u) - cdf.begin(), cdf.size() - 1);
+            const f32 previous = index > 0 ? cdf[index - 1] : 0.0f;
+
+            pmf = cdf[index] - previous;
+            const f32 offset = pmf > 0.0f ? (u - previous) / pmf : 0.5f;
+
+            return static_cast<f32>(index) + std::clamp(offset, 0.0f, 0x1.fffffep-1f);
+        }
+
+        f32 PmfAt(std::span<const f32> cdf, u32 index)
+        {
+            return cdf[index] - (index > 0 ? cdf[index - 1] : 0.0f);
+        }
+
+    }
+
+    std::optional<EnvironmentMap> EnvironmentMap::Load(const std::filesystem::path& path)
+    {
+        auto image = Image::ImageDecoder::Load(path);
+        if (!image) return std::nullopt;
+
+        if (image->width < 2 || image->height < 1) {
+            LOG_ERROR("Environment map {} is too small", path.string());
+            return std::nullopt;
+        }
+
+        return Build(std::move(*image));
+    }
+
+    EnvironmentMap EnvironmentMap::Build(Image::DecodedImage&& image)
+    {
+        return Build(std::move(image), CPU::ThreadPool::Get());
+    }
+
+    EnvironmentMap EnvironmentMap::Build(Image::DecodedImage&& image, CPU::ThreadPool& pool)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        EnvironmentMap map;
+        map.m_Width = image.width;
+        map.m_Height = image.height;
+        map.m_Pixels = std::move(image.pixels);
+
+        map.m_BlockSize = (map.m_Width + MAX_DISTRIBUTION_WIDTH - 1) / MAX_DISTRIBUTION_WIDTH;
+        map.m_DistributionWidth = (map.m_Width + map.m_BlockSize - 1) / map.m_BlockSize;
+        map.m_DistributionHeight = (map.m_Height + map.m_BlockSize - 1) / map.m_BlockSize;
+
+        const u32 dw = map.m_DistributionWidth;
+        const u32 dh = map.m_DistributionHeight;
+        const u32 block = map.m_BlockSize;
+
+        map.m_CDFSize = dh + static_cast<usize>(dw) * dh;
+        map.m_CDF = std::make_unique_for_overwrite<f32[]>(map.m_CDFSize);
+        std::vector<f64> rowSums(dh);
+
+        // Rows are independent: each sums its block of texels, scales by the row's sin(theta) and turns
+        // into a conditional CDF. Only the short marginal pass below is serial.
+        pool.ParallelFor(dh, ROW_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 y = begin; y < end; ++y) {
+                std::span<f32> row(map.m_CDF.get() + dh + static_cast<usize>(y) * dw, dw);
+                std::ranges::fill(row, 0.0f);
+
+                const u32 firstLine = y * block;
+                const u32 lastLine = std::min(firstLine + block, map.m_Height);
+
+                for (u32 line = firstLine; line < lastLine; ++line) {
+                    const glm::vec4* texels = map.m_Pixels.data() + static_cast<usize>(line) * map.m_Width;
+
+                    for (u32 x = 0; x < dw; ++x) {
+                        const u32 first = x * block;
+                        const u32 last = std::min(first + block, map.m_Width);
+
+                        // Luminance is linear, so the block is summed first and weighted once; clamping each
+                        // texel keeps stray negative channels from cancelling lit neighbours.
+                        glm::vec4 sum(0.0f);
+                        for (u32 t = first; t < last; ++t) {
+                            sum += glm::max(texels[t], glm::vec4(0.0f));
+                        }
+                        row[x] += Luminance(sum);
+                    }
+                }
+
+                const f32 sinTheta = std::sin(PI * (static_cast<f32>(y) + 0.5f) / static_cast<f32>(dh));
+                for (auto& value : row) {
+                    value *= sinTheta;
+                }
+
+                rowSums[y] = BuildCDF(row);
+            }
+        });
+
+        std::span<f32> marginal(map.m_CDF.get(), dh);
+        for (u32 y = 0; y < dh; ++y) {
+            marginal[y] = static_cast<f32>(rowSums[y]);
+        }
+        BuildCDF(marginal);
+
+        const f64 elapsed = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("Environment map: {}x{}, {}x{} distribution built in {:.1f} ms", map.m_Width, map.m_Height, dw, dh, elapsed);
+
+        return map;
+    }
+
+    glm::vec3 EnvironmentMap::Evaluate(const glm::vec3& direction) const
+    {
+        if (m_Pixels.empty()) return glm::vec3(0.0f);
+
+        const glm::vec2 uv = DirectionToUV(direction);
+        const u32 x = std::min(static_cast<u32>(uv.x * static_cast<f32>(m_Width)), m_Width - 1);
+        const u32 y = std::min(static_cast<u32>(uv.y * static_cast<f32>(m_Height)), m_Height - 1);
+
+        return glm::vec3(m_Pixels[static_cast<usize>(y) * m_Width + x]);
+    }
+
+    EnvironmentMap::Sample EnvironmentMap::SampleDirection(const glm::vec2& u) const
+    {
+        Sample sample;
+        if (!m_CDF) return sample;
+
+        const std::span<const f32> marginal(m_CDF.get(), m_DistributionHeight);
+
+        f32 pmfRow = 0.0f;
+        const f32 row = SampleCDF(marginal, u.y, pmfRow);
+
+        const u32 y = static_cast<u32>(row);
+        const std::span<const f32> conditional(m_CDF.get() + m_DistributionHeight + static_cast<usize>(y) * m_DistributionWidth, m_DistributionWidth);
+
+        f32 pmfColumn = 0.0f;
+        const f32 column = SampleCDF(conditional, u.x, pmfColumn);
+
+        const glm::vec2 uv(column / static_cast<f32>(m_DistributionWidth), row / static_cast<f32>(m_DistributionHeight));
+        const f32 sinTheta = std::sin(PI * uv.y);
+        if (sinTheta <= 0.0f) return sample;
+
+        sample.direction = UVToDirection(uv);
+        sample.radiance = Evaluate(sample.direction);
+        sample.pdf = pmfRow * pmfColumn * static_cast<f32>(m_DistributionWidth) * static_cast<f32>(m_DistributionHeight) / (2.0f * PI * PI * sinTheta);
+
+        return sample;
+    }
+
+    f32 EnvironmentMap::Pdf(const glm::vec3& direction) const
+    {
+        if (!m_CDF) return 0.0f;
+
+        const glm::vec2 uv = DirectionToUV(direction);
+        const f32 sinTheta = std::sin(PI * uv.y);
+        if (sinTheta <= 0.0f) return 0.0f;
+
+        const u32 x = std::min(static_cast<u32>(uv.x * static_cast<f32>(m_DistributionWidth)), m_DistributionWidth - 1);
+        const u32 y = std::min(static_cast<u32>(uv.y * static_cast<f32>(m_DistributionHeight)), m_DistributionHeight - 1);
+
+        const std::span<const f32> marginal(m_CDF.get(), m_DistributionHeight);
+        const std::span<const f32> conditional(m_CDF.get() + m_DistributionHeight + static_cast<usize>(y) * m_DistributionWidth, m_DistributionWidth);
+
+        return PmfAt(marginal, y) * PmfAt(conditional, x) * static_cast<f32>(m_DistributionWidth) * static_cast<f32>(m_DistributionHeight) / (2.0f * PI * PI * sinTheta);
+    }
+
+    glm::vec2 EnvironmentMap::DirectionToUV(const glm::vec3& direction)
+    {
+        const f32 phi = std::atan2(direction.z, direction.x);
+        const f32 theta = std::acos(std::clamp(direction.y, -1.0f, 1.0f));
+
+        return glm::vec2(phi / (2.0f * PI) + 0.5f, theta / PI);
+    }
+
+    glm::vec3 EnvironmentMap::UVToDirection(const glm::vec2& uv)
+    {
+        const f32 phi = 2.0f * PI * (uv.x - 0.5f);
+        const f32 theta = PI * uv.y;
+        const f32 sinTheta = std::sin(theta);
+
+        return glm::vec3(sinTheta * std::cos(phi), std::cos(theta), sinTheta * std::sin(phi));
+    }
+
+}
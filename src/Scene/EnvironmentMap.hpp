@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Image/ImageDecoder.hpp"
+
+namespace CPU {
+
+    class ThreadPool;
+
+}
+
+namespace Scene {
+
+    // Equirectangular radiance map with a piecewise-constant 2D distribution for importance sampling: a
+    // marginal CDF over rows and one conditional CDF per row, weighted by luminance times sin(theta).
+    // Maps wider than MAX_DISTRIBUTION_WIDTH are sampled over square blocks of texels, so the tables
+    // stay small while every lit texel keeps a non-zero pdf. The tables double as the GPU layout read
+    // by shaders/environment.glsl.
+    class EnvironmentMap
+    {
+    public:
+        inline static constexpr u32 MAX_DISTRIBUTION_WIDTH { 4096 };
+
+        struct Sample
+        {
+            glm::vec3 direction { 0.0f };
+            glm::vec3 radiance { 0.0f };
+            f32 pdf { 0.0f };
+        };
+
+    public:
+        EnvironmentMap() = default;
+
+        static std::optional<EnvironmentMap> Load(const std::filesystem::path& path);
+        static EnvironmentMap Build(Image::DecodedImage&& image);
+        static EnvironmentMap Build(Image::DecodedImage&& image, CPU::ThreadPool& pool);
+
+        glm::vec3 Evaluate(const glm::vec3& direction) const;
+
+        // Direction with pdf in solid angle; pdf is 0 only for a black map.
+        Sample SampleDirection(const glm::vec2& u) const;
+        f32 Pdf(const glm::vec3& direction) const;
+
+        inline u32 GetWidth() const { return m_Width; }
+        inline u32 GetHeight() const { return m_Height; }
+        inline std::span<const glm::vec4> GetPixels() const { return m_Pixels; }
+
+        // Marginal CDF (GetDistributionHeight() entries) followed by each row's conditional CDF
+        // (GetDistributionWidth() entries); every CDF is inclusive and ends at 1.
+        inline u32 GetDistributionWidth() const { return m_DistributionWidth; }
+        inline u32 GetDistributionHeight() const { return m_DistributionHeight; }
+        inline std::span<const f32> GetDistribution() const { return { m_CDF.get(), m_CDFSize }; }
+
+        inline bool IsEmpty() const { return m_Pixels.empty(); }
+
+        static glm::vec2 DirectionToUV(const glm::vec3& direction);
+        static glm::vec3 UVToDirection(const glm::vec2& uv);
+
+    private:
+        u32 m_Width { 0 };
+        u32 m_Height { 0 };
+        std::vector<glm::vec4> m_Pixels;
+
+        u32 m_DistributionWidth { 0 };
+        u32 m_DistributionHeight { 0 };
+        u32 m_BlockSize { 1 };
+
+        // Left uninitialised on allocation so the first touch, and its page faults, happen on the worker
+        // threads that fill each row.
+        std::unique_ptr<f32[]> m_CDF;
+        usize m_CDFSize { 0 };
+    };
+
+}
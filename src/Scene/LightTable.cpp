@@ -0,0 +1,147 @@
+#include "LightTable.hpp"
+
+namespace Scene {
+
+    namespace {
+
+        // Sub-triangles per edge when averaging an emissive texture over a triangle; n^2 equal-area
+        // centroids, so the estimate is exact for constant and linear emission.
+        inline constexpr u32 TEXTURE_SUBDIVISIONS { 4 };
+
+        inline f32 Luminance(const glm::vec3& c)
+        {
+            return 0.2126f * c.r + 0.7152f * c.g + 0.0722f * c.b;
+        }
+
+        glm::vec3 FetchTexel(const ImageData& tex, const glm::vec2& uv)
+        {
+            if (tex.width == 0 || tex.height == 0 || tex.channels < 3) return glm::vec3(1.0f);
+
+            const i32 width = static_cast<i32>(tex.width);
+            const i32 height = static_cast<i32>(tex.height);
+
+            i32 x = static_cast<i32>(std::floor(uv.x * static_cast<f32>(width)));
+            i32 y = static_cast<i32>(std::floor(uv.y * static_cast<f32>(height)));
+            x = ((x % width) + width) % width;
+            y = ((y % height) + height) % height;
+
+            const std::byte* p = tex.pixels.data() + (static_cast<usize>(y) * tex.width + x) * tex.channels;
+            return glm::vec3(std::to_integer<u8>(p[0]), std::to_integer<u8>(p[1]), std::to_integer<u8>(p[2])) / 255.0f;
+        }
+
+        glm::vec3 AverageEmission(const SceneData& scene, const MaterialData& material, const glm::vec2& uv0, const glm::vec2& uv1, const glm::vec2& uv2)
+        {
+            if (material.emissiveTexture < 0 || static_cast<usize>(material.emissiveTexture) >= scene.textures.size()) {
+                return material.emissiveFactor;
+            }
+
+            const auto& tex = scene.textures[material.emissiveTexture];
+            const f32 n = static_cast<f32>(TEXTURE_SUBDIVISIONS);
+
+            auto Lookup = [&](f32 a, f32 b) {
+                return FetchTexel(tex, uv0 + (uv1 - uv0) * (a / n) + (uv2 - uv0) * (b / n));
+            };
+
+            glm::vec3 sum(0.0f);
+            for (u32 i = 0; i < TEXTURE_SUBDIVISIONS; ++i) {
+                for (u32 j = 0; i + j < TEXTURE_SUBDIVISIONS; ++j) {
+                    const f32 a = static_cast<f32>(i);
+                    const f32 b = static_cast<f32>(j);
+
+                    sum += Lookup(a + 1.0f / 3.0f, b + 1.0f / 3.0f);
+                    if (i + j + 1 < TEXTURE_SUBDIVISIONS) {
+                        sum += Lookup(a + 2.0f / 3.0f, b + 2.0f / 3.0f);
+                    }
+                }
+            }
+
+            return material.emissiveFactor * sum / (n * n);
+        }
+
+    }
+
+    LightTable LightTable::Build(const SceneData& scene)
+    {
+        LightTable table;
+        std::vector<f64> powers;
+
+        for (const auto& node : scene.nodes) {
+            if (node.meshIndex >= scene.meshes.size()) continue;
+
+            for (const auto& prim : scene.meshes[node.meshIndex].primitives) {
+                if (prim.materialIndex >= scene.materials.size()) continue;
+
+                const auto& material = scene.materials[prim.materialIndex];
+                if (Luminance(material.emissiveFactor) <= 0.0f) continue;
+
+                for (u32 i = 0; i + 2 < prim.indexCount; i += 3) {
+                    const auto& v0 = scene.vertices[scene.indices[prim.indexOffset + i + 0]];
+                    const auto& v1 = scene.vertices[scene.indices[prim.indexOffset + i + 1]];
+                    const auto& v2 = scene.vertices[scene.indices[prim.indexOffset + i + 2]];
+
+                    Triangle tri {
+                        .p0 = glm::vec3(node.transform * glm::vec4(v0.position, 1.0f)),
+                        .material = prim.materialIndex,
+                        .p1 = glm::vec3(node.transform * glm::vec4(v1.position, 1.0f)),
+                        .p2 = glm::vec3(node.transform * glm::vec4(v2.position, 1.0f)),
+                        .uv0 = v0.uv0,
+                        .uv1 = v1.uv0,
+                        .uv2 = v2.uv0
+                    };
+
+                    tri.area = 0.5f * glm::length(glm::cross(tri.p1 - tri.p0, tri.p2 - tri.p0));
+
+                    // Radiant exitance of a diffuse emitter is pi * L; kept for absolute power reporting.
+                    const f64 power = std::numbers::pi * Luminance(AverageEmission(scene, material, tri.uv0, tri.uv1, tri.uv2)) * tri.area;
+                    if (!(power > 0.0)) continue;
+
+                    table.m_Triangles.push_back(tri);
+                    powers.push_back(power);
+                }
+            }
+        }
+
+        if (table.m_Triangles.empty()) return table;
+
+        const f64 total = std::accumulate(powers.begin(), powers.end(), 0.0);
+        const usize count = table.m_Triangles.size();
+
+        table.m_TotalPower = static_cast<f32>(total);
+
+        // Vose's alias method: every bucket holds 1/N of the probability mass, split between itself and
+        // at most one alias.
+        std::vector<f64> scaled(count);
+        std::vector<u32> small;
+        std::vector<u32> large;
+
+        for (usize i = 0; i < count; ++i) {
+            table.m_Triangles[i].pdf = static_cast<f32>(powers[i] / total);
+            scaled[i] = powers[i] / total * static_cast<f64>(count);
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<u32>(i));
+        }
+
+        while (!small.empty() && !large.empty()) {
+            const u32 s = small.back();
+            const u32 l = large.back();
+            small.pop_back();
+
+            table.m_Triangles[s].threshold = static_cast<f32>(scaled[s]);
+            table.m_Triangles[s].alias = l;
+
+            scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+
+        // Leftovers are 1 up to rounding.
+        for (u32 i : small) { table.m_Triangles[i].threshold = 1.0f; table.m_Triangles[i].alias = i; }
+        for (u32 i : large) { table.m_Triangles[i].threshold = 1.0f; table.m_Triangles[i].alias = i; }
+
+        LOG_INFO("Light table: {} emissive triangles, total power {:.3f}", count, total);
+
+        return table;
+    }
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "SceneData.hpp"
+
+namespace Scene {
+
+    // Emissive triangles in world space with a power-weighted alias table (Vose), so next-event estimation
+    // picks a light in O(1) with probability proportional to its emitted power. Triangle doubles as the
+    // GPU layout read by shaders/lights.glsl.
+    class LightTable
+    {
+    public:
+        struct Triangle
+        {
+            glm::vec3 p0 { 0.0f };
+            u32 material { 0 };
+            glm::vec3 p1 { 0.0f };
+            f32 area { 0.0f };
+            glm::vec3 p2 { 0.0f };
+            f32 pdf { 0.0f };
+            glm::vec2 uv0 { 0.0f };
+            glm::vec2 uv1 { 0.0f };
+            glm::vec2 uv2 { 0.0f };
+            f32 threshold { 1.0f };
+            u32 alias { 0 };
+        };
+
+        static_assert(sizeof(Triangle) == 80);
+
+    public:
+        LightTable() = default;
+
+        static LightTable Build(const SceneData& scene);
+
+        // Maps one uniform number to a triangle index; the selection probability is GetTriangles()[i].pdf.
+        inline u32 Sample(f32 u) const
+        {
+            const f32 scaled = u * static_cast<f32>(m_Triangles.size());
+            const u32 index = std::min(static_cast<u32>(scaled), static_cast<u32>(m_Triangles.size()) - 1);
+
+            return scaled - static_cast<f32>(index) < m_Triangles[index].threshold ? index : m_Triangles[index].alias;
+        }
+
+        inline std::span<const Triangle> GetTriangles() const { return m_Triangles; }
+        inline f32 GetTotalPower() const { return m_TotalPower; }
+        inline bool IsEmpty() const { return m_Triangles.empty(); }
+
+    private:
+        std::vector<Triangle> m_Triangles;
+        f32 m_TotalPower { 0.0f };
+    };
+
+}
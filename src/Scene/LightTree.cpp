@@ -0,0 +1,318 @@
+#include "LightTree.hpp"
+
+namespace Scene {
+
+    namespace {
+
+        inline constexpr u32 SPLIT_BUCKETS { 12 };
+
+        // Diffuse emitters: light leaves over the full hemisphere around each normal.
+        inline constexpr f32 COS_THETA_E { 0.0f };
+
+        inline constexpr f32 PI { std::numbers::pi_v<f32> };
+
+        inline f32 SafeSqrt(f32 x) { return std::sqrt(std::max(x, 0.0f)); }
+        inline f32 SafeAcos(f32 x) { return std::acos(std::clamp(x, -1.0f, 1.0f)); }
+
+        struct Cone
+        {
+            glm::vec3 axis { 0.0f, 0.0f, 1.0f };
+            f32 cosTheta { 1.0f };
+            bool empty { true };
+        };
+
+        // Smallest cone holding both inputs, folding b onto a's hemisphere first since a light with
+        // normal n covers -n as well.
+        Cone Union(const Cone& a, Cone b)
+        {
+            if (a.empty) return b;
+            if (b.empty) return a;
+
+            if (glm::dot(a.axis, b.axis) < 0.0f) b.axis = -b.axis;
+
+            const f32 thetaA = SafeAcos(a.cosTheta);
+            const f32 thetaB = SafeAcos(b.cosTheta);
+            const f32 thetaD = SafeAcos(glm::dot(a.axis, b.axis));
+
+            if (std::min(thetaD + thetaB, PI) <= thetaA) return a;
+            if (std::min(thetaD + thetaA, PI) <= thetaB) return b;
+
+            const f32 thetaO = 0.5f * (thetaA + thetaD + thetaB);
+            if (thetaO >= PI) return Cone { a.axis, -1.0f, false };
+
+            const glm::vec3 rotationAxis = glm::cross(a.axis, b.axis);
+            if (glm::dot(rotationAxis, rotationAxis) < 1e-12f) return Cone { a.axis, -1.0f, false };
+
+            // Rodrigues rotation of a's axis towards b's by thetaO - thetaA.
+            const glm::vec3 k = glm::normalize(rotationAxis);
+            const f32 angle = thetaO - thetaA;
+            const glm::vec3 axis = a.axis * std::cos(angle) + glm::cross(k, a.axis) * std::sin(angle) + k * glm::dot(k, a.axis) * (1.0f - std::cos(angle));
+
+            return Cone { glm::normalize(axis), std::cos(thetaO), false };
+        }
+
+        struct Bounds
+        {
+            glm::vec3 min { std::numeric_limits<f32>::max() };
+            glm::vec3 max { std::numeric_limits<f32>::lowest() };
+            f64 power { 0.0 };
+            Cone cone;
+
+            void Merge(const Bounds& other)
+            {
+                min = glm::min(min, other.min);
+                max = glm::max(max, other.max);
+                power += other.power;
+                cone = Union(cone, other.cone);
+            }
+
+            f32 SurfaceArea() const
+            {
+                const glm::vec3 d = glm::max(max - min, glm::vec3(0.0f));
+                return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+            }
+        };
+
+        // Surface area orientation heuristic: power times the solid angle the cone can light.
+        f64 OrientationCost(const Bounds& b, f32 regularizer)
+        {
+            const f32 thetaO = SafeAcos(b.cone.cosTheta);
+            const f32 thetaW = std::min(thetaO + PI * 0.5f, PI);
+            const f32 sinThetaO = SafeSqrt(1.0f - b.cone.cosTheta * b.cone.cosTheta);
+
+            const f32 measure = 2.0f * PI * (1.0f - b.cone.cosTheta)
+                + 0.5f * PI * (2.0f * thetaW * sinThetaO - std::cos(thetaO - 2.0f * thetaW) - 2.0f * thetaO * sinThetaO + b.cone.cosTheta);
+
+            return b.power * measure * std::max(b.SurfaceArea(), 1e-12f) * regularizer;
+        }
+
+        struct Builder
+        {
+            std::vector<LightTree::Node>& nodes;
+            std::vector<Bounds>& lights;
+            std::vector<glm::vec3>& centroids;
+            std::vector<u32>& order;
+
+            u32 Build(u32 begin, u32 end)
+            {
+                Bounds bounds;
+                glm::vec3 centroidMin(std::numeric_limits<f32>::max());
+                glm::vec3 centroidMax(std::numeric_limits<f32>::lowest());
+
+                for (u32 i = begin; i < end; ++i) {
+                    bounds.Merge(lights[order[i]]);
+                    centroidMin = glm::min(centroidMin, centroids[order[i]]);
+                    centroidMax = glm::max(centroidMax, centroids[order[i]]);
+                }
+
+                const u32 index = static_cast<u32>(nodes.size());
+                nodes.push_back(LightTree::Node {
+                    .boundsMin = bounds.min,
+                    .power = static_cast<f32>(bounds.power),
+                    .boundsMax = bounds.max,
+                    .cosThetaO = bounds.cone.cosTheta,
+                    .axis = bounds.cone.axis
+                });
+
+                if (end - begin == 1) {
+                    nodes[index].child = order[begin] | LightTree::LEAF_BIT;
+                    return index;
+                }
+
+                const u32 mid = Split(begin, end, bounds, centroidMin, centroidMax);
+
+                Build(begin, mid);
+                const u32 right = Build(mid, end);
+
+                nodes[index].child = right;
+                return index;
+            }
+
+            u32 Split(u32 begin, u32 end, const Bounds& bounds, const glm::vec3& centroidMin, const glm::vec3& centroidMax)
+            {
+                const glm::vec3 extent = centroidMax - centroidMin;
+                const glm::vec3 diagonal = bounds.max - bounds.min;
+                const f32 maxDiagonal = std::max({ diagonal.x, diagonal.y, diagonal.z });
+
+                f64 bestCost = std::numeric_limits<f64>::max();
+                i32 bestAxis = -1;
+                u32 bestBucket = 0;
+
+                for (i32 axis = 0; axis < 3; ++axis) {
+                    if (extent[axis] <= 0.0f) continue;
+
+                    std::array<Bounds, SPLIT_BUCKETS> buckets;
+                    for (u32 i = begin; i < end; ++i) {
+                        buckets[BucketOf(centroids[order[i]], axis, centroidMin, extent)].Merge(lights[order[i]]);
+                    }
+
+                    // Penalises thin slabs so splits along a flat axis do not win on area alone.
+                    const f32 regularizer = maxDiagonal / std::max(diagonal[axis], 1e-12f);
+
+                    std::array<f64, SPLIT_BUCKETS - 1> costs {};
+
+                    Bounds below;
+                    for (u32 b = 0; b + 1 < SPLIT_BUCKETS; ++b) {
+                        below.Merge(buckets[b]);
+                        costs[b] = below.power > 0.0 ? OrientationCost(below, regularizer) : 0.0;
+                    }
+
+                    Bounds above;
+                    for (u32 b = SPLIT_BUCKETS - 1; b > 0; --b) {
+                        above.Merge(buckets[b]);
+                        costs[b - 1] += above.power > 0.0 ? OrientationCost(above, regularizer) : 0.0;
+                    }
+
+                    for (u32 b = 0; b + 1 < SPLIT_BUCKETS; ++b) {
+                        if (costs[b] < bestCost) {
+                            bestCost = costs[b];
+                            bestAxis = axis;
+                            bestBucket = b;
+                        }
+                    }
+                }
+
+                u32 mid = begin;
+                if (bestAxis >= 0) {
+                    auto first = order.begin() + begin;
+                    auto last = order.begin() + end;
+                    mid = static_cast<u32>(std::partition(first, last, [&](u32 light) {
+                        return BucketOf(centroids[light], bestAxis, centroidMin, extent) <= bestBucket;
+                    }) - order.begin());
+                }
+
+                // Coincident centroids or a degenerate partition: split by count.
+                if (mid == begin || mid == end) {
+                    mid = begin + (end - begin) / 2;
+                }
+
+                return mid;
+            }
+
+            static u32 BucketOf(const glm::vec3& centroid, i32 axis, const glm::vec3& centroidMin, const glm::vec3& extent)
+            {
+                const u32 bucket = static_cast<u32>(static_cast<f32>(SPLIT_BUCKETS) * (centroid[axis] - centroidMin[axis]) / extent[axis]);
+                return std::min(bucket, SPLIT_BUCKETS - 1);
+            }
+        };
+
+    }
+
+    LightTree LightTree::Build(const LightTable& table)
+    {
+        LightTree tree;
+
+        const auto triangles = table.GetTriangles();
+        if (triangles.empty()) return tree;
+
+        std::vector<Bounds> lights(triangles.size());
+        std::vector<glm::vec3> centroids(triangles.size());
+        std::vector<u32> order(triangles.size());
+
+        for (usize i = 0; i < triangles.size(); ++i) {
+            const auto& tri = triangles[i];
+
+            glm::vec3 normal = glm::cross(tri.p1 - tri.p0, tri.p2 - tri.p0);
+            normal = glm::dot(normal, normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f, 0.0f, 1.0f);
+
+            lights[i] = Bounds {
+                .min = glm::min(tri.p0, glm::min(tri.p1, tri.p2)),
+                .max = glm::max(tri.p0, glm::max(tri.p1, tri.p2)),
+                .power = static_cast<f64>(tri.pdf) * table.GetTotalPower(),
+                .cone = Cone { normal, 1.0f, false }
+            };
+
+            centroids[i] = (tri.p0 + tri.p1 + tri.p2) / 3.0f;
+            order[i] = static_cast<u32>(i);
+        }
+
+        tree.m_Nodes.reserve(triangles.size() * 2 - 1);
+
+        Builder builder { tree.m_Nodes, lights, centroids, order };
+        builder.Build(0, static_cast<u32>(triangles.size()));
+
+        LOG_INFO("Light tree: {} nodes over {} emissive triangles", tree.m_Nodes.size(), triangles.size());
+
+        return tree;
+    }
+
+    f32 LightTree::Importance(const Node& node, const glm::vec3& position, const glm::vec3& normal)
+    {
+        // Angle differences clamped at zero, in sin/cos form so no acos is needed.
+        auto CosSubClamped = [](f32 sinA, f32 cosA, f32 sinB, f32 cosB) {
+            return cosA > cosB ? 1.0f : cosA * cosB + sinA * sinB;
+        };
+        auto SinSubClamped = [](f32 sinA, f32 cosA, f32 sinB, f32 cosB) {
+            return cosA > cosB ? 0.0f : sinA * cosB - cosA * sinB;
+        };
+
+        const glm::vec3 center = 0.5f * (node.boundsMin + node.boundsMax);
+        const glm::vec3 diagonal = node.boundsMax - node.boundsMin;
+
+        const glm::vec3 toPoint = position - center;
+        const f32 d2 = std::max(glm::dot(toPoint, toPoint), 0.5f * glm::length(diagonal));
+
+        // Half-angle subtended by the bounding sphere; everything is visible from inside it.
+        const f32 radius2 = 0.25f * glm::dot(diagonal, diagonal);
+        const f32 distance2 = glm::dot(toPoint, toPoint);
+        const f32 cosThetaB = distance2 < radius2 ? -1.0f : SafeSqrt(1.0f - radius2 / distance2);
+        const f32 sinThetaB = SafeSqrt(1.0f - cosThetaB * cosThetaB);
+
+        const glm::vec3 wi = distance2 > 0.0f ? toPoint / std::sqrt(distance2) : glm::vec3(0.0f, 0.0f, 1.0f);
+
+        const f32 cosThetaW = std::abs(glm::dot(node.axis, wi));
+        const f32 sinThetaW = SafeSqrt(1.0f - cosThetaW * cosThetaW);
+        const f32 sinThetaO = SafeSqrt(1.0f - node.cosThetaO * node.cosThetaO);
+
+        const f32 cosThetaX = CosSubClamped(sinThetaW, cosThetaW, sinThetaO, node.cosThetaO);
+        const f32 sinThetaX = SinSubClamped(sinThetaW, cosThetaW, sinThetaO, node.cosThetaO);
+        const f32 cosThetaP = CosSubClamped(sinThetaX, cosThetaX, sinThetaB, cosThetaB);
+
+        if (cosThetaP <= COS_THETA_E) return 0.0f;
+
+        f32 importance = node.power * cosThetaP / d2;
+
+        if (glm::dot(normal, normal) > 0.0f) {
+            const f32 cosThetaI = std::abs(glm::dot(wi, normal));
+            const f32 sinThetaI = SafeSqrt(1.0f - cosThetaI * cosThetaI);
+            importance *= CosSubClamped(sinThetaI, cosThetaI, sinThetaB, cosThetaB);
+        }
+
+        return std::max(importance, 0.0f);
+    }
+
+    std::optional<u32> LightTree::Sample(const glm::vec3& position, const glm::vec3& normal, f32 u, f32& pmf) const
+    {
+        pmf = 0.0f;
+        if (m_Nodes.empty()) return std::nullopt;
+
+        f32 probability = 1.0f;
+        u32 index = 0;
+
+        while (!(m_Nodes[index].child & LEAF_BIT)) {
+            const u32 left = index + 1;
+            const u32 right = m_Nodes[index].child;
+
+            const f32 importanceLeft = Importance(m_Nodes[left], position, normal);
+            const f32 importanceRight = Importance(m_Nodes[right], position, normal);
+
+            if (importanceLeft <= 0.0f && importanceRight <= 0.0f) return std::nullopt;
+
+            // One uniform number drives the whole descent: rescale the part that chose the child.
+            const f32 pLeft = importanceLeft / (importanceLeft + importanceRight);
+            if (u < pLeft) {
+                u = std::min(u / pLeft, 0x1.fffffep-1f);
+                probability *= pLeft;
+                index = left;
+            } else {
+                u = std::min((u - pLeft) / (1.0f - pLeft), 0x1.fffffep-1f);
+                probability *= 1.0f - pLeft;
+                index = right;
+            }
+        }
+
+        pmf = probability;
+        return m_Nodes[index].child & ~LEAF_BIT;
+    }
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "LightTable.hpp"
+
+namespace Scene {
+
+    // Light BVH over the emissive triangles of a LightTable (Conty Estevez & Kulla, "Importance Sampling
+    // of Many Lights with Adaptive Tree Splitting", 2018). Each node bounds its lights' positions,
+    // orientations and power; sampling walks from the root, picking a child in proportion to its
+    // importance at the shading point. Node doubles as the GPU layout read by shaders/lights.glsl.
+    class LightTree
+    {
+    public:
+        inline static constexpr u32 LEAF_BIT { 0x80000000u };
+
+        // Interior nodes keep the left child at index + 1 and the right child in child; leaves set
+        // LEAF_BIT and store a LightTable triangle index. The orientation cone is folded: emitters are
+        // double-sided, so a light with normal n also covers -n.
+        struct Node
+        {
+            glm::vec3 boundsMin { 0.0f };
+            f32 power { 0.0f };
+            glm::vec3 boundsMax { 0.0f };
+            f32 cosThetaO { 1.0f };
+            glm::vec3 axis { 0.0f, 0.0f, 1.0f };
+            u32 child { 0 };
+        };
+
+        static_assert(sizeof(Node) == 48);
+
+    public:
+        LightTree() = default;
+
+        static LightTree Build(const LightTable& lights);
+
+        // Returns a triangle index and its selection probability, or nullopt if no light can contribute
+        // to a receiver at position with normal (pass a zero normal for none).
+        std::optional<u32> Sample(const glm::vec3& position, const glm::vec3& normal, f32 u, f32& pmf) const;
+
+        inline std::span<const Node> GetNodes() const { return m_Nodes; }
+        inline bool IsEmpty() const { return m_Nodes.empty(); }
+
+        static f32 Importance(const Node& node, const glm::vec3& position, const glm::vec3& normal);
+
+    private:
+        std::vector<Node> m_Nodes;
+    };
+
+}
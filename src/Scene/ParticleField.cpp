@@ -0,0 +1,60 @@
+#include "ParticleField.hpp"
+
+#include "CPU/ThreadPool.hpp"
+
+namespace Scene {
+
+    namespace {
+
+        inline constexpr u32 PARTICLE_GRAIN { 1u << 14 };
+
+        inline u64 SplitMix64(u64& state)
+        {
+            u64 z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        inline f32 ToUnitFloat(u64 bits)
+        {
+            return static_cast<f32>(bits >> 40) * 0x1p-24f;
+        }
+
+    }
+
+    std::vector<ProceduralPrimitive> ParticleField::Scatter(const Settings& settings)
+    {
+        std::vector<ProceduralPrimitive> particles(settings.count);
+
+        CPU::ThreadPool::Get().ParallelFor(settings.count, PARTICLE_GRAIN, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i) {
+                u64 state = (static_cast<u64>(settings.seed) << 32) | i;
+                auto Next = [&]() { return ToUnitFloat(SplitMix64(state)); };
+
+                // Draws are sequenced explicitly; the order of evaluation of constructor arguments is not.
+                const f32 x = Next();
+                const f32 y = Next();
+                const f32 z = Next();
+
+                ProceduralPrimitive& particle = particles[i];
+                particle.a = glm::mix(settings.min, settings.max, glm::vec3(x, y, z));
+                particle.radius = glm::mix(settings.minRadius, settings.maxRadius, Next());
+                particle.b = particle.a;
+                particle.material = settings.material;
+
+                if (Next() < settings.capsuleFraction) {
+                    const f32 cosTheta = 2.0f * Next() - 1.0f;
+                    const f32 phi = 2.0f * std::numbers::pi_v<f32> * Next();
+                    const f32 sinTheta = std::sqrt(std::max(1.0f - cosTheta * cosTheta, 0.0f));
+                    const f32 length = particle.radius * settings.capsuleLength * Next();
+
+                    particle.b += glm::vec3(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta) * length;
+                }
+            }
+        });
+
+        return particles;
+    }
+
+}
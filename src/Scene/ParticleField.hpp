@@ -0,0 +1,33 @@
+#pragma once
+
+#include "SceneData.hpp"
+
+namespace Scene {
+
+    // Spheres and rounded capsules scattered uniformly through a box, as procedural primitives. Every
+    // particle is a pure function of (seed, index), so the field is identical at any thread count.
+    class ParticleField
+    {
+    public:
+        struct Settings
+        {
+            u32 count { 0 };
+            glm::vec3 min { -1.0f };
+            glm::vec3 max { 1.0f };
+
+            f32 minRadius { 0.005f };
+            f32 maxRadius { 0.02f };
+
+            // Share of particles that are capsules, with a segment up to this many radii long.
+            f32 capsuleFraction { 0.25f };
+            f32 capsuleLength { 4.0f };
+
+            u32 material { 0 };
+            u32 seed { 1 };
+        };
+
+    public:
+        static std::vector<ProceduralPrimitive> Scatter(const Settings& settings);
+    };
+
+}
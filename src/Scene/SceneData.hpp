@@ -60,6 +60,21 @@ namespace Scene {
         std::vector<MeshPrimitive> primitives;
     };
 
+    // Analytic primitive traced through AABB geometry and shaders/procedural.rint: a sphere when a == b,
+    // otherwise a capsule of the given radius around segment ab. Doubles as the GPU layout.
+    struct ProceduralPrimitive
+    {
+        glm::vec3 a { 0.0f };
+        f32 radius { 0.0f };
+        glm::vec3 b { 0.0f };
+        u32 material { 0 };
+
+        inline glm::vec3 GetMin() const { return glm::min(a, b) - radius; }
+        inline glm::vec3 GetMax() const { return glm::max(a, b) + radius; }
+    };
+
+    static_assert(sizeof(ProceduralPrimitive) == 32);
+
     struct Node
     {
         glm::mat4 transform { 1.0f };
@@ -76,6 +91,9 @@ namespace Scene {
 
         std::vector<Mesh> meshes;
         std::vector<Node> nodes;
+
+        // World space; rendered by the GPU tracer only.
+        std::vector<ProceduralPrimitive> procedurals;
     };
 
 }